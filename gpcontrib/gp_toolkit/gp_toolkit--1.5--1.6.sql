@@ -0,0 +1,152 @@
+/* gpcontrib/gp_toolkit/gp_toolkit--1.5--1.6.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION gp_toolkit UPDATE TO '1.6'" to load this file. \quit
+
+-- Internal function that will be used by gp_toolkit.gp_interconnect_proxy_peers
+CREATE TYPE gp_toolkit.__ic_proxy_peer_stats AS (segindex int4, peer_segindex int4, peer_dbid int4,
+    queued_packets int8, queued_bytes int8, send_bps int8, recv_bps int8,
+    packets_sent int8, bytes_sent int8, writes int8, packets_received int8, bytes_received int8);
+
+CREATE FUNCTION gp_toolkit.__gp_ic_proxy_peer_stats() RETURNS SETOF gp_toolkit.__ic_proxy_peer_stats AS 'gp_toolkit.so','gp_ic_proxy_get_peer_stats' LANGUAGE C STRICT;
+
+GRANT EXECUTE ON FUNCTION gp_toolkit.__gp_ic_proxy_peer_stats TO public;
+
+--------------------------------------------------------------------------------
+-- @view:
+--              gp_toolkit.gp_interconnect_proxy_peers
+--
+-- @doc:
+--              Traffic of the ic-proxy of each segment to each of its peers,
+--              when gp_interconnect_type is proxy.  The queue depths and the
+--              rates, in bytes per second, are sampled every second, the other
+--              columns count from the start of the ic-proxy.  packets_sent
+--              over writes is how many packets are coalesced into one write.
+--
+--------------------------------------------------------------------------------
+
+CREATE VIEW gp_toolkit.gp_interconnect_proxy_peers AS
+    SELECT stats.segindex,
+           segs.hostname,
+           stats.peer_segindex,
+           stats.peer_dbid,
+           peers.hostname AS peer_hostname,
+           stats.queued_packets,
+           stats.queued_bytes,
+           stats.send_bps,
+           stats.recv_bps,
+           stats.packets_sent,
+           stats.bytes_sent,
+           stats.writes,
+           stats.packets_received,
+           stats.bytes_received
+    FROM (SELECT (gp_toolkit.__gp_ic_proxy_peer_stats()).* FROM gp_id
+          UNION ALL
+          SELECT (gp_toolkit.__gp_ic_proxy_peer_stats()).* FROM gp_dist_random('gp_id')) AS stats
+    JOIN gp_segment_configuration AS segs
+      ON stats.segindex = segs.content AND segs.role = 'p'
+    LEFT JOIN gp_segment_configuration AS peers
+      ON stats.peer_dbid = peers.dbid;
+
+GRANT SELECT ON gp_toolkit.gp_interconnect_proxy_peers TO public;
+
+-- Internal function that will be used by gp_toolkit.gp_interconnect_connections
+CREATE TYPE gp_toolkit.__interconnect_conn_stats AS (segindex int4, sess_id int4, command_count int4,
+    motion_id int4, direction text, peer_segindex int4, peer_pid int4, peer_address text,
+    shared_memory bool, end_time timestamptz, packets int8,
+    rtt_min_us int8, rtt_avg_us float8, rtt_max_us int8, rtt_histogram int8[],
+    retransmits int8, stalls int8, stall_time_us int8,
+    disordered int8, duplicated int8, dropped int8, queue_avg float8, queue_max int4);
+
+CREATE FUNCTION gp_toolkit.__gp_interconnect_conn_stats() RETURNS SETOF gp_toolkit.__interconnect_conn_stats AS 'gp_toolkit.so','gp_interconnect_get_conn_stats' LANGUAGE C STRICT;
+
+GRANT EXECUTE ON FUNCTION gp_toolkit.__gp_interconnect_conn_stats TO public;
+
+--------------------------------------------------------------------------------
+-- @view:
+--              gp_toolkit.gp_interconnect_connections
+--
+-- @doc:
+--              Statistics of the last 2048 interconnect connections of each
+--              segment, recorded when the query tears down its interconnect.
+--              There is a row for each end of a connection that carried a
+--              packet; sess_id and command_count tell the query, motion_id
+--              its motion node.
+--
+--              The sender's columns: the ack times of its packets (rtt), in
+--              microseconds, with a histogram of the packets sent only once
+--              whose bucket i counts the acks that took less than 32 << i
+--              microseconds and the last bucket the slower ones; the
+--              retransmits; and the stalls, where it waited for acks to get
+--              a send buffer.  The receiver's columns: the packets that came
+--              out of order, duplicated or were dropped, and the depth of its
+--              receive queue.
+--
+--              Only the UDP interconnect keeps these statistics.
+--
+--------------------------------------------------------------------------------
+
+CREATE VIEW gp_toolkit.gp_interconnect_connections AS
+    SELECT stats.segindex,
+           segs.hostname,
+           stats.sess_id,
+           stats.command_count,
+           stats.motion_id,
+           stats.direction,
+           stats.peer_segindex,
+           stats.peer_pid,
+           stats.peer_address,
+           stats.shared_memory,
+           stats.end_time,
+           stats.packets,
+           stats.rtt_min_us,
+           stats.rtt_avg_us,
+           stats.rtt_max_us,
+           stats.rtt_histogram,
+           stats.retransmits,
+           stats.stalls,
+           stats.stall_time_us,
+           stats.disordered,
+           stats.duplicated,
+           stats.dropped,
+           stats.queue_avg,
+           stats.queue_max
+    FROM (SELECT (gp_toolkit.__gp_interconnect_conn_stats()).* FROM gp_id
+          UNION ALL
+          SELECT (gp_toolkit.__gp_interconnect_conn_stats()).* FROM gp_dist_random('gp_id')) AS stats
+    JOIN gp_segment_configuration AS segs
+      ON stats.segindex = segs.content AND segs.role = 'p';
+
+GRANT SELECT ON gp_toolkit.gp_interconnect_connections TO public;
+
+--------------------------------------------------------------------------------
+-- @view:
+--              gp_toolkit.gp_interconnect_host_pairs
+--
+-- @doc:
+--              gp_toolkit.gp_interconnect_connections summed up for each
+--              host and peer address, to find the NIC or switch port that
+--              loses or delays packets: it has many more retransmits or out
+--              of order packets, or slower acks, than the other pairs.
+--
+--------------------------------------------------------------------------------
+
+CREATE VIEW gp_toolkit.gp_interconnect_host_pairs AS
+    SELECT hostname,
+           peer_address,
+           count(*) AS connections,
+           sum(packets) AS packets,
+           sum(retransmits) AS retransmits,
+           round(sum(retransmits) * 100.0 / nullif(sum(packets) FILTER (WHERE direction = 'send'), 0), 3) AS retransmit_pct,
+           sum(rtt_avg_us * packets) FILTER (WHERE direction = 'send') / nullif(sum(packets) FILTER (WHERE direction = 'send' AND rtt_avg_us IS NOT NULL), 0) AS rtt_avg_us,
+           max(rtt_max_us) AS rtt_max_us,
+           sum(stalls) AS stalls,
+           sum(stall_time_us) AS stall_time_us,
+           sum(disordered) AS disordered,
+           sum(duplicated) AS duplicated,
+           sum(dropped) AS dropped
+    FROM gp_toolkit.gp_interconnect_connections
+    WHERE NOT shared_memory
+    GROUP BY hostname, peer_address;
+
+GRANT SELECT ON gp_toolkit.gp_interconnect_host_pairs TO public;
@@ -0,0 +1,92 @@
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbvars.h"
+#include "cdb/ic_proxy_bgworker.h"
+#include "funcapi.h"
+
+#define IC_PROXY_PEER_STATS_NATTS	12
+
+PG_FUNCTION_INFO_V1(gp_ic_proxy_get_peer_stats);
+
+/*
+ * Return the traffic statistics of the peers of the ic-proxy bgworker of this
+ * segment, one row for each peer.  Nothing is returned if the ic-proxy is not
+ * built in.
+ */
+Datum
+gp_ic_proxy_get_peer_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	int		   *slot;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldContext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		oldContext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(IC_PROXY_PEER_STATS_NATTS);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "segindex", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "peer_segindex", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "peer_dbid", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "queued_packets", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "queued_bytes", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "send_bps", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "recv_bps", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "packets_sent", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "bytes_sent", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "writes", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "packets_received", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "bytes_received", INT8OID, -1, 0);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		slot = palloc0(sizeof(int));
+		funcctx->user_fctx = slot;
+
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	slot = funcctx->user_fctx;
+
+#ifdef ENABLE_IC_PROXY
+	while (*slot < IC_PROXY_MAX_PEER_STATS)
+	{
+		ICProxyPeerStats *stats = &ic_proxy_peer_stats[(*slot)++];
+		Datum		values[IC_PROXY_PEER_STATS_NATTS];
+		bool		nulls[IC_PROXY_PEER_STATS_NATTS];
+		uint32		dbid;
+		HeapTuple	tuple;
+
+		dbid = pg_atomic_read_u32(&stats->dbid);
+		if (dbid == 0)
+			continue;
+		/* pairs with the write barrier of the proxy taking the slot */
+		pg_read_barrier();
+
+		MemSet(nulls, 0, sizeof(nulls));
+		values[0] = Int32GetDatum(GpIdentity.segindex);
+		values[1] = Int32GetDatum(stats->content);
+		values[2] = Int32GetDatum(dbid);
+		values[3] = Int64GetDatum(pg_atomic_read_u64(&stats->queued_packets));
+		values[4] = Int64GetDatum(pg_atomic_read_u64(&stats->queued_bytes));
+		values[5] = Int64GetDatum(pg_atomic_read_u64(&stats->send_rate));
+		values[6] = Int64GetDatum(pg_atomic_read_u64(&stats->recv_rate));
+		values[7] = Int64GetDatum(pg_atomic_read_u64(&stats->packets_sent));
+		values[8] = Int64GetDatum(pg_atomic_read_u64(&stats->bytes_sent));
+		values[9] = Int64GetDatum(pg_atomic_read_u64(&stats->writes));
+		values[10] = Int64GetDatum(pg_atomic_read_u64(&stats->packets_received));
+		values[11] = Int64GetDatum(pg_atomic_read_u64(&stats->bytes_received));
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+#endif
+
+	SRF_RETURN_DONE(funcctx);
+}
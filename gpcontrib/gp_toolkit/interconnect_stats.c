@@ -0,0 +1,138 @@
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbvars.h"
+#include "cdb/ic_stats.h"
+#include "funcapi.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/timestamp.h"
+
+#define IC_CONN_STATS_NATTS	23
+
+PG_FUNCTION_INFO_V1(gp_interconnect_get_conn_stats);
+
+/*
+ * Return the history of the statistics of the recent interconnect
+ * connections of this segment, one row for each end of a connection.
+ */
+Datum
+gp_interconnect_get_conn_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	int		   *slot;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldContext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		oldContext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(IC_CONN_STATS_NATTS);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "segindex", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "sess_id", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "command_count", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "motion_id", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "direction", TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "peer_segindex", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "peer_pid", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "peer_address", TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "shared_memory", BOOLOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "end_time", TIMESTAMPTZOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "packets", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "rtt_min_us", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 13, "rtt_avg_us", FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 14, "rtt_max_us", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 15, "rtt_histogram", INT8ARRAYOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 16, "retransmits", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 17, "stalls", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 18, "stall_time_us", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 19, "disordered", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 20, "duplicated", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 21, "dropped", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 22, "queue_avg", FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 23, "queue_max", INT4OID, -1, 0);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		slot = palloc0(sizeof(int));
+		funcctx->user_fctx = slot;
+
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	slot = funcctx->user_fctx;
+
+	while (*slot < IC_STATS_HISTORY_SIZE)
+	{
+		ICConnStats stats;
+		Datum		values[IC_CONN_STATS_NATTS];
+		bool		nulls[IC_CONN_STATS_NATTS];
+		Datum		hist[IC_RTT_HIST_BUCKETS];
+		HeapTuple	tuple;
+
+		if (!ic_stats_read((*slot)++, &stats))
+			continue;
+
+		MemSet(nulls, 0, sizeof(nulls));
+		values[0] = Int32GetDatum(GpIdentity.segindex);
+		values[1] = Int32GetDatum(stats.sessionId);
+		values[2] = Int32GetDatum(stats.commandCount);
+		values[3] = Int32GetDatum(stats.motNodeId);
+		values[4] = CStringGetTextDatum(stats.isSender ? "send" : "receive");
+		values[5] = Int32GetDatum(stats.remoteContentId);
+		values[6] = Int32GetDatum(stats.remotePid);
+		values[7] = CStringGetTextDatum(stats.remoteAddr);
+		values[8] = BoolGetDatum(stats.viaShm);
+		values[9] = TimestampTzGetDatum(stats.endTime);
+		values[10] = Int64GetDatum(stats.packets);
+
+		/* the sender's columns */
+		if (stats.isSender && stats.maxRtt > 0)
+		{
+			values[11] = Int64GetDatum(stats.minRtt);
+			values[12] = Float8GetDatum((double) stats.totalRtt / stats.packets);
+			values[13] = Int64GetDatum(stats.maxRtt);
+		}
+		else
+			nulls[11] = nulls[12] = nulls[13] = true;
+
+		if (stats.isSender)
+		{
+			for (int i = 0; i < IC_RTT_HIST_BUCKETS; i++)
+				hist[i] = Int64GetDatum(stats.rttHist[i]);
+			values[14] = PointerGetDatum(construct_array(hist, IC_RTT_HIST_BUCKETS,
+														 INT8OID, sizeof(int64),
+														 FLOAT8PASSBYVAL, 'd'));
+			values[15] = Int64GetDatum(stats.retransmits);
+			values[16] = Int64GetDatum(stats.stalls);
+			values[17] = Int64GetDatum(stats.stallTime);
+		}
+		else
+			nulls[14] = nulls[15] = nulls[16] = nulls[17] = true;
+
+		/* and the receiver's */
+		if (!stats.isSender)
+		{
+			values[18] = Int64GetDatum(stats.disordered);
+			values[19] = Int64GetDatum(stats.duplicated);
+			values[20] = Int64GetDatum(stats.dropped);
+			if (stats.queueSamples > 0)
+				values[21] = Float8GetDatum((double) stats.totalQueueSize / stats.queueSamples);
+			else
+				nulls[21] = true;
+			values[22] = Int32GetDatum(stats.maxQueueSize);
+		}
+		else
+			nulls[18] = nulls[19] = nulls[20] = nulls[21] = nulls[22] = true;
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
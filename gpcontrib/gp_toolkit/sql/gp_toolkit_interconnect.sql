@@ -0,0 +1,55 @@
+-- Test the interconnect statistics of gp_toolkit.  A query with motions records
+-- both ends of each of its connections when it tears down its interconnect.
+-- The numbers depend on the cluster and the network, so only check that they
+-- are there and consistent.  Only the UDP interconnect keeps them.
+
+CREATE TABLE toolkit_ic_test (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO toolkit_ic_test SELECT i, i % 100 FROM generate_series(1, 10000) i;
+
+-- Redistribute one side of the join, and gather the counts
+SELECT count(*) FROM toolkit_ic_test x JOIN toolkit_ic_test y ON x.b = y.a;
+
+-- The last command of this session recorded so far is the query above
+SELECT max(command_count) AS cmd FROM gp_toolkit.gp_interconnect_connections
+  WHERE sess_id = current_setting('gp_session_id')::int \gset
+
+-- Every end of a connection carried packets, and none went through shared
+-- memory, which is off by default
+SELECT direction, count(DISTINCT motion_id) > 0 AS motions, bool_and(packets > 0) AS packets,
+       bool_or(shared_memory) AS shared_memory
+  FROM gp_toolkit.gp_interconnect_connections
+  WHERE sess_id = current_setting('gp_session_id')::int AND command_count = :cmd
+  GROUP BY direction ORDER BY direction;
+
+-- The two ends of a connection name each other
+SELECT count(*) AS unmatched
+  FROM gp_toolkit.gp_interconnect_connections s
+  WHERE s.sess_id = current_setting('gp_session_id')::int AND s.command_count = :cmd AND s.direction = 'send'
+    AND NOT EXISTS (SELECT 1 FROM gp_toolkit.gp_interconnect_connections r
+                    WHERE r.sess_id = current_setting('gp_session_id')::int AND r.command_count = :cmd AND r.direction = 'receive'
+                      AND r.motion_id = s.motion_id
+                      AND r.segindex = s.peer_segindex
+                      AND r.peer_segindex = s.segindex);
+
+-- The sender's columns are only set on the sending end, and the receiver's
+-- on the receiving end.  The ack times of the packets sent once are in the
+-- histogram.
+SELECT bool_and(rtt_min_us <= rtt_avg_us AND rtt_avg_us <= rtt_max_us) AS rtt,
+       bool_and(array_length(rtt_histogram, 1) = 16) AS buckets,
+       bool_and((SELECT sum(n) FROM unnest(rtt_histogram) n) <= packets) AS histogram,
+       bool_and(retransmits >= 0 AND stalls >= 0 AND stall_time_us >= 0) AS send_counters,
+       bool_and(disordered IS NULL AND queue_max IS NULL) AS no_receive_counters
+  FROM gp_toolkit.gp_interconnect_connections
+  WHERE sess_id = current_setting('gp_session_id')::int AND command_count = :cmd AND direction = 'send';
+SELECT bool_and(disordered >= 0 AND duplicated >= 0 AND dropped >= 0) AS receive_counters,
+       bool_and(queue_max >= 0) AS queue,
+       bool_and(rtt_avg_us IS NULL AND rtt_histogram IS NULL AND retransmits IS NULL) AS no_send_counters
+  FROM gp_toolkit.gp_interconnect_connections
+  WHERE sess_id = current_setting('gp_session_id')::int AND command_count = :cmd AND direction = 'receive';
+
+-- The connections of the query are summed up by host and peer address
+SELECT count(*) > 0 AS pairs, bool_and(connections > 0) AS connections, bool_and(packets > 0) AS packets,
+       bool_and(retransmit_pct BETWEEN 0 AND 100) AS retransmit_pct
+  FROM gp_toolkit.gp_interconnect_host_pairs;
+
+DROP TABLE toolkit_ic_test;
@@ -22,6 +22,7 @@
 #include "access/appendonlywriter.h"
 #include "access/heapam.h"
 #include "access/hio.h"
+#include "access/nbtree.h"
 #include "access/reloptions.h"
 #include "access/xact.h"
 #include "catalog/catalog.h"
@@ -45,6 +46,7 @@
 #include "pgstat.h"
 #include "storage/procarray.h"
 #include "storage/smgr.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/datumstream.h"
 #include "utils/faultinjector.h"
@@ -54,6 +56,7 @@
 #include "utils/relcache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
+#include "utils/typcache.h"
 
 static AOCSScanDesc aocs_beginscan_internal(Relation relation,
 						AOCSFileSegInfo **seginfo,
@@ -118,6 +121,9 @@ open_all_datumstreamread_segfiles(AOCSScanDesc scan, AOCSFileSegInfo *segInfo)
 		AttrNumber	attno = proj_atts[i];
 
 		open_datumstreamread_segfile(basepath, rel, segInfo, ds[attno], attno);
+		scan->columnScanInfo.batches[attno].count = 0;
+		scan->columnScanInfo.batches[attno].pos = 0;
+		scan->columnScanInfo.batches[attno].skip = 0;
 
 		/* skip reading block for ANALYZE/SampleScan/partial scan */
 		if ((scan->rs_base.rs_flags & SO_TYPE_ANALYZE) != 0 ||
@@ -344,6 +350,132 @@ int aoco_proj_move_anchor_first(AttrNumber *proj_atts,
 	return num_proj_atts;
 }
 
+/*
+ * Open the block directory of the table to check the scan filters against
+ * the zone maps of the blocks, if the table has one and any filter can use
+ * them.
+ *
+ * Only the tables with an index have a block directory.  The zone maps are
+ * not worth one of their own: that is an auxiliary table and its index for
+ * every table, and a minipage write for every block inserted.  A table that
+ * is scanned with selective quals can get one with an index on any column.
+ */
+static void
+init_zone_map_directory(AOCSScanDesc scan)
+{
+	Relation	rel = scan->rs_base.rs_rd;
+	AttrNumber	natts = RelationGetNumberOfAttributes(rel);
+	bool	   *proj;
+	bool		useZoneMaps = false;
+
+	proj = (bool *) palloc0(natts * sizeof(bool));
+	for (int j = 0; j < scan->columnScanInfo.num_filters; j++)
+	{
+		AOCSScanFilter *filter = &scan->columnScanInfo.filters[j];
+
+		if (filter->strategy != InvalidStrategy)
+		{
+			proj[filter->attno] = true;
+			useZoneMaps = true;
+		}
+	}
+
+	if (useZoneMaps)
+	{
+		scan->zoneMapDirectory = (AppendOnlyBlockDirectory *)
+			palloc0(sizeof(AppendOnlyBlockDirectory));
+		AppendOnlyBlockDirectory_Init_forSearch(scan->zoneMapDirectory,
+												scan->appendOnlyMetaDataSnapshot,
+												(FileSegInfo **) scan->seginfo,
+												scan->total_seg,
+												rel,
+												natts,
+												true,
+												proj);
+
+		/* no block directory, no zone maps */
+		if (scan->zoneMapDirectory->blkdirRel == NULL)
+		{
+			pfree(scan->zoneMapDirectory);
+			scan->zoneMapDirectory = NULL;
+		}
+	}
+
+	pfree(proj);
+}
+
+/*
+ * Set up the scan filters: open the block directory to check them against
+ * the zone maps, and move the columns they reference right after the anchor
+ * column in the projection, so that aocs_getnext reads them first.
+ *
+ * The filters are dropped if the scan builds a block directory, which needs
+ * every block of every column.  The zone maps are used even if the rows are
+ * not filtered one by one, which takes gp_enable_aocs_late_materialization
+ * and a column left to skip.
+ */
+static void
+init_scan_filters(AOCSScanDesc scan)
+{
+	AttrNumber *proj_atts = scan->columnScanInfo.proj_atts;
+	AttrNumber	num_proj_atts = scan->columnScanInfo.num_proj_atts;
+	AttrNumber	num_filter_atts = 1;
+
+	scan->columnScanInfo.num_filter_atts = 0;
+
+	if (scan->columnScanInfo.num_filters == 0)
+		return;
+
+	if (scan->blockDirectory != NULL || scan->partialScan)
+	{
+		scan->columnScanInfo.num_filters = 0;
+		return;
+	}
+
+	if (scan->zoneMapDirectory == NULL)
+		init_zone_map_directory(scan);
+
+	if (!gp_enable_aocs_late_materialization)
+		return;
+
+	/* the column datum streams are new, forget their dictionaries */
+	for (int j = 0; j < scan->columnScanInfo.num_filters; j++)
+		scan->columnScanInfo.filters[j].dictionaryGeneration = 0;
+
+	for (AttrNumber i = 1; i < num_proj_atts; i++)
+	{
+		for (int j = 0; j < scan->columnScanInfo.num_filters; j++)
+		{
+			if (scan->columnScanInfo.filters[j].attno == proj_atts[i])
+			{
+				AttrNumber	tmp = proj_atts[num_filter_atts];
+
+				proj_atts[num_filter_atts++] = proj_atts[i];
+				proj_atts[i] = tmp;
+				break;
+			}
+		}
+	}
+
+	for (int j = 0; j < scan->columnScanInfo.num_filters; j++)
+	{
+		AttrNumber	i;
+
+		for (i = 0; i < num_filter_atts; i++)
+			if (scan->columnScanInfo.filters[j].attno == proj_atts[i])
+				break;
+
+		/* not projected, which doesn't happen for the quals of a scan */
+		if (i == num_filter_atts)
+			return;
+	}
+
+	if (num_filter_atts == num_proj_atts)
+		return;
+
+	scan->columnScanInfo.num_filter_atts = num_filter_atts;
+}
+
 void
 initscan_with_colinfo(AOCSScanDesc scan)
 {
@@ -370,6 +502,9 @@ initscan_with_colinfo(AOCSScanDesc scan)
 	if (scan->columnScanInfo.ds == NULL)
 		scan->columnScanInfo.ds = (DatumStreamRead **)
 								  palloc0(natts * sizeof(DatumStreamRead *));
+	if (scan->columnScanInfo.batches == NULL)
+		scan->columnScanInfo.batches = (AOCSColumnBatch *)
+									   palloc0(natts * sizeof(AOCSColumnBatch));
 
 	/* pick the anchor column to scan first */
 	anchor_colno = get_anchor_col(scan->seginfo, 
@@ -408,6 +543,8 @@ initscan_with_colinfo(AOCSScanDesc scan)
 												scan->columnScanInfo.num_proj_atts,
 												anchor_colno);
 
+	init_scan_filters(scan);
+
 	open_ds_read(scan->rs_base.rs_rd, scan->columnScanInfo.ds,
 				 scan->columnScanInfo.relationTupleDesc,
 				 scan->columnScanInfo.proj_atts, scan->columnScanInfo.num_proj_atts,
@@ -478,6 +615,22 @@ open_next_scan_seg(AOCSScanDesc scan)
 
 				open_all_datumstreamread_segfiles(scan, curSegInfo);
 
+				/*
+				 * Load all visimap entries of the segment file for the
+				 * visibility checks.
+				 */
+				if (scan->rs_base.rs_snapshot != SnapshotAny &&
+					AppendOnlyVisimap_LoadSegmentFile(&scan->visibilityMap,
+													  curSegInfo->segno))
+				{
+#ifdef FAULT_INJECTOR
+					FaultInjector_InjectFaultIfSet("ao_visimap_segment_loaded",
+												   DDLNotSpecified,
+												   "",	/* databaseName */
+												   RelationGetRelationName(scan->rs_base.rs_rd));	/* tableName */
+#endif
+				}
+
 				return scan->cur_seg;
 			}
 		}
@@ -754,6 +907,482 @@ aocs_beginscan_internal(Relation relation,
 	return scan;
 }
 
+/*
+ * Collect the quals of a sequential scan that can be checked as soon as the
+ * column they reference has been read: strict, leakproof boolean operators
+ * comparing a column with a non-null constant, or with any element of a
+ * non-null array constant, as IN lists are.
+ *
+ * The caller still evaluates the whole qual on the returned rows, the filters
+ * only let aocs_getnext pass over the rows they reject without decoding the
+ * other columns. Leakproof operators don't raise errors depending on their
+ * input, so evaluating them ahead of the other quals is safe.
+ */
+void
+aocs_set_scan_filters(AOCSScanDesc scan, List *qual)
+{
+	TupleDesc	tupdesc = RelationGetDescr(scan->rs_base.rs_rd);
+	MemoryContext oldCtx;
+	ListCell   *lc;
+
+	if (scan->rs_base.rs_snapshot == SnapshotAny)
+		return;
+
+	oldCtx = MemoryContextSwitchTo(scan->columnScanInfo.scanCtx);
+
+	foreach(lc, qual)
+	{
+		Node	   *clause = (Node *) lfirst(lc);
+		Oid			opno;
+		Oid			opfuncid;
+		Oid			inputcollid;
+		Node	   *leftop;
+		Node	   *rightop;
+		Var		   *var;
+		Const	   *con;
+		bool		constFirst;
+		bool		isArray;
+		AOCSScanFilter *filter;
+
+		if (IsA(clause, OpExpr))
+		{
+			OpExpr	   *opexpr = (OpExpr *) clause;
+
+			if (list_length(opexpr->args) != 2 ||
+				opexpr->opresulttype != BOOLOID || opexpr->opretset)
+				continue;
+
+			opno = opexpr->opno;
+			opfuncid = opexpr->opfuncid;
+			inputcollid = opexpr->inputcollid;
+			leftop = (Node *) linitial(opexpr->args);
+			rightop = (Node *) lsecond(opexpr->args);
+			isArray = false;
+		}
+		else if (IsA(clause, ScalarArrayOpExpr))
+		{
+			ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) clause;
+
+			/*
+			 * The parser only accepts boolean operators here. "column op ALL
+			 * (...)" is rarely selective, leave it alone.
+			 */
+			if (!saop->useOr || list_length(saop->args) != 2)
+				continue;
+
+			opno = saop->opno;
+			opfuncid = saop->opfuncid;
+			inputcollid = saop->inputcollid;
+			leftop = (Node *) linitial(saop->args);
+			rightop = (Node *) lsecond(saop->args);
+			isArray = true;
+		}
+		else
+			continue;
+
+		if (!OidIsValid(opfuncid))
+			continue;
+
+		if (IsA(leftop, Var) && IsA(rightop, Const))
+		{
+			var = (Var *) leftop;
+			con = (Const *) rightop;
+			constFirst = false;
+		}
+		else if (!isArray && IsA(leftop, Const) && IsA(rightop, Var))
+		{
+			var = (Var *) rightop;
+			con = (Const *) leftop;
+			constFirst = true;
+		}
+		else
+			continue;
+
+		if (IS_SPECIAL_VARNO(var->varno) || var->varlevelsup != 0 ||
+			var->varattno <= 0 || var->varattno > tupdesc->natts ||
+			var->vartype != TupleDescAttr(tupdesc, var->varattno - 1)->atttypid ||
+			con->constisnull)
+			continue;
+
+		if (!func_strict(opfuncid) ||
+			!get_func_leakproof(opfuncid))
+			continue;
+
+		if (scan->columnScanInfo.filters == NULL)
+			scan->columnScanInfo.filters = (AOCSScanFilter *)
+				palloc(list_length(qual) * sizeof(AOCSScanFilter));
+
+		filter = &scan->columnScanInfo.filters[scan->columnScanInfo.num_filters++];
+		filter->attno = var->varattno - 1;
+		filter->constFirst = constFirst;
+		filter->constval = con->constvalue;
+		filter->elems = NULL;
+		filter->nelems = 0;
+		filter->collation = inputcollid;
+		fmgr_info(opfuncid, &filter->finfo);
+		filter->dictionaryGeneration = 0;
+
+		if (isArray)
+		{
+			ArrayType  *arr = DatumGetArrayTypeP(con->constvalue);
+			int16		elmlen;
+			bool		elmbyval;
+			char		elmalign;
+			bool	   *elemnulls;
+			int			nelems;
+
+			get_typlenbyvalalign(ARR_ELEMTYPE(arr), &elmlen, &elmbyval, &elmalign);
+			deconstruct_array(arr, ARR_ELEMTYPE(arr), elmlen, elmbyval, elmalign,
+							  &filter->elems, &elemnulls, &nelems);
+
+			/* the operator is strict, a null element never matches */
+			for (int j = 0; j < nelems; j++)
+				if (!elemnulls[j])
+					filter->elems[filter->nelems++] = filter->elems[j];
+
+			/* zone maps are only checked against a single constant */
+			filter->strategy = InvalidStrategy;
+			continue;
+		}
+
+		/*
+		 * Zone maps are only kept for the fixed-length pass-by-value types,
+		 * in the order of the default btree opclass of the type.
+		 */
+		filter->strategy = InvalidStrategy;
+		if (TupleDescAttr(tupdesc, filter->attno)->attbyval &&
+			TupleDescAttr(tupdesc, filter->attno)->attlen > 0)
+		{
+			TypeCacheEntry *typentry;
+			int			strategy = InvalidStrategy;
+			Oid			cmpproc = InvalidOid;
+
+			typentry = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+			if (OidIsValid(typentry->btree_opf))
+			{
+				strategy = get_op_opfamily_strategy(opno,
+													typentry->btree_opf);
+				cmpproc = get_opfamily_proc(typentry->btree_opf,
+											var->vartype, con->consttype,
+											BTORDER_PROC);
+			}
+
+			if (strategy != InvalidStrategy && OidIsValid(cmpproc))
+			{
+				filter->strategy = constFirst ?
+					BTCommuteStrategyNumber(strategy) : strategy;
+				fmgr_info(cmpproc, &filter->cmpfinfo);
+			}
+		}
+	}
+
+	if (scan->columnScanInfo.num_filters > 0)
+		scan->columnScanInfo.filterCtx =
+			AllocSetContextCreate(scan->columnScanInfo.scanCtx,
+								  "AOCS scan filter context",
+								  ALLOCSET_SMALL_SIZES);
+
+	MemoryContextSwitchTo(oldCtx);
+}
+
+/*
+ * Evaluate a scan filter on a non-null value of its column.
+ */
+static bool
+scan_filter_matches(AOCSScanFilter *filter, Datum value)
+{
+	if (filter->elems != NULL)
+	{
+		for (int i = 0; i < filter->nelems; i++)
+		{
+			if (DatumGetBool(FunctionCall2Coll(&filter->finfo, filter->collation,
+											   value, filter->elems[i])))
+				return true;
+		}
+		return false;
+	}
+
+	if (filter->constFirst)
+		return DatumGetBool(FunctionCall2Coll(&filter->finfo, filter->collation,
+											  filter->constval, value));
+	else
+		return DatumGetBool(FunctionCall2Coll(&filter->finfo, filter->collation,
+											  value, filter->constval));
+}
+
+/*
+ * Check the current row against the scan filters.
+ *
+ * If the value of a filter column was read from a dictionary encoded block,
+ * the filter is evaluated once per dictionary code.
+ */
+static bool
+scan_filters_pass(AOCSScanDesc scan, Datum *d, bool *null,
+				  int64 rowNum, int segno)
+{
+	MemoryContext oldCtx;
+	bool		pass = true;
+
+	oldCtx = MemoryContextSwitchTo(scan->columnScanInfo.filterCtx);
+
+	for (int i = 0; i < scan->columnScanInfo.num_filters; i++)
+	{
+		AOCSScanFilter *filter = &scan->columnScanInfo.filters[i];
+		uint32		generation;
+
+		/* the operators are strict */
+		if (null[filter->attno])
+		{
+			pass = false;
+			break;
+		}
+
+		generation = datumstreamread_dictionary_generation(scan->columnScanInfo.ds[filter->attno]);
+		if (generation != 0 &&
+			!AO_ATTR_VAL_IS_MISSING(rowNum, filter->attno, segno,
+									scan->columnScanInfo.attnum_to_rownum))
+		{
+			AOCSColumnBatch *batch = &scan->columnScanInfo.batches[filter->attno];
+			uint8		code = batch->codes[batch->pos];
+
+			if (filter->dictionaryGeneration != generation)
+			{
+				memset(filter->dictionaryResults, 0,
+					   sizeof(filter->dictionaryResults));
+				filter->dictionaryGeneration = generation;
+			}
+
+			if (filter->dictionaryResults[code] == 0)
+				filter->dictionaryResults[code] =
+					scan_filter_matches(filter, d[filter->attno]) ? 1 : -1;
+
+			if (filter->dictionaryResults[code] < 0)
+			{
+				pass = false;
+				break;
+			}
+		}
+		else if (!scan_filter_matches(filter, d[filter->attno]))
+		{
+			pass = false;
+			break;
+		}
+	}
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextReset(scan->columnScanInfo.filterCtx);
+
+	return pass;
+}
+
+/*
+ * Does the zone map show that the filter rejects every row of the block?
+ */
+static bool
+zone_map_rejects(AOCSScanFilter *filter, MinipageZoneMap *zoneMap)
+{
+	Datum		minValue = (Datum) zoneMap->minValue;
+	Datum		maxValue = (Datum) zoneMap->maxValue;
+
+	/* all values are null, and the operators are strict */
+	if ((zoneMap->flags & ZONEMAP_HAS_VALUES) == 0)
+		return true;
+
+#define ZONE_MAP_CMP(value) \
+	DatumGetInt32(FunctionCall2Coll(&filter->cmpfinfo, filter->collation, \
+									(value), filter->constval))
+
+	switch (filter->strategy)
+	{
+		case BTLessStrategyNumber:
+			return ZONE_MAP_CMP(minValue) >= 0;
+		case BTLessEqualStrategyNumber:
+			return ZONE_MAP_CMP(minValue) > 0;
+		case BTEqualStrategyNumber:
+			return ZONE_MAP_CMP(minValue) > 0 || ZONE_MAP_CMP(maxValue) < 0;
+		case BTGreaterEqualStrategyNumber:
+			return ZONE_MAP_CMP(maxValue) < 0;
+		case BTGreaterStrategyNumber:
+			return ZONE_MAP_CMP(maxValue) <= 0;
+		default:
+			return false;
+	}
+
+#undef ZONE_MAP_CMP
+}
+
+/*
+ * Check the rows [firstRowNum, firstRowNum + rowCount) of a segment file
+ * against the zone maps of the scan filters. Returns true if the zone maps
+ * show that one of the filters rejects all of them.
+ */
+static bool
+zone_maps_reject_rows(AOCSScanDesc scan, int segno,
+					  int64 firstRowNum, int64 rowCount)
+{
+	int64		lastRowNum = firstRowNum + rowCount - 1;
+
+	for (int i = 0; i < scan->columnScanInfo.num_filters; i++)
+	{
+		AOCSScanFilter *filter = &scan->columnScanInfo.filters[i];
+		int64		rowNum = firstRowNum;
+
+		if (filter->strategy == InvalidStrategy)
+			continue;
+
+		/* the missing values of a column are not in its zone maps */
+		if (AO_ATTR_VAL_IS_MISSING(firstRowNum, filter->attno, segno,
+								   scan->columnScanInfo.attnum_to_rownum))
+			continue;
+
+		/* the rows may span several blocks of the filter column */
+		while (rowNum <= lastRowNum)
+		{
+			AOTupleId	aoTupleId;
+			MinipageZoneMap zoneMap;
+			int64		entryLastRowNum;
+
+			AOTupleIdInit(&aoTupleId, segno, rowNum);
+			if (!AppendOnlyBlockDirectory_GetZoneMap(scan->zoneMapDirectory,
+													 &aoTupleId,
+													 filter->attno,
+													 scan->columnScanInfo.attnum_to_rownum,
+													 &zoneMap,
+													 &entryLastRowNum) ||
+				!zone_map_rejects(filter, &zoneMap))
+				break;
+
+			rowNum = entryLastRowNum + 1;
+		}
+
+		if (rowNum > lastRowNum)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Read the next block of the anchor column, passing over the blocks whose
+ * rows the zone maps show the scan filters reject. The other projected
+ * columns pass over the values of these rows, as for the rows rejected by
+ * scan_filters_pass().
+ *
+ * Returns -1 if the end of the segment file is reached.
+ */
+static int
+read_anchor_block(AOCSScanDesc scan, AttrNumber attno, int segno)
+{
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+	while (datumstreamread_next_block_info(ds))
+	{
+		int64		firstRowNum = ds->blockFirstRowNum;
+		int64		lastRowNum = firstRowNum + ds->blockRowCount - 1;
+
+		if (!zone_maps_reject_rows(scan, segno, firstRowNum, ds->blockRowCount))
+		{
+			datumstreamread_block_content(ds);
+			return 0;
+		}
+
+		for (AttrNumber i = 1; i < scan->columnScanInfo.num_proj_atts; i++)
+		{
+			AttrNumber	colno = scan->columnScanInfo.proj_atts[i];
+			int64		lastMissingRowNum;
+
+			/* the values of the rows up to lastMissingRowNum are missing */
+			lastMissingRowNum =
+				scan->columnScanInfo.attnum_to_rownum[colno * MAX_AOREL_CONCURRENCY + segno];
+			if (lastMissingRowNum < lastRowNum)
+				scan->columnScanInfo.batches[colno].skip +=
+					lastRowNum - Max(firstRowNum, lastMissingRowNum + 1) + 1;
+		}
+
+#ifdef FAULT_INJECTOR
+		FaultInjector_InjectFaultIfSet("aocs_zone_map_skip_block",
+									   DDLNotSpecified,
+									   "",	/* databaseName */
+									   RelationGetRelationName(scan->rs_base.rs_rd));	/* tableName */
+#endif
+
+		scan->segrowsprocessed += ds->blockRowCount;
+		AppendOnlyStorageRead_SkipCurrentBlock(&ds->ao_read);
+	}
+
+	return -1;
+}
+
+/*
+ * Remember to pass over the values of the columns that follow the filter
+ * columns in the projection, for a row rejected by the scan filters.
+ */
+static void
+skip_remaining_columns(AOCSScanDesc scan, int64 rowNum, int segno)
+{
+	for (AttrNumber i = scan->columnScanInfo.num_filter_atts;
+		 i < scan->columnScanInfo.num_proj_atts; i++)
+	{
+		AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+
+		/* a missing value is not stored in the column */
+		if (!AO_ATTR_VAL_IS_MISSING(rowNum, attno, segno,
+									scan->columnScanInfo.attnum_to_rownum))
+			scan->columnScanInfo.batches[attno].skip++;
+	}
+}
+
+/*
+ * Pass over the values of a column that belong to rows rejected by the scan
+ * filters. What is left of the current block is decoded, but the blocks
+ * holding only rejected rows are skipped without reading their content.
+ *
+ * Returns -1 if the end of the segment file is reached.
+ */
+static int
+skip_column_values(AOCSScanDesc scan, AttrNumber attno)
+{
+	AOCSColumnBatch *batch = &scan->columnScanInfo.batches[attno];
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+	while (batch->skip > 0)
+	{
+		int			nrows = batch->count - (batch->pos + 1);
+
+		if (nrows > 0)
+		{
+			nrows = Min(nrows, batch->skip);
+			batch->pos += nrows;
+			batch->skip -= nrows;
+			continue;
+		}
+
+		nrows = datumstreamread_get_batch(ds, batch->values, batch->nulls,
+										  batch->codes, AOCS_SCAN_BATCH_ROWS);
+		if (nrows == 0)
+		{
+			if (datumstreamread_block_skip(ds, &batch->skip) < 0)
+				return -1;
+
+			AOCSScanDesc_UpdateTotalBytesRead(scan, attno);
+			pgstat_count_buffer_read_ao(scan->rs_base.rs_rd,
+										RelationGuessNumberOfBlocksFromSize(scan->totalBytesRead));
+
+			/* let aocs_getnext decode the new block */
+			batch->count = 0;
+			batch->pos = 0;
+			continue;
+		}
+
+		/* nothing of the new batch has been consumed yet */
+		batch->count = nrows;
+		batch->pos = -1;
+		batch->firstNth = datumstreamread_nth(ds) - (nrows - 1);
+	}
+
+	return 0;
+}
+
 void
 aocs_rescan(AOCSScanDesc scan)
 {
@@ -846,6 +1475,31 @@ aocs_endscan(AOCSScanDesc scan)
 		scan->columnScanInfo.ds = NULL;
 	}
 
+	if (scan->columnScanInfo.batches)
+	{
+		pfree(scan->columnScanInfo.batches);
+		scan->columnScanInfo.batches = NULL;
+	}
+
+	if (scan->columnScanInfo.filters)
+	{
+		pfree(scan->columnScanInfo.filters);
+		scan->columnScanInfo.filters = NULL;
+	}
+
+	if (scan->columnScanInfo.filterCtx)
+	{
+		MemoryContextDelete(scan->columnScanInfo.filterCtx);
+		scan->columnScanInfo.filterCtx = NULL;
+	}
+
+	if (scan->zoneMapDirectory)
+	{
+		AppendOnlyBlockDirectory_End_forSearch(scan->zoneMapDirectory);
+		pfree(scan->zoneMapDirectory);
+		scan->zoneMapDirectory = NULL;
+	}
+
 	if (scan->columnScanInfo.relationTupleDesc)
 	{
 		Assert(scan->columnScanInfo.proj_atts);
@@ -1418,6 +2072,7 @@ aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 	AOTupleId	aoTupleId;
 	int64		rowNum = InvalidAORowNum;
 	int64		nthInBlock;
+	AOCSColumnBatch *batch;
 	int			err = 0;
 	bool		isSnapshotAny = (scan->rs_base.rs_snapshot == SnapshotAny);
 	AttrNumber	natts;
@@ -1476,6 +2131,23 @@ ReadNext:
 		{
 			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
 
+			/*
+			 * Once the columns referenced by the scan filters have been read,
+			 * check the row. The values of the remaining columns of a
+			 * rejected row are not decoded, but passed over when reading the
+			 * next row that passes.
+			 */
+			if (scan->columnScanInfo.num_filter_atts > 0 &&
+				i == scan->columnScanInfo.num_filter_atts &&
+				!scan_filters_pass(scan, d, null, rowNum, curseginfo->segno))
+			{
+				Assert(rowNum > 0);
+				skip_remaining_columns(scan, rowNum, curseginfo->segno);
+				scan->segrowsprocessed++;
+				rowNum = InvalidAORowNum;
+				goto ReadNext;
+			}
+
 			/*
 			 * Check missing value before reading from data files.
 			 * 
@@ -1500,36 +2172,62 @@ ReadNext:
 				}
 			}
 
-			/* otherwise, read from data file */
-			err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-			Assert(err >= 0);
-			if (err == 0)
+			/*
+			 * Otherwise, read from data file. The values of a column are
+			 * decoded a batch at a time, which keeps the decoding loop and
+			 * the block data hot in the CPU caches.
+			 */
+			batch = &scan->columnScanInfo.batches[attno];
+			if (batch->skip > 0 && skip_column_values(scan, attno) < 0)
 			{
-				err = datumstreamread_block(scan->columnScanInfo.ds[attno], scan->blockDirectory, attno);
-				if (err < 0)
+				err = -1;
+				close_cur_scan_seg(scan);
+				goto ReadNext;
+			}
+
+			if (batch->pos + 1 < batch->count)
+				batch->pos++;
+			else
+			{
+				int			nrows;
+
+				nrows = datumstreamread_get_batch(scan->columnScanInfo.ds[attno],
+												  batch->values, batch->nulls,
+												  batch->codes, AOCS_SCAN_BATCH_ROWS);
+				if (nrows == 0)
 				{
-					/*
-					 * Ha, cannot read next block, we need to go to next seg
-					 */
-					close_cur_scan_seg(scan);
-					goto ReadNext;
-				}
+					if (i == ANCHOR_COL_IN_PROJ && scan->zoneMapDirectory != NULL)
+						err = read_anchor_block(scan, attno, curseginfo->segno);
+					else
+						err = datumstreamread_block(scan->columnScanInfo.ds[attno], scan->blockDirectory, attno);
+					if (err < 0)
+					{
+						/*
+						 * Ha, cannot read next block, we need to go to next seg
+						 */
+						close_cur_scan_seg(scan);
+						goto ReadNext;
+					}
 
-				AOCSScanDesc_UpdateTotalBytesRead(scan, attno);
-				pgstat_count_buffer_read_ao(scan->rs_base.rs_rd,
-											RelationGuessNumberOfBlocksFromSize(scan->totalBytesRead));
+					AOCSScanDesc_UpdateTotalBytesRead(scan, attno);
+					pgstat_count_buffer_read_ao(scan->rs_base.rs_rd,
+												RelationGuessNumberOfBlocksFromSize(scan->totalBytesRead));
 
-				err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-				Assert(err > 0);
+					nrows = datumstreamread_get_batch(scan->columnScanInfo.ds[attno],
+													  batch->values, batch->nulls,
+													  batch->codes, AOCS_SCAN_BATCH_ROWS);
+					Assert(nrows > 0);
+				}
+
+				batch->count = nrows;
+				batch->pos = 0;
+				batch->firstNth = datumstreamread_nth(scan->columnScanInfo.ds[attno]) - (nrows - 1);
 			}
 
-			/*
-			 * Get the column's datum right here since the data structures
-			 * should still be hot in CPU data cache memory.
-			 */
-			datumstreamread_get(scan->columnScanInfo.ds[attno], &d[attno], &null[attno]);
+			d[attno] = batch->values[batch->pos];
+			null[attno] = batch->nulls[batch->pos];
 
-			nthInBlock = datumstreamread_nth(scan->columnScanInfo.ds[attno]);
+			nthInBlock = batch->firstNth + batch->pos;
 			if (rowNum == InvalidAORowNum &&
 				scan->columnScanInfo.ds[attno]->blockFirstRowNum != InvalidAORowNum)
 			{
@@ -385,6 +385,12 @@ get_or_create_aoco_insert_descriptor(const Relation relation, int64 num_rows)
 													   firstRowNum,
 													   fileOffset,
 													   firstNonDroppedColumn);
+
+			/*
+			 * Same for the blocks of that column, which mustn't be recorded
+			 * one block late as with background compression.
+			 */
+			dsw->ao_write.compressAsync = false;
 		}
 		state->insertDesc = insertDesc;
 		MemoryContextSwitchTo(oldcxt);
@@ -577,6 +583,7 @@ aoco_beginscan_extractcolumns(Relation rel, Snapshot snapshot,
 							proj,
 							projKind,
 							flags);
+	aocs_set_scan_filters(aoscan, qual);
 
 	if (needFree)
 		pfree(proj);
@@ -112,7 +112,7 @@ gp_aoblkdir(PG_FUNCTION_ARGS)
 										   sst,
 										   0,
 										   NULL);
-		context->currMinipage.minipage = palloc0(minipage_size(NUM_MINIPAGE_ENTRIES));
+		alloc_minipage(&context->currMinipage);
 		context->currMinipageValid = false;
 		context->currMinipageEntryIdx = -1;
 		funcctx->user_fctx = (void *) context;
@@ -18,8 +18,11 @@
 #include "access/appendonly_visimap_store.h"
 #include "access/appendonlytid.h"
 #include "access/hash.h"
+#include "catalog/aovisimap.h"
 #include "cdb/cdbappendonlyblockdirectory.h"
+#include "port/pg_bitutils.h"
 #include "storage/fd.h"
+#include "utils/fmgroids.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 #include "utils/snapmgr.h"
@@ -145,9 +148,375 @@ AppendOnlyVisimap_Init(
 								appendOnlyMetaDataSnapshot,
 								visiMap->memoryContext);
 
+	visiMap->segmentMap = NULL;
+
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Loads all visibility map entries of a segment file, so that the
+ * visibility checks of the tuples of that segment file don't need to
+ * search and load the entries one by one. Replaces the entries of the
+ * segment file loaded before.
+ *
+ * Only done for MVCC snapshots, for which the visible entries don't
+ * change during the scan. Returns false, without loading anything, for
+ * other snapshots.
+ *
+ * Assumes that the visibility has been initialized and not finished.
+ */
+bool
+AppendOnlyVisimap_LoadSegmentFile(
+								  AppendOnlyVisimap *visiMap,
+								  int segno)
+{
+	AppendOnlyVisimapSegment *segmentMap;
+	AppendOnlyVisimapEntry visiMapEntry;
+	Snapshot	snapshot = visiMap->visimapStore.snapshot;
+	ScanKeyData scanKey;
+	SysScanDesc indexScan;
+	MemoryContext oldContext;
+	int			maxContainers = 0;
+
+	Assert(visiMap);
+
+	if (snapshot == NULL || !IsMVCCSnapshot(snapshot))
+		return false;
+
+	segmentMap = visiMap->segmentMap;
+	if (segmentMap == NULL)
+	{
+		segmentMap = MemoryContextAllocZero(visiMap->memoryContext,
+											sizeof(AppendOnlyVisimapSegment));
+		segmentMap->memoryContext = AllocSetContextCreate(visiMap->memoryContext,
+														  "VisiMapSegmentContext",
+														  ALLOCSET_DEFAULT_SIZES);
+	}
+	else
+		MemoryContextReset(segmentMap->memoryContext);
+
+	segmentMap->segno = segno;
+	segmentMap->containers = NULL;
+	segmentMap->numContainers = 0;
+	segmentMap->currentContainer = 0;
+	segmentMap->visibleFrom = 0;
+	segmentMap->visibleTo = 0;
+
+	oldContext = MemoryContextSwitchTo(segmentMap->memoryContext);
+
+	AppendOnlyVisimapEntry_Init(&visiMapEntry, segmentMap->memoryContext);
+
+	ScanKeyInit(&scanKey,
+				Anum_pg_aovisimap_segno,	/* segno */
+				BTEqualStrategyNumber,
+				F_INT4EQ,
+				Int32GetDatum(segno));
+
+	indexScan = AppendOnlyVisimapStore_BeginScan(&visiMap->visimapStore,
+												 1,
+												 &scanKey);
+
+	/* the entries are returned in ascending order of their first row number */
+	while (AppendOnlyVisimapStore_GetNext(&visiMap->visimapStore,
+										  indexScan, ForwardScanDirection,
+										  &visiMapEntry, NULL))
+	{
+		AppendOnlyVisimapContainer *container;
+		int			hiddenCount;
+		int			offset;
+
+		hiddenCount = bms_num_members(visiMapEntry.bitmap);
+		if (hiddenCount == 0)
+			continue;
+
+		if (segmentMap->numContainers == maxContainers)
+		{
+			maxContainers = Max(maxContainers * 2, 16);
+			if (segmentMap->containers == NULL)
+				segmentMap->containers =
+					palloc(sizeof(AppendOnlyVisimapContainer) * maxContainers);
+			else
+				segmentMap->containers =
+					repalloc(segmentMap->containers,
+							 sizeof(AppendOnlyVisimapContainer) * maxContainers);
+		}
+
+		container = &segmentMap->containers[segmentMap->numContainers++];
+		container->firstRowNum = visiMapEntry.firstRowNum;
+		container->hiddenCount = hiddenCount;
+		container->offsets = NULL;
+		container->words = NULL;
+
+		if (hiddenCount == APPENDONLY_VISIMAP_MAX_RANGE)
+			continue;
+
+		if (hiddenCount <= APPENDONLY_VISIMAP_ARRAY_MAX_HIDDEN)
+		{
+			int			i = 0;
+
+			container->offsets = palloc(sizeof(uint16) * hiddenCount);
+			offset = -1;
+			while ((offset = bms_next_member(visiMapEntry.bitmap, offset)) >= 0)
+			{
+				Assert(offset < APPENDONLY_VISIMAP_MAX_RANGE);
+				container->offsets[i++] = offset;
+			}
+		}
+		else
+		{
+			container->words = palloc0(sizeof(uint64) * APPENDONLY_VISIMAP_CONTAINER_WORDS);
+			offset = -1;
+			while ((offset = bms_next_member(visiMapEntry.bitmap, offset)) >= 0)
+			{
+				Assert(offset < APPENDONLY_VISIMAP_MAX_RANGE);
+				container->words[offset / 64] |= UINT64CONST(1) << (offset % 64);
+			}
+		}
+	}
+
+	AppendOnlyVisimapStore_EndScan(&visiMap->visimapStore, indexScan);
+	AppendOnlyVisimapEntry_Finish(&visiMapEntry);
+
+	MemoryContextSwitchTo(oldContext);
+
+	visiMap->segmentMap = segmentMap;
+
+	elogif(Debug_appendonly_print_visimap, LOG,
+		   "Append-only visi map: Loaded %d entries with hidden tuples of "
+		   "segment file %d", segmentMap->numContainers, segno);
+
+	return true;
+}
+
+/*
+ * Returns the position of the container covering the rowNum, or else of
+ * the first container after the rowNum.
+ */
+static int
+AppendOnlyVisimapSegment_Seek(
+							  AppendOnlyVisimapSegment *segmentMap,
+							  int64 rowNum)
+{
+	AppendOnlyVisimapContainer *containers = segmentMap->containers;
+	int			low = 0;
+	int			high = segmentMap->numContainers;
+
+	/* Scans mostly ask for the current or the following container */
+	for (int pos = segmentMap->currentContainer;
+		 pos <= segmentMap->currentContainer + 1 && pos <= high; pos++)
+	{
+		if ((pos == high ||
+			 containers[pos].firstRowNum + APPENDONLY_VISIMAP_MAX_RANGE > rowNum) &&
+			(pos == 0 ||
+			 containers[pos - 1].firstRowNum + APPENDONLY_VISIMAP_MAX_RANGE <= rowNum))
+		{
+			segmentMap->currentContainer = pos;
+			return pos;
+		}
+	}
+
+	while (low < high)
+	{
+		int			mid = low + (high - low) / 2;
+
+		if (containers[mid].firstRowNum + APPENDONLY_VISIMAP_MAX_RANGE <= rowNum)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	segmentMap->currentContainer = low;
+	return low;
+}
+
+/*
+ * Returns the position of the first offset of an array container that is
+ * not smaller than the given one.
+ */
+static int
+AppendOnlyVisimapContainer_LowerBound(
+									  AppendOnlyVisimapContainer *container,
+									  int offset)
+{
+	int			low = 0;
+	int			high = container->hiddenCount;
+
+	Assert(container->offsets);
+
+	while (low < high)
+	{
+		int			mid = low + (high - low) / 2;
+
+		if (container->offsets[mid] < offset)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/*
+ * Returns the offset of the first hidden row of the container at or after
+ * the given offset, or APPENDONLY_VISIMAP_MAX_RANGE if there is none.
+ */
+static int
+AppendOnlyVisimapContainer_NextHidden(
+									  AppendOnlyVisimapContainer *container,
+									  int offset)
+{
+	if (container->offsets != NULL)
+	{
+		int			pos = AppendOnlyVisimapContainer_LowerBound(container, offset);
+
+		if (pos < container->hiddenCount)
+			return container->offsets[pos];
+		return APPENDONLY_VISIMAP_MAX_RANGE;
+	}
+	else if (container->words != NULL)
+	{
+		int			wordNum = offset / 64;
+		uint64		word;
+
+		word = container->words[wordNum] & (~UINT64CONST(0) << (offset % 64));
+		while (word == 0)
+		{
+			if (++wordNum == APPENDONLY_VISIMAP_CONTAINER_WORDS)
+				return APPENDONLY_VISIMAP_MAX_RANGE;
+			word = container->words[wordNum];
+		}
+		return wordNum * 64 + pg_rightmost_one_pos64(word);
+	}
+
+	/* all rows are hidden */
+	return offset;
+}
+
+/*
+ * Returns the number of hidden rows of the container in the offsets
+ * [from, to).
+ */
+static int
+AppendOnlyVisimapContainer_CountHidden(
+									   AppendOnlyVisimapContainer *container,
+									   int from,
+									   int to)
+{
+	int			count = 0;
+
+	Assert(0 <= from && from <= to && to <= APPENDONLY_VISIMAP_MAX_RANGE);
+
+	if (container->offsets != NULL)
+		return AppendOnlyVisimapContainer_LowerBound(container, to) -
+			AppendOnlyVisimapContainer_LowerBound(container, from);
+
+	if (container->words == NULL)
+		return to - from;
+
+	while (from < to)
+	{
+		int			bit = from % 64;
+		int			numBits = Min(64 - bit, to - from);
+		uint64		word = container->words[from / 64] >> bit;
+
+		if (numBits < 64)
+			word &= (UINT64CONST(1) << numBits) - 1;
+		count += pg_popcount64(word);
+		from += numBits;
+	}
+
+	return count;
+}
+
+/*
+ * Checks the visibility of a row of the loaded segment file.
+ */
+static bool
+AppendOnlyVisimapSegment_IsVisible(
+								   AppendOnlyVisimapSegment *segmentMap,
+								   int64 rowNum)
+{
+	int			pos;
+
+	if (segmentMap->visibleFrom <= rowNum && rowNum < segmentMap->visibleTo)
+		return true;
+
+	pos = AppendOnlyVisimapSegment_Seek(segmentMap, rowNum);
+	if (pos < segmentMap->numContainers &&
+		segmentMap->containers[pos].firstRowNum <= rowNum)
+	{
+		AppendOnlyVisimapContainer *container = &segmentMap->containers[pos];
+		int			offset = rowNum - container->firstRowNum;
+		int			nextHidden;
+
+		nextHidden = AppendOnlyVisimapContainer_NextHidden(container, offset);
+		if (nextHidden == offset)
+			return false;
+
+		if (nextHidden < APPENDONLY_VISIMAP_MAX_RANGE)
+		{
+			segmentMap->visibleFrom = rowNum;
+			segmentMap->visibleTo = container->firstRowNum + nextHidden;
+			return true;
+		}
+
+		/* the remaining rows of the container are visible */
+		pos++;
+	}
+
+	/* no row is hidden until the next container */
+	segmentMap->visibleFrom = rowNum;
+	segmentMap->visibleTo = (pos < segmentMap->numContainers) ?
+		segmentMap->containers[pos].firstRowNum : PG_INT64_MAX;
+	return true;
+}
+
+/*
+ * Returns the number of hidden tuples among the numRows rows of a segment
+ * file starting at firstRowNum, e.g. of a block, so that blocks without
+ * hidden tuples need no visibility check per tuple.
+ *
+ * Returns -1 if the segment file has not been loaded with
+ * AppendOnlyVisimap_LoadSegmentFile().
+ */
+int64
+AppendOnlyVisimap_GetHiddenTupleCountInRange(
+											 AppendOnlyVisimap *visiMap,
+											 int segno,
+											 int64 firstRowNum,
+											 int64 numRows)
+{
+	AppendOnlyVisimapSegment *segmentMap = visiMap->segmentMap;
+	int64		endRowNum = firstRowNum + numRows;
+	int64		count = 0;
+
+	Assert(visiMap);
+	Assert(numRows >= 0);
+
+	if (segmentMap == NULL || segmentMap->segno != segno)
+		return -1;
+
+	if (segmentMap->visibleFrom <= firstRowNum && endRowNum <= segmentMap->visibleTo)
+		return 0;
+
+	for (int pos = AppendOnlyVisimapSegment_Seek(segmentMap, firstRowNum);
+		 pos < segmentMap->numContainers &&
+		 segmentMap->containers[pos].firstRowNum < endRowNum;
+		 pos++)
+	{
+		AppendOnlyVisimapContainer *container = &segmentMap->containers[pos];
+		int64		from = Max(firstRowNum, container->firstRowNum);
+		int64		to = Min(endRowNum,
+							 container->firstRowNum + APPENDONLY_VISIMAP_MAX_RANGE);
+
+		count += AppendOnlyVisimapContainer_CountHidden(container,
+														from - container->firstRowNum,
+														to - container->firstRowNum);
+	}
+
+	return count;
+}
+
 /*
  * Moves the visibility map entry so that the given
  * AO tuple id is covered by it.
@@ -203,6 +572,11 @@ AppendOnlyVisimap_IsVisible(
 		   "(tupleId) = %s",
 		   AOTupleIdToString(aoTupleId));
 
+	if (visiMap->segmentMap != NULL &&
+		visiMap->segmentMap->segno == AOTupleIdGet_segmentFileNum(aoTupleId))
+		return AppendOnlyVisimapSegment_IsVisible(visiMap->segmentMap,
+												  AOTupleIdGet_rowNum(aoTupleId));
+
 	if (!AppendOnlyVisimapEntry_CoversTuple(&visiMap->visimapEntry,
 											aoTupleId))
 	{
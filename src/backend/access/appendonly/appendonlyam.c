@@ -56,6 +56,7 @@
 #include "cdb/cdbvars.h"
 #include "fmgr.h"
 #include "miscadmin.h"
+#include "optimizer/optimizer.h"
 #include "pgstat.h"
 #include "utils/datum.h"
 #include "utils/faultinjector.h"
@@ -125,6 +126,32 @@ initscan(AppendOnlyScanDesc scan, ScanKey key)
 	pgstat_count_heap_scan(scan->aos_rd);
 }
 
+/*
+ * Should the scan deform its memtuples with JIT compiled code?
+ *
+ * The table AM has no access to the executor's JIT flags, so estimate the
+ * cost of the scan the way the planner would, from the tuple counts of the
+ * segment files, and compare it against jit_above_cost. Only plain
+ * sequential scans qualify; they read enough rows to amortize the compile.
+ */
+static bool
+AppendOnlyScan_UseJitDeform(AppendOnlyScanDesc scan)
+{
+	double		tupcount = 0;
+	int			i;
+
+	if (!jit_enabled || !jit_tuple_deforming || jit_above_cost < 0)
+		return false;
+
+	if ((scan->rs_base.rs_flags & SO_TYPE_SEQSCAN) == 0)
+		return false;
+
+	for (i = 0; i < scan->aos_total_segfiles; i++)
+		tupcount += scan->aos_segfile_arr[i]->total_tupcount;
+
+	return cpu_tuple_cost * tupcount >= jit_above_cost;
+}
+
 /*
  * Open the next file segment to scan and allocate all resources needed for it.
  */
@@ -199,6 +226,7 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 										 scan->aoScanInitContext,
 										 &scan->storageRead,
 										 scan->usableBlockSize);
+		scan->executorReadBlock.jitDeform = AppendOnlyScan_UseJitDeform(scan);
 
 		scan->needNextBuffer = true;	/* so we read a new buffer right away */
 
@@ -271,6 +299,18 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 												 &scan->executorReadBlock,
 												  /* blockFirstRowNum */ 1);
 
+	/* Load all visimap entries of the segment file for the visibility checks */
+	if (scan->snapshot != SnapshotAny &&
+		AppendOnlyVisimap_LoadSegmentFile(&scan->visibilityMap, segno))
+	{
+#ifdef FAULT_INJECTOR
+		FaultInjector_InjectFaultIfSet("ao_visimap_segment_loaded",
+									   DDLNotSpecified,
+									   "",	/* databaseName */
+									   RelationGetRelationName(scan->aos_rd));	/* tableName */
+#endif
+	}
+
 	/* ready to go! */
 	scan->aos_need_new_segfile = false;
 
@@ -774,6 +814,16 @@ AppendOnlyExecutorReadBlock_Finish(AppendOnlyExecutorReadBlock *executorReadBloc
 		executorReadBlock->mt_bind = NULL;
 	}
 
+	/* releases the JIT compiled deform functions */
+	if (executorReadBlock->mt_jit_context)
+	{
+		jit_release_context(executorReadBlock->mt_jit_context);
+		executorReadBlock->mt_jit_context = NULL;
+	}
+	executorReadBlock->mt_deform = NULL;
+	executorReadBlock->mt_jit_deform = NULL;
+	executorReadBlock->mt_jit_tupdesc = NULL;
+
 	if (executorReadBlock->attnum_to_rownum)
 	{
 		pfree(executorReadBlock->attnum_to_rownum);
@@ -859,6 +909,28 @@ AppendOnlyExecutorReadBlock_BindingInit(AppendOnlyExecutorReadBlock *executorRea
 	MemoryContextSwitchTo(oldContext);
 
 	executorReadBlock->curLargestAttnum = largestAttnum;
+
+	/*
+	 * Compile the deforming of bindings without missing attributes, the
+	 * others need to fill in the missing values from the catalog.
+	 *
+	 * Every block recreates the binding, but the bindings of all attributes
+	 * of the same slot descriptor are all alike, so compile the function
+	 * only once for them.  If compiling fails, don't try again.
+	 */
+	executorReadBlock->mt_deform = NULL;
+	if (executorReadBlock->jitDeform &&
+		largestAttnum == slot->tts_tupleDescriptor->natts)
+	{
+		if (executorReadBlock->mt_jit_tupdesc != slot->tts_tupleDescriptor)
+		{
+			executorReadBlock->mt_jit_deform = (MemTupleDeformFunc)
+				jit_compile_memtuple_deform(&executorReadBlock->mt_jit_context,
+											executorReadBlock->mt_bind);
+			executorReadBlock->mt_jit_tupdesc = slot->tts_tupleDescriptor;
+		}
+		executorReadBlock->mt_deform = executorReadBlock->mt_jit_deform;
+	}
 }
 
 
@@ -894,7 +966,10 @@ AppendOnlyExecutorReadBlock_ProcessTuple(AppendOnlyExecutorReadBlock *executorRe
 		Assert(executorReadBlock->mt_bind);
 
 		ExecClearTuple(slot);
-		memtuple_deform(tuple, executorReadBlock->mt_bind, slot->tts_values, slot->tts_isnull);
+		if (executorReadBlock->mt_deform)
+			executorReadBlock->mt_deform(tuple, slot->tts_values, slot->tts_isnull);
+		else
+			memtuple_deform(tuple, executorReadBlock->mt_bind, slot->tts_values, slot->tts_isnull);
 		slot->tts_tid = fake_ctid;
 		ExecStoreVirtualTuple(slot);
 	}
@@ -1532,6 +1607,16 @@ appendonlygettup(AppendOnlyScanDesc scan,
 			}
 
 			scan->needNextBuffer = false;
+
+			/*
+			 * Skip the visibility check of each tuple if the visimap hides
+			 * none of the block.
+			 */
+			scan->blockAllVisible = !isSnapshotAny &&
+				AppendOnlyVisimap_GetHiddenTupleCountInRange(&scan->visibilityMap,
+															 scan->executorReadBlock.segmentFileNum,
+															 scan->executorReadBlock.blockFirstRowNum,
+															 scan->executorReadBlock.rowCount) == 0;
 		}
 
 		found = AppendOnlyExecutorReadBlock_ScanNextTuple(&scan->executorReadBlock,
@@ -1546,7 +1631,8 @@ appendonlygettup(AppendOnlyScanDesc scan,
 			 */
 			AOTupleId  *aoTupleId = (AOTupleId *) &slot->tts_tid;
 
-			if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, aoTupleId))
+			if (!isSnapshotAny && !scan->blockAllVisible &&
+				!AppendOnlyVisimap_IsVisible(&scan->visibilityMap, aoTupleId))
 			{
 				/* The tuple is invisible */
 			}
@@ -1606,6 +1692,24 @@ setupNextWriteBlock(AppendOnlyInsertDesc aoInsertDesc)
 	aoInsertDesc->bufferCount++;
 }
 
+/*
+ * Write out the block given to the compression workers by finishWriteBlock(),
+ * if any, and record it in the block directory.
+ */
+static void
+completePendingWriteBlock(AppendOnlyInsertDesc aoInsertDesc)
+{
+	if (!AppendOnlyStorageWrite_CompletePendingBuffer(&aoInsertDesc->storageWrite))
+		return;
+
+	AppendOnlyBlockDirectory_InsertEntry(
+		&aoInsertDesc->blockDirectory,
+		0,
+		aoInsertDesc->pendingBlockFirstRowNum,
+		AppendOnlyStorageWrite_LogicalBlockStartOffset(&aoInsertDesc->storageWrite),
+		aoInsertDesc->pendingBlockItemCount);
+}
+
 static void
 finishWriteBlock(AppendOnlyInsertDesc aoInsertDesc)
 {
@@ -1639,6 +1743,24 @@ finishWriteBlock(AppendOnlyInsertDesc aoInsertDesc)
 		executorBlockKind = AoExecutorBlockKind_SingleRow;
 	}
 
+	if (AppendOnlyStorageWrite_IsCompressAsync(&aoInsertDesc->storageWrite))
+	{
+		/*
+		 * Write out the previous block, and let the compression workers
+		 * compress this one while we fill the next.
+		 */
+		completePendingWriteBlock(aoInsertDesc);
+
+		AppendOnlyStorageWrite_SubmitBuffer(&aoInsertDesc->storageWrite,
+											dataLen,
+											executorBlockKind,
+											itemCount);
+		aoInsertDesc->nonCompressedData = NULL;
+		aoInsertDesc->pendingBlockFirstRowNum = aoInsertDesc->blockFirstRowNum;
+		aoInsertDesc->pendingBlockItemCount = itemCount;
+		return;
+	}
+
 	aoInsertDesc->storageWrite.logicalBlockStartOffset =
 		BufferedAppendNextBufferPosition(&(aoInsertDesc->storageWrite.bufferedAppend));
 
@@ -3362,8 +3484,9 @@ appendonly_insert(AppendOnlyInsertDesc aoInsertDesc,
 		Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
 
 		/*
-		 * Write large content.
+		 * Write large content, after the pending block.
 		 */
+		completePendingWriteBlock(aoInsertDesc);
 		AppendOnlyStorageWrite_Content(
 									   &aoInsertDesc->storageWrite,
 									   (uint8 *) tup,
@@ -3425,6 +3548,7 @@ appendonly_insert_finish(AppendOnlyInsertDesc aoInsertDesc)
 	 * Finish up that last varblock.
 	 */
 	finishWriteBlock(aoInsertDesc);
+	completePendingWriteBlock(aoInsertDesc);
 
 	CloseWritableFileSeg(aoInsertDesc);
 
@@ -341,6 +341,13 @@ get_or_create_ao_insert_descriptor(const Relation relation, int64 num_rows)
 													   firstRowNum,
 													   fileOffset,
 													   0);
+
+			/*
+			 * Record each block in the block directory as soon as it is
+			 * written, rather than one block late as with background
+			 * compression.
+			 */
+			insertDesc->storageWrite.compressAsync = false;
 		}
 		state->insertDesc = insertDesc;
 		MemoryContextSwitchTo(oldcxt);
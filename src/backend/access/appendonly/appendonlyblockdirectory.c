@@ -33,6 +33,7 @@
 
 int			gp_blockdirectory_entry_min_range = 0;
 int			gp_blockdirectory_minipage_size = NUM_MINIPAGE_ENTRIES;
+int			gp_blockdirectory_minipage_cache_size = 32;
 
 static void load_last_minipage(
 				   AppendOnlyBlockDirectory *blockDirectory,
@@ -53,12 +54,20 @@ static void extract_minipage(
 static void write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 			   int columnGroupNo,
 			   MinipagePerColumnGroup *minipageInfo);
+static bool minipage_cache_lookup(AppendOnlyBlockDirectory *blockDirectory,
+					  int segmentFileNum,
+					  int columnGroupNo,
+					  int64 rowNum);
+static void minipage_cache_insert(AppendOnlyBlockDirectory *blockDirectory,
+					  int segmentFileNum,
+					  int columnGroupNo);
 static bool
 insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int columnGroupNo,
 				 int64 firstRowNum,
 				 int64 fileOffset,
-				 int64 rowCount);
+				 int64 rowCount,
+				 MinipageZoneMap *zoneMap);
 static void clear_minipage(MinipagePerColumnGroup *minipagePerColumnGroup);
 
 static int findFileSegInfo(AppendOnlyBlockDirectory *blockDirectory,
@@ -145,13 +154,20 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 		MinipagePerColumnGroup *minipageInfo =
 							&blockDirectory->minipages[groupNo];
 
-		minipageInfo->minipage =
-			palloc0(minipage_size(NUM_MINIPAGE_ENTRIES));
+		alloc_minipage(minipageInfo);
 		minipageInfo->numMinipageEntries = 0;
 		ItemPointerSetInvalid(&minipageInfo->tupleTid);
 		minipageInfo->cached_entry_no = InvalidEntryNum;
 	}
 
+	/* The minipage cache is enabled by the callers that can use it */
+	blockDirectory->minipageCache = NULL;
+	blockDirectory->minipageCacheSize = 0;
+	blockDirectory->minipageCacheCount = 0;
+	blockDirectory->minipageCacheClock = 0;
+	blockDirectory->minipageCacheHits = 0;
+	blockDirectory->minipageCacheMisses = 0;
+
 	MemoryContextSwitchTo(oldcxt);
 }
 
@@ -273,6 +289,8 @@ AppendOnlyBlockDirectory_Init_forSearch(
 	init_internal_proj(blockDirectory, proj, isAOCol);
 
 	init_internal(blockDirectory);
+
+	blockDirectory->minipageCacheSize = gp_blockdirectory_minipage_cache_size;
 }
 
 /*
@@ -399,6 +417,8 @@ AppendOnlyBlockDirectory_Init_forIndexOnlyScan(
 	init_internal_proj(blockDirectory, NULL, blockDirectory->isAOCol);
 
 	init_internal(blockDirectory);
+
+	blockDirectory->minipageCacheSize = gp_blockdirectory_minipage_cache_size;
 }
 
 /*
@@ -772,6 +792,18 @@ AppendOnlyBlockDirectory_GetEntry(
 			continue;
 		}
 
+		/*
+		 * A minipage covering the rowNum may have been read before, e.g. by
+		 * an index scan going back and forth between the blocks.
+		 */
+		if (minipage_cache_lookup(blockDirectory, segmentFileNum,
+								  tmpGroupNo, rowNum))
+		{
+			blockDirectory->currentSegmentFileNum = segmentFileNum;
+			blockDirectory->currentSegmentFileInfo = fsInfo;
+			continue;
+		}
+
 		/*
 		 * Set up the scan keys values. The keys have already been set up in
 		 * init_internal() with the following strategy:
@@ -809,6 +841,7 @@ AppendOnlyBlockDirectory_GetEntry(
 							 tuple,
 							 heapTupleDesc,
 							 tmpGroupNo);
+			minipage_cache_insert(blockDirectory, segmentFileNum, tmpGroupNo);
 		}
 		else
 		{
@@ -1140,6 +1173,16 @@ blkdir_entry_exists(AppendOnlyBlockDirectory *blockDirectory,
 		}
 	}
 
+	/* Then the other minipages read before */
+	if (minipage_cache_lookup(blockDirectory, segmentFileNum,
+							  columnGroupNo, rowNum))
+	{
+		blockDirectory->currentSegmentFileNum = segmentFileNum;
+		if (find_minipage_entry(&blockDirectory->minipages[columnGroupNo],
+								rowNum) != InvalidEntryNum)
+			return true;
+	}
+
 	blkdirTupleDesc = RelationGetDescr(blkdirRel);
 
 	/*
@@ -1212,6 +1255,7 @@ blkdir_entry_exists(AppendOnlyBlockDirectory *blockDirectory,
 		entry_no = find_minipage_entry(minipageInfo, rowNum);
 		if (entry_no != InvalidEntryNum)
 		{
+			minipage_cache_insert(blockDirectory, segmentFileNum, columnGroupNo);
 			found = true;
 			break;
 		}
@@ -1249,7 +1293,73 @@ AppendOnlyBlockDirectory_InsertEntry(AppendOnlyBlockDirectory *blockDirectory,
 									 int64 rowCount)
 {
 	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
-							fileOffset, rowCount);
+							fileOffset, rowCount, NULL);
+}
+
+/*
+ * AppendOnlyBlockDirectory_InsertEntryWithZoneMap
+ *
+ * Like AppendOnlyBlockDirectory_InsertEntry(), but also records the zone map
+ * of the block.
+ */
+bool
+AppendOnlyBlockDirectory_InsertEntryWithZoneMap(AppendOnlyBlockDirectory *blockDirectory,
+												int columnGroupNo,
+												int64 firstRowNum,
+												int64 fileOffset,
+												int64 rowCount,
+												MinipageZoneMap *zoneMap)
+{
+	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
+							fileOffset, rowCount, zoneMap);
+}
+
+/*
+ * AppendOnlyBlockDirectory_GetZoneMap
+ *
+ * Find the block directory entry of the given column group that covers the
+ * row of aoTupleId, and return its zone map, as well as the last row number
+ * the entry covers.
+ *
+ * Returns false if there is no such entry, or if no zone map was recorded for
+ * it.
+ */
+bool
+AppendOnlyBlockDirectory_GetZoneMap(AppendOnlyBlockDirectory *blockDirectory,
+									AOTupleId *aoTupleId,
+									int columnGroupNo,
+									int64 *attnum_to_rownum,
+									MinipageZoneMap *zoneMap,
+									int64 *lastRowNum)
+{
+	AppendOnlyBlockDirectoryEntry directoryEntry;
+	MinipagePerColumnGroup *minipageInfo =
+	&blockDirectory->minipages[columnGroupNo];
+	MinipageEntry *entry;
+	int			entry_no;
+
+	if (!AppendOnlyBlockDirectory_GetEntry(blockDirectory, aoTupleId,
+										   columnGroupNo, &directoryEntry,
+										   attnum_to_rownum))
+		return false;
+
+	/*
+	 * GetEntry() falls back to the last entry of the minipage when no entry
+	 * covers the row, look for an exact match.
+	 */
+	entry_no = find_minipage_entry(minipageInfo,
+								   AOTupleIdGet_rowNum(aoTupleId));
+	if (entry_no == InvalidEntryNum)
+		return false;
+
+	if ((minipageInfo->zoneMaps[entry_no].flags & ZONEMAP_VALID) == 0)
+		return false;
+
+	entry = &minipageInfo->minipage->entry[entry_no];
+	*zoneMap = minipageInfo->zoneMaps[entry_no];
+	*lastRowNum = entry->firstRowNum + entry->rowCount - 1;
+
+	return true;
 }
 
 /*
@@ -1314,7 +1424,8 @@ insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int columnGroupNo,
 				 int64 firstRowNum,
 				 int64 fileOffset,
-				 int64 rowCount)
+				 int64 rowCount,
+				 MinipageZoneMap *zoneMap)
 {
 	MinipageEntry *entry = NULL;
 	MinipagePerColumnGroup *minipageInfo;
@@ -1350,6 +1461,12 @@ insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 	entry->fileOffset = fileOffset;
 	entry->rowCount = rowCount;
 
+	if (zoneMap != NULL)
+		minipageInfo->zoneMaps[minipageInfo->numMinipageEntries] = *zoneMap;
+	else
+		MemSet(&minipageInfo->zoneMaps[minipageInfo->numMinipageEntries], 0,
+			   sizeof(MinipageZoneMap));
+
 	minipageInfo->numMinipageEntries++;
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -1510,6 +1627,150 @@ extract_minipage(AppendOnlyBlockDirectory *blockDirectory,
 	ItemPointerCopy(&tuple->t_self, &minipageInfo->tupleTid);
 }
 
+/*
+ * copy_minipage
+ *
+ * Copy the minipage info of a column group into another one.
+ */
+static void
+copy_minipage(MinipagePerColumnGroup *dst, MinipagePerColumnGroup *src)
+{
+	memcpy(dst->minipage, src->minipage, VARSIZE(src->minipage));
+	memcpy(dst->zoneMaps, src->zoneMaps,
+		   sizeof(MinipageZoneMap) * src->numMinipageEntries);
+	dst->numMinipageEntries = src->numMinipageEntries;
+	ItemPointerCopy(&src->tupleTid, &dst->tupleTid);
+	dst->cached_entry_no = InvalidEntryNum;
+}
+
+/*
+ * minipage_cache_enabled
+ *
+ * The minipages visible to an MVCC snapshot don't change, so they can be
+ * kept for the whole lookup. Other snapshots must see the latest minipages.
+ */
+static inline bool
+minipage_cache_enabled(AppendOnlyBlockDirectory *blockDirectory)
+{
+	return blockDirectory->minipageCacheSize > 0 &&
+		blockDirectory->appendOnlyMetaDataSnapshot != NULL &&
+		IsMVCCSnapshot(blockDirectory->appendOnlyMetaDataSnapshot);
+}
+
+/*
+ * minipage_cache_lookup
+ *
+ * Search the minipage cache for the minipage of the given column group
+ * covering the rowNum. If found, it becomes the current minipage of the
+ * column group and true is returned.
+ */
+static bool
+minipage_cache_lookup(AppendOnlyBlockDirectory *blockDirectory,
+					  int segmentFileNum,
+					  int columnGroupNo,
+					  int64 rowNum)
+{
+	if (!minipage_cache_enabled(blockDirectory))
+		return false;
+
+	for (int i = 0; i < blockDirectory->minipageCacheCount; i++)
+	{
+		MinipageCacheEntry *entry = &blockDirectory->minipageCache[i];
+
+		if (entry->segmentFileNum == segmentFileNum &&
+			entry->columnGroupNo == columnGroupNo &&
+			entry->firstRowNum <= rowNum && rowNum <= entry->lastRowNum)
+		{
+			copy_minipage(&blockDirectory->minipages[columnGroupNo],
+						  &entry->minipageInfo);
+			entry->lastUsed = ++blockDirectory->minipageCacheClock;
+			blockDirectory->minipageCacheHits++;
+#ifdef FAULT_INJECTOR
+			FaultInjector_InjectFaultIfSet("ao_minipage_cache_hit",
+										   DDLNotSpecified,
+										   "",	/* databaseName */
+										   RelationGetRelationName(blockDirectory->aoRel));	/* tableName */
+#endif
+			return true;
+		}
+	}
+
+	blockDirectory->minipageCacheMisses++;
+	return false;
+}
+
+/*
+ * minipage_cache_insert
+ *
+ * Add the current minipage of the given column group to the minipage cache,
+ * replacing the least recently used minipage if the cache is full.
+ */
+static void
+minipage_cache_insert(AppendOnlyBlockDirectory *blockDirectory,
+					  int segmentFileNum,
+					  int columnGroupNo)
+{
+	MinipagePerColumnGroup *minipageInfo = &blockDirectory->minipages[columnGroupNo];
+	MinipageCacheEntry *entry = NULL;
+	MinipageEntry *firstentry;
+	MinipageEntry *lastentry;
+
+	if (!minipage_cache_enabled(blockDirectory) ||
+		minipageInfo->numMinipageEntries == 0)
+		return;
+
+	firstentry = &minipageInfo->minipage->entry[0];
+	lastentry = &minipageInfo->minipage->entry[minipageInfo->numMinipageEntries - 1];
+
+	if (blockDirectory->minipageCache == NULL)
+		blockDirectory->minipageCache =
+			MemoryContextAllocZero(blockDirectory->memoryContext,
+								   sizeof(MinipageCacheEntry) * blockDirectory->minipageCacheSize);
+
+	for (int i = 0; i < blockDirectory->minipageCacheCount; i++)
+	{
+		MinipageCacheEntry *cur = &blockDirectory->minipageCache[i];
+
+		/* the same minipage, e.g. read again through a different snapshot */
+		if (cur->segmentFileNum == segmentFileNum &&
+			cur->columnGroupNo == columnGroupNo &&
+			cur->firstRowNum == firstentry->firstRowNum)
+		{
+			entry = cur;
+			break;
+		}
+	}
+
+	if (entry == NULL)
+	{
+		if (blockDirectory->minipageCacheCount < blockDirectory->minipageCacheSize)
+		{
+			MemoryContext oldcxt;
+
+			entry = &blockDirectory->minipageCache[blockDirectory->minipageCacheCount++];
+			oldcxt = MemoryContextSwitchTo(blockDirectory->memoryContext);
+			alloc_minipage(&entry->minipageInfo);
+			MemoryContextSwitchTo(oldcxt);
+		}
+		else
+		{
+			entry = &blockDirectory->minipageCache[0];
+			for (int i = 1; i < blockDirectory->minipageCacheCount; i++)
+			{
+				if (blockDirectory->minipageCache[i].lastUsed < entry->lastUsed)
+					entry = &blockDirectory->minipageCache[i];
+			}
+		}
+	}
+
+	entry->segmentFileNum = segmentFileNum;
+	entry->columnGroupNo = columnGroupNo;
+	entry->firstRowNum = firstentry->firstRowNum;
+	entry->lastRowNum = lastentry->firstRowNum + lastentry->rowCount - 1;
+	entry->lastUsed = ++blockDirectory->minipageCacheClock;
+	copy_minipage(&entry->minipageInfo, minipageInfo);
+}
+
 /*
  * load_last_minipage
  *
@@ -1690,9 +1951,34 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 		Int64GetDatum(minipageInfo->minipage->entry[0].firstRowNum);
 	nulls[Anum_pg_aoblkdir_firstrownum - 1] = false;
 
+	minipageInfo->minipage->nEntry = minipageInfo->numMinipageEntries;
+	minipageInfo->minipage->version = 0;
 	SET_VARSIZE(minipageInfo->minipage,
 				minipage_size(minipageInfo->numMinipageEntries));
-	minipageInfo->minipage->nEntry = minipageInfo->numMinipageEntries;
+
+	/*
+	 * Zone maps are stored after the entries, only when there is one. That
+	 * keeps the minipages of tables without zone maps in the old format, and
+	 * so do the tables created before AORelationVersion_GP7_ZoneMaps, whose
+	 * block directory the binaries that don't know zone maps must be able to
+	 * read.
+	 */
+	if (AORelationVersion_Validate(blockDirectory->aoRel, AORelationVersion_GP7_ZoneMaps))
+	{
+		for (uint32 i = 0; i < minipageInfo->numMinipageEntries; i++)
+		{
+			if (minipageInfo->zoneMaps[i].flags & ZONEMAP_VALID)
+			{
+				memcpy(&minipageInfo->minipage->entry[minipageInfo->numMinipageEntries],
+					   minipageInfo->zoneMaps,
+					   sizeof(MinipageZoneMap) * minipageInfo->numMinipageEntries);
+				minipageInfo->minipage->version = MINIPAGE_VERSION_ZONEMAP;
+				SET_VARSIZE(minipageInfo->minipage,
+							minipage_zonemap_size(minipageInfo->numMinipageEntries));
+				break;
+			}
+		}
+	}
 	values[Anum_pg_aoblkdir_minipage - 1] =
 		PointerGetDatum(minipageInfo->minipage);
 	nulls[Anum_pg_aoblkdir_minipage - 1] = false;
@@ -1747,6 +2033,8 @@ clear_minipage(MinipagePerColumnGroup *minipagePerColumnGroup)
 {
 	MemSet(minipagePerColumnGroup->minipage->entry, 0,
 		   minipagePerColumnGroup->numMinipageEntries * sizeof(MinipageEntry));
+	MemSet(minipagePerColumnGroup->zoneMaps, 0,
+		   minipagePerColumnGroup->numMinipageEntries * sizeof(MinipageZoneMap));
 	minipagePerColumnGroup->numMinipageEntries = 0;
 	ItemPointerSetInvalid(&minipagePerColumnGroup->tupleTid);
 	minipagePerColumnGroup->cached_entry_no = InvalidEntryNum;
@@ -1811,7 +2099,7 @@ AppendOnlyBlockDirectory_InsertPlaceholder(AppendOnlyBlockDirectory *blockDirect
 
 	/* insert placeholder entry with a max row count */
 	insert_new_entry(blockDirectory, columnGroupNo, firstRowNum, fileOffset,
-					 AOTupleId_MaxRowNum);
+					 AOTupleId_MaxRowNum, NULL);
 	/* insert placeholder row containing placeholder entry */
 	write_minipage(blockDirectory, columnGroupNo, minipagePerColumnGroup);
 	/*
@@ -1882,7 +2170,10 @@ AppendOnlyBlockDirectory_End_forSearch(
 					  "(%d, %d, %d)",
 					  blockDirectory->totalSegfiles,
 					  blockDirectory->numColumnGroups,
-					  blockDirectory->isAOCol)));
+					  blockDirectory->isAOCol),
+			   errdetail("minipage cache (hits, misses) = (" INT64_FORMAT ", " INT64_FORMAT ")",
+						 blockDirectory->minipageCacheHits,
+						 blockDirectory->minipageCacheMisses)));
 
 	if (blockDirectory->blkdirIdx)
 		index_close(blockDirectory->blkdirIdx, AccessShareLock);
@@ -1968,10 +2259,13 @@ AppendOnlyBlockDirectory_End_forIndexOnlyScan(AppendOnlyBlockDirectory *blockDir
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
 			  (errmsg("Append-only block directory end for index-only scan"),
-				  errdetail("(aoRel = %u, blkdirrel = %u, blkdiridxrel = %u)",
+				  errdetail("(aoRel = %u, blkdirrel = %u, blkdiridxrel = %u, "
+							"minipage cache hits = " INT64_FORMAT ", misses = " INT64_FORMAT ")",
 							blockDirectory->aoRel->rd_id,
 							blockDirectory->blkdirRel->rd_id,
-							blockDirectory->blkdirIdx->rd_id)));
+							blockDirectory->blkdirIdx->rd_id,
+							blockDirectory->minipageCacheHits,
+							blockDirectory->minipageCacheMisses)));
 
 	index_close(blockDirectory->blkdirIdx, AccessShareLock);
 	heap_close(blockDirectory->blkdirRel, AccessShareLock);
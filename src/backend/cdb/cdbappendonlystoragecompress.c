@@ -0,0 +1,465 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbappendonlystoragecompress.c
+ *	  Compress Append-Only Storage Blocks in background threads.
+ *
+ * Inserting into a compressed append-only table compresses every block
+ * before it is written, which makes large loads bound by the speed of a
+ * single core.  The routines here let the Append-Only Storage Layer hand a
+ * filled block to a small pool of worker threads, and go on filling the next
+ * block (or the blocks of other columns) meanwhile.  The compressed block is
+ * collected later by the backend, which writes it out, and WAL-logs it, in
+ * the original order.
+ *
+ * The worker threads must not call into the backend: no palloc, no elog, no
+ * fmgr.  So they call the compression libraries directly, which is why only
+ * zlib and zstd are supported, and they only touch memory owned by the job.
+ * The output is the same as from the compression functions of pg_compression,
+ * so it is read back with the regular decompressors.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/cdbappendonlystoragecompress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "access/xact.h"
+#include "cdb/cdbappendonlystoragecompress.h"
+
+/* GUC */
+int			gp_appendonly_compress_workers = 0;
+
+/* Upper limit of gp_appendonly_compress_workers */
+#define MAX_COMPRESS_WORKERS 64
+
+typedef enum AppendOnlyCompressAlgorithm
+{
+	AOCompressAlgorithm_Zlib,
+	AOCompressAlgorithm_Zstd
+} AppendOnlyCompressAlgorithm;
+
+typedef enum AppendOnlyCompressJobState
+{
+	AOCompressJobState_Free,	/* in the free list */
+	AOCompressJobState_Queued,	/* waiting for, or being compressed by, a
+								 * worker */
+	AOCompressJobState_Done		/* compressed, waiting to be collected */
+} AppendOnlyCompressJobState;
+
+struct AppendOnlyCompressJob
+{
+	/* Link in the work queue or in the free list. */
+	AppendOnlyCompressJob *next;
+
+	/* Link in the list of all jobs, for the cleanup at transaction end. */
+	AppendOnlyCompressJob *allNext;
+
+	AppendOnlyCompressJobState state;
+
+	AppendOnlyCompressAlgorithm algorithm;
+	int			level;
+
+	/* Private copy of the uncompressed block. */
+	uint8	   *source;
+	int32		sourceLen;
+	int32		sourceCapacity;
+
+	/*
+	 * Output buffer, compressedBufferLen is the size the caller allows the
+	 * compressed block to have.
+	 */
+	uint8	   *compressed;
+	int32		compressedBufferLen;
+	int32		compressedCapacity;
+
+	/*
+	 * Result.  As with the compression functions of pg_compression, a
+	 * compressedLen of sourceLen or more means the block didn't compress.
+	 */
+	int32		compressedLen;
+	int			error;
+};
+
+/*
+ * The pool is per backend.  The lock protects the work queue, the job states
+ * and the lists; the buffers of a queued job belong to the worker.
+ */
+static struct
+{
+	bool		initialized;
+
+	pthread_mutex_t lock;
+	pthread_cond_t workCond;	/* signaled when a job is queued */
+	pthread_cond_t doneCond;	/* signaled when a job is done */
+
+	AppendOnlyCompressJob *queueHead;
+	AppendOnlyCompressJob *queueTail;
+
+	AppendOnlyCompressJob *freeList;
+	AppendOnlyCompressJob *allJobs;
+
+	int			numWorkers;
+	pthread_t	workers[MAX_COMPRESS_WORKERS];
+} compressPool;
+
+static void AppendOnlyCompressPool_Init(void);
+static void AppendOnlyCompressPool_StartWorkers(int numWorkers);
+static void *AppendOnlyCompressPool_WorkerMain(void *arg);
+static void AppendOnlyCompressPool_Compress(AppendOnlyCompressJob *job,
+											void **workerState);
+static void AppendOnlyCompressPool_XactCallback(XactEvent event, void *arg);
+
+/*
+ * Can blocks of the given compression type be compressed by the worker
+ * threads?
+ */
+bool
+AppendOnlyCompressPool_Supports(char *compressType)
+{
+	if (gp_appendonly_compress_workers <= 0 || compressType == NULL)
+		return false;
+
+#ifdef HAVE_LIBZ
+	if (pg_strcasecmp(compressType, "zlib") == 0)
+		return true;
+#endif
+#ifdef USE_ZSTD
+	if (pg_strcasecmp(compressType, "zstd") == 0)
+		return true;
+#endif
+
+	return false;
+}
+
+static void
+AppendOnlyCompressPool_Init(void)
+{
+	if (compressPool.initialized)
+		return;
+
+	if (pthread_mutex_init(&compressPool.lock, NULL) != 0 ||
+		pthread_cond_init(&compressPool.workCond, NULL) != 0 ||
+		pthread_cond_init(&compressPool.doneCond, NULL) != 0)
+		elog(ERROR, "could not initialize the append-only compression workers");
+
+	RegisterXactCallback(AppendOnlyCompressPool_XactCallback, NULL);
+
+	compressPool.initialized = true;
+}
+
+/*
+ * Start worker threads until there are numWorkers of them.  The workers stay
+ * around for the lifetime of the backend.
+ */
+static void
+AppendOnlyCompressPool_StartWorkers(int numWorkers)
+{
+	pthread_attr_t t_atts;
+	sigset_t	sigs;
+	sigset_t	old_sigs;
+
+	numWorkers = Min(numWorkers, MAX_COMPRESS_WORKERS);
+	if (compressPool.numWorkers >= numWorkers)
+		return;
+
+	pthread_attr_init(&t_atts);
+	pthread_attr_setstacksize(&t_atts, Max(PTHREAD_STACK_MIN, (256 * 1024)));
+
+	/* the workers must not run our signal handlers */
+	sigfillset(&sigs);
+	pthread_sigmask(SIG_BLOCK, &sigs, &old_sigs);
+
+	while (compressPool.numWorkers < numWorkers)
+	{
+		int			err;
+
+		err = pthread_create(&compressPool.workers[compressPool.numWorkers],
+							 &t_atts, AppendOnlyCompressPool_WorkerMain, NULL);
+		if (err != 0)
+		{
+			/* carry on with the workers we have, if any */
+			elog(compressPool.numWorkers > 0 ? LOG : ERROR,
+				 "could not create append-only compression worker thread: error code %d",
+				 err);
+			break;
+		}
+		compressPool.numWorkers++;
+	}
+
+	pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+	pthread_attr_destroy(&t_atts);
+}
+
+static void *
+AppendOnlyCompressPool_WorkerMain(void *arg)
+{
+	void	   *workerState = NULL;
+
+	pthread_mutex_lock(&compressPool.lock);
+	for (;;)
+	{
+		AppendOnlyCompressJob *job;
+
+		while (compressPool.queueHead == NULL)
+			pthread_cond_wait(&compressPool.workCond, &compressPool.lock);
+
+		job = compressPool.queueHead;
+		compressPool.queueHead = job->next;
+		if (compressPool.queueHead == NULL)
+			compressPool.queueTail = NULL;
+		job->next = NULL;
+
+		pthread_mutex_unlock(&compressPool.lock);
+
+		AppendOnlyCompressPool_Compress(job, &workerState);
+
+		pthread_mutex_lock(&compressPool.lock);
+		job->state = AOCompressJobState_Done;
+		pthread_cond_broadcast(&compressPool.doneCond);
+	}
+
+	return NULL;
+}
+
+/*
+ * Compress a job, in a worker thread.  workerState holds the compression
+ * context of the worker, reused across jobs.
+ *
+ * This mirrors zlib_compress() and zstd_compress().
+ */
+static void
+AppendOnlyCompressPool_Compress(AppendOnlyCompressJob *job, void **workerState)
+{
+	job->error = 0;
+
+	switch (job->algorithm)
+	{
+#ifdef HAVE_LIBZ
+		case AOCompressAlgorithm_Zlib:
+			{
+				unsigned long dstLen = job->compressedBufferLen;
+				int			err;
+
+				err = compress2(job->compressed, &dstLen,
+								job->source, job->sourceLen, job->level);
+				if (err == Z_OK)
+					job->compressedLen = (int32) dstLen;
+				else if (err == Z_BUF_ERROR)
+					job->compressedLen = job->sourceLen;
+				else
+					job->error = err;
+			}
+			break;
+#endif
+#ifdef USE_ZSTD
+		case AOCompressAlgorithm_Zstd:
+			{
+				size_t		dstLen;
+
+				if (*workerState == NULL)
+					*workerState = ZSTD_createCCtx();
+				if (*workerState == NULL)
+				{
+					job->error = -1;
+					break;
+				}
+
+				dstLen = ZSTD_compressCCtx((ZSTD_CCtx *) *workerState,
+										   job->compressed, job->compressedBufferLen,
+										   job->source, job->sourceLen,
+										   job->level);
+				if (!ZSTD_isError(dstLen))
+					job->compressedLen = (int32) dstLen;
+				else if (ZSTD_getErrorCode(dstLen) == ZSTD_error_dstSize_tooSmall)
+					job->compressedLen = job->sourceLen;
+				else
+					job->error = (int) ZSTD_getErrorCode(dstLen);
+			}
+			break;
+#endif
+		default:
+			job->error = -1;
+			break;
+	}
+}
+
+/*
+ * Queue a block for compression.  The block is copied, so the caller may
+ * reuse sourceData right away.
+ *
+ * The job has to be collected with AppendOnlyCompressPool_Wait() and given
+ * back with AppendOnlyCompressPool_Release().
+ */
+AppendOnlyCompressJob *
+AppendOnlyCompressPool_Submit(char *compressType,
+							  int compressLevel,
+							  uint8 *sourceData,
+							  int32 sourceLen,
+							  int32 compressedBufferLen)
+{
+	AppendOnlyCompressJob *job;
+
+	AppendOnlyCompressPool_Init();
+	AppendOnlyCompressPool_StartWorkers(Max(gp_appendonly_compress_workers, 1));
+
+	/*
+	 * Get a job.  The free list is only changed by the backend, but the
+	 * workers walk the queue, so hold the lock.
+	 */
+	pthread_mutex_lock(&compressPool.lock);
+	job = compressPool.freeList;
+	if (job != NULL)
+		compressPool.freeList = job->next;
+	pthread_mutex_unlock(&compressPool.lock);
+
+	if (job == NULL)
+	{
+		job = (AppendOnlyCompressJob *) calloc(1, sizeof(AppendOnlyCompressJob));
+		if (job == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+		job->state = AOCompressJobState_Free;
+		job->allNext = compressPool.allJobs;
+		compressPool.allJobs = job;
+	}
+
+	/* The buffers are malloc'd, so that they survive an aborted transaction */
+	if (job->sourceCapacity < sourceLen)
+	{
+		free(job->source);
+		job->sourceCapacity = 0;
+		job->source = malloc(sourceLen);
+		if (job->source == NULL)
+			goto oom;
+		job->sourceCapacity = sourceLen;
+	}
+	if (job->compressedCapacity < compressedBufferLen)
+	{
+		free(job->compressed);
+		job->compressedCapacity = 0;
+		job->compressed = malloc(compressedBufferLen);
+		if (job->compressed == NULL)
+			goto oom;
+		job->compressedCapacity = compressedBufferLen;
+	}
+
+	memcpy(job->source, sourceData, sourceLen);
+	job->sourceLen = sourceLen;
+	job->compressedBufferLen = compressedBufferLen;
+	job->compressedLen = 0;
+	job->error = 0;
+	job->level = Max(compressLevel, 1);
+	if (pg_strcasecmp(compressType, "zlib") == 0)
+		job->algorithm = AOCompressAlgorithm_Zlib;
+	else
+		job->algorithm = AOCompressAlgorithm_Zstd;
+
+	pthread_mutex_lock(&compressPool.lock);
+	job->state = AOCompressJobState_Queued;
+	job->next = NULL;
+	if (compressPool.queueTail != NULL)
+		compressPool.queueTail->next = job;
+	else
+		compressPool.queueHead = job;
+	compressPool.queueTail = job;
+	pthread_cond_signal(&compressPool.workCond);
+	pthread_mutex_unlock(&compressPool.lock);
+
+	return job;
+
+oom:
+	AppendOnlyCompressPool_Release(job);
+	ereport(ERROR,
+			(errcode(ERRCODE_OUT_OF_MEMORY),
+			 errmsg("out of memory")));
+	return NULL;				/* keep compiler quiet */
+}
+
+/*
+ * Wait for a job to be compressed.  Returns the uncompressed and compressed
+ * blocks; they stay valid until the job is released.
+ */
+void
+AppendOnlyCompressPool_Wait(AppendOnlyCompressJob *job,
+							uint8 **sourceData,
+							uint8 **compressedData,
+							int32 *compressedLen)
+{
+	Assert(job->state != AOCompressJobState_Free);
+
+	pthread_mutex_lock(&compressPool.lock);
+	while (job->state != AOCompressJobState_Done)
+		pthread_cond_wait(&compressPool.doneCond, &compressPool.lock);
+	pthread_mutex_unlock(&compressPool.lock);
+
+	if (job->error != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("%s compression of append-only block failed with error %d",
+						job->algorithm == AOCompressAlgorithm_Zlib ? "zlib" : "zstd",
+						job->error)));
+
+	*sourceData = job->source;
+	*compressedData = job->compressed;
+	*compressedLen = job->compressedLen;
+}
+
+/*
+ * Give back a job that is not queued.
+ */
+void
+AppendOnlyCompressPool_Release(AppendOnlyCompressJob *job)
+{
+	pthread_mutex_lock(&compressPool.lock);
+	Assert(job->state != AOCompressJobState_Queued);
+	job->state = AOCompressJobState_Free;
+	job->next = compressPool.freeList;
+	compressPool.freeList = job;
+	pthread_mutex_unlock(&compressPool.lock);
+}
+
+/*
+ * At transaction end, take back the jobs that were never collected because
+ * the insert was aborted.  Their writers are gone, and the workers only
+ * touch the job itself, so it's enough to wait for them to finish.
+ */
+static void
+AppendOnlyCompressPool_XactCallback(XactEvent event, void *arg)
+{
+	AppendOnlyCompressJob *job;
+
+	if (event != XACT_EVENT_COMMIT &&
+		event != XACT_EVENT_ABORT &&
+		event != XACT_EVENT_PREPARE)
+		return;
+
+	pthread_mutex_lock(&compressPool.lock);
+	for (job = compressPool.allJobs; job != NULL; job = job->allNext)
+	{
+		if (job->state == AOCompressJobState_Free)
+			continue;
+
+		while (job->state != AOCompressJobState_Done)
+			pthread_cond_wait(&compressPool.doneCond, &compressPool.lock);
+
+		job->state = AOCompressJobState_Free;
+		job->next = compressPool.freeList;
+		compressPool.freeList = job;
+	}
+	pthread_mutex_unlock(&compressPool.lock);
+}
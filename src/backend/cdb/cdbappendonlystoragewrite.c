@@ -173,6 +173,11 @@ AppendOnlyStorageWrite_Init(AppendOnlyStorageWrite *storageWrite,
 	storageWrite->formatVersion = -1;
 	storageWrite->needsWAL = needsWAL;
 
+	/* Compress in the worker threads, if enabled for this compression type */
+	storageWrite->compressAsync =
+		(storageWrite->storageAttributes.compress &&
+		 AppendOnlyCompressPool_Supports(storageWrite->storageAttributes.compressType));
+
 	MemoryContextSwitchTo(oldMemoryContext);
 
 	storageWrite->isActive = true;
@@ -189,6 +194,9 @@ AppendOnlyStorageWrite_FinishSession(AppendOnlyStorageWrite *storageWrite)
 	if (!storageWrite->isActive)
 		return;
 
+	/* The caller must have written out the pending block */
+	Assert(storageWrite->pendingJob == NULL);
+
 	oldMemoryContext = MemoryContextSwitchTo(storageWrite->memoryContext);
 
 	/*
@@ -379,6 +387,7 @@ AppendOnlyStorageWrite_FlushAndCloseFile(
 {
 	Assert(storageWrite != NULL);
 	Assert(storageWrite->isActive);
+	Assert(storageWrite->pendingJob == NULL);
 
 	if (storageWrite->file == -1)
 	{
@@ -1003,10 +1012,17 @@ AppendOnlyStorageWrite_VerifyWriteBlock(AppendOnlyStorageWrite *storageWrite,
 #endif
 }
 
+/*
+ * Compress the source data into the write buffer, and make the header.
+ *
+ * When compressedData is given, the data was already compressed by a
+ * compression worker into compressedData, with the length *compressedLen.
+ */
 static void
 AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
 									  uint8 *sourceData,
 									  int32 sourceLen,
+									  uint8 *compressedData,
 									  int executorBlockKind,
 									  int itemCount,
 									  int32 *compressedLen,
@@ -1045,13 +1061,19 @@ AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
 	 * Compress into the BufferedAppend buffer after the large header (and
 	 * optional checksum, etc.
 	 */
-	gp_trycompress(sourceData,
-					sourceLen,
-					dataBuffer,
-					dataBufferWithOverrrunLen,
-					compressedLen,
-					compressor,
-					storageWrite->compressionState);
+	if (compressedData != NULL)
+	{
+		if (*compressedLen < sourceLen)
+			memcpy(dataBuffer, compressedData, *compressedLen);
+	}
+	else
+		gp_trycompress(sourceData,
+					   sourceLen,
+					   dataBuffer,
+					   dataBufferWithOverrrunLen,
+					   compressedLen,
+					   compressor,
+					   storageWrite->compressionState);
 
 #ifdef FAULT_INJECTOR
 	/* Simulate that compression is not possible if the fault is set. */
@@ -1306,6 +1328,7 @@ AppendOnlyStorageWrite_FinishBuffer(AppendOnlyStorageWrite *storageWrite,
 		AppendOnlyStorageWrite_CompressAppend(storageWrite,
 											  storageWrite->uncompressedBuffer,
 											  contentLen,
+											  NULL,
 											  executorBlockKind,
 											  rowCount,
 											  &compressedLen,
@@ -1342,6 +1365,149 @@ AppendOnlyStorageWrite_FinishBuffer(AppendOnlyStorageWrite *storageWrite,
 	storageWrite->isFirstRowNumSet = false;
 }
 
+/*
+ * Are blocks compressed by the compression worker threads?
+ *
+ * If so, the caller can use ~_SubmitBuffer instead of ~_FinishBuffer, to
+ * go on with the next block while the current one is compressed.
+ */
+bool
+AppendOnlyStorageWrite_IsCompressAsync(AppendOnlyStorageWrite *storageWrite)
+{
+	return storageWrite->compressAsync;
+}
+
+/*
+ * Like ~_FinishBuffer, but hands the block to the compression workers.
+ *
+ * The block is not written out before the next ~_CompletePendingBuffer
+ * call.  Only one block can be pending, so the caller must complete the
+ * previous one first; also before writing large content with ~_Content or
+ * closing the file.
+ */
+void
+AppendOnlyStorageWrite_SubmitBuffer(AppendOnlyStorageWrite *storageWrite,
+									int32 contentLen,
+									int executorBlockKind,
+									int rowCount)
+{
+	Assert(storageWrite != NULL);
+	Assert(storageWrite->isActive);
+	Assert(storageWrite->compressAsync);
+	Assert(storageWrite->pendingJob == NULL);
+
+	Assert(storageWrite->currentCompleteHeaderLen > 0);
+
+	if (contentLen >
+		storageWrite->maxBufferLen - storageWrite->currentCompleteHeaderLen)
+		elog(ERROR,
+			 "Append-only content too large AO storage block (table '%s', "
+			 "content length = %d, maximum buffer length %d, complete header length %d, first row number is set %s)",
+			 storageWrite->relationName,
+			 contentLen,
+			 storageWrite->maxBufferLen,
+			 storageWrite->currentCompleteHeaderLen,
+			 (storageWrite->isFirstRowNumSet ? "true" : "false"));
+
+	storageWrite->pendingJob =
+		AppendOnlyCompressPool_Submit(storageWrite->storageAttributes.compressType,
+									  storageWrite->storageAttributes.compressLevel,
+									  storageWrite->uncompressedBuffer,
+									  contentLen,
+									  storageWrite->maxBufferWithCompressionOverrrunLen -
+									  storageWrite->currentCompleteHeaderLen);
+
+#ifdef FAULT_INJECTOR
+	FaultInjector_InjectFaultIfSet("appendonly_compress_async",
+								   DDLNotSpecified,
+								   "",	/* databaseName */
+								   storageWrite->relationName);	/* tableName */
+#endif
+
+	storageWrite->pendingAoHeaderKind = storageWrite->getBufferAoHeaderKind;
+	storageWrite->pendingIsFirstRowNumSet = storageWrite->isFirstRowNumSet;
+	storageWrite->pendingFirstRowNum = storageWrite->firstRowNum;
+	storageWrite->pendingContentLen = contentLen;
+	storageWrite->pendingExecutorBlockKind = executorBlockKind;
+	storageWrite->pendingRowCount = rowCount;
+
+	/* Declare it finished, for the caller. */
+	storageWrite->currentCompleteHeaderLen = 0;
+	storageWrite->currentBuffer = NULL;
+	storageWrite->isFirstRowNumSet = false;
+}
+
+/*
+ * Write out the block given to ~_SubmitBuffer, once it is compressed.
+ *
+ * Returns false if there was no pending block.  Otherwise, the offset of the
+ * block in the file is left in logicalBlockStartOffset, for the caller to
+ * record in the block directory.
+ */
+bool
+AppendOnlyStorageWrite_CompletePendingBuffer(AppendOnlyStorageWrite *storageWrite)
+{
+	AppendOnlyCompressJob *job = storageWrite->pendingJob;
+	uint8	   *sourceData;
+	uint8	   *compressedData;
+	int32		compressedLen;
+	int32		bufferLen;
+	int64		headerOffsetInFile;
+
+	Assert(storageWrite != NULL);
+	Assert(storageWrite->isActive);
+
+	if (job == NULL)
+		return false;
+
+	/* There can't be a block in the making, we use its header state */
+	Assert(storageWrite->currentCompleteHeaderLen == 0);
+
+	AppendOnlyCompressPool_Wait(job, &sourceData, &compressedData, &compressedLen);
+
+	storageWrite->getBufferAoHeaderKind = storageWrite->pendingAoHeaderKind;
+	storageWrite->isFirstRowNumSet = storageWrite->pendingIsFirstRowNumSet;
+	storageWrite->firstRowNum = storageWrite->pendingFirstRowNum;
+
+	storageWrite->logicalBlockStartOffset =
+		BufferedAppendNextBufferPosition(&storageWrite->bufferedAppend);
+	headerOffsetInFile = BufferedAppendCurrentBufferPosition(&storageWrite->bufferedAppend);
+
+	AppendOnlyStorageWrite_CompressAppend(storageWrite,
+										  sourceData,
+										  storageWrite->pendingContentLen,
+										  compressedData,
+										  storageWrite->pendingExecutorBlockKind,
+										  storageWrite->pendingRowCount,
+										  &compressedLen,
+										  &bufferLen);
+
+	if (gp_appendonly_verify_write_block)
+		AppendOnlyStorageWrite_VerifyWriteBlock(storageWrite,
+												headerOffsetInFile,
+												bufferLen,
+												sourceData,
+												storageWrite->pendingContentLen,
+												storageWrite->pendingExecutorBlockKind,
+												storageWrite->pendingRowCount,
+												compressedLen);
+
+	BufferedAppendFinishBuffer(&storageWrite->bufferedAppend,
+							   bufferLen,
+							   (storageWrite->currentCompleteHeaderLen +
+								AOStorage_RoundUp(storageWrite->pendingContentLen,
+												  storageWrite->formatVersion) /* non-compressed size */ ),
+							   storageWrite->needsWAL);
+
+	storageWrite->currentCompleteHeaderLen = 0;
+	storageWrite->isFirstRowNumSet = false;
+
+	storageWrite->pendingJob = NULL;
+	AppendOnlyCompressPool_Release(job);
+
+	return true;
+}
+
 /*
  * Cancel the last ~GetBuffer call.
  *
@@ -1416,6 +1582,7 @@ AppendOnlyStorageWrite_Content(AppendOnlyStorageWrite *storageWrite,
 
 	Assert(storageWrite != NULL);
 	Assert(storageWrite->isActive);
+	Assert(storageWrite->pendingJob == NULL);
 
 	completeHeaderLen =
 		AppendOnlyStorageWrite_CompleteHeaderLen(storageWrite,
@@ -1453,6 +1620,7 @@ AppendOnlyStorageWrite_Content(AppendOnlyStorageWrite *storageWrite,
 			AppendOnlyStorageWrite_CompressAppend(storageWrite,
 												  content,
 												  contentLen,
+												  NULL,
 												  executorBlockKind,
 												  rowCount,
 												  &compressedLen,
@@ -1575,6 +1743,7 @@ AppendOnlyStorageWrite_Content(AppendOnlyStorageWrite *storageWrite,
 				AppendOnlyStorageWrite_CompressAppend(storageWrite,
 													  contentNext,
 													  smallContentLen,
+													  NULL,
 													  executorBlockKind,
 													   /* rowCount */ 0,
 													  &compressedLen,
@@ -23,6 +23,8 @@
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
 
+static void BufferedReadPrefetch(
+					 BufferedRead *bufferedRead);
 static void BufferedReadIo(
 			   BufferedRead *bufferedRead);
 static uint8 *BufferedReadUseBeforeBuffer(
@@ -105,6 +107,7 @@ BufferedReadInit(
 	bufferedRead->fileLen = 0;
 	/* start reading from beginning of file */
 	bufferedRead->fileOff = 0;
+	bufferedRead->prefetchPosition = 0;
 
 	/*
 	 * Temporary limit support for random reading.
@@ -144,6 +147,7 @@ BufferedReadSetFile(
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
 	bufferedRead->fileOff =0;
+	bufferedRead->prefetchPosition = 0;
 
 	if (fileLen > 0)
 	{
@@ -158,6 +162,57 @@ BufferedReadSetFile(
 	}
 }
 
+/*
+ * Ask the operating system to start reading the next gp_appendonly_read_ahead
+ * large reads after the one about to be done, so that the disk works on them
+ * while the current one is processed (e.g. decompressed).
+ *
+ * Only the part of that range not prefetched by an earlier call is
+ * requested, so a sequential scan issues about one request per large read.
+ */
+static void
+BufferedReadPrefetch(
+					 BufferedRead *bufferedRead)
+{
+	int64		inEffectFileLen;
+	int64		readAfterPos;
+	int64		prefetchBeginPos;
+	int64		prefetchAfterPos;
+
+	if (gp_appendonly_read_ahead <= 0)
+		return;
+
+	if (bufferedRead->haveTemporaryLimitInEffect)
+		inEffectFileLen = bufferedRead->temporaryLimitFileLen;
+	else
+		inEffectFileLen = bufferedRead->fileLen;
+
+	readAfterPos = bufferedRead->largeReadPosition + bufferedRead->largeReadLen;
+
+	prefetchBeginPos = Max(readAfterPos, bufferedRead->prefetchPosition);
+	prefetchAfterPos = Min(readAfterPos +
+						   (int64) gp_appendonly_read_ahead * bufferedRead->maxLargeReadLen,
+						   inEffectFileLen);
+
+	if (prefetchAfterPos <= prefetchBeginPos)
+		return;
+
+	/* The request is only advice, a failure is not worth reporting. */
+	(void) FilePrefetch(bufferedRead->file,
+						prefetchBeginPos,
+						(int) Min(prefetchAfterPos - prefetchBeginPos, PG_INT32_MAX),
+						WAIT_EVENT_DATA_FILE_PREFETCH);
+
+#ifdef FAULT_INJECTOR
+	FaultInjector_InjectFaultIfSet("ao_read_ahead_prefetch",
+								   DDLNotSpecified,
+								   "",	/* databaseName */
+								   bufferedRead->relationName);	/* tableName */
+#endif
+
+	bufferedRead->prefetchPosition = prefetchAfterPos;
+}
+
 /*
  * Perform a large read i/o.
  */
@@ -173,6 +228,8 @@ BufferedReadIo(
 	Assert(bufferedRead->largeReadLen > 0);
 	largeReadMemory = bufferedRead->largeReadMemory;
 
+	BufferedReadPrefetch(bufferedRead);
+
 	offset = 0;
 	while (largeReadLen > 0)
 	{
@@ -371,6 +428,10 @@ BufferedReadSetTemporaryRange(
 	 */
 	bufferedRead->bufferLen = 0;
 
+	/* Set before any read, to keep the prefetching within the range. */
+	bufferedRead->haveTemporaryLimitInEffect = true;
+	bufferedRead->temporaryLimitFileLen = afterFileOffset;
+
 	newReadNeeded = false;
 	largeReadAfterPos = bufferedRead->largeReadPosition +
 		bufferedRead->largeReadLen;
@@ -427,6 +488,9 @@ BufferedReadSetTemporaryRange(
 		bufferedRead->fileOff = beginFileOffset;
 		bufferedRead->bufferOffset = 0;
 
+		/* What was prefetched for the old position is of no use here. */
+		bufferedRead->prefetchPosition = 0;
+
 		remainingFileLen = afterFileOffset - beginFileOffset;
 		if (remainingFileLen > bufferedRead->maxLargeReadLen)
 			bufferedRead->largeReadLen = bufferedRead->maxLargeReadLen;
@@ -438,10 +502,6 @@ BufferedReadSetTemporaryRange(
 		if (bufferedRead->largeReadLen > 0)
 			BufferedReadIo(bufferedRead);
 	}
-
-	bufferedRead->haveTemporaryLimitInEffect = true;
-	bufferedRead->temporaryLimitFileLen = afterFileOffset;
-
 }
 
 /*
@@ -670,6 +730,8 @@ BufferedReadCompleteFile(
 
 	bufferedRead->largeReadPosition = 0;
 	bufferedRead->largeReadLen = 0;
+
+	bufferedRead->prefetchPosition = 0;
 }
 
 
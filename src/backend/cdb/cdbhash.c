@@ -33,6 +33,7 @@
 #include "utils/lsyscache.h"
 #include "utils/syscache.h"
 #include "utils/typcache.h"
+#include "utils/uuid.h"
 
 /*
  * GUC to enable use of legacy hash opclasses by default. If set,
@@ -50,9 +51,49 @@ bool gp_use_legacy_hashops = false;
 /* Fast mod using a bit mask, assuming that y is a power of 2 */
 #define FASTMOD(x,y)		((x) & ((y)-1))
 
+/* Rotate a 32-bit value left by k bits */
+#define ROTL32(x,k)			(((x) << (k)) | ((x) >> (32 - (k))))
+
 /* local function declarations */
 static int	ispowof2(int numsegs);
 static inline int32 jump_consistent_hash(uint64 key, int32 num_segments);
+static CdbHashFastFunc cdbhash_fast_func(Oid funcid);
+static inline uint32 cdbhashdatum(CdbHash *h, int attno, Datum datum);
+
+/*
+ * Same as hash_uint32(), but inline so that the loops in cdbhashbatch() can
+ * be vectorized by the compiler.  This is the final() mix of hash_bytes().
+ */
+static inline uint32
+cdbhash_uint32(uint32 k)
+{
+	uint32		a,
+				b,
+				c;
+
+	a = b = c = 0x9e3779b9 + (uint32) sizeof(uint32) + 3923095;
+	a += k;
+
+	c ^= b; c -= ROTL32(b, 14);
+	a ^= c; a -= ROTL32(c, 11);
+	b ^= a; b -= ROTL32(a, 25);
+	c ^= b; c -= ROTL32(b, 16);
+	a ^= c; a -= ROTL32(c, 4);
+	b ^= a; b -= ROTL32(a, 14);
+	c ^= b; c -= ROTL32(b, 24);
+
+	return c;
+}
+
+/*
+ * Fold an int8 into the 32-bit value hashint8() hashes, without a branch:
+ * the high half is complemented for negative values.
+ */
+static inline uint32
+cdbhash_int8_key(int64 val)
+{
+	return (uint32) val ^ (uint32) (val >> 32) ^ (uint32) (val >> 63);
+}
 
 /*================================================================
  *
@@ -94,6 +135,7 @@ makeCdbHash(int numsegs, int natts, Oid *hashfuncs)
 
 	/* Load hash function info */
 	h->hashfuncs = (FmgrInfo *) palloc(natts * sizeof(FmgrInfo));
+	h->fastfuncs = (CdbHashFastFunc *) palloc(natts * sizeof(CdbHashFastFunc));
 	for (i = 0; i < natts; i++)
 	{
 		Oid			funcid = hashfuncs[i];
@@ -102,6 +144,7 @@ makeCdbHash(int numsegs, int natts, Oid *hashfuncs)
 			is_legacy_hash = true;
 
 		fmgr_info(funcid, &h->hashfuncs[i]);
+		h->fastfuncs[i] = cdbhash_fast_func(funcid);
 	}
 	h->natts = natts;
 	h->is_legacy_hash = is_legacy_hash;
@@ -160,6 +203,8 @@ void freeCdbHash(CdbHash *hash)
 	{
 		if (hash->hashfuncs)
 			pfree(hash->hashfuncs);
+		if (hash->fastfuncs)
+			pfree(hash->fastfuncs);
 		pfree(hash);
 	}
 }
@@ -193,52 +238,16 @@ cdbhash(CdbHash *h, int attno, Datum datum, bool isnull)
 	if (!h->is_legacy_hash)
 	{
 		/* rotate hashkey left 1 bit at each step */
-		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+		hashkey = ROTL32(hashkey, 1);
 
 		if (!isnull)
-		{
-			LOCAL_FCINFO(fcinfo, 1);
-			uint32		hkey;
-
-			InitFunctionCallInfoData(*fcinfo, &h->hashfuncs[attno - 1], 1,
-									 DEFAULT_COLLATION_OID, /* have to specify collation for attribute of text or bpchar */
-									 NULL, NULL);
-
-			fcinfo->args[0].value = datum;
-			fcinfo->args[0].isnull = false;
-
-			hkey = DatumGetUInt32(FunctionCallInvoke(fcinfo));
-
-			/* Check for null result, since caller is clearly not expecting one */
-			if (fcinfo->isnull)
-				elog(ERROR, "function %u returned NULL", fcinfo->flinfo->fn_oid);
-
-			hashkey ^= hkey;
-		}
+			hashkey ^= cdbhashdatum(h, attno, datum);
 	}
 	else
 	{
 		magic_hash_stash = hashkey;
 		if (!isnull)
-		{
-			LOCAL_FCINFO(fcinfo, 1);
-			uint32		hkey;
-
-			InitFunctionCallInfoData(*fcinfo, &h->hashfuncs[attno - 1], 1,
-									 DEFAULT_COLLATION_OID, /* legacy hash functions don't care about collations */
-									 NULL, NULL);
-
-			fcinfo->args[0].value = datum;
-			fcinfo->args[0].isnull = false;
-
-			hkey = DatumGetUInt32(FunctionCallInvoke(fcinfo));
-
-			/* Check for null result, since caller is clearly not expecting one */
-			if (fcinfo->isnull)
-				elog(ERROR, "function %u returned NULL", fcinfo->flinfo->fn_oid);
-
-			hashkey = hkey;
-		}
+			hashkey = cdbhashdatum(h, attno, datum);
 		else
 			hashkey = cdblegacyhash_null();
 		magic_hash_stash = FNV1_32_INIT;
@@ -246,6 +255,49 @@ cdbhash(CdbHash *h, int attno, Datum datum, bool isnull)
 	h->hash = hashkey;
 }
 
+/*
+ * Hash a single non-NULL attribute value with its hash function.
+ */
+static inline uint32
+cdbhashdatum(CdbHash *h, int attno, Datum datum)
+{
+	LOCAL_FCINFO(fcinfo, 1);
+	uint32		hkey;
+
+	switch (h->fastfuncs[attno - 1])
+	{
+		case CDBHASH_FAST_INT2:
+			return cdbhash_uint32((int32) DatumGetInt16(datum));
+		case CDBHASH_FAST_INT4:
+			return cdbhash_uint32(DatumGetInt32(datum));
+		case CDBHASH_FAST_INT8:
+			return cdbhash_uint32(cdbhash_int8_key(DatumGetInt64(datum)));
+		case CDBHASH_FAST_UUID:
+			return hash_bytes(DatumGetUUIDP(datum)->data, UUID_LEN);
+		case CDBHASH_FAST_NONE:
+			break;
+	}
+
+	/*
+	 * Have to specify collation for attribute of text or bpchar, legacy hash
+	 * functions don't care about collations.
+	 */
+	InitFunctionCallInfoData(*fcinfo, &h->hashfuncs[attno - 1], 1,
+							 DEFAULT_COLLATION_OID,
+							 NULL, NULL);
+
+	fcinfo->args[0].value = datum;
+	fcinfo->args[0].isnull = false;
+
+	hkey = DatumGetUInt32(FunctionCallInvoke(fcinfo));
+
+	/* Check for null result, since caller is clearly not expecting one */
+	if (fcinfo->isnull)
+		elog(ERROR, "function %u returned NULL", fcinfo->flinfo->fn_oid);
+
+	return hkey;
+}
+
 /*
  * Reduce the hash to a segment number.
  */
@@ -284,6 +336,114 @@ cdbhashreduce(CdbHash *h)
 	return result;
 }
 
+/*
+ * Initialize the hashes of a batch of n tuples, see cdbhashinit().
+ */
+void
+cdbhashbatchinit(CdbHash *h, uint32 *hashes, int n)
+{
+	uint32		init = h->is_legacy_hash ? FNV1_32_INIT : 0;
+	int			i;
+
+	for (i = 0; i < n; i++)
+		hashes[i] = init;
+}
+
+/*
+ * Add an attribute of a batch of n tuples to their hashes, see cdbhash().
+ *
+ * The types with an inline hash function are hashed in tight loops over the
+ * whole batch, the hash of a NULL is computed too and masked out, so that
+ * the loops have no branches.
+ */
+void
+cdbhashbatch(CdbHash *h, int attno, const Datum *datums, const bool *isnulls,
+			 uint32 *hashes, int n)
+{
+	int			i;
+
+	/* the legacy hash functions pass state around, take the slow path */
+	if (h->is_legacy_hash)
+	{
+		for (i = 0; i < n; i++)
+		{
+			h->hash = hashes[i];
+			cdbhash(h, attno, datums[i], isnulls ? isnulls[i] : false);
+			hashes[i] = h->hash;
+		}
+		return;
+	}
+
+#define CDBHASH_BATCH_LOOP(hkeyexpr) \
+	do { \
+		for (i = 0; i < n; i++) \
+		{ \
+			uint32		hkey = (hkeyexpr); \
+			uint32		mask = (isnulls && isnulls[i]) ? 0 : ~(uint32) 0; \
+\
+			hashes[i] = ROTL32(hashes[i], 1) ^ (hkey & mask); \
+		} \
+	} while (0)
+
+	switch (h->fastfuncs[attno - 1])
+	{
+		case CDBHASH_FAST_INT2:
+			CDBHASH_BATCH_LOOP(cdbhash_uint32((int32) DatumGetInt16(datums[i])));
+			break;
+
+		case CDBHASH_FAST_INT4:
+			CDBHASH_BATCH_LOOP(cdbhash_uint32(DatumGetInt32(datums[i])));
+			break;
+
+		case CDBHASH_FAST_INT8:
+			CDBHASH_BATCH_LOOP(cdbhash_uint32(cdbhash_int8_key(DatumGetInt64(datums[i]))));
+			break;
+
+		default:
+			/* by reference or through fmgr, a NULL must not be looked at */
+			for (i = 0; i < n; i++)
+			{
+				hashes[i] = ROTL32(hashes[i], 1);
+				if (!isnulls || !isnulls[i])
+					hashes[i] ^= cdbhashdatum(h, attno, datums[i]);
+			}
+			break;
+	}
+
+#undef CDBHASH_BATCH_LOOP
+}
+
+/*
+ * Reduce the hashes of a batch of n tuples to segment numbers, see
+ * cdbhashreduce().
+ */
+void
+cdbhashreducebatch(CdbHash *h, const uint32 *hashes, unsigned int *segs, int n)
+{
+	uint32		numsegs = h->numsegs;
+	int			i;
+
+	Assert(h->natts > 0);
+
+	switch (h->reducealg)
+	{
+		case REDUCE_BITMASK:
+			for (i = 0; i < n; i++)
+				segs[i] = FASTMOD(hashes[i], numsegs);
+			break;
+
+		case REDUCE_LAZYMOD:
+			for (i = 0; i < n; i++)
+				segs[i] = hashes[i] % numsegs;
+			break;
+
+		case REDUCE_JUMP_HASH:
+			for (i = 0; i < n; i++)
+				segs[i] = jump_consistent_hash(hashes[i], h->numsegs);
+			break;
+	}
+}
+
 /*
  * Return a random segment number, for randomly distributed policy.
  */
@@ -511,6 +671,28 @@ cdb_eqop_in_hash_opfamily(Oid opfamily, Oid typeoid)
  *================================================================
  */
 
+/*
+ * Which of the hash functions computed inline is the function, if any?
+ */
+static CdbHashFastFunc
+cdbhash_fast_func(Oid funcid)
+{
+	switch (funcid)
+	{
+		case F_HASHINT2:
+			return CDBHASH_FAST_INT2;
+		case F_HASHINT4:
+			return CDBHASH_FAST_INT4;
+		case F_HASHINT8:
+		case F_TIMESTAMP_HASH:
+			return CDBHASH_FAST_INT8;
+		case F_UUID_HASH:
+			return CDBHASH_FAST_UUID;
+		default:
+			return CDBHASH_FAST_NONE;
+	}
+}
+
 /*
  * returns 1 is the input int is a power of 2 and 0 otherwise.
  */
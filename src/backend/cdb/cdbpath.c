@@ -19,6 +19,7 @@
 #include "catalog/pg_amop.h"
 #include "catalog/pg_opclass.h"
 #include "catalog/pg_operator.h"
+#include "catalog/pg_statistic.h"
 #include "catalog/pg_trigger.h"
 #include "commands/trigger.h"
 #include "nodes/makefuncs.h"	/* makeFuncExpr() */
@@ -36,6 +37,7 @@
 #include "utils/catcache.h"
 #include "utils/guc.h"
 #include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
 #include "utils/syscache.h"
 
 #include "cdb/cdbdef.h"			/* CdbSwap() */
@@ -71,6 +73,9 @@ static bool allow_append_initplan_for_function_scan = true;
 
 static bool try_redistribute(PlannerInfo *root, CdbpathMfjRel *g,
 							 CdbpathMfjRel *o, List *redistribution_clauses);
+static bool cdbpath_hybrid_redistribute(PlannerInfo *root, JoinType jointype,
+										CdbpathMfjRel *outer,
+										CdbpathMfjRel *inner);
 
 static SplitUpdatePath *make_splitupdate_path(PlannerInfo *root, Path *subpath, Index rti);
 
@@ -1274,6 +1279,162 @@ add_rowid_to_path(PlannerInfo *root, Path *path, int *rowidexpr_id)
 													  NIL, true);
 }
 
+/*
+ * cdbpath_hot_key_hashes
+ *
+ * Returns the cdbhash values of the hot keys of a single column
+ * redistribution of 'path' to 'locus', as an integer List, or NIL if the
+ * key is not skewed or there are no statistics to tell.
+ *
+ * A key is hot if, by the MCV statistics of the key column, its rows alone
+ * are at least gp_hybrid_redistribute_skew_ratio times the rows that each
+ * segment would get with an even distribution.
+ */
+static List *
+cdbpath_hot_key_hashes(PlannerInfo *root, Path *path, CdbPathLocus locus)
+{
+	List	   *exprs;
+	List	   *opfamilies;
+	Node	   *expr;
+	Oid			hashfunc;
+	int			numsegments = CdbPathLocus_NumSegments(locus);
+	VariableStatData vardata;
+	AttStatsSlot sslot;
+	List	   *result = NIL;
+
+	if (list_length(locus.distkey) != 1)
+		return NIL;
+
+	cdbpathlocus_get_distkey_exprs(locus,
+								   path->parent->relids,
+								   path->pathtarget->exprs,
+								   &exprs, &opfamilies);
+	if (exprs == NIL)
+		return NIL;
+	expr = (Node *) linitial(exprs);
+
+	examine_variable(root, expr, 0, &vardata);
+
+	/*
+	 * The values must be hashed the way the Motion hashes the key, so insist
+	 * that they are of the same type.
+	 */
+	if (HeapTupleIsValid(vardata.statsTuple) &&
+		vardata.atttype == exprType(expr) &&
+		get_attstatsslot(&sslot, vardata.statsTuple,
+						 STATISTIC_KIND_MCV, InvalidOid,
+						 ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS))
+	{
+		CdbHash    *h;
+
+		hashfunc = cdb_hashproc_in_opfamily(linitial_oid(opfamilies),
+											exprType(expr));
+		h = makeCdbHash(numsegments, 1, &hashfunc);
+
+		/* The MCVs are in decreasing order of frequency */
+		for (int i = 0; i < sslot.nvalues; i++)
+		{
+			if (sslot.numbers[i] * numsegments < gp_hybrid_redistribute_skew_ratio)
+				break;
+
+			cdbhashinit(h);
+			cdbhash(h, 1, sslot.values[i], false);
+			result = list_append_unique_int(result, (int) h->hash);
+		}
+
+		freeCdbHash(h);
+		free_attstatsslot(&sslot);
+	}
+
+	ReleaseVariableStats(vardata);
+
+	return result;
+}
+
+/*
+ * cdbpath_hybrid_redistribute
+ *
+ * The outer rel is redistributed to meet the inner rel on the join key.  If
+ * the key is skewed, that sends all outer rows of a hot key to the same
+ * segment, which then does most of the join alone.  Instead, keep the outer
+ * rows of the hot keys on whichever segment they already are, and broadcast
+ * the inner rows of the hot keys to all segments.  Each outer row still
+ * meets all its matches exactly once.  The rows of the other keys are
+ * redistributed as before.
+ *
+ * Since the inner rows of the hot keys are duplicated, this is only done if
+ * the inner rel is not preserved by the join.  If the inner rel was not
+ * going to be moved, it is already distributed on the join key, and a Motion
+ * is added for it to broadcast its hot rows.
+ *
+ * Returns true if the paths in 'outer' and 'inner' were changed.
+ */
+static bool
+cdbpath_hybrid_redistribute(PlannerInfo *root, JoinType jointype,
+							CdbpathMfjRel *outer, CdbpathMfjRel *inner)
+{
+	CdbMotionPath *outer_motion;
+	CdbMotionPath *inner_motion;
+	List	   *hotkeys;
+
+	if (!gp_enable_hybrid_redistribute)
+		return false;
+
+	switch (jointype)
+	{
+		case JOIN_INNER:
+		case JOIN_LEFT:
+		case JOIN_SEMI:
+		case JOIN_ANTI:
+			break;
+		default:
+			return false;
+	}
+
+	if (!inner->ok_to_replicate || inner->require_existing_order)
+		return false;
+
+	if (!CdbPathLocus_IsHashed(outer->move_to) ||
+		!IsA(outer->path, CdbMotionPath))
+		return false;
+	outer_motion = (CdbMotionPath *) outer->path;
+
+	if (!CdbPathLocus_IsNull(inner->move_to))
+	{
+		if (!CdbPathLocus_IsHashed(inner->move_to) ||
+			!IsA(inner->path, CdbMotionPath))
+			return false;
+		inner_motion = (CdbMotionPath *) inner->path;
+	}
+	else if (CdbPathLocus_IsHashed(inner->locus))
+		inner_motion = NULL;
+	else
+		return false;
+
+	if (CdbPathLocus_NumSegments(outer->move_to) !=
+		CdbPathLocus_NumSegments(inner->path->locus))
+		return false;
+
+	hotkeys = cdbpath_hot_key_hashes(root, outer_motion->subpath,
+									 outer->move_to);
+	if (hotkeys == NIL)
+		return false;
+
+	if (!inner_motion)
+	{
+		inner_motion = make_motion_path(root, inner->path, inner->locus,
+										false, NULL);
+		inner->path = (Path *) inner_motion;
+	}
+
+	outer_motion->hotKeyPolicy = MOTION_HOTKEY_LOCAL;
+	outer_motion->hotKeyHashes = hotkeys;
+	inner_motion->hotKeyPolicy = MOTION_HOTKEY_BROADCAST;
+	inner_motion->hotKeyHashes = hotkeys;
+
+	return true;
+}
+
 /*
  * cdbpath_motion_for_join
  *
@@ -1307,6 +1468,7 @@ cdbpath_motion_for_join(PlannerInfo *root,
 	CdbpathMfjRel inner;
 	int			numsegments;
 	bool		join_quals_contain_outer_references;
+	bool		redistributed_on_join_key = false;
 	ListCell   *lc;
 
 	*p_rowidexpr_id = 0;
@@ -1980,6 +2142,7 @@ cdbpath_motion_for_join(PlannerInfo *root,
 		{
 			AssertEquivalent(CdbPathLocus_NumSegments(large_rel->locus),
 							 CdbPathLocus_NumSegments(small_rel->move_to));
+			redistributed_on_join_key = true;
 		}
 
 		/*
@@ -2014,6 +2177,7 @@ cdbpath_motion_for_join(PlannerInfo *root,
 		{
 			AssertEquivalent(CdbPathLocus_NumSegments(small_rel->locus),
 							 CdbPathLocus_NumSegments(large_rel->move_to));
+			redistributed_on_join_key = true;
 		}
 
 		/* Replicate smaller rel if cheaper than redistributing both rels. */
@@ -2051,7 +2215,7 @@ cdbpath_motion_for_join(PlannerInfo *root,
 											 &large_rel->move_to,
 											 &small_rel->move_to))
 		{
-			/* ok */
+			redistributed_on_join_key = true;
 		}
 
 		/*
@@ -2119,6 +2283,24 @@ cdbpath_motion_for_join(PlannerInfo *root,
 			goto fail;
 	}
 
+	/*
+	 * If the outer rel is redistributed on a skewed join key, route the rows
+	 * of its hot keys differently.  The hot outer rows are then not where
+	 * the hash says, so the join is Strewn.
+	 */
+	if (redistributed_on_join_key &&
+		cdbpath_hybrid_redistribute(root, jointype, &outer, &inner))
+	{
+		CdbPathLocus locus;
+
+		*p_outer_path = outer.path;
+		*p_inner_path = inner.path;
+
+		CdbPathLocus_MakeStrewn(&locus,
+								CdbPathLocus_NumSegments(outer.path->locus));
+		return locus;
+	}
+
 	/*
 	 * Ok to join.  Give modified subpaths to caller.
 	 */
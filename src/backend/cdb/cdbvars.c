@@ -204,9 +204,13 @@ int			Gp_interconnect_timer_checking_period = 20;
 int			Gp_interconnect_default_rtt = 20;
 int			Gp_interconnect_min_rto = 20;
 int			Gp_interconnect_fc_method = INTERCONNECT_FC_METHOD_LOSS;
+int			Gp_interconnect_compression = INTERCONNECT_COMPRESSION_NONE;
 int			Gp_interconnect_transmit_timeout = 3600;
 int			Gp_interconnect_min_retries_before_timeout = 100;
 int			Gp_interconnect_debug_retry_interval = 10;
+int			Gp_interconnect_batch_size = 16;
+int			Gp_interconnect_tuple_batch_size = 0;
+int			gp_motion_hash_batch_size = 0;
 
 int			interconnect_setup_timeout = 7200;
 
@@ -221,6 +225,7 @@ bool		gp_interconnect_full_crc = false;	/* sanity check UDP data. */
 bool		gp_interconnect_log_stats = false;	/* emit stats at log-level */
 
 bool		gp_interconnect_cache_future_packets = true;
+int			gp_interconnect_local_shm = INTERCONNECT_LOCAL_SHM_OFF;
 
 int			Gp_postmaster_address_family_type = POSTMASTER_ADDRESS_FAMILY_TYPE_AUTO;
 
@@ -260,6 +265,8 @@ uint32		gp_interconnect_id = 0;
  */
 
 double		gp_motion_cost_per_row = 0;
+bool		gp_enable_hybrid_redistribute = false;
+double		gp_hybrid_redistribute_skew_ratio = 1.0;
 int			gp_segments_for_planner = 0;
 
 bool		gp_adjust_selectivity_for_outerjoins = true;
@@ -269,6 +276,7 @@ double		gp_selectivity_damping_factor = 1;
 bool		gp_selectivity_damping_sigsort = true;
 
 int			gp_hashjoin_tuples_per_bucket = 5;
+bool		gp_enable_runtime_filter = false;
 
 /* Analyzing aid */
 int			gp_motion_slice_noop = 0;
@@ -26,6 +26,7 @@
 #include "cdb/ml_ipc.h"
 #include "cdb/tupleremap.h"
 #include "cdb/tupser.h"
+#include "utils/faultinjector.h"
 #include "utils/memutils.h"
 #include "utils/typcache.h"
 
@@ -77,6 +78,8 @@ static void statChunksProcessed(MotionLayerState *mlStates, MotionNodeEntry *pMN
 static void statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry);
 static void statRecvTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry);
 static bool ShouldSendRecordCache(MotionConn *conn, SerTupInfo *pSerInfo);
+static SendReturnCode SendTupleBatch(MotionLayerState *mlStates, ChunkTransportState *transportStates,
+									 MotionNodeEntry *pMNEntry, int16 motNodeID, int16 targetRoute);
 static void UpdateSentRecordCache(MotionConn *conn);
 
 
@@ -100,15 +103,18 @@ reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleRem
 	/* We're done with the chunks now. */
 	clearTCList(NULL, &pCSEntry->chunk_list);
 
-	if (!tup)
-		return;
+	/* A batch of tuples has more to stow after the first one. */
+	while (tup)
+	{
+		tup = TRCheckAndRemap(remapper, pSerInfo->tupdesc, tup);
 
-	tup = TRCheckAndRemap(remapper, pSerInfo->tupdesc, tup);
+		htfifo_addtuple(pCSEntry->ready_tuples, tup);
 
-	htfifo_addtuple(pCSEntry->ready_tuples, tup);
+		/* Stats */
+		statNewTupleArrived(pMNEntry, pCSEntry);
 
-	/* Stats */
-	statNewTupleArrived(pMNEntry, pCSEntry);
+		tup = CvtBatchToTup(pSerInfo);
+	}
 }
 
 /*
@@ -274,6 +280,13 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 	pEntry->tuple_desc = CreateTupleDescCopy(tupDesc);
 	InitSerTupInfo(pEntry->tuple_desc, &pEntry->ser_tup_info);
 
+	/*
+	 * Tuples to a merge receiver are sent one by one, so that a batch never
+	 * holds back the next tuple the receiver needs to make progress.
+	 */
+	if (!preserveOrder && Gp_interconnect_tuple_batch_size > 0)
+		InitSerTupBatches(&pEntry->ser_tup_info, Gp_interconnect_tuple_batch_size);
+
 	if (!preserveOrder)
 	{
 		/* Create a tuple-store for the motion node's incoming tuples. */
@@ -460,6 +473,20 @@ SendTuple(MotionLayerState *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID);
 
+	if (pMNEntry->ser_tup_info.batch_size > 0)
+	{
+		bool		full;
+
+		oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+		full = AddTupleToBatch(slot, &pMNEntry->ser_tup_info, targetRoute);
+		MemoryContextSwitchTo(oldCtxt);
+
+		if (!full)
+			return SEND_COMPLETE;
+
+		return SendTupleBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute);
+	}
+
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "Serializing HeapTuple for sending.");
 #endif
@@ -475,6 +502,24 @@ SendTuple(MotionLayerState *mlStates,
 
 	sent = SerializeTuple(slot, &pMNEntry->ser_tup_info, &b, &tcList, targetRoute);
 
+	/*
+	 * The route is a loopback one through shared memory and the tuple does not
+	 * fit into what is left of the packet.  Start a new packet rather than
+	 * chunk the tuple and have the receiver put it together again.
+	 */
+	if (sent < 0)
+	{
+		if (!flushTransportDirectBuffer(transportStates, motNodeID, targetRoute, &b))
+		{
+			MemoryContextSwitchTo(oldCtxt);
+			pMNEntry->stopped = true;
+			return STOP_SENDING;
+		}
+
+		sent = SerializeTuple(slot, &pMNEntry->ser_tup_info, &b, &tcList, targetRoute);
+		Assert(sent >= 0);
+	}
+
 	MemoryContextSwitchTo(oldCtxt);
 	if (sent > 0)
 	{
@@ -521,6 +566,49 @@ SendTuple(MotionLayerState *mlStates,
 	return rc;
 }
 
+/*
+ * Send the tuples waiting in the batch of a route.
+ */
+static SendReturnCode
+SendTupleBatch(MotionLayerState *mlStates,
+			   ChunkTransportState *transportStates,
+			   MotionNodeEntry *pMNEntry,
+			   int16 motNodeID,
+			   int16 targetRoute)
+{
+	TupleChunkListData tcList;
+	MemoryContext oldCtxt;
+	SendReturnCode rc;
+	int			ntuples;
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+	ntuples = SerializeTupleBatch(&pMNEntry->ser_tup_info, targetRoute, &tcList);
+	MemoryContextSwitchTo(oldCtxt);
+
+	if (ntuples == 0)
+		return SEND_COMPLETE;
+
+	if (!SendTupleChunkToAMS(mlStates, transportStates, motNodeID, targetRoute, tcList.p_first))
+	{
+		pMNEntry->stopped = true;
+		rc = STOP_SENDING;
+	}
+	else
+	{
+		/* update stats, statSendTuple() counts the batch as one tuple */
+		statSendTuple(mlStates, pMNEntry, &tcList);
+		pMNEntry->stat_total_sends += ntuples - 1;
+
+		SIMPLE_FAULT_INJECTOR("motion_tuple_batch_sent");
+
+		rc = SEND_COMPLETE;
+	}
+
+	clearTCList(&pMNEntry->ser_tup_info.chunkCache, &tcList);
+
+	return rc;
+}
+
 /*
  * Sends a token to all peer Motion Nodes, indicating that this motion
  * node has no more tuples to send out.
@@ -539,6 +627,16 @@ SendEndOfStream(MotionLayerState *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID);
 
+	/* Send the tuples still waiting in batches ahead of the end-of-stream. */
+	if (pMNEntry->ser_tup_info.batch_size > 0)
+	{
+		int16		targetRoute;
+
+		while (!pMNEntry->stopped &&
+			   GetPendingBatchRoute(&pMNEntry->ser_tup_info, &targetRoute))
+			SendTupleBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute);
+	}
+
 	transportStates->SendEos(transportStates, motNodeID, s_eos_chunk_data);
 
 	/*
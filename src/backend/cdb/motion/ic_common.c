@@ -31,6 +31,13 @@
 #include <sys/time.h>
 #include <netinet/in.h>
 
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 /*
   #define AMS_VERBOSE_LOGGING
 */
@@ -47,6 +54,22 @@ typedef struct interconnect_handle_t
 	struct interconnect_handle_t *prev;
 } interconnect_handle_t;
 
+/*
+ * Compression of the packets of tuple chunks, see compressChunkPacket().
+ *
+ * Packets smaller than COMPRESS_MIN_PACKET_SIZE are always sent as they are,
+ * other ones only go compressed if that saves at least 1/COMPRESS_MIN_SAVING
+ * of their size.  After COMPRESS_MAX_MISSES packets in a row that did not,
+ * the next COMPRESS_SKIP_PACKETS packets of the connection are not tried.
+ */
+#define COMPRESS_MIN_PACKET_SIZE	512
+#define COMPRESS_MIN_SAVING			8
+#define COMPRESS_MAX_MISSES			4
+#define COMPRESS_SKIP_PACKETS		64
+
+/* both zlib and zstd favor speed at their lowest level */
+#define COMPRESS_LEVEL				1
+
 /*=========================================================================
  * GLOBAL STATE VARIABLES
  */
@@ -58,6 +81,15 @@ int			UDP_listenerFd;
 static interconnect_handle_t *open_interconnect_handles;
 static bool interconnect_resowner_callback_registered;
 
+/* scratch buffers of Gp_max_packet_size bytes for (de)compressing packets */
+static uint8 *compressBuffer;
+static uint8 *decompressBuffer;
+
+#ifdef USE_ZSTD
+static ZSTD_CCtx *compressCtx;
+static ZSTD_DCtx *decompressCtx;
+#endif
+
 /*=========================================================================
  * FUNCTIONS PROTOTYPES
  */
@@ -70,6 +102,10 @@ static void cleanup_interconnect_handle(interconnect_handle_t *h);
 static interconnect_handle_t *allocate_interconnect_handle(void);
 static void destroy_interconnect_handle(interconnect_handle_t *h);
 static interconnect_handle_t *find_interconnect_handle(ChunkTransportState *icContext);
+static int	compressChunkData(int method, const uint8 *src, int srcLen,
+							  uint8 *dst, int dstCapacity);
+static void decompressChunkPacket(MotionConn *conn, int hdrSize,
+								  uint8 **data, int *dataSize);
 
 static void
 logChunkParseDetails(MotionConn *conn, uint32 ic_instance_id)
@@ -96,6 +132,8 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 	TupleChunkListItem lastTcItem = NULL;
 	uint32		tcSize;
 	int			bytesProcessed = 0;
+	uint8	   *data;
+	int			dataSize;
 
 	if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP ||
 		Gp_interconnect_type == INTERCONNECT_TYPE_PROXY)
@@ -117,9 +155,20 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 		 conn->recvBytes, conn->msgSize, conn->pBuff, conn->msgPos);
 #endif
 
-	while (bytesProcessed != conn->msgSize)
+	/*
+	 * The chunks are parsed from the packet itself, or from its expanded copy
+	 * if the sender compressed it.
+	 */
+	data = conn->msgPos;
+	dataSize = conn->msgSize;
+
+	if (dataSize - bytesProcessed >= COMPRESSED_CHUNK_HEADER_SIZE &&
+		*(uint16 *) (data + bytesProcessed + 2) == TC_COMPRESSED)
+		decompressChunkPacket(conn, bytesProcessed, &data, &dataSize);
+
+	while (bytesProcessed != dataSize)
 	{
-		if (conn->msgSize - bytesProcessed < TUPLE_CHUNK_HEADER_SIZE)
+		if (dataSize - bytesProcessed < TUPLE_CHUNK_HEADER_SIZE)
 		{
 			logChunkParseDetails(conn, transportStates->sliceTable->ic_instance_id);
 
@@ -127,10 +176,10 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 					(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 					 errmsg("interconnect error parsing message: insufficient data received"),
 					 errdetail("conn->msgSize %d bytesProcessed %d < chunk-header %d",
-							   conn->msgSize, bytesProcessed, TUPLE_CHUNK_HEADER_SIZE)));
+							   dataSize, bytesProcessed, TUPLE_CHUNK_HEADER_SIZE)));
 		}
 
-		tcSize = TUPLE_CHUNK_HEADER_SIZE + (*(uint16 *) (conn->msgPos + bytesProcessed));
+		tcSize = TUPLE_CHUNK_HEADER_SIZE + (*(uint16 *) (data + bytesProcessed));
 
 		/* sanity check */
 		if (tcSize > Gp_max_packet_size)
@@ -157,7 +206,7 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 					 errdetail("tcSize %d > max %d header %d processed %d/%d from %p",
 							   tcSize, Gp_max_packet_size,
 							   TUPLE_CHUNK_HEADER_SIZE, bytesProcessed,
-							   conn->msgSize, conn->msgPos)));
+							   dataSize, data)));
 		}
 
 
@@ -168,7 +217,7 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 		if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP ||
 			Gp_interconnect_type == INTERCONNECT_TYPE_PROXY)
 		{
-			if (tcSize >= conn->msgSize)
+			if (tcSize >= dataSize)
 			{
 				/*
 				 * see MPP-720: it is possible that our message got messed up
@@ -182,10 +231,10 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("interconnect error parsing message"),
 						 errdetail("tcSize %d >= conn->msgSize %d",
-								   tcSize, conn->msgSize)));
+								   tcSize, dataSize)));
 			}
 		}
-		Assert(tcSize < conn->msgSize);
+		Assert(tcSize < dataSize);
 
 		/*
 		 * We store the data inplace, and handle any necessary copying later
@@ -195,7 +244,7 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 
 		tcItem->p_next = NULL;
 		tcItem->chunk_length = tcSize;
-		tcItem->inplace = (char *) (conn->msgPos + bytesProcessed);
+		tcItem->inplace = (char *) (data + bytesProcessed);
 
 		bytesProcessed += tcSize;
 
@@ -225,6 +274,264 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 	return firstTcItem;
 }
 
+/*
+ * compressChunkData
+ *		Compress srcLen bytes from src into dst with the given method.
+ *
+ * Returns the compressed length, or -1 if the result does not fit into
+ * dstCapacity bytes.
+ */
+static int
+compressChunkData(int method, const uint8 *src, int srcLen,
+				  uint8 *dst, int dstCapacity)
+{
+	switch (method)
+	{
+#ifdef HAVE_LIBZ
+		case INTERCONNECT_COMPRESSION_ZLIB:
+			{
+				uLongf		dstLen = dstCapacity;
+
+				if (compress2(dst, &dstLen, src, srcLen, COMPRESS_LEVEL) != Z_OK)
+					return -1;
+				return dstLen;
+			}
+#endif
+#ifdef USE_ZSTD
+		case INTERCONNECT_COMPRESSION_ZSTD:
+			{
+				size_t		dstLen;
+
+				if (compressCtx == NULL)
+				{
+					compressCtx = ZSTD_createCCtx();
+					if (compressCtx == NULL)
+						ereport(ERROR,
+								(errcode(ERRCODE_OUT_OF_MEMORY),
+								 errmsg("out of memory"),
+								 errdetail("Failed to create the interconnect compression context.")));
+				}
+
+				dstLen = ZSTD_compressCCtx(compressCtx, dst, dstCapacity,
+										   src, srcLen, COMPRESS_LEVEL);
+				if (ZSTD_isError(dstLen))
+					return -1;
+				return dstLen;
+			}
+#endif
+		default:
+			return -1;
+	}
+}
+
+/*
+ * decompressChunkPacket
+ *		Expand the TC_COMPRESSED chunk of the packet received on conn.
+ *
+ * The chunk follows the transport header of hdrSize bytes.  On return *data
+ * and *dataSize describe a copy of the packet holding the original chunks at
+ * the same offset.  The copy lives in a buffer of this backend that is reused
+ * for the next compressed packet, the motion layer copies the chunks out of
+ * it before that happens.
+ */
+static void
+decompressChunkPacket(MotionConn *conn, int hdrSize, uint8 **data, int *dataSize)
+{
+	uint8	   *chunk = *data + hdrSize;
+	uint16		chunkSize;
+	uint16		method;
+	uint16		rawLen;
+	int			len;
+
+	memcpy(&chunkSize, chunk, sizeof(uint16));
+	memcpy(&method, chunk + TUPLE_CHUNK_HEADER_SIZE, sizeof(uint16));
+	memcpy(&rawLen, chunk + TUPLE_CHUNK_HEADER_SIZE + 2, sizeof(uint16));
+
+	len = chunkSize - (COMPRESSED_CHUNK_HEADER_SIZE - TUPLE_CHUNK_HEADER_SIZE);
+	if (len < 0 || hdrSize + COMPRESSED_CHUNK_HEADER_SIZE + len != *dataSize ||
+		hdrSize + rawLen > Gp_max_packet_size)
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect error parsing compressed message"),
+				 errdetail("chunk size %d uncompressed size %d packet size %d",
+						   chunkSize, rawLen, *dataSize)));
+
+	if (decompressBuffer == NULL)
+		decompressBuffer = MemoryContextAlloc(TopMemoryContext, Gp_max_packet_size);
+
+	chunk += COMPRESSED_CHUNK_HEADER_SIZE;
+
+	switch (method)
+	{
+#ifdef HAVE_LIBZ
+		case INTERCONNECT_COMPRESSION_ZLIB:
+			{
+				uLongf		dstLen = rawLen;
+
+				if (uncompress(decompressBuffer + hdrSize, &dstLen, chunk, len) != Z_OK)
+					dstLen = 0;
+				len = dstLen;
+				break;
+			}
+#endif
+#ifdef USE_ZSTD
+		case INTERCONNECT_COMPRESSION_ZSTD:
+			{
+				size_t		dstLen;
+
+				if (decompressCtx == NULL)
+				{
+					decompressCtx = ZSTD_createDCtx();
+					if (decompressCtx == NULL)
+						ereport(ERROR,
+								(errcode(ERRCODE_OUT_OF_MEMORY),
+								 errmsg("out of memory"),
+								 errdetail("Failed to create the interconnect decompression context.")));
+				}
+
+				dstLen = ZSTD_decompressDCtx(decompressCtx, decompressBuffer + hdrSize,
+											 rawLen, chunk, len);
+				len = ZSTD_isError(dstLen) ? 0 : dstLen;
+				break;
+			}
+#endif
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+					 errmsg("interconnect error parsing compressed message"),
+					 errdetail("unsupported compression method %d", method)));
+	}
+
+	if (len != rawLen)
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect error decompressing message"),
+				 errdetail("method %d expected %d bytes, got %d",
+						   method, rawLen, len)));
+
+	*data = decompressBuffer;
+	*dataSize = hdrSize + rawLen;
+
+	conn->stat_compress_pkts++;
+	conn->stat_compress_raw_bytes += rawLen;
+	conn->stat_compress_wire_bytes += TUPLE_CHUNK_HEADER_SIZE + chunkSize;
+}
+
+/*
+ * compressChunkPacket
+ *		Compress the tuple chunks of the packet about to be sent on conn.
+ *
+ * The packet starts at conn->pBuff with a transport header of hdrSize bytes,
+ * the chunks fill it up to conn->msgSize.  If gp_interconnect_compression is
+ * set and the chunks compress well enough, they are replaced in place by a
+ * single TC_COMPRESSED chunk and conn->msgSize is updated, otherwise the
+ * packet is left alone.  Packets that keep failing to compress make the
+ * connection stop trying for a while, so incompressible data only pays for
+ * an occasional probe.
+ */
+void
+compressChunkPacket(MotionConn *conn, int hdrSize)
+{
+	uint8	   *chunk = conn->pBuff + hdrSize;
+	int			method = Gp_interconnect_compression;
+	int			rawLen = conn->msgSize - hdrSize;
+	int			maxLen;
+	int			len;
+	uint16		val;
+
+	if (method == INTERCONNECT_COMPRESSION_NONE || rawLen < COMPRESS_MIN_PACKET_SIZE)
+		return;
+
+	if (conn->compressSkip > 0)
+	{
+		conn->compressSkip--;
+		return;
+	}
+
+	if (compressBuffer == NULL)
+		compressBuffer = MemoryContextAlloc(TopMemoryContext, Gp_max_packet_size);
+
+	maxLen = rawLen - rawLen / COMPRESS_MIN_SAVING - COMPRESSED_CHUNK_HEADER_SIZE;
+	len = compressChunkData(method, chunk, rawLen, compressBuffer, maxLen);
+	if (len < 0)
+	{
+		if (++conn->compressMisses >= COMPRESS_MAX_MISSES)
+		{
+			conn->compressMisses = 0;
+			conn->compressSkip = COMPRESS_SKIP_PACKETS;
+		}
+		return;
+	}
+	conn->compressMisses = 0;
+
+	SetChunkDataSize(chunk, COMPRESSED_CHUNK_HEADER_SIZE - TUPLE_CHUNK_HEADER_SIZE + len);
+	SetChunkType(chunk, TC_COMPRESSED);
+	val = method;
+	memcpy(chunk + TUPLE_CHUNK_HEADER_SIZE, &val, sizeof(uint16));
+	val = rawLen;
+	memcpy(chunk + TUPLE_CHUNK_HEADER_SIZE + 2, &val, sizeof(uint16));
+	memcpy(chunk + COMPRESSED_CHUNK_HEADER_SIZE, compressBuffer, len);
+
+	conn->msgSize = hdrSize + COMPRESSED_CHUNK_HEADER_SIZE + len;
+}
+
+/* See ml_ipc.h */
+bool
+GetMotionTransportStats(ChunkTransportState *transportStates, int16 motNodeID,
+						MotionTransportStats *stats)
+{
+	ChunkTransportStateEntry *pEntry;
+	ExecSlice  *recvSlice;
+
+	if (transportStates == NULL || motNodeID <= 0 ||
+		motNodeID > transportStates->size)
+		return false;
+
+	pEntry = &transportStates->states[motNodeID - 1];
+	if (!pEntry->valid || pEntry->conns == NULL)
+		return false;
+
+	/* only the receiver keeps these */
+	recvSlice = pEntry->recvSlice;
+	if (recvSlice == NULL || recvSlice->sliceIndex != transportStates->sliceId)
+		return false;
+
+	memset(stats, 0, sizeof(MotionTransportStats));
+	stats->worstContentId = -2;
+
+	for (int i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *conn = &pEntry->conns[i];
+		uint64		anomalies;
+
+		if (conn->cdbProc == NULL)
+			continue;
+
+		stats->nconns++;
+		stats->packets += conn->stat_count_pkts;
+		stats->disordered += conn->stat_count_disordered;
+		stats->duplicated += conn->stat_count_duplicated;
+		stats->dropped += conn->stat_count_dropped;
+		stats->totalQueueSize += conn->stat_total_queue_size;
+		stats->queueSamples += conn->stat_count_queue_samples;
+		stats->maxQueueSize = Max(stats->maxQueueSize, conn->stat_max_queue_size);
+
+		anomalies = conn->stat_count_disordered + conn->stat_count_duplicated +
+			conn->stat_count_dropped;
+		if (anomalies > stats->worstAnomalies)
+		{
+			stats->worstAnomalies = anomalies;
+			stats->worstContentId = conn->cdbProc->contentid;
+		}
+
+		stats->compressPkts += conn->stat_compress_pkts;
+		stats->compressRawBytes += conn->stat_compress_raw_bytes;
+		stats->compressWireBytes += conn->stat_compress_wire_bytes;
+	}
+
+	return true;
+}
+
 /*=========================================================================
  * VISIBLE FUNCTIONS
  */
@@ -399,6 +706,9 @@ getTransportDirectBuffer(ChunkTransportState *transportStates,
 
 		b->pri = conn->pBuff + conn->msgSize;
 		b->prilen = Gp_max_packet_size - conn->msgSize;
+		b->flushlen = 0;
+		if (conn->shmRing != NULL && conn->tupleCount > 0)
+			b->flushlen = Gp_max_packet_size - sizeof(struct icpkthdr);
 
 		/* got buffer. */
 		return;
@@ -409,6 +719,7 @@ getTransportDirectBuffer(ChunkTransportState *transportStates,
 
 	b->pri = NULL;
 	b->prilen = 0;
+	b->flushlen = 0;
 
 	return;
 }
@@ -456,6 +767,41 @@ putTransportDirectBuffer(ChunkTransportState *transportStates,
 	return;
 }
 
+/* See ml_ipc.h */
+bool
+flushTransportDirectBuffer(ChunkTransportState *transportStates,
+						   int16 motNodeID,
+						   int16 targetRoute,
+						   struct directTransportBuffer *b)
+{
+	ChunkTransportStateEntry *pEntry = NULL;
+	MotionConn *conn;
+	int			i;
+
+	Assert(b->flushlen > 0);
+	Assert(Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC);
+
+	getChunkTransportState(transportStates, motNodeID, &pEntry);
+	conn = pEntry->conns + targetRoute;
+
+	if (!flushShmConnUDPIFC(transportStates, pEntry, conn))
+	{
+		/* this receiver stopped, are there any others left? */
+		for (i = 0; i < pEntry->numConns; i++)
+		{
+			if (pEntry->conns[i].stillActive)
+				break;
+		}
+
+		if (i == pEntry->numConns)
+			return false;
+	}
+
+	/* no buffer if the connection stopped, the tuple is thrown away then */
+	getTransportDirectBuffer(transportStates, motNodeID, targetRoute, b);
+	return true;
+}
+
 /*
  * DeregisterReadInterest is called on receiving nodes when they
  * believe that they're done with the receiver
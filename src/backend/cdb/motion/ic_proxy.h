@@ -28,6 +28,10 @@
 #define IC_PROXY_TRESHOLD_UNACK_PACKET_RESUME 30
 /* send a ack message after a batch of packets*/
 #define IC_PROXY_ACK_INTERVAL 10
+/* write the packets to a peer once this many are coalesced */
+#define IC_PROXY_COALESCE_MAX_PACKETS 64
+/* or once they add up to this many bytes */
+#define IC_PROXY_COALESCE_MAX_BYTES (256 * 1024)
 
 #define ic_proxy_alloc(size) palloc(size)
 #define ic_proxy_free(ptr) pfree(ptr)
@@ -37,6 +37,27 @@ ICProxyMain(Datum main_arg)
 	proc_exit(ic_proxy_server_main());
 }
 
+static void
+ic_proxy_peer_stats_init(ICProxyPeerStats *stats)
+{
+	pg_atomic_init_u32(&stats->dbid, 0);
+	stats->content = IC_PROXY_INVALID_CONTENT;
+
+	pg_atomic_init_u64(&stats->queued_packets, 0);
+	pg_atomic_init_u64(&stats->queued_bytes, 0);
+	pg_atomic_init_u64(&stats->send_rate, 0);
+	pg_atomic_init_u64(&stats->recv_rate, 0);
+
+	pg_atomic_init_u64(&stats->packets_sent, 0);
+	pg_atomic_init_u64(&stats->bytes_sent, 0);
+	pg_atomic_init_u64(&stats->writes, 0);
+	pg_atomic_init_u64(&stats->packets_received, 0);
+	pg_atomic_init_u64(&stats->bytes_received, 0);
+
+	stats->last_bytes_sent = 0;
+	stats->last_bytes_received = 0;
+}
+
 /*
  * the size of ICProxy SHM structure
  */
@@ -45,11 +66,14 @@ ICProxyShmemSize(void)
 {
 	Size		size = 0;
 	size = add_size(size, sizeof(*ic_proxy_peer_listener_failed));
+	size = add_size(size, mul_size(IC_PROXY_MAX_PEER_STATS,
+								   sizeof(ICProxyPeerStats)));
 	return size;
 }
 
 /*
- * initialize ICProxy's SHM structure: only one flag variable
+ * initialize ICProxy's SHM structure: the listener failure flag and the peer
+ * statistics
  */
 void
 ICProxyShmemInit(void)
@@ -60,4 +84,14 @@ ICProxyShmemInit(void)
 													&found);
 	if (!found)
 		pg_atomic_init_u32(ic_proxy_peer_listener_failed, 0);
+
+	ic_proxy_peer_stats = ShmemInitStruct("IC_PROXY Peer Statistics",
+										  mul_size(IC_PROXY_MAX_PEER_STATS,
+												   sizeof(ICProxyPeerStats)),
+										  &found);
+	if (!found)
+	{
+		for (int i = 0; i < IC_PROXY_MAX_PEER_STATS; i++)
+			ic_proxy_peer_stats_init(&ic_proxy_peer_stats[i]);
+	}
 }
\ No newline at end of file
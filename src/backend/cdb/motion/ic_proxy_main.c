@@ -472,7 +472,8 @@ ic_proxy_server_drop_legacy_peers(uv_loop_t *loop)
  * Timer handler.
  *
  * This is used to maintain the proxy-proxy network, as well as the client and
- * peer listeners.
+ * peer listeners.  It also samples the peer statistics, as it fires once per
+ * second.
  */
 static void
 ic_proxy_server_on_timer(uv_timer_t *timer)
@@ -480,6 +481,8 @@ ic_proxy_server_on_timer(uv_timer_t *timer)
 	ic_proxy_server_peer_listener_init(timer->loop);
 	ic_proxy_server_ensure_peers(timer->loop);
 	ic_proxy_server_client_listener_init(timer->loop);
+
+	ic_proxy_peer_table_sample_stats();
 }
 
 /*
@@ -548,7 +551,7 @@ ic_proxy_server_main(void)
 	ic_proxy_reload_addresses(&ic_proxy_server_loop);
 
 	ic_proxy_router_init(&ic_proxy_server_loop);
-	ic_proxy_peer_table_init();
+	ic_proxy_peer_table_init(&ic_proxy_server_loop);
 	ic_proxy_client_table_init();
 
 	ic_proxy_peer_listening = false;
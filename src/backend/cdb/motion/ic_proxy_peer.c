@@ -34,6 +34,11 @@
  * the peer, they are routed to the target clients, or their placeholders,
  * immediately.
  *
+ * Outgoing packets to a ready peer are coalesced: they are queued until all
+ * the current I/O events are handled, then written with a single request.
+ * Most of the packets are small, so this saves a lot of system calls when
+ * many clients are sending to the same peer.
+ *
  *
  * Copyright (c) 2020-Present VMware, Inc. or its affiliates.
  *
@@ -57,6 +62,16 @@
  */
 static ICProxyPeer *ic_proxy_peers[65536];
 
+/*
+ * The peers with coalesced packets to write, and the libuv idle handle to
+ * write them.  An idle handle is used instead of a check one so that the loop
+ * does not block for I/O while there are packets to write.
+ */
+static List *ic_proxy_peer_flush_list;
+static uv_idle_t ic_proxy_peer_flush_idle;
+
+ICProxyPeerStats *ic_proxy_peer_stats;
+
 
 static void ic_proxy_peer_shutdown(ICProxyPeer *peer);
 static void ic_proxy_peer_handle_out_cache(ICProxyPeer *peer);
@@ -93,9 +108,16 @@ ic_proxy_peer_build_delay(ICProxyPeer *peer, ICProxyPkt *pkt,
  * Initialize the peer register table.
  */
 void
-ic_proxy_peer_table_init(void)
+ic_proxy_peer_table_init(uv_loop_t *loop)
 {
 	memset(ic_proxy_peers, 0, sizeof(ic_proxy_peers));
+
+	ic_proxy_peer_flush_list = NIL;
+	uv_idle_init(loop, &ic_proxy_peer_flush_idle);
+
+	/* the statistics of a previous proxy bgworker are stale */
+	for (int i = 0; i < IC_PROXY_MAX_PEER_STATS; i++)
+		pg_atomic_write_u32(&ic_proxy_peer_stats[i].dbid, 0);
 }
 
 void
@@ -106,6 +128,163 @@ ic_proxy_peer_table_uninit(void)
 	 * - no need to clear the peers table, we will do that in init();
 	 * - no need to free the peers, they should already freed themselves;
 	 */
+
+	uv_idle_stop(&ic_proxy_peer_flush_idle);
+	ic_proxy_peer_flush_list = ic_proxy_list_free(ic_proxy_peer_flush_list);
+}
+
+/*
+ * Bump a counter of the peer statistics.
+ *
+ * We are the only writer, so there is no need for an atomic add.
+ */
+static inline void
+ic_proxy_peer_stats_add(pg_atomic_uint64 *counter, uint64 value)
+{
+	pg_atomic_write_u64(counter, pg_atomic_read_u64(counter) + value);
+}
+
+/*
+ * Get the statistics slot of a peer, taking a free one if it has none yet.
+ *
+ * A slot is kept by dbid, so a placeholder, the real peer and a legacy one
+ * all share it.
+ */
+static ICProxyPeerStats *
+ic_proxy_peer_stats_lookup(int16 content, uint16 dbid)
+{
+	ICProxyPeerStats *freeslot = NULL;
+
+	for (int i = 0; i < IC_PROXY_MAX_PEER_STATS; i++)
+	{
+		ICProxyPeerStats *stats = &ic_proxy_peer_stats[i];
+		uint32		slotdbid = pg_atomic_read_u32(&stats->dbid);
+
+		if (slotdbid == dbid)
+			return stats;
+		if (slotdbid == 0 && !freeslot)
+			freeslot = stats;
+	}
+
+	if (!freeslot)
+		return NULL;
+
+	freeslot->content = content;
+	pg_atomic_write_u64(&freeslot->queued_packets, 0);
+	pg_atomic_write_u64(&freeslot->queued_bytes, 0);
+	pg_atomic_write_u64(&freeslot->send_rate, 0);
+	pg_atomic_write_u64(&freeslot->recv_rate, 0);
+	pg_atomic_write_u64(&freeslot->packets_sent, 0);
+	pg_atomic_write_u64(&freeslot->bytes_sent, 0);
+	pg_atomic_write_u64(&freeslot->writes, 0);
+	pg_atomic_write_u64(&freeslot->packets_received, 0);
+	pg_atomic_write_u64(&freeslot->bytes_received, 0);
+	freeslot->last_bytes_sent = 0;
+	freeslot->last_bytes_received = 0;
+
+	/* readers skip the slot until the dbid is set */
+	pg_write_barrier();
+	pg_atomic_write_u32(&freeslot->dbid, dbid);
+
+	return freeslot;
+}
+
+/*
+ * Sample the queue depths and the rates of all the peers.
+ *
+ * This is called once per second.
+ */
+void
+ic_proxy_peer_table_sample_stats(void)
+{
+	for (int i = 0; i < IC_PROXY_MAX_PEER_STATS; i++)
+	{
+		ICProxyPeerStats *stats = &ic_proxy_peer_stats[i];
+		uint32		dbid = pg_atomic_read_u32(&stats->dbid);
+		ICProxyPeer *peer;
+		uint64		bytes_sent;
+		uint64		bytes_received;
+
+		if (dbid == 0)
+			continue;
+
+		peer = ic_proxy_peers[dbid];
+		if (peer)
+		{
+			pg_atomic_write_u64(&stats->queued_packets,
+								list_length(peer->reqs) + list_length(peer->outq));
+			pg_atomic_write_u64(&stats->queued_bytes,
+								peer->tcp.write_queue_size);
+		}
+
+		bytes_sent = pg_atomic_read_u64(&stats->bytes_sent);
+		bytes_received = pg_atomic_read_u64(&stats->bytes_received);
+
+		pg_atomic_write_u64(&stats->send_rate,
+							bytes_sent - stats->last_bytes_sent);
+		pg_atomic_write_u64(&stats->recv_rate,
+							bytes_received - stats->last_bytes_received);
+
+		stats->last_bytes_sent = bytes_sent;
+		stats->last_bytes_received = bytes_received;
+	}
+}
+
+/*
+ * Write the coalesced packets of a peer.
+ */
+static void
+ic_proxy_peer_flush(ICProxyPeer *peer)
+{
+	List	   *delays = peer->outq;
+
+	if (delays == NIL)
+		return;
+
+	/* detach the packets first, the callbacks might route new ones */
+	peer->outq = NIL;
+
+	if (peer->stats)
+	{
+		ic_proxy_peer_stats_add(&peer->stats->packets_sent, list_length(delays));
+		ic_proxy_peer_stats_add(&peer->stats->bytes_sent, peer->outq_bytes);
+		ic_proxy_peer_stats_add(&peer->stats->writes, 1);
+	}
+	peer->outq_bytes = 0;
+
+	elogif(gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG, DEBUG5,
+		   "ic-proxy: %s: writing %d coalesced pkts",
+				 peer->name, list_length(delays));
+
+	ic_proxy_router_writev((uv_stream_t *) &peer->tcp, delays);
+}
+
+/*
+ * The flush idle is triggered, write the coalesced packets of all the peers.
+ */
+static void
+ic_proxy_peer_on_flush_idle(uv_idle_t *handle)
+{
+	List	   *peers;
+	ListCell   *cell;
+
+	/*
+	 * Stop the idle callback and detach the list before writing, peers that
+	 * get new packets during the process are flushed in the next round.
+	 */
+	uv_idle_stop(&ic_proxy_peer_flush_idle);
+
+	peers = ic_proxy_peer_flush_list;
+	ic_proxy_peer_flush_list = NIL;
+
+	foreach(cell, peers)
+	{
+		ICProxyPeer *peer = lfirst(cell);
+
+		ic_proxy_peer_flush(peer);
+	}
+
+	list_free(peers);
 }
 
 /*
@@ -244,6 +423,9 @@ ic_proxy_peer_register(ICProxyPeer *peer)
 
 	ic_proxy_peers[peer->dbid] = peer;
 
+	if (!peer->stats)
+		peer->stats = ic_proxy_peer_stats_lookup(peer->content, peer->dbid);
+
 	elogif(gp_log_interconnect >= GPVARS_VERBOSITY_VERBOSE, LOG,
 		   "ic-proxy: %s: registered", peer->name);
 }
@@ -309,6 +491,12 @@ ic_proxy_peer_on_data_pkt(void *opaque, const void *data, uint16 size)
 		return;
 	}
 
+	if (peer->stats)
+	{
+		ic_proxy_peer_stats_add(&peer->stats->packets_received, 1);
+		ic_proxy_peer_stats_add(&peer->stats->bytes_received, size);
+	}
+
 	ic_proxy_router_route(peer->tcp.loop, ic_proxy_pkt_dup(pkt), NULL, NULL);
 }
 
@@ -363,6 +551,9 @@ ic_proxy_peer_new(uv_loop_t *loop, int16 content, uint16 dbid)
 	peer->dbid = dbid;
 	peer->state = 0;
 	peer->reqs = NIL;
+	peer->outq = NIL;
+	peer->outq_bytes = 0;
+	peer->stats = NULL;
 
 	ic_proxy_ibuf_init_p2p(&peer->ibuf);
 
@@ -401,6 +592,19 @@ ic_proxy_peer_free(ICProxyPeer *peer)
 
 	list_free(peer->reqs);
 
+	foreach(cell, peer->outq)
+	{
+		ICProxyDelay *delay = lfirst(cell);
+
+		elog(WARNING, "ic-proxy: %s: unwritten outgoing %s, dropping it",
+					 peer->name, ic_proxy_pkt_to_str(delay->pkt));
+
+		ic_proxy_pkt_cache_free(delay->pkt);
+	}
+
+	ic_proxy_list_free_deep(peer->outq);
+	ic_proxy_peer_flush_list = list_delete_ptr(ic_proxy_peer_flush_list, peer);
+
 	ic_proxy_ibuf_uninit(&peer->ibuf);
 	ic_proxy_free(peer);
 
@@ -419,6 +623,7 @@ static void
 ic_proxy_peer_on_close(uv_handle_t *handle)
 {
 	ICProxyPeer *peer = CONTAINER_OF((void *) handle, ICProxyPeer, tcp);
+	ListCell   *cell;
 
 	elogif(gp_log_interconnect >= GPVARS_VERBOSITY_VERBOSE, LOG,
 		   "ic-proxy: %s: closed", peer->name);
@@ -429,6 +634,20 @@ ic_proxy_peer_on_close(uv_handle_t *handle)
 	/* it's unlikely that the ibuf is non-empty, but clear it for sure */
 	ic_proxy_ibuf_clear(&peer->ibuf);
 
+	/* packets routed during the shutdown can not be written any more */
+	foreach(cell, peer->outq)
+	{
+		ICProxyDelay *delay = lfirst(cell);
+
+		if (delay->callback)
+			delay->callback(delay->opaque, delay->pkt, UV_ECANCELED);
+
+		ic_proxy_pkt_cache_free(delay->pkt);
+	}
+
+	peer->outq = ic_proxy_list_free_deep(peer->outq);
+	peer->outq_bytes = 0;
+
 	ic_proxy_peer_unregister(peer);
 }
 
@@ -489,6 +708,9 @@ ic_proxy_peer_shutdown(ICProxyPeer *peer)
 
 	peer->state |= IC_PROXY_PEER_STATE_SHUTTING;
 
+	/* the coalesced packets must go out before the shutdown */
+	ic_proxy_peer_flush(peer);
+
 	/* disconnect all the clients */
 	ic_proxy_client_table_shutdown_by_dbid(peer->dbid);
 
@@ -907,7 +1129,27 @@ ic_proxy_peer_route_data(ICProxyPeer *peer, ICProxyPkt *pkt,
 		return;
 	}
 
-	ic_proxy_router_write((uv_stream_t *) &peer->tcp, pkt, 0, callback, opaque);
+	/*
+	 * Coalesce the packet with the others to the peer, they are written
+	 * together by the flush idle, or right now if there are enough of them.
+	 */
+	if (peer->outq == NIL)
+	{
+		if (ic_proxy_peer_flush_list == NIL)
+			uv_idle_start(&ic_proxy_peer_flush_idle,
+						  ic_proxy_peer_on_flush_idle);
+
+		if (!list_member_ptr(ic_proxy_peer_flush_list, peer))
+			ic_proxy_peer_flush_list = lappend(ic_proxy_peer_flush_list, peer);
+	}
+
+	peer->outq = lappend(peer->outq,
+						 ic_proxy_peer_build_delay(peer, pkt, callback, opaque));
+	peer->outq_bytes += pkt->len;
+
+	if (list_length(peer->outq) >= IC_PROXY_COALESCE_MAX_PACKETS ||
+		peer->outq_bytes >= IC_PROXY_COALESCE_MAX_BYTES)
+		ic_proxy_peer_flush(peer);
 }
 
 /*
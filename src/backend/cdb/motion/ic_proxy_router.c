@@ -22,6 +22,7 @@
 
 
 typedef struct ICProxyWriteReq ICProxyWriteReq;
+typedef struct ICProxyWriteVReq ICProxyWriteVReq;
 typedef struct ICProxyLoopback ICProxyLoopback;
 
 
@@ -40,6 +41,16 @@ struct ICProxyWriteReq
 	void	   *opaque;			/* the callback data */
 };
 
+/*
+ * A router write request of several packets, see ic_proxy_router_writev().
+ */
+struct ICProxyWriteVReq
+{
+	uv_write_t	req;			/* the libuv write request */
+
+	List	   *delays;			/* List<ICProxyDelay *>, the packets */
+};
+
 /*
  * The loopback packet queue.
  *
@@ -316,3 +327,91 @@ ic_proxy_router_write(uv_stream_t *stream, ICProxyPkt *pkt, int32 offset,
 
 	uv_write(&wreq->req, stream, &wbuf, 1, ic_proxy_router_on_write);
 }
+
+/*
+ * The packets are written.
+ */
+static void
+ic_proxy_router_on_writev(uv_write_t *req, int status)
+{
+	ICProxyWriteVReq *wreq = (ICProxyWriteVReq *) req;
+	ListCell   *cell;
+
+	foreach(cell, wreq->delays)
+	{
+		ICProxyDelay *delay = lfirst(cell);
+		ICProxyPkt *pkt = delay->pkt;
+
+		Assert(ic_proxy_pkt_is_valid(pkt));
+
+		if (status < 0)
+		{
+			elogif(gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG, DEBUG5,
+				   "ic-proxy: router: failed to send %s: %s",
+						 ic_proxy_pkt_to_str(pkt), uv_strerror(status));
+		}
+		else
+		{
+			elogif(gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG, DEBUG5,
+				   "ic-proxy: router: sent %s",
+						 ic_proxy_pkt_to_str(pkt));
+		}
+
+		if (delay->callback)
+			delay->callback(delay->opaque, pkt, status);
+
+		ic_proxy_pkt_cache_free(pkt);
+	}
+
+	ic_proxy_list_free_deep(wreq->delays);
+	ic_proxy_free(wreq);
+}
+
+/*
+ * Write several packets to a libuv stream with one write request.
+ *
+ * This is the vectored version of ic_proxy_router_write(), the packets are
+ * written one after the other from offset 0, so it is only for the peers.
+ * Coalescing small packets this way saves a system call, and a round in the
+ * mainloop, for each of them.
+ *
+ * - stream: the target stream, a peer;
+ * - delays: List<ICProxyDelay *>, the packets with their callbacks, the
+ *   ownership of the list, the delays and the packets is taken;
+ */
+void
+ic_proxy_router_writev(uv_stream_t *stream, List *delays)
+{
+	ICProxyWriteVReq *wreq;
+	uv_buf_t   *wbufs;
+	ListCell   *cell;
+	int			nbufs = 0;
+	int			ret;
+
+	Assert(delays != NIL);
+
+	wreq = ic_proxy_new(ICProxyWriteVReq);
+	wreq->delays = delays;
+
+	/* libuv keeps a copy of the buffer descriptors, not of the array */
+	wbufs = ic_proxy_alloc(sizeof(uv_buf_t) * list_length(delays));
+
+	foreach(cell, delays)
+	{
+		ICProxyDelay *delay = lfirst(cell);
+
+		elogif(gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG, DEBUG5,
+			   "ic-proxy: router: sending %s", ic_proxy_pkt_to_str(delay->pkt));
+
+		wbufs[nbufs].base = (char *) delay->pkt;
+		wbufs[nbufs].len = delay->pkt->len;
+		nbufs++;
+	}
+
+	ret = uv_write(&wreq->req, stream, wbufs, nbufs, ic_proxy_router_on_writev);
+	ic_proxy_free(wbufs);
+
+	/* the request is not queued, so libuv will not call back */
+	if (ret < 0)
+		ic_proxy_router_on_writev(&wreq->req, ret);
+}
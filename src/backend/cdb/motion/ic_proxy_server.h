@@ -16,6 +16,7 @@
 
 #include <uv.h>
 
+#include "cdb/ic_proxy_bgworker.h"
 #include "ic_proxy.h"
 #include "ic_proxy_iobuf.h"
 #include "ic_proxy_packet.h"
@@ -66,6 +67,13 @@ struct ICProxyPeer
 	List	   *reqs;			/* outgoing queue for data that can't be sent
 								 * immediately */
 
+	List	   *outq;			/* outgoing packets being coalesced, they are
+								 * written together at the end of the round */
+	int			outq_bytes;		/* total length of the outq packets */
+
+	ICProxyPeerStats *stats;	/* the statistics in SHM, or NULL if there is
+								 * no free slot */
+
 	ICProxyIBuf	ibuf;			/* ibuf detects the packet boundaries */
 
 	char		name[128];		/* name of the client, only for logging */
@@ -119,8 +127,9 @@ extern void ic_proxy_client_table_init(void);
 extern void ic_proxy_client_table_uninit(void);
 extern void ic_proxy_client_table_shutdown_by_dbid(uint16 dbid);
 
-extern void ic_proxy_peer_table_init(void);
+extern void ic_proxy_peer_table_init(uv_loop_t *loop);
 extern void ic_proxy_peer_table_uninit(void);
+extern void ic_proxy_peer_table_sample_stats(void);
 
 extern ICProxyPeer *ic_proxy_peer_new(uv_loop_t *loop,
 									  int16 content, uint16 dbid);
@@ -0,0 +1,512 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_shm.c
+ *	  Shared memory rings for the interconnect traffic between two
+ *	  processes on the same host.
+ *
+ * The primaries and mirrors of a host are started by different postmasters,
+ * so two interconnect peers on the same host do not share the main shared
+ * memory segment nor any DSM segment.  Instead the receiver of a connection
+ * creates a POSIX shared memory object of its own, named after the identity
+ * of the connection, and the sender maps it by that name when it flushes its
+ * first packet.  The sender then writes the packets straight into the slots
+ * of the ring and the receiver hands the slots to the motion layer without
+ * copying them.
+ *
+ * Each ring has exactly one producer and one consumer, so the head (advanced
+ * by the sender) and the tail (advanced by the receiver) are enough to
+ * synchronize them.  A sender blocked on a full ring sleeps on a futex of the
+ * tail.  A receiver blocked on empty rings sleeps on its latch, which the
+ * sender can not set directly; ic_shm_ring_publish() tells the caller when
+ * the receiver asked to be woken up, and the caller rings a doorbell on the
+ * receiver's interconnect socket.
+ *
+ * Copyright (c) 2024-Present VMware, Inc. or its affiliates.
+ *
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/file_perm.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "portability/mem.h"
+#include "storage/fd.h"
+
+#include "ic_shm.h"
+
+/*
+ * The ring relies on the atomics working across processes, which is not the
+ * case for the spinlock based emulation.
+ */
+#if defined(HAVE_SHM_OPEN) && !defined(PG_HAVE_ATOMIC_U32_SIMULATION)
+#define USE_IC_SHM
+#endif
+
+/* Bits of ICShmRing.state */
+#define IC_SHM_RING_STOPPED		(1)
+
+struct ICShmRing
+{
+	uint32		nslots;
+	uint32		slotSize;
+	Size		mapSize;
+	char		name[IC_SHM_RING_NAME_LEN];
+
+	pg_atomic_uint32 state;
+
+	/* written by the sender, keep them off the cache line of the tail */
+	char		pad1[PG_CACHE_LINE_SIZE];
+	pg_atomic_uint32 head;
+	pg_atomic_uint32 receiverWaiting;
+
+	/* written by the receiver */
+	char		pad2[PG_CACHE_LINE_SIZE];
+	pg_atomic_uint32 tail;
+	pg_atomic_uint32 senderWaiting;
+};
+
+#define IC_SHM_RING_HEADER_SIZE TYPEALIGN(PG_CACHE_LINE_SIZE, sizeof(ICShmRing))
+
+/*
+ * The head and the tail count the packets and wrap around at 2^32.  nslots is
+ * a power of two, so the masked sequence number keeps walking the slots in
+ * order across the wrap, which a modulo of any other size would not.
+ */
+#define IC_SHM_RING_SLOT(ring, seq) \
+	((uint8 *) (ring) + IC_SHM_RING_HEADER_SIZE + \
+	 (Size) ((seq) & ((ring)->nslots - 1)) * (ring)->slotSize)
+
+#ifdef USE_IC_SHM
+
+/*
+ * Sleep until *word is no longer expected, somebody wakes us up or
+ * timeout_ms passes, whichever comes first.
+ */
+static void
+ic_shm_futex_wait(pg_atomic_uint32 *word, uint32 expected, int timeout_ms)
+{
+#ifdef __linux__
+	struct timespec ts;
+
+	ts.tv_sec = timeout_ms / 1000;
+	ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+
+	/* not FUTEX_PRIVATE_FLAG, the waker is another process */
+	syscall(SYS_futex, &word->value, FUTEX_WAIT, expected, &ts, NULL, 0);
+#else
+	/* no futex, poll the word */
+	if (pg_atomic_read_u32(word) == expected)
+		pg_usleep(Min(timeout_ms, 1) * 1000L);
+#endif
+}
+
+static void
+ic_shm_futex_wake(pg_atomic_uint32 *word)
+{
+#ifdef __linux__
+	syscall(SYS_futex, &word->value, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+#endif   /* USE_IC_SHM */
+
+/*
+ * Compose the name of the ring of a connection.
+ *
+ * The pids are unique on a host and the interconnect instance id tells apart
+ * the queries of a session, so both ends of a connection come to the same
+ * name and no other connection ever uses it.
+ *
+ * The name starts with the dbid of the receiver, that is of the postmaster
+ * whose backend creates the ring, so that the postmaster can find the rings
+ * its backends left behind, see ic_shm_ring_cleanup().
+ *
+ * The name buffer must hold IC_SHM_RING_NAME_LEN bytes.
+ */
+void
+ic_shm_ring_name(char *name, int receiverDbid, int sessionId, uint32 icId,
+				 int motNodeId, int senderPid, int receiverPid)
+{
+	snprintf(name, IC_SHM_RING_NAME_LEN, IC_SHM_RING_PREFIX "%d.%d.%u.%d.%d.%d",
+			 receiverDbid, sessionId, icId, motNodeId, senderPid, receiverPid);
+}
+
+/*
+ * Remove the rings created by the backends of this postmaster.
+ *
+ * A ring is normally removed by its receiver when the connection ends, or by
+ * the sender as soon as it has attached to it.  A receiver killed before its
+ * sender attached leaves the ring behind though, so the postmaster removes
+ * them all at startup and after a crash of a backend, when none of its
+ * backends can be using one.
+ *
+ * POSIX shared memory objects can not be listed portably, this relies on
+ * them being files in /dev/shm, as they are on Linux.
+ */
+void
+ic_shm_ring_cleanup(int dbid)
+{
+#if defined(USE_IC_SHM) && defined(__linux__)
+	DIR		   *dir;
+	struct dirent *de;
+	char		prefix[IC_SHM_RING_NAME_LEN];
+	int			prefixlen;
+
+	/* names of shared memory objects start with a slash, file names do not */
+	prefixlen = snprintf(prefix, sizeof(prefix), IC_SHM_RING_PREFIX "%d.", dbid) - 1;
+
+	dir = AllocateDir("/dev/shm");
+	while ((de = ReadDirExtended(dir, "/dev/shm", LOG)) != NULL)
+	{
+		char		name[IC_SHM_RING_NAME_LEN];
+
+		if (strncmp(de->d_name, prefix + 1, prefixlen) != 0)
+			continue;
+
+		snprintf(name, sizeof(name), "/%s", de->d_name);
+		if (shm_unlink(name) != 0 && errno != ENOENT)
+			elog(LOG, "could not remove interconnect ring \"%s\": %m", name);
+		else
+			elog(DEBUG1, "removed stale interconnect ring \"%s\"", name);
+	}
+	if (dir)
+		FreeDir(dir);
+#endif
+}
+
+/*
+ * Create the ring of an incoming connection, called by the receiver.
+ *
+ * The ring gets at least nslots slots, rounded up to a power of two.
+ *
+ * Returns NULL if the ring can not be created, the connection then goes
+ * through the network as usual.
+ */
+ICShmRing *
+ic_shm_ring_create(const char *name, int nslots, int slotSize)
+{
+#ifdef USE_IC_SHM
+	ICShmRing  *ring;
+	Size		mapSize;
+	void	   *address;
+	int			fd;
+
+	Assert(nslots > 0 && nslots <= PG_INT32_MAX / 2);
+	nslots = 1 << (pg_leftmost_one_pos32((uint32) nslots * 2 - 1));
+	slotSize = MAXALIGN(slotSize);
+	mapSize = IC_SHM_RING_HEADER_SIZE + (Size) nslots * slotSize;
+
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, PG_FILE_MODE_OWNER);
+	if (fd < 0 && errno == EEXIST)
+	{
+		/*
+		 * Left behind by a killed backend that had the same pid, in case the
+		 * cleanup at postmaster restart could not remove it.
+		 */
+		shm_unlink(name);
+		fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, PG_FILE_MODE_OWNER);
+	}
+	if (fd < 0)
+	{
+		elog(DEBUG1, "could not create interconnect ring \"%s\": %m", name);
+		return NULL;
+	}
+
+	if (ftruncate(fd, mapSize) != 0)
+	{
+		elog(DEBUG1, "could not resize interconnect ring \"%s\" to %zu bytes: %m",
+			 name, mapSize);
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+
+#if defined(HAVE_POSIX_FALLOCATE) && defined(__linux__)
+
+	/*
+	 * Allocate the pages now, running out of space in /dev/shm later would
+	 * end up with a SIGBUS instead of an error.
+	 */
+	if (posix_fallocate(fd, 0, mapSize) != 0)
+	{
+		elog(DEBUG1, "could not allocate interconnect ring \"%s\"", name);
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+#endif
+
+	address = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+				   MAP_SHARED | MAP_HASSEMAPHORE | MAP_NOSYNC, fd, 0);
+	close(fd);
+	if (address == MAP_FAILED)
+	{
+		elog(DEBUG1, "could not map interconnect ring \"%s\": %m", name);
+		shm_unlink(name);
+		return NULL;
+	}
+
+	ring = (ICShmRing *) address;
+	ring->nslots = nslots;
+	ring->slotSize = slotSize;
+	ring->mapSize = mapSize;
+	strlcpy(ring->name, name, IC_SHM_RING_NAME_LEN);
+	pg_atomic_init_u32(&ring->state, 0);
+	pg_atomic_init_u32(&ring->head, 0);
+	pg_atomic_init_u32(&ring->receiverWaiting, 0);
+	pg_atomic_init_u32(&ring->tail, 0);
+	pg_atomic_init_u32(&ring->senderWaiting, 0);
+
+	return ring;
+#else
+	return NULL;
+#endif
+}
+
+/*
+ * Attach to the ring of an outgoing connection, called by the sender.
+ *
+ * Returns NULL if the receiver did not create a ring for the connection, or
+ * its slots can not hold packets of slotSize bytes.
+ */
+ICShmRing *
+ic_shm_ring_attach(const char *name, int slotSize)
+{
+#ifdef USE_IC_SHM
+	ICShmRing  *ring;
+	struct stat st;
+	void	   *address;
+	int			fd;
+
+	fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st) != 0 || st.st_size < IC_SHM_RING_HEADER_SIZE)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	address = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+				   MAP_SHARED | MAP_HASSEMAPHORE | MAP_NOSYNC, fd, 0);
+	close(fd);
+	if (address == MAP_FAILED)
+		return NULL;
+
+	ring = (ICShmRing *) address;
+	if (ring->mapSize != st.st_size || ring->slotSize < slotSize ||
+		ic_shm_ring_stopped(ring))
+	{
+		munmap(address, st.st_size);
+		return NULL;
+	}
+
+	/*
+	 * Both ends have the ring mapped now, and nobody else is going to look
+	 * for it.  Drop the name so that it does not outlive the connection even
+	 * if both of them crash.
+	 */
+	shm_unlink(name);
+
+	return ring;
+#else
+	return NULL;
+#endif
+}
+
+/*
+ * Unmap the ring.  The receiver also tells a sender which is still sending
+ * to stop, and removes the name of a ring the sender never attached to.
+ */
+void
+ic_shm_ring_detach(ICShmRing *ring, bool isReceiver)
+{
+#ifdef USE_IC_SHM
+	char		name[IC_SHM_RING_NAME_LEN];
+
+	if (isReceiver)
+	{
+		strlcpy(name, ring->name, IC_SHM_RING_NAME_LEN);
+		ic_shm_ring_stop(ring);
+	}
+
+	munmap(ring, ring->mapSize);
+
+	if (isReceiver)
+		shm_unlink(name);
+#endif
+}
+
+/*
+ * Return the oldest packet of the ring, or NULL if it is empty.
+ *
+ * The packet stays in the ring until ic_shm_ring_release() is called.
+ */
+uint8 *
+ic_shm_ring_peek(ICShmRing *ring)
+{
+#ifdef USE_IC_SHM
+	uint32		tail = pg_atomic_read_u32(&ring->tail);
+
+	if (pg_atomic_read_u32(&ring->head) == tail)
+		return NULL;
+
+	/* read the packet only after seeing the head move past it */
+	pg_read_barrier();
+
+	return IC_SHM_RING_SLOT(ring, tail);
+#else
+	return NULL;
+#endif
+}
+
+/*
+ * Hand the oldest packet of the ring back to the sender.
+ */
+void
+ic_shm_ring_release(ICShmRing *ring)
+{
+#ifdef USE_IC_SHM
+	/* a full barrier, we are done with the slot before the sender sees it */
+	pg_atomic_fetch_add_u32(&ring->tail, 1);
+
+	if (pg_atomic_read_u32(&ring->senderWaiting) != 0 &&
+		pg_atomic_exchange_u32(&ring->senderWaiting, 0) != 0)
+		ic_shm_futex_wake(&ring->tail);
+#endif
+}
+
+/*
+ * Ask the sender for a doorbell once it publishes the next packet.
+ *
+ * Returns true, without asking, if the ring is not empty anymore; the
+ * receiver must not sleep then.
+ */
+bool
+ic_shm_ring_arm(ICShmRing *ring)
+{
+#ifdef USE_IC_SHM
+	pg_atomic_write_u32(&ring->receiverWaiting, 1);
+	pg_memory_barrier();
+
+	if (pg_atomic_read_u32(&ring->head) != pg_atomic_read_u32(&ring->tail))
+	{
+		pg_atomic_write_u32(&ring->receiverWaiting, 0);
+		return true;
+	}
+#endif
+	return false;
+}
+
+/*
+ * Tell the sender that no more packets are needed.
+ */
+void
+ic_shm_ring_stop(ICShmRing *ring)
+{
+#ifdef USE_IC_SHM
+	pg_atomic_fetch_or_u32(&ring->state, IC_SHM_RING_STOPPED);
+	ic_shm_futex_wake(&ring->tail);
+#endif
+}
+
+/*
+ * Does buf point into a slot of the ring?
+ */
+bool
+ic_shm_ring_owns(ICShmRing *ring, uint8 *buf)
+{
+	return buf >= (uint8 *) ring + IC_SHM_RING_HEADER_SIZE &&
+		buf < (uint8 *) ring + ring->mapSize;
+}
+
+/*
+ * Return the slot the next packet of the sender goes to, or NULL if the
+ * ring is full.
+ */
+uint8 *
+ic_shm_ring_reserve(ICShmRing *ring)
+{
+#ifdef USE_IC_SHM
+	uint32		head = pg_atomic_read_u32(&ring->head);
+
+	if (head - pg_atomic_read_u32(&ring->tail) >= ring->nslots)
+		return NULL;
+
+	/* do not write the slot before the receiver is done reading it */
+	pg_memory_barrier();
+
+	return IC_SHM_RING_SLOT(ring, head);
+#else
+	return NULL;
+#endif
+}
+
+/*
+ * Publish the packet written to the slot returned by ic_shm_ring_reserve().
+ *
+ * Returns true if the receiver is waiting for it, the caller must wake it up
+ * then.
+ */
+bool
+ic_shm_ring_publish(ICShmRing *ring)
+{
+#ifdef USE_IC_SHM
+	/* a full barrier, the packet is visible before the new head */
+	pg_atomic_fetch_add_u32(&ring->head, 1);
+
+	return pg_atomic_read_u32(&ring->receiverWaiting) != 0 &&
+		pg_atomic_exchange_u32(&ring->receiverWaiting, 0) != 0;
+#else
+	return false;
+#endif
+}
+
+/*
+ * Wait for the receiver to free a slot of a full ring, or to stop the
+ * connection, for at most timeout_ms.
+ */
+void
+ic_shm_ring_wait(ICShmRing *ring, int timeout_ms)
+{
+#ifdef USE_IC_SHM
+	uint32		head = pg_atomic_read_u32(&ring->head);
+	uint32		tail;
+
+	pg_atomic_write_u32(&ring->senderWaiting, 1);
+	pg_memory_barrier();
+
+	tail = pg_atomic_read_u32(&ring->tail);
+	if (head - tail < ring->nslots || ic_shm_ring_stopped(ring))
+		return;
+
+	ic_shm_futex_wait(&ring->tail, tail, timeout_ms);
+#endif
+}
+
+/*
+ * Has the receiver stopped the connection?
+ */
+bool
+ic_shm_ring_stopped(ICShmRing *ring)
+{
+#ifdef USE_IC_SHM
+	return (pg_atomic_read_u32(&ring->state) & IC_SHM_RING_STOPPED) != 0;
+#else
+	return true;
+#endif
+}
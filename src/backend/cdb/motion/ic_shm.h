@@ -0,0 +1,49 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_shm.h
+ *	  Shared memory rings for the interconnect traffic between two
+ *	  processes on the same host.
+ *
+ * Copyright (c) 2024-Present VMware, Inc. or its affiliates.
+ *
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef IC_SHM_H
+#define IC_SHM_H
+
+/*
+ * A single-producer single-consumer ring of packet sized slots in POSIX
+ * shared memory.  The fields are private to ic_shm.c.
+ */
+typedef struct ICShmRing ICShmRing;
+
+/* Max length of the name of a ring, including the terminating zero */
+#define IC_SHM_RING_NAME_LEN (64)
+
+/* All the names start with this, followed by the dbid of the receiver */
+#define IC_SHM_RING_PREFIX "/gpic."
+
+extern void ic_shm_ring_name(char *name, int receiverDbid, int sessionId, uint32 icId,
+							 int motNodeId, int senderPid, int receiverPid);
+extern void ic_shm_ring_cleanup(int dbid);
+
+/* receiver side */
+extern ICShmRing *ic_shm_ring_create(const char *name, int nslots, int slotSize);
+extern uint8 *ic_shm_ring_peek(ICShmRing *ring);
+extern void ic_shm_ring_release(ICShmRing *ring);
+extern bool ic_shm_ring_arm(ICShmRing *ring);
+extern void ic_shm_ring_stop(ICShmRing *ring);
+extern bool ic_shm_ring_owns(ICShmRing *ring, uint8 *buf);
+
+/* sender side */
+extern ICShmRing *ic_shm_ring_attach(const char *name, int slotSize);
+extern uint8 *ic_shm_ring_reserve(ICShmRing *ring);
+extern bool ic_shm_ring_publish(ICShmRing *ring);
+extern void ic_shm_ring_wait(ICShmRing *ring, int timeout_ms);
+extern bool ic_shm_ring_stopped(ICShmRing *ring);
+
+extern void ic_shm_ring_detach(ICShmRing *ring, bool isReceiver);
+
+#endif   /* IC_SHM_H */
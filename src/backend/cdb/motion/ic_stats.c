@@ -0,0 +1,127 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_stats.c
+ *	  History of the statistics of the recent interconnect connections.
+ *
+ * Each backend records the statistics of the connections of its motions in a
+ * ring in shared memory when it tears down the interconnect of the query, so
+ * that they can be looked at after the query is over, see
+ * gp_toolkit.gp_interconnect_connections.  The ring keeps the last
+ * IC_STATS_HISTORY_SIZE connections of the segment.
+ *
+ * A writer claims the next slot with an atomic increment, and bumps the
+ * change count of the slot before and after it fills it in, like the
+ * backend status array does.  A reader copies the slot, and retries if the
+ * change count was odd or changed while it did.
+ *
+ * Copyright (c) 2024-Present VMware, Inc. or its affiliates.
+ *
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "cdb/ic_stats.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/shmem.h"
+
+typedef struct ICStatsSlot
+{
+	int			changecount;
+	ICConnStats stats;
+} ICStatsSlot;
+
+typedef struct ICStatsHistory
+{
+	pg_atomic_uint64 next;
+	ICStatsSlot slots[IC_STATS_HISTORY_SIZE];
+} ICStatsHistory;
+
+static ICStatsHistory *ic_stats_history;
+
+Size
+ICStatsShmemSize(void)
+{
+	return sizeof(ICStatsHistory);
+}
+
+void
+ICStatsShmemInit(void)
+{
+	bool		found;
+
+	ic_stats_history = ShmemInitStruct("Interconnect Statistics History",
+									   ICStatsShmemSize(), &found);
+	if (!found)
+	{
+		MemSet(ic_stats_history, 0, ICStatsShmemSize());
+		pg_atomic_init_u64(&ic_stats_history->next, 0);
+	}
+}
+
+/*
+ * Add the statistics of a connection to the history, replacing the oldest
+ * one.
+ */
+void
+ic_stats_record(const ICConnStats *stats)
+{
+	ICStatsSlot *slot;
+	uint64		pos;
+
+	if (ic_stats_history == NULL)
+		return;
+
+	pos = pg_atomic_fetch_add_u64(&ic_stats_history->next, 1);
+	slot = &ic_stats_history->slots[pos % IC_STATS_HISTORY_SIZE];
+
+	slot->changecount++;
+	pg_write_barrier();
+
+	memcpy(&slot->stats, stats, sizeof(ICConnStats));
+
+	pg_write_barrier();
+	slot->changecount++;
+}
+
+/*
+ * Copy the statistics in the given slot of the history.
+ *
+ * Returns false if the slot was never used, or if it keeps being rewritten
+ * while we read it.
+ */
+bool
+ic_stats_read(int slot, ICConnStats *stats)
+{
+	ICStatsSlot *s;
+
+	Assert(slot >= 0 && slot < IC_STATS_HISTORY_SIZE);
+
+	if (ic_stats_history == NULL)
+		return false;
+
+	s = &ic_stats_history->slots[slot];
+
+	for (int retry = 0; retry < 10; retry++)
+	{
+		int			before;
+		int			after;
+
+		before = s->changecount;
+		pg_read_barrier();
+
+		memcpy(stats, &s->stats, sizeof(ICConnStats));
+
+		pg_read_barrier();
+		after = s->changecount;
+
+		if (before == after && (before & 1) == 0)
+			return before != 0;
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	return false;
+}
@@ -2805,6 +2805,8 @@ flushBuffer(ChunkTransportState *transportStates,
 	}
 #endif
 
+	compressChunkPacket(conn, PACKET_HEADER_SIZE);
+
 	/* first set header length */
 	*(uint32 *) conn->pBuff = conn->msgSize;
 
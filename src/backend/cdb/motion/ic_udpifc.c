@@ -49,6 +49,7 @@
 #include "utils/guc.h"
 #include "utils/memutils.h"
 #include "utils/faultinjector.h"
+#include "utils/timestamp.h"
 
 #include "cdb/tupchunklist.h"
 #include "cdb/ml_ipc.h"
@@ -57,6 +58,8 @@
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/cdbicudpfaultinjection.h"
 
+#include "ic_shm.h"
+
 #ifdef WIN32
 #define WIN32_LEAN_AND_MEAN
 #ifndef _WIN32_WINNT
@@ -138,6 +141,9 @@ int
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/* Upper bound of gp_interconnect_batch_size */
+#define UDPIFC_MAX_BATCH_SIZE (64)
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -151,6 +157,7 @@ int
 #define UDPIC_FLAGS_DISORDER    		(32)
 #define UDPIC_FLAGS_DUPLICATE   		(64)
 #define UDPIC_FLAGS_CAPACITY    		(128)
+#define UDPIC_FLAGS_SHM_DOORBELL		(256)
 
 #define UDPIC_MIN_BUF_SIZE (128 * 1024)
 
@@ -281,6 +288,13 @@ struct ReceiveControlInfo
 	 * concurrent cursor cases.
 	 */
 	DistributedTransactionId lastDXatId;
+
+	/*
+	 * The number of packets the background thread receives at once, that is
+	 * the number of receive buffers it holds for picking packets from the OS
+	 * buffer.  Fixed when the interconnect is initialized.
+	 */
+	int			batchSize;
 };
 
 /*
@@ -315,8 +329,8 @@ struct RxBufferPool
 /*
  * The buffer pool used for keeping data packets.
  *
- * maxCount is set to 1 to make sure there is always a buffer
- * for picking packets from OS buffer.
+ * maxCount is set to rx_control_info.batchSize (at least 1) to make sure
+ * there are always buffers for picking packets from OS buffer.
  */
 static RxBufferPool rx_buffer_pool = {1, 0, NULL};
 
@@ -612,6 +626,10 @@ typedef struct AckSendParam
  * duplicatedPktNum          - duplicate packet number.
  * recvAckNum                - the number of Acks received.
  * statusQueryMsgNum         - the number of status query messages sent.
+ * sndBatchNum               - the number of system calls sending sndPktNum packets.
+ * recvBatchNum              - the number of system calls receiving recvPktNum packets.
+ * coalescedAckNum           - the number of acks superseded by a later one of the same batch.
+ * shmPktNum                 - the number of packets sent or received through shared memory rings.
  *
  */
 typedef struct ICStatistics
@@ -633,6 +651,10 @@ typedef struct ICStatistics
 	int32		duplicatedPktNum;
 	int32		recvAckNum;
 	int32		statusQueryMsgNum;
+	int32		sndBatchNum;
+	int32		recvBatchNum;
+	int32		coalescedAckNum;
+	int32		shmPktNum;
 } ICStatistics;
 
 /* Statistics for UDP interconnect. */
@@ -738,11 +760,23 @@ static bool SendChunkUDPIFC(ChunkTransportState *transportStates,
 				ChunkTransportStateEntry *pEntry, MotionConn *conn, TupleChunkListItem tcItem, int16 motionId);
 
 static void doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID);
+
+static bool isLocalPeer(ChunkTransportState *transportStates, CdbProcess *cdbProc);
+static bool useShmRing(ChunkTransportState *transportStates, CdbProcess *cdbProc);
+static bool prepareShmConnForRead(MotionConn *conn);
+static MotionConn *getShmConnForRead(ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool armShmConns(ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool setupShmSend(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool sendShmPacket(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, bool last);
+
 static void dispatcherAYT(void);
 static void checkQDConnectionAlive(void);
 
 
 static void *rxThreadFunc(void *arg);
+static int receivePackets(icpkthdr **pkts, int npkts, struct sockaddr_storage *peers,
+						  socklen_t *peerlens, int *lens);
+static bool checkRxPacket(icpkthdr *pkt, int read_count);
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
 static void handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
@@ -758,6 +792,9 @@ static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn *conn);
+static void xmitPacket(ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn *conn);
+static void sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+					  MotionConn *conn, ICBuffer **bufs, int nbufs);
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
@@ -778,6 +815,9 @@ static void initMutex(pthread_mutex_t *mutex);
 
 static inline void logPkt(char *prefix, icpkthdr *pkt);
 static void aggregateStatistics(ChunkTransportStateEntry *pEntry);
+static inline void sampleRecvQueue(MotionConn *conn);
+static void recordConnStats(ChunkTransportStateEntry *pEntry, MotionConn *conn,
+							bool isSender);
 
 static inline bool pollAcks(ChunkTransportState *transportStates, int fd, int timeout);
 
@@ -1455,9 +1495,15 @@ InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort)
 	rx_control_info.lastTornIcId = 0;
 	initCursorICHistoryTable(&rx_control_info.cursorHistoryTable);
 
+#ifdef HAVE_RECVMMSG
+	rx_control_info.batchSize = Min(Gp_interconnect_batch_size, UDPIFC_MAX_BATCH_SIZE);
+#else
+	rx_control_info.batchSize = 1;
+#endif
+
 	/* Initialize receive buffer pool */
 	rx_buffer_pool.count = 0;
-	rx_buffer_pool.maxCount = 1;
+	rx_buffer_pool.maxCount = rx_control_info.batchSize;
 	rx_buffer_pool.freeList = NULL;
 
 	/* Initialize send control data */
@@ -1788,7 +1834,7 @@ destroyConnHashTable(ConnHashTable *ht)
 static inline void
 sendControlMessage(icpkthdr *pkt, int fd, struct sockaddr *addr, socklen_t peerLen)
 {
-	int			n;
+	int			n = 0;
 
 #ifdef USE_ASSERT_CHECKING
 	if (testmode_inject_fault(gp_udpic_dropacks_percent))
@@ -1851,6 +1897,121 @@ sendAckWithParam(AckSendParam *param)
 	sendControlMessage(&param->msg, UDP_listenerFd, (struct sockaddr *) &param->peer, param->peer_len);
 }
 
+/*
+ * sendAcksWithParam
+ * 		Send the acknowledgments of a batch of packets to the senders.
+ *
+ * Like sendControlMessage(), but with a single sendmmsg() call when there
+ * are several of them.
+ */
+static void
+sendAcksWithParam(AckSendParam *params, int nparams)
+{
+#ifdef HAVE_SENDMMSG
+	if (nparams > 1)
+	{
+		struct mmsghdr msgs[UDPIFC_MAX_BATCH_SIZE];
+		struct iovec iovs[UDPIFC_MAX_BATCH_SIZE];
+		int			nmsgs = 0;
+		int			sent = 0;
+		int			counter = 0;
+		int			i;
+
+		Assert(nparams <= UDPIFC_MAX_BATCH_SIZE);
+
+		for (i = 0; i < nparams; i++)
+		{
+			icpkthdr   *pkt = &params[i].msg;
+
+#ifdef USE_ASSERT_CHECKING
+			if (testmode_inject_fault(gp_udpic_dropacks_percent))
+				continue;
+#endif
+
+			/* Add CRC for the control message. */
+			if (gp_interconnect_full_crc)
+				addCRC(pkt);
+
+			iovs[nmsgs].iov_base = pkt;
+			iovs[nmsgs].iov_len = pkt->len;
+			memset(&msgs[nmsgs], 0, sizeof(struct mmsghdr));
+			msgs[nmsgs].msg_hdr.msg_name = &params[i].peer;
+			msgs[nmsgs].msg_hdr.msg_namelen = params[i].peer_len;
+			msgs[nmsgs].msg_hdr.msg_iov = &iovs[nmsgs];
+			msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+			nmsgs++;
+		}
+
+		/* retry 10 times for sending control messages */
+		while (sent < nmsgs && counter < 10)
+		{
+			int			n;
+
+			counter++;
+			n = sendmmsg(UDP_listenerFd, &msgs[sent], nmsgs - sent, 0);
+			if (n < 0)
+			{
+				if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+					continue;
+
+				write_log("sendcontrolmessage: got errno %d", errno);
+				return;
+			}
+			sent += n;
+		}
+		if (sent < nmsgs)
+			write_log("sendcontrolmessage: sent %d of %d messages", sent, nmsgs);
+		return;
+	}
+#endif
+
+	if (nparams == 1)
+		sendAckWithParam(&params[0]);
+}
+
+/*
+ * queueAckWithParam
+ * 		Add an acknowledgment to the ones of the current batch of packets.
+ *
+ * A cumulative ack supersedes the previous ack of the batch for the same
+ * connection if that one has the same flags, so the previous one is not sent
+ * at all.  Acks reporting disordered or duplicate packets are always sent.
+ *
+ * Returns the new number of queued acks.
+ *
+ * SHOULD BE CALLED WITH ic_control_info.lock *LOCKED*
+ */
+static int
+queueAckWithParam(AckSendParam *params, MotionConn **conns, int nparams,
+				  AckSendParam *param, MotionConn *conn)
+{
+	const int32 unmergeable = UDPIC_FLAGS_NAK | UDPIC_FLAGS_DISORDER | UDPIC_FLAGS_DUPLICATE;
+	int			i;
+
+	if ((param->msg.flags & UDPIC_FLAGS_ACK) && !(param->msg.flags & unmergeable))
+	{
+		for (i = nparams - 1; i >= 0; i--)
+		{
+			if (conns[i] != conn)
+				continue;
+
+			if (params[i].msg.flags == param->msg.flags &&
+				params[i].msg.seq <= param->msg.seq &&
+				params[i].msg.extraSeq <= param->msg.extraSeq)
+			{
+				memcpy(&params[i], param, sizeof(AckSendParam));
+				ic_statistics.coalescedAckNum++;
+				return nparams;
+			}
+			break;
+		}
+	}
+
+	memcpy(&params[nparams], param, sizeof(AckSendParam));
+	conns[nparams] = conn;
+	return nparams + 1;
+}
+
 /*
  * sendAck
  * 		Send acknowledgment to sender.
@@ -2006,7 +2167,14 @@ MlPutRxBufferIFC(ChunkTransportState *transportStates, int motNodeID, int route)
 
 	pthread_mutex_lock(&ic_control_info.lock);
 
-	if (conn->pBuff != NULL)
+	if (conn->pBuff != NULL && conn->shmRing != NULL &&
+		ic_shm_ring_owns(conn->shmRing, conn->pBuff))
+	{
+		/* the packets of a shared memory ring need no ack */
+		conn->pBuff = NULL;
+		ic_shm_ring_release(conn->shmRing);
+	}
+	else if (conn->pBuff != NULL)
 	{
 		putRxBufferAndSendAck(conn, &param);
 	}
@@ -3164,6 +3332,23 @@ SetupUDPIFCInterconnect_Internal(SliceTable *sliceTable)
 				conn->conn_info.icId = sliceTable->ic_instance_id;
 				conn->conn_info.flags = UDPIC_FLAGS_RECEIVER_TO_SENDER;
 
+				/*
+				 * Offer a shared memory ring to a sender on the same host,
+				 * it still may choose the network.
+				 */
+				if (useShmRing(interconnect_context, conn->cdbProc))
+				{
+					char		name[IC_SHM_RING_NAME_LEN];
+
+					ic_shm_ring_name(name, GpIdentity.dbid, gp_session_id,
+									 sliceTable->ic_instance_id, pEntry->motNodeId,
+									 conn->cdbProc->pid, MyProcPid);
+					conn->shmRing = ic_shm_ring_create(name, Gp_interconnect_queue_depth,
+													   Gp_max_packet_size);
+					if (conn->shmRing != NULL)
+						pEntry->numShmConns++;
+				}
+
 				connAddHash(&ic_control_info.connHtab, conn);
 			}
 		}
@@ -3476,10 +3661,17 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 					/* compute some statistics */
 					computeNetworkStatistics(conn->rtt, &minRtt, &maxRtt, &avgRtt);
 					computeNetworkStatistics(conn->dev, &minDev, &maxDev, &avgDev);
+					recordConnStats(pEntry, conn, true);
 
 					icBufferListReturn(&conn->sndQueue, false);
 					icBufferListReturn(&conn->unackQueue, Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_CAPACITY ? false : true);
 
+					if (conn->shmRing)
+					{
+						ic_shm_ring_detach(conn->shmRing, false);
+						conn->shmRing = NULL;
+					}
+
 					connDelHash(&ic_control_info.connHtab, conn);
 				}
 				avgRtt = avgRtt / pEntry->numConns;
@@ -3548,6 +3740,15 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 					if (!conn->pkt_q)
 						break;
 
+					recordConnStats(pEntry, conn, false);
+
+					/* the sender stops if it is still sending to the ring */
+					if (conn->shmRing)
+					{
+						ic_shm_ring_detach(conn->shmRing, true);
+						conn->shmRing = NULL;
+					}
+
 					rx_buffer_pool.maxCount -= conn->pkt_q_capacity;
 
 					connDelHash(&ic_control_info.connHtab, conn);
@@ -3622,7 +3823,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 " freebuf_avg %f "
 		 "mismatch_pkt_num %d disordered_pkt_num %d duplicated_pkt_num %d"
 		 " rtt/dev [" UINT64_FORMAT "/" UINT64_FORMAT ", %f/%f, " UINT64_FORMAT "/" UINT64_FORMAT "] "
-		 " cwnd %f status_query_msg_num %d",
+		 " cwnd %f status_query_msg_num %d"
+		 " snd_batch_avg %f recv_batch_avg %f coalesced_ack_num %d shm_pkt_num %d",
 		 ic_control_info.isSender, isReceiver,
 		 Gp_interconnect_snd_queue_depth, Gp_interconnect_queue_depth, Gp_max_packet_size,
 		 UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
@@ -3635,7 +3837,10 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 (double) ((double) ic_statistics.totalBuffers) / ((double) ic_statistics.bufferCountingTime),
 		 ic_statistics.mismatchNum, ic_statistics.disorderedPktNum, ic_statistics.duplicatedPktNum,
 		 (minRtt == ~((uint64) 0) ? 0 : minRtt), (minDev == ~((uint64) 0) ? 0 : minDev), avgRtt, avgDev, maxRtt, maxDev,
-		 snd_control_info.cwnd, ic_statistics.statusQueryMsgNum);
+		 snd_control_info.cwnd, ic_statistics.statusQueryMsgNum,
+		 (double) ((double) ic_statistics.sndPktNum) / ((double) ic_statistics.sndBatchNum),
+		 (double) ((double) ic_statistics.recvPktNum) / ((double) ic_statistics.recvBatchNum),
+		 ic_statistics.coalescedAckNum, ic_statistics.shmPktNum);
 
 	ic_control_info.isSender = false;
 	memset(&ic_statistics, 0, sizeof(ICStatistics));
@@ -3706,6 +3911,157 @@ prepareRxConnForRead(MotionConn *conn)
 	conn->recvBytes = conn->msgSize;
 }
 
+/*
+ * isLocalPeer
+ * 		Is the process on the same host as we are?
+ *
+ * The listener addresses of all the processes of a query come from the
+ * segment configuration, so the processes of a host have the same one.
+ */
+static bool
+isLocalPeer(ChunkTransportState *transportStates, CdbProcess *cdbProc)
+{
+	ExecSlice  *mySlice = &transportStates->sliceTable->slices[transportStates->sliceId];
+	ListCell   *cell;
+
+	if (cdbProc == NULL || cdbProc->listenerAddr == NULL)
+		return false;
+
+	foreach(cell, mySlice->primaryProcesses)
+	{
+		CdbProcess *myProc = lfirst(cell);
+
+		if (myProc != NULL && myProc->pid == MyProcPid)
+			return myProc->listenerAddr != NULL &&
+				strcmp(myProc->listenerAddr, cdbProc->listenerAddr) == 0;
+	}
+
+	return false;
+}
+
+/*
+ * useShmRing
+ * 		Do the packets exchanged with the process go through a shared memory
+ * 		ring?  See gp_interconnect_local_shm.
+ *
+ * Both ends of a connection must come to the same answer.
+ */
+static bool
+useShmRing(ChunkTransportState *transportStates, CdbProcess *cdbProc)
+{
+	switch (gp_interconnect_local_shm)
+	{
+		case INTERCONNECT_LOCAL_SHM_ON:
+			return isLocalPeer(transportStates, cdbProc);
+
+		case INTERCONNECT_LOCAL_SHM_LOOPBACK:
+			/* a process of our own segment, or the QD and its entry db readers */
+			return cdbProc != NULL &&
+				cdbProc->contentid == GpIdentity.segindex &&
+				isLocalPeer(transportStates, cdbProc);
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * prepareShmConnForRead
+ * 		Prepare the receive connection for reading the oldest packet of its
+ * 		shared memory ring.
+ *
+ * Returns false if the connection has no ring or the ring is empty.
+ *
+ * MUST BE CALLED WITH ic_control_info.lock LOCKED.
+ */
+static bool
+prepareShmConnForRead(MotionConn *conn)
+{
+	icpkthdr   *pkt;
+
+	if (conn->shmRing == NULL)
+		return false;
+
+	pkt = (icpkthdr *) ic_shm_ring_peek(conn->shmRing);
+	if (pkt == NULL)
+		return false;
+
+	/* the rx thread does this for the packets from the network */
+	if (pkt->flags & UDPIC_FLAGS_EOS)
+		conn->conn_info.flags |= UDPIC_FLAGS_EOS;
+
+	conn->pBuff = (uint8 *) pkt;
+	conn->msgPos = conn->pBuff;
+	conn->msgSize = pkt->len;
+	conn->recvBytes = conn->msgSize;
+
+	ic_statistics.shmPktNum++;
+	conn->stat_count_pkts++;
+
+	return true;
+}
+
+/*
+ * getShmConnForRead
+ * 		Find a connection with a packet in its shared memory ring and prepare
+ * 		it for reading.  If conn is given only that connection is checked.
+ *
+ * MUST BE CALLED WITH ic_control_info.lock LOCKED.
+ */
+static MotionConn *
+getShmConnForRead(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	int			i;
+
+	if (pEntry->numShmConns == 0)
+		return NULL;
+
+	if (conn != NULL)
+		return prepareShmConnForRead(conn) ? conn : NULL;
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *rxconn = pEntry->conns + (pEntry->scanStart + i) % pEntry->numConns;
+
+		if (prepareShmConnForRead(rxconn))
+			return rxconn;
+	}
+
+	return NULL;
+}
+
+/*
+ * armShmConns
+ * 		Ask the senders of the shared memory rings to ring the doorbell when
+ * 		they publish a packet.  If conn is given only its ring is armed.
+ *
+ * Returns true if a ring has a packet already, the caller must not wait then.
+ *
+ * MUST BE CALLED WITH ic_control_info.lock LOCKED.
+ */
+static bool
+armShmConns(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	int			i;
+
+	if (pEntry->numShmConns == 0)
+		return false;
+
+	if (conn != NULL)
+		return conn->shmRing != NULL && ic_shm_ring_arm(conn->shmRing);
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *rxconn = pEntry->conns + i;
+
+		if (rxconn->shmRing != NULL && rxconn->stillActive &&
+			ic_shm_ring_arm(rxconn->shmRing))
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * receiveChunksUDPIFC
  * 		Receive chunks from the senders
@@ -3809,6 +4165,8 @@ receiveChunksUDPIFCLoop(ChunkTransportState *pTransportStates, ChunkTransportSta
 			elog(DEBUG2, "receiveChunksUDPIFC: non-directed rx woke on route %d", rx_control_info.mainWaitingState.reachRoute);
 			resetMainThreadWaiting(&rx_control_info.mainWaitingState);
 		}
+		else
+			rxconn = getShmConnForRead(pEntry, conn);
 
 		aggregateStatistics(pEntry);
 
@@ -3836,6 +4194,14 @@ receiveChunksUDPIFCLoop(ChunkTransportState *pTransportStates, ChunkTransportSta
 		 * arrive. The RX thread will wake us up using the latch.
 		 */
 		ResetLatch(&ic_control_info.latch);
+
+		/*
+		 * The senders of the shared memory rings can not set our latch, they
+		 * ring a doorbell on our socket for the RX thread instead.
+		 */
+		if (armShmConns(pEntry, conn))
+			continue;
+
 		pthread_mutex_unlock(&ic_control_info.lock);
 
 		if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
@@ -3941,6 +4307,7 @@ RecvTupleChunkFromAnyUDPIFC_Internal(ChunkTransportState *transportStates,
 
 		ic_statistics.totalRecvQueueSize += conn->pkt_q_size;
 		ic_statistics.recvQueueSizeCountingTime++;
+		sampleRecvQueue(conn);
 
 		if (conn->pkt_q_size > 0)
 		{
@@ -3948,6 +4315,12 @@ RecvTupleChunkFromAnyUDPIFC_Internal(ChunkTransportState *transportStates,
 			prepareRxConnForRead(conn);
 			break;
 		}
+
+		if (prepareShmConnForRead(conn))
+		{
+			found = true;
+			break;
+		}
 	}
 
 	if (found)
@@ -4061,10 +4434,12 @@ RecvTupleChunkFromUDPIFC_Internal(ChunkTransportState *transportStates,
 
 	ic_statistics.totalRecvQueueSize += conn->pkt_q_size;
 	ic_statistics.recvQueueSizeCountingTime++;
+	sampleRecvQueue(conn);
 
-	if (conn->pkt_q[conn->pkt_q_head] != NULL)
+	if (conn->pkt_q[conn->pkt_q_head] != NULL || prepareShmConnForRead(conn))
 	{
-		prepareRxConnForRead(conn);
+		if (conn->pkt_q[conn->pkt_q_head] != NULL)
+			prepareRxConnForRead(conn);
 
 		pthread_mutex_unlock(&ic_control_info.lock);
 
@@ -4112,6 +4487,17 @@ RecvTupleChunkFromUDPIFC(ChunkTransportState *transportStates,
 	return icItem;
 }
 
+/*
+ * CleanupShmRingsUDPIFC
+ * 		Remove the shared memory rings left behind by the backends of this
+ * 		segment, called by the postmaster when none of them runs.
+ */
+void
+CleanupShmRingsUDPIFC(void)
+{
+	ic_shm_ring_cleanup(GpIdentity.dbid);
+}
+
 /*
  * markUDPConnInactiveIFC
  * 		Mark the connection inactive.
@@ -4161,6 +4547,69 @@ aggregateStatistics(ChunkTransportStateEntry *pEntry)
 	}
 }
 
+/*
+ * sampleRecvQueue
+ * 		Sample the depth of the receive queue of a connection.
+ */
+static inline void
+sampleRecvQueue(MotionConn *conn)
+{
+	conn->stat_total_queue_size += conn->pkt_q_size;
+	conn->stat_count_queue_samples++;
+	conn->stat_max_queue_size = Max(conn->stat_max_queue_size, conn->pkt_q_size);
+}
+
+/*
+ * recordConnStats
+ * 		Add the statistics of a connection to the history of ic_stats.c.
+ *
+ * Connections that never carried a packet are left out.
+ */
+static void
+recordConnStats(ChunkTransportStateEntry *pEntry, MotionConn *conn, bool isSender)
+{
+	ICConnStats stats;
+
+	if (conn->stat_count_pkts == 0)
+		return;
+
+	memset(&stats, 0, sizeof(stats));
+	stats.sessionId = gp_session_id;
+	stats.commandCount = gp_command_count;
+	stats.motNodeId = pEntry->motNodeId;
+	stats.localContentId = GpIdentity.segindex;
+	stats.remoteContentId = conn->cdbProc->contentid;
+	stats.remotePid = conn->cdbProc->pid;
+	stats.isSender = isSender;
+	stats.viaShm = conn->shmRing != NULL;
+	stats.endTime = GetCurrentTimestamp();
+	strlcpy(stats.remoteAddr, conn->cdbProc->listenerAddr, sizeof(stats.remoteAddr));
+
+	stats.packets = conn->stat_count_pkts;
+	if (isSender)
+	{
+		if (conn->stat_max_ack_time > 0)
+			stats.minRtt = conn->stat_min_ack_time;
+		stats.maxRtt = conn->stat_max_ack_time;
+		stats.totalRtt = conn->stat_total_ack_time;
+		memcpy(stats.rttHist, conn->stat_rtt_hist, sizeof(stats.rttHist));
+		stats.retransmits = conn->stat_count_resent;
+		stats.stalls = conn->stat_count_stalls;
+		stats.stallTime = conn->stat_stall_time;
+	}
+	else
+	{
+		stats.disordered = conn->stat_count_disordered;
+		stats.duplicated = conn->stat_count_duplicated;
+		stats.dropped = conn->stat_count_dropped;
+		stats.totalQueueSize = conn->stat_total_queue_size;
+		stats.queueSamples = conn->stat_count_queue_samples;
+		stats.maxQueueSize = conn->stat_max_queue_size;
+	}
+
+	ic_stats_record(&stats);
+}
+
 /*
  * logPkt
  * 		Log a packet.
@@ -4221,6 +4670,15 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 
 	buf = icBufferListDelete(&ackConn->unackQueue, buf);
 
+	ackTime = now - buf->sentTime;
+
+	/*
+	 * The ack of a retransmitted packet may be for any of its copies, so only
+	 * the packets sent once go into the histogram.
+	 */
+	if (buf->nRetry == 0)
+		buf->conn->stat_rtt_hist[ic_stats_rtt_bucket(ackTime)]++;
+
 	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
 	{
 		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
@@ -4228,8 +4686,6 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 		if (icBufferListLength(&ackConn->unackQueue) >= 1)
 			unack_queue_ring.numSharedOutStanding--;
 
-		ackTime = now - buf->sentTime;
-
 		/*
 		 * In udp_testmode, we do not change rtt dynamically due to the large
 		 * number of packet losses introduced by fault injection code. This
@@ -4658,8 +5114,6 @@ xmit_retry:
 static void
 sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn *conn)
 {
-	int32 n;
-
 #ifdef USE_ASSERT_CHECKING
 	if (testmode_inject_fault(gp_udpic_dropxmit_percent))
 	{
@@ -4670,6 +5124,18 @@ sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
 	}
 #endif
 
+	xmitPacket(pEntry, buf, conn);
+}
+
+/*
+ * xmitPacket
+ * 		Send a packet, without the fault injection of sendOnce().
+ */
+static void
+xmitPacket(ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn *conn)
+{
+	int32 n;
+
 	char errDetail[100];
 	snprintf(errDetail, sizeof(errDetail), "For Remote Connection: contentId=%d at %s",
 					  conn->remoteContentId,
@@ -4690,44 +5156,141 @@ sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
 	return;
 }
 
-
 /*
- * handleStopMsgs
- *		handle stop messages.
+ * sendBatch
+ * 		Send a batch of packets of a connection.
  *
+ * The packets are handed to the kernel with a single sendmmsg() call where
+ * possible.  A packet sendmmsg() fails on goes through xmitPacket(), which
+ * retries or reports the error as for a single packet, and the rest of the
+ * batch follows.
  */
 static void
-handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, int16 motionId)
+sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+		  MotionConn *conn, ICBuffer **bufs, int nbufs)
 {
-	int			i = 0;
+	int			i;
 
-#ifdef AMS_VERBOSE_LOGGING
-	elog(DEBUG3, "handleStopMsgs: node %d", motionId);
-#endif
-	while (i < pEntry->numConns)
+#ifdef HAVE_SENDMMSG
+	if (nbufs > 1)
 	{
-		MotionConn *conn = NULL;
+		struct mmsghdr msgs[UDPIFC_MAX_BATCH_SIZE];
+		struct iovec iovs[UDPIFC_MAX_BATCH_SIZE];
+		ICBuffer   *sendBufs[UDPIFC_MAX_BATCH_SIZE];
+		int			nmsgs = 0;
 
-		conn = pEntry->conns + i;
+		Assert(nbufs <= UDPIFC_MAX_BATCH_SIZE);
 
+		for (i = 0; i < nbufs; i++)
+		{
+#ifdef USE_ASSERT_CHECKING
+			if (testmode_inject_fault(gp_udpic_dropxmit_percent))
+			{
 #ifdef AMS_VERBOSE_LOGGING
-		elog(DEBUG3, "handleStopMsgs: node %d route %d %s %s", motionId, conn->route,
-			 (conn->stillActive ? "active" : "NOT active"), (conn->stopRequested ? "stop requested" : ""));
-		elog(DEBUG3, "handleStopMsgs: node %d route %d msgSize %d", motionId, conn->route, conn->msgSize);
+				write_log("THROW PKT with seq %d srcpid %d despid %d", bufs[i]->pkt->seq, bufs[i]->pkt->srcPid, bufs[i]->pkt->dstPid);
+#endif
+				continue;
+			}
 #endif
+			iovs[nmsgs].iov_base = bufs[i]->pkt;
+			iovs[nmsgs].iov_len = bufs[i]->pkt->len;
+			memset(&msgs[nmsgs], 0, sizeof(struct mmsghdr));
+			msgs[nmsgs].msg_hdr.msg_name = (void *) &conn->peer;
+			msgs[nmsgs].msg_hdr.msg_namelen = conn->peer_len;
+			msgs[nmsgs].msg_hdr.msg_iov = &iovs[nmsgs];
+			msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+			sendBufs[nmsgs++] = bufs[i];
+		}
 
-		/*
-		 * MPP-2427: we're guaranteed to have recently flushed, but this might
-		 * not be empty (if we got a stop on a buffer that wasn't the one we
-		 * were sending) ... empty it first so the outbound buffer is empty
-		 * when we get here.
-		 */
-		if (conn->stillActive && conn->stopRequested)
+		i = 0;
+		while (i < nmsgs)
 		{
+			int			n = sendmmsg(pEntry->txfd, &msgs[i], nmsgs - i, 0);
 
-			/* mark buffer empty */
-			conn->tupleCount = 0;
-			conn->msgSize = sizeof(conn->conn_info);
+			ic_statistics.sndBatchNum++;
+
+			if (n <= 0)
+			{
+				xmitPacket(pEntry, sendBufs[i], conn);
+				i++;
+				continue;
+			}
+
+#ifdef FAULT_INJECTOR
+			if (n > 1)
+				SIMPLE_FAULT_INJECTOR("interconnect_send_batch");
+#endif
+
+			for (; n > 0; n--, i++)
+			{
+				if (msgs[i].msg_len != sendBufs[i]->pkt->len && DEBUG1 >= log_min_messages)
+					write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendmmsg() call."
+							  "For Remote Connection: contentId=%d at %s", sendBufs[i]->pkt->seq, sendBufs[i]->pkt->len, msgs[i].msg_len,
+							  conn->remoteContentId,
+							  conn->remoteHostAndPort);
+			}
+		}
+	}
+	else
+#endif
+	{
+		for (i = 0; i < nbufs; i++)
+		{
+			sendOnce(transportStates, pEntry, bufs[i], conn);
+			ic_statistics.sndBatchNum++;
+		}
+	}
+
+	for (i = 0; i < nbufs; i++)
+	{
+		ic_statistics.sndPktNum++;
+
+#ifdef AMS_VERBOSE_LOGGING
+		logPkt("SEND PKT DETAIL", bufs[i]->pkt);
+#endif
+
+		conn->sentSeq = bufs[i]->pkt->seq;
+	}
+}
+
+
+/*
+ * handleStopMsgs
+ *		handle stop messages.
+ *
+ */
+static void
+handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, int16 motionId)
+{
+	int			i = 0;
+
+#ifdef AMS_VERBOSE_LOGGING
+	elog(DEBUG3, "handleStopMsgs: node %d", motionId);
+#endif
+	while (i < pEntry->numConns)
+	{
+		MotionConn *conn = NULL;
+
+		conn = pEntry->conns + i;
+
+#ifdef AMS_VERBOSE_LOGGING
+		elog(DEBUG3, "handleStopMsgs: node %d route %d %s %s", motionId, conn->route,
+			 (conn->stillActive ? "active" : "NOT active"), (conn->stopRequested ? "stop requested" : ""));
+		elog(DEBUG3, "handleStopMsgs: node %d route %d msgSize %d", motionId, conn->route, conn->msgSize);
+#endif
+
+		/*
+		 * MPP-2427: we're guaranteed to have recently flushed, but this might
+		 * not be empty (if we got a stop on a buffer that wasn't the one we
+		 * were sending) ... empty it first so the outbound buffer is empty
+		 * when we get here.
+		 */
+		if (conn->stillActive && conn->stopRequested)
+		{
+
+			/* mark buffer empty */
+			conn->tupleCount = 0;
+			conn->msgSize = sizeof(conn->conn_info);
 
 			/* now send our stop-ack EOS */
 			conn->conn_info.flags |= UDPIC_FLAGS_EOS;
@@ -4799,6 +5362,10 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+	ICBuffer   *batch[UDPIFC_MAX_BATCH_SIZE];
+	int			batchSize = Min(Gp_interconnect_batch_size, UDPIFC_MAX_BATCH_SIZE);
+	int			nbatch = 0;
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer   *buf = NULL;
@@ -4821,6 +5388,7 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		buf->nRetry = 0;
 		buf->conn = conn;
 		conn->capacity--;
+		conn->stat_count_pkts++;
 
 		icBufferListAppend(&conn->unackQueue, buf);
 
@@ -4837,9 +5405,9 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		}
 
 		/*
-		 * Note the place of sendOnce here. If we send before appending it to
+		 * Note the place of sendBatch here. If we send before appending it to
 		 * the unack queue and putting it into unack queue ring, and there is
-		 * a network error occurred in the sendOnce function, error message
+		 * a network error occurred in the sendBatch function, error message
 		 * will be output. In the time of error message output, interrupts is
 		 * potentially checked, if there is a pending query cancel, it will
 		 * lead to a dangled buffer (memory leak).
@@ -4848,15 +5416,16 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
-		ic_statistics.sndPktNum++;
-
-#ifdef AMS_VERBOSE_LOGGING
-		logPkt("SEND PKT DETAIL", buf->pkt);
-#endif
-
-		buf->conn->sentSeq = buf->pkt->seq;
+		batch[nbatch++] = buf;
+		if (nbatch == batchSize)
+		{
+			sendBatch(transportStates, pEntry, conn, batch, nbatch);
+			nbatch = 0;
+		}
 	}
+
+	if (nbatch > 0)
+		sendBatch(transportStates, pEntry, conn, batch, nbatch);
 }
 
 /*
@@ -5018,6 +5587,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 #endif
 
 			ic_statistics.retransmits++;
+			buf->conn->stat_count_resent++;
 			curLostPktSeq++;
 			lostPktCnt--;
 
@@ -5475,6 +6045,157 @@ computeTimeout(MotionConn *conn, int retry)
 	return TIMEOUT(buf->nRetry);
 }
 
+/*
+ * setupShmSend
+ * 		Switch an outgoing connection to the shared memory ring created by
+ * 		its receiver, if there is one.
+ *
+ * Called when the connection flushes its first packet, the packet is moved
+ * from its send buffer to the first slot of the ring.  Returns whether the
+ * connection goes through a ring.
+ */
+static bool
+setupShmSend(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	char		name[IC_SHM_RING_NAME_LEN];
+	uint8	   *slot;
+
+	if (conn->shmChecked)
+		return conn->shmRing != NULL;
+
+	conn->shmChecked = true;
+
+	if (!useShmRing(transportStates, conn->cdbProc))
+		return false;
+
+	ic_shm_ring_name(name, conn->cdbProc->dbid, gp_session_id,
+					 transportStates->sliceTable->ic_instance_id, pEntry->motNodeId,
+					 MyProcPid, conn->cdbProc->pid);
+	conn->shmRing = ic_shm_ring_attach(name, Gp_max_packet_size);
+	if (conn->shmRing == NULL)
+		return false;
+
+	/* nothing was published yet, the first slot is free */
+	slot = ic_shm_ring_reserve(conn->shmRing);
+	Assert(slot != NULL);
+
+	memcpy(slot, conn->pBuff, conn->msgSize);
+	icBufferListAppend(&snd_buffer_pool.freeList, conn->curBuff);
+	conn->curBuff = NULL;
+	conn->pBuff = slot;
+
+	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+		elog(DEBUG1, "Interconnect sending to seg%d pid %d through shared memory, node %d route %d",
+			 conn->remoteContentId, conn->cdbProc->pid, pEntry->motNodeId, conn->route);
+
+	return true;
+}
+
+/*
+ * sendShmPacket
+ * 		Publish the packet built in the current slot of the shared memory
+ * 		ring, and unless it is the last one, wait for the next slot.
+ *
+ * If the receiver waits for the packet, it is woken up by a doorbell on its
+ * listener socket.  Returns false if the receiver stopped the connection,
+ * which is marked inactive then.
+ */
+static bool
+sendShmPacket(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+			  MotionConn *conn, bool last)
+{
+	int			retry = 0;
+	uint64		stallStart = 0;
+
+	prepareXmit(conn);
+
+	if (ic_shm_ring_publish(conn->shmRing))
+	{
+		icpkthdr	doorbell;
+
+		memcpy(&doorbell, &conn->conn_info, sizeof(icpkthdr));
+		doorbell.flags = UDPIC_FLAGS_SHM_DOORBELL;
+		doorbell.len = sizeof(icpkthdr);
+		doorbell.crc = 0;
+
+		sendControlMessage(&doorbell, pEntry->txfd, (struct sockaddr *) &conn->peer, conn->peer_len);
+	}
+
+	ic_statistics.shmPktNum++;
+	conn->stat_count_pkts++;
+
+	conn->tupleCount = 0;
+	conn->msgSize = sizeof(conn->conn_info);
+	conn->pBuff = NULL;
+
+	if (last)
+		return true;
+
+	for (;;)
+	{
+		if (ic_shm_ring_stopped(conn->shmRing))
+		{
+			if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+				elog(DEBUG1, "sendShmPacket: node %d route %d stopped by the receiver",
+					 pEntry->motNodeId, conn->route);
+
+			conn->state = mcsEosSent;
+			conn->stillActive = false;
+			return false;
+		}
+
+		conn->pBuff = ic_shm_ring_reserve(conn->shmRing);
+		if (conn->pBuff != NULL)
+		{
+			if (stallStart != 0)
+				conn->stat_stall_time += getCurrentTime() - stallStart;
+			return true;
+		}
+
+		/* the ring is full, wait for the receiver */
+		if (stallStart == 0)
+		{
+			stallStart = getCurrentTime();
+			conn->stat_count_stalls++;
+		}
+
+		ic_shm_ring_wait(conn->shmRing, MAIN_THREAD_COND_TIMEOUT_MS);
+
+		ML_CHECK_FOR_INTERRUPTS(transportStates->teardownActive);
+
+		if ((++retry & 0x3f) == 0)
+		{
+			checkQDConnectionAlive();
+
+			if (!PostmasterIsAlive())
+				ereport(FATAL,
+						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						 errmsg("interconnect failed to send chunks"),
+						 errdetail("Postmaster is not alive.")));
+		}
+	}
+}
+
+/*
+ * flushShmConnUDPIFC
+ * 		Send the packet of a connection that goes through a shared memory
+ * 		ring before it is full.
+ *
+ * A ring slot costs the same however much of it is used, so the motion layer
+ * rather starts a new packet than splits a tuple into chunks, see
+ * flushTransportDirectBuffer().  Returns false if the connection has no ring
+ * or the receiver stopped it.
+ */
+bool
+flushShmConnUDPIFC(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+				   MotionConn *conn)
+{
+	if (conn->shmRing == NULL || !conn->stillActive)
+		return false;
+
+	return sendShmPacket(transportStates, pEntry, conn, false);
+}
+
 /*
  * SendChunkUDPIFC
  * 		is used to send a tcItem to a single destination. Tuples often are
@@ -5497,6 +6218,7 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 	int			retry = 0;
 	bool		doCheckExpiration = false;
 	bool		gotStops = false;
+	bool		stalled = false;
 
 	Assert(conn->msgSize > 0);
 
@@ -5514,6 +6236,18 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 		return true;
 	}
 
+	if (setupShmSend(transportStates, pEntry, conn))
+	{
+		if (!sendShmPacket(transportStates, pEntry, conn, false))
+			return true;
+
+		memcpy(conn->pBuff + conn->msgSize, tcItem->chunk_data, tcItem->chunk_length);
+		conn->msgSize += length;
+
+		conn->tupleCount++;
+		return true;
+	}
+
 	/* prepare this for transmit */
 
 	ic_statistics.totalCapacity += conn->capacity;
@@ -5521,6 +6255,7 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 
 	/* try to send it */
 
+	compressChunkPacket(conn, sizeof(conn->conn_info));
 	prepareXmit(conn);
 
 	icBufferListAppend(&conn->sndQueue, conn->curBuff);
@@ -5544,6 +6279,13 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 	{
 		int			timeout = (doCheckExpiration ? 0 : computeTimeout(conn, retry));
 
+		/* no send buffer, we have to wait for acks */
+		if (!doCheckExpiration && !stalled)
+		{
+			stalled = true;
+			conn->stat_count_stalls++;
+		}
+
 		if (pollAcks(transportStates, pEntry->txfd, timeout))
 		{
 			if (handleAcks(transportStates, pEntry))
@@ -5561,6 +6303,9 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 		doCheckExpiration = false;
 	}
 
+	if (stalled)
+		conn->stat_stall_time += getCurrentTime() - now;
+
 	conn->pBuff = (uint8 *) conn->curBuff->pkt;
 
 	if (gotStops)
@@ -5651,6 +6396,16 @@ SendEosUDPIFC(ChunkTransportState *transportStates,
 			if (pEntry->sendingEos)
 				conn->conn_info.flags |= UDPIC_FLAGS_EOS;
 
+			/* nothing to wait for, the receiver owns the ring */
+			if (setupShmSend(transportStates, pEntry, conn))
+			{
+				sendShmPacket(transportStates, pEntry, conn, true);
+				conn->state = mcsEosSent;
+				conn->stillActive = false;
+				continue;
+			}
+
+			compressChunkPacket(conn, sizeof(conn->conn_info));
 			prepareXmit(conn);
 
 			/* place it into the send queue */
@@ -5779,6 +6534,10 @@ doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID)
 				conn->stopRequested = true;
 				conn->conn_info.flags |= UDPIC_FLAGS_STOP;
 
+				/* a sender using the shared memory ring checks it there */
+				if (conn->shmRing)
+					ic_shm_ring_stop(conn->shmRing);
+
 				/*
 				 * The peer addresses for incoming connections will not be set
 				 * until the first packet has arrived. However, when the lower
@@ -6070,6 +6829,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	if (pkt->seq < conn->conn_info.seq)
 	{
 		ic_statistics.duplicatedPktNum++;
+		conn->stat_count_duplicated++;
 		if (DEBUG3 >= log_min_messages)
 			write_log("dropped ack ? ignored data packet w/ cmd %d conn->cmd %d node %d route %d seq %d expected %d flags 0x%x",
 					  pkt->icId, conn->conn_info.icId, pkt->motNodeId,
@@ -6116,6 +6876,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	if (conn->pkt_q[pos] == NULL)
 	{
 		conn->pkt_q[pos] = (uint8 *) pkt;
+		conn->stat_count_pkts++;
 		if (pos == conn->pkt_q_head)
 		{
 #ifdef AMS_VERBOSE_LOGGING
@@ -6156,6 +6917,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 
 			/* send an ack for out-of-order packet */
 			ic_statistics.disorderedPktNum++;
+			conn->stat_count_disordered++;
 			handleDisorderPacket(conn, pos, headSeq + conn->pkt_q_size, pkt);
 		}
 	}
@@ -6166,6 +6928,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 
 		setAckSendParam(param, conn, UDPIC_FLAGS_DUPLICATE | conn->conn_info.flags, pkt->seq, conn->conn_info.seq - 1);
 		ic_statistics.duplicatedPktNum++;
+		conn->stat_count_duplicated++;
 		return false;
 	}
 
@@ -6207,7 +6970,14 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 static void *
 rxThreadFunc(void *arg)
 {
-	icpkthdr   *pkt = NULL;
+	icpkthdr   *pkts[UDPIFC_MAX_BATCH_SIZE];
+	struct sockaddr_storage peers[UDPIFC_MAX_BATCH_SIZE];
+	socklen_t	peerlens[UDPIFC_MAX_BATCH_SIZE];
+	int			lens[UDPIFC_MAX_BATCH_SIZE];
+	bool		valid[UDPIFC_MAX_BATCH_SIZE];
+	AckSendParam acks[UDPIFC_MAX_BATCH_SIZE];
+	MotionConn *ackConns[UDPIFC_MAX_BATCH_SIZE];
+	int			npkts = 0;
 	bool		skip_poll = false;
 
 	for (;;)
@@ -6225,14 +6995,21 @@ rxThreadFunc(void *arg)
 			break;
 		}
 
-		/* Try to get a buffer */
-		if (pkt == NULL)
+		/* Try to get buffers, one for each packet of a batch */
+		if (npkts < rx_control_info.batchSize)
 		{
 			pthread_mutex_lock(&ic_control_info.lock);
-			pkt = getRxBuffer(&rx_buffer_pool);
+			while (npkts < rx_control_info.batchSize)
+			{
+				icpkthdr   *pkt = getRxBuffer(&rx_buffer_pool);
+
+				if (pkt == NULL)
+					break;
+				pkts[npkts++] = pkt;
+			}
 			pthread_mutex_unlock(&ic_control_info.lock);
 
-			if (pkt == NULL)
+			if (npkts == 0)
 			{
 				setRxThreadError(ENOMEM);
 				continue;
@@ -6282,15 +7059,13 @@ rxThreadFunc(void *arg)
 			/* we've got something interesting to read */
 			/* handle incoming */
 			/* ready to read on our socket */
-			MotionConn *conn = NULL;
-			int			read_count = 0;
-
-			struct sockaddr_storage peer;
-			socklen_t	peerlen;
+			bool		wakeup_mainthread = false;
+			int			nrecv;
+			int			nacks = 0;
+			int			i;
+			int			j;
 
-			peerlen = sizeof(peer);
-			read_count = recvfrom(UDP_listenerFd, (char *) pkt, Gp_max_packet_size, 0,
-								  (struct sockaddr *) &peer, &peerlen);
+			nrecv = receivePackets(pkts, npkts, peers, peerlens, lens);
 
 			if (pg_atomic_read_u32(&ic_control_info.shutdown) == 1)
 			{
@@ -6301,10 +7076,7 @@ rxThreadFunc(void *arg)
 				break;
 			}
 
-			if (DEBUG5 >= log_min_messages)
-				write_log("received inbound len %d", read_count);
-
-			if (read_count < 0)
+			if (nrecv < 0)
 			{
 				skip_poll = false;
 
@@ -6325,99 +7097,80 @@ rxThreadFunc(void *arg)
 				continue;
 			}
 
-			if (read_count < sizeof(icpkthdr))
-			{
-				if (DEBUG1 >= log_min_messages)
-					write_log("Interconnect error: short conn receive (%d)", read_count);
-				continue;
-			}
-
 			/*
 			 * when we get a "good" recvfrom() result, we can skip poll()
 			 * until we get a bad one.
 			 */
 			skip_poll = true;
 
-			/* length must be >= 0 */
-			if (pkt->len < 0)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
-
-			if (pkt->len != read_count)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
-				continue;
-			}
+			for (i = 0; i < nrecv; i++)
+				valid[i] = checkRxPacket(pkts[i], lens[i]);
 
 			/*
-			 * check the CRC of the payload.
+			 * Get the connection for each pkt.
+			 *
+			 * The connection hash table should be locked until finishing the
+			 * processing of the packets to avoid the connection
+			 * addition/removal from the hash table during the mean time.
 			 */
-			if (gp_interconnect_full_crc)
+			pthread_mutex_lock(&ic_control_info.lock);
+			for (i = 0; i < nrecv; i++)
 			{
-				if (!checkCRC(pkt))
+				icpkthdr   *pkt = pkts[i];
+				MotionConn *conn = NULL;
+				AckSendParam param;
+
+				if (!valid[i])
+					continue;
+
+				/* a sender published into a shared memory ring */
+				if (pkt->flags & UDPIC_FLAGS_SHM_DOORBELL)
 				{
-					pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
+					wakeup_mainthread = true;
 					continue;
 				}
-			}
-
-#ifdef AMS_VERBOSE_LOGGING
-			logPkt("GOT MESSAGE", pkt);
-#endif
-
-			bool		wakeup_mainthread = false;
-			AckSendParam param;
-
-			memset(&param, 0, sizeof(AckSendParam));
 
-			/*
-			 * Get the connection for the pkt.
-			 *
-			 * The connection hash table should be locked until finishing the
-			 * processing of the packet to avoid the connection
-			 * addition/removal from the hash table during the mean time.
-			 */
+				memset(&param, 0, sizeof(AckSendParam));
 
-			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+				conn = findConnByHeader(&ic_control_info.connHtab, pkt);
 
-			if (conn != NULL)
-			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param, &wakeup_mainthread))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets: a) Past
-				 * packets from previous command after I was torn down b)
-				 * Future packets from current command before my connections
-				 * are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+				if (conn != NULL)
 				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+					/* Handling a regular packet */
+					if (handleDataPacket(conn, pkt, &peers[i], &peerlens[i], &param, &wakeup_mainthread))
+						pkts[i] = NULL;
+					ic_statistics.recvPktNum++;
+				}
+				else
+				{
+					/*
+					 * There may have two kinds of Mismatched packets: a) Past
+					 * packets from previous command after I was torn down b)
+					 * Future packets from current command before my
+					 * connections are built.
+					 *
+					 * The handling logic is to "Ack the past and Nak the
+					 * future".
+					 */
+					if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+					{
+						if (DEBUG1 >= log_min_messages)
+							write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
 
 #ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
+						logPkt("Got a Mismatched Packet", pkt);
 #endif
 
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
+						if (handleMismatch(pkt, &peers[i], peerlens[i]))
+							pkts[i] = NULL;
+						ic_statistics.mismatchNum++;
+					}
 				}
+
+				if (param.msg.len != 0)
+					nacks = queueAckWithParam(acks, ackConns, nacks, &param, conn);
 			}
+			ic_statistics.recvBatchNum++;
 			pthread_mutex_unlock(&ic_control_info.lock);
 
 			if (wakeup_mainthread)
@@ -6427,19 +7180,26 @@ rxThreadFunc(void *arg)
 			 * real ack sending is after lock release to decrease the lock
 			 * holding time.
 			 */
-			if (param.msg.len != 0)
-				sendAckWithParam(&param);
+			sendAcksWithParam(acks, nacks);
+
+			/* Keep the buffers of the packets not taken over for the next batch */
+			for (i = 0, j = 0; i < npkts; i++)
+			{
+				if (pkts[i] != NULL)
+					pkts[j++] = pkts[i];
+			}
+			npkts = j;
 		}
 
 		/* pthread_yield(); */
 	}
 
-	/* Before return, we release the packet. */
-	if (pkt)
+	/* Before return, we release the packets. */
+	if (npkts > 0)
 	{
 		pthread_mutex_lock(&ic_control_info.lock);
-		freeRxBuffer(&rx_buffer_pool, pkt);
-		pkt = NULL;
+		while (npkts > 0)
+			freeRxBuffer(&rx_buffer_pool, pkts[--npkts]);
 		pthread_mutex_unlock(&ic_control_info.lock);
 	}
 
@@ -6447,6 +7207,120 @@ rxThreadFunc(void *arg)
 	return NULL;
 }
 
+/*
+ * receivePackets
+ * 		Receive up to npkts packets into the given buffers.
+ *
+ * The packets are received with a single recvmmsg() call where possible.
+ * Returns the number of packets received, or -1 with errno set.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static int
+receivePackets(icpkthdr **pkts, int npkts, struct sockaddr_storage *peers,
+			   socklen_t *peerlens, int *lens)
+{
+#ifdef HAVE_RECVMMSG
+	if (npkts > 1)
+	{
+		struct mmsghdr msgs[UDPIFC_MAX_BATCH_SIZE];
+		struct iovec iovs[UDPIFC_MAX_BATCH_SIZE];
+		int			n;
+		int			i;
+
+		Assert(npkts <= UDPIFC_MAX_BATCH_SIZE);
+
+		for (i = 0; i < npkts; i++)
+		{
+			iovs[i].iov_base = pkts[i];
+			iovs[i].iov_len = Gp_max_packet_size;
+			memset(&msgs[i], 0, sizeof(struct mmsghdr));
+			msgs[i].msg_hdr.msg_name = &peers[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		n = recvmmsg(UDP_listenerFd, msgs, npkts, 0, NULL);
+
+		for (i = 0; i < n; i++)
+		{
+			lens[i] = msgs[i].msg_len;
+			peerlens[i] = msgs[i].msg_hdr.msg_namelen;
+
+			if (DEBUG5 >= log_min_messages)
+				write_log("received inbound len %d", lens[i]);
+		}
+
+		return n;
+	}
+#endif
+
+	peerlens[0] = sizeof(struct sockaddr_storage);
+	lens[0] = recvfrom(UDP_listenerFd, (char *) pkts[0], Gp_max_packet_size, 0,
+					   (struct sockaddr *) &peers[0], &peerlens[0]);
+
+	if (lens[0] < 0)
+		return -1;
+
+	if (DEBUG5 >= log_min_messages)
+		write_log("received inbound len %d", lens[0]);
+
+	return 1;
+}
+
+/*
+ * checkRxPacket
+ * 		Check the length and the CRC of a received packet.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static bool
+checkRxPacket(icpkthdr *pkt, int read_count)
+{
+	if (read_count < sizeof(icpkthdr))
+	{
+		if (DEBUG1 >= log_min_messages)
+			write_log("Interconnect error: short conn receive (%d)", read_count);
+		return false;
+	}
+
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return false;
+	}
+
+	if (pkt->len != read_count)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return false;
+	}
+
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return false;
+		}
+	}
+
+#ifdef AMS_VERBOSE_LOGGING
+	logPkt("GOT MESSAGE", pkt);
+#endif
+
+	return true;
+}
+
 /*
  * handleMismatch
  * 		If the mismatched packet is from an old connection, we may need to
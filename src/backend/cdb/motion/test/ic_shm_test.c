@@ -0,0 +1,131 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../../motion/ic_shm.c"
+
+#define TEST_RING_NAME "/gpic.ic_shm_test"
+#define TEST_SLOT_SIZE 64
+
+/*
+ * Create a ring for nslots packets, as if seq packets went through it
+ * already, and attach to it as the sender.
+ */
+static ICShmRing *
+create_ring_at(int nslots, uint32 seq, ICShmRing **sender)
+{
+	ICShmRing  *receiver;
+
+	receiver = ic_shm_ring_create(TEST_RING_NAME, nslots, TEST_SLOT_SIZE);
+	assert_true(receiver != NULL);
+	pg_atomic_write_u32(&receiver->head, seq);
+	pg_atomic_write_u32(&receiver->tail, seq);
+
+	*sender = ic_shm_ring_attach(TEST_RING_NAME, TEST_SLOT_SIZE);
+	assert_true(*sender != NULL);
+
+	return receiver;
+}
+
+/*
+ * Fill the ring, then drain it, a few times.  Each packet carries its number,
+ * the receiver must see them all in order.
+ */
+static void
+send_and_receive(ICShmRing *sender, ICShmRing *receiver, int rounds)
+{
+	uint32		sent = 0;
+	uint32		received = 0;
+	uint8	   *slot;
+
+	for (int i = 0; i < rounds; i++)
+	{
+		while ((slot = ic_shm_ring_reserve(sender)) != NULL)
+		{
+			memcpy(slot, &sent, sizeof(sent));
+			ic_shm_ring_publish(sender);
+			sent++;
+		}
+		assert_int_equal(sent - received, receiver->nslots);
+
+		while ((slot = ic_shm_ring_peek(receiver)) != NULL)
+		{
+			uint32		pktno;
+
+			memcpy(&pktno, slot, sizeof(pktno));
+			assert_int_equal(pktno, received);
+			ic_shm_ring_release(receiver);
+			received++;
+		}
+		assert_int_equal(received, sent);
+	}
+}
+
+static void
+test__ic_shm_ring_create__power_of_two(void **state)
+{
+	int			nslots[] = {1, 2, 3, 4, 5, 31, 32, 33, 4096};
+	int			expected[] = {1, 2, 4, 4, 8, 32, 32, 64, 4096};
+
+	for (int i = 0; i < lengthof(nslots); i++)
+	{
+		ICShmRing  *ring;
+
+		ring = ic_shm_ring_create(TEST_RING_NAME, nslots[i], TEST_SLOT_SIZE);
+		assert_true(ring != NULL);
+		assert_int_equal(ring->nslots, expected[i]);
+		assert_true(ring->mapSize >= IC_SHM_RING_HEADER_SIZE +
+					(Size) expected[i] * TEST_SLOT_SIZE);
+		ic_shm_ring_detach(ring, true);
+	}
+}
+
+static void
+test__ic_shm_ring__in_order(void **state)
+{
+	ICShmRing  *receiver;
+	ICShmRing  *sender;
+
+	receiver = create_ring_at(3, 0, &sender);
+	send_and_receive(sender, receiver, 10);
+	ic_shm_ring_detach(sender, false);
+	ic_shm_ring_detach(receiver, true);
+}
+
+/*
+ * The head and the tail wrap around at 2^32 while packets are in flight.
+ * With a ring size that does not divide 2^32, the slots of the packets before
+ * and after the wrap would collide.
+ */
+static void
+test__ic_shm_ring__wraps_around(void **state)
+{
+	int			nslots[] = {1, 3, 5, 8};
+
+	for (int i = 0; i < lengthof(nslots); i++)
+	{
+		ICShmRing  *receiver;
+		ICShmRing  *sender;
+
+		receiver = create_ring_at(nslots[i], PG_UINT32_MAX - 4, &sender);
+		send_and_receive(sender, receiver, 10);
+		assert_true(pg_atomic_read_u32(&receiver->tail) < 100);
+		ic_shm_ring_detach(sender, false);
+		ic_shm_ring_detach(receiver, true);
+	}
+}
+
+int
+main(int argc, char *argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__ic_shm_ring_create__power_of_two),
+		unit_test(test__ic_shm_ring__in_order),
+		unit_test(test__ic_shm_ring__wraps_around),
+	};
+
+	return run_tests(tests);
+}
@@ -17,6 +17,7 @@
 
 #include "access/htup.h"
 #include "access/memtup.h"
+#include "access/tupmacs.h"
 #include "access/tuptoaster.h"
 #include "catalog/pg_type.h"
 #include "cdb/cdbmotion.h"
@@ -39,7 +40,32 @@
  */
 #define RECORD_CACHE_MAGIC_TUPLEN	-1
 
+/*
+ * So is a batch of tuples laid out column by column.  After the "tuple
+ * length" come the number of tuples and of columns, then for each column:
+ *
+ *	- the bitmap of its non-NULL values,
+ *	- for a varlena column, the offsets of the values and one past the last,
+ *	- the values.
+ *
+ * Each of these starts at a MAXALIGN'ed offset from the "tuple length", and
+ * the values of a fixed-width column are typlen apart, with NULLs zeroed, so
+ * the receiver can read them in place.  A varlena with a 4-byte header is
+ * also int aligned.
+ */
+#define BATCH_MAGIC_TUPLEN			-2
+
+/* A batch is sent once it holds this many bytes, even if not full */
+#define TUPLE_BATCH_MAX_BYTES		(256 * 1024)
+
+/* The batch of the broadcast route comes before the ones of the segments */
+#define BatchIndex(route)	((route) == BROADCAST_SEGIDX ? 0 : (route) + 1)
+#define BatchRoute(idx)		((idx) == 0 ? BROADCAST_SEGIDX : (idx) - 1)
+
 static void addByteStringToChunkList(TupleChunkList tcList, char *data, int datalen, TupleChunkListCache *cache);
+static void addBatchSectionToChunkList(TupleChunkList tcList, char *data, int datalen, TupleChunkListCache *cache);
+static TupleBatch *getTupleBatch(SerTupInfo *pSerInfo, int16 targetRoute);
+static void initBatchReader(SerTupInfo *pSerInfo, char *buf, int len);
 
 #define addCharToChunkList(tcList, x, c)							\
 	do															\
@@ -170,6 +196,25 @@ CleanupSerTupInfo(SerTupInfo *pSerInfo)
 
 	pSerInfo->tupdesc = NULL;
 
+	for (int i = 0; i < pSerInfo->nbatches; i++)
+	{
+		TupleBatch *batch = pSerInfo->batches[i];
+
+		if (batch == NULL)
+			continue;
+		/* the columns' buffers go away with the motion layer's context */
+		pfree(batch->cols);
+		pfree(batch);
+	}
+	if (pSerInfo->batches != NULL)
+		pfree(pSerInfo->batches);
+	pSerInfo->batches = NULL;
+	pSerInfo->nbatches = 0;
+
+	if (pSerInfo->reader.buf != NULL)
+		pfree(pSerInfo->reader.buf);
+	pSerInfo->reader.buf = NULL;
+
 	while (pSerInfo->chunkCache.items != NULL)
 	{
 		TupleChunkListItem item;
@@ -342,6 +387,10 @@ CandidateForSerializeDirect(int16 targetRoute, struct directTransportBuffer *b)
  * Convert a HeapTuple into a byte-sequence, and store it directly
  * into a chunklist for transmission.
  *
+ * Returns the length stored into the direct buffer, 0 if the tuple went
+ * into the chunklist instead, or -1 if it only fits into the next packet
+ * of a connection that can flush its buffer early (b->flushlen).
+ *
  * This code is based on the printtup_internal_20() function in printtup.c.
  */
 int
@@ -460,6 +509,14 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 		return dataSize;
 	}
 
+	if (CandidateForSerializeDirect(targetRoute, b) &&
+		tuplen + TUPLE_CHUNK_HEADER_SIZE <= b->flushlen)
+	{
+		if (shouldFreeTuple)
+			pfree(mintuple);
+		return -1;
+	}
+
 	/*
 	 * If direct in-line serialization failed then we fallback to chunked
 	 * out-of-line serialization.
@@ -506,8 +563,319 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 	return 0;
 }
 
+/*
+ * Set up a SerTupInfo to send its tuples in batches of 'batch_size'.
+ *
+ * Tuples with record types stay one by one, as the receiver must remap them
+ * as they come, and so do cstrings, which have no length of their own.
+ */
+void
+InitSerTupBatches(SerTupInfo *pSerInfo, int batch_size)
+{
+	TupleDesc	tupdesc = pSerInfo->tupdesc;
+
+	if (batch_size <= 1 || tupdesc->natts == 0 || pSerInfo->has_record_types)
+		return;
+
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		if (pSerInfo->myinfo[i].typlen == -2)
+			return;
+	}
+
+	pSerInfo->batch_size = batch_size;
+}
+
+/*
+ * Get the batch of a route, creating it if this is the first tuple for it.
+ */
+static TupleBatch *
+getTupleBatch(SerTupInfo *pSerInfo, int16 targetRoute)
+{
+	int			idx = BatchIndex(targetRoute);
+	TupleBatch *batch;
+
+	Assert(idx >= 0);
+
+	if (idx >= pSerInfo->nbatches)
+	{
+		int			newsize = Max(idx + 1, pSerInfo->nbatches * 2);
+
+		if (pSerInfo->batches == NULL)
+			pSerInfo->batches = palloc0(newsize * sizeof(TupleBatch *));
+		else
+		{
+			pSerInfo->batches = repalloc(pSerInfo->batches,
+										 newsize * sizeof(TupleBatch *));
+			memset(pSerInfo->batches + pSerInfo->nbatches, 0,
+				   (newsize - pSerInfo->nbatches) * sizeof(TupleBatch *));
+		}
+		pSerInfo->nbatches = newsize;
+	}
+
+	batch = pSerInfo->batches[idx];
+	if (batch == NULL)
+	{
+		int			natts = pSerInfo->tupdesc->natts;
+
+		batch = palloc(sizeof(TupleBatch));
+		batch->ntuples = 0;
+		batch->nbytes = 0;
+		batch->cols = palloc(natts * sizeof(TupleBatchColumn));
+		for (int i = 0; i < natts; i++)
+		{
+			initStringInfo(&batch->cols[i].nulls);
+			initStringInfo(&batch->cols[i].values);
+			initStringInfo(&batch->cols[i].offsets);
+		}
+		pSerInfo->batches[idx] = batch;
+	}
+
+	return batch;
+}
+
+/*
+ * Add the tuple in a slot to the batch of a route.
+ *
+ * Returns true if the batch is full, and the caller should send it with
+ * SerializeTupleBatch().
+ */
+bool
+AddTupleToBatch(TupleTableSlot *slot, SerTupInfo *pSerInfo, int16 targetRoute)
+{
+	TupleBatch *batch = getTupleBatch(pSerInfo, targetRoute);
+	int			natts = pSerInfo->tupdesc->natts;
+	int			n = batch->ntuples;
+
+	Assert(pSerInfo->batch_size > 0);
+
+	slot_getallattrs(slot);
+
+	for (int i = 0; i < natts; i++)
+	{
+		SerAttrInfo *attrInfo = &pSerInfo->myinfo[i];
+		TupleBatchColumn *col = &batch->cols[i];
+		StringInfo	values = &col->values;
+		Datum		val = slot->tts_values[i];
+		bool		isnull = slot->tts_isnull[i];
+		int			oldlen = values->len;
+
+		/* a new byte of the bitmap every 8 tuples */
+		if (n % BITS_PER_BYTE == 0)
+			appendStringInfoCharMacro(&col->nulls, 0);
+		if (!isnull)
+			col->nulls.data[n / BITS_PER_BYTE] |= 1 << (n % BITS_PER_BYTE);
+
+		if (attrInfo->typlen > 0)
+		{
+			char	   *ptr;
+
+			enlargeStringInfo(values, attrInfo->typlen);
+			ptr = values->data + values->len;
+			if (isnull)
+				memset(ptr, 0, attrInfo->typlen);
+			else if (attrInfo->typbyval)
+				store_att_byval(ptr, val, attrInfo->typlen);
+			else
+				memcpy(ptr, DatumGetPointer(val), attrInfo->typlen);
+			values->len += attrInfo->typlen;
+			values->data[values->len] = '\0';
+		}
+		else
+		{
+			uint32		start;
+
+			Assert(attrInfo->typlen == -1);
+
+			if (isnull)
+				start = values->len;
+			else
+			{
+				struct varlena *v = (struct varlena *) DatumGetPointer(val);
+				bool		shouldFree = false;
+
+				if (VARATT_IS_EXTERNAL(v))
+				{
+					v = heap_tuple_fetch_attr(v);
+					shouldFree = true;
+				}
+
+				if (VARATT_IS_SHORT(v))
+				{
+					start = values->len;
+					appendBinaryStringInfo(values, (char *) v, VARSIZE_SHORT(v));
+				}
+				else if (VARATT_CAN_MAKE_SHORT(v))
+				{
+					/* convert to a short header, as heap_fill_tuple() would */
+					int			len = VARATT_CONVERTED_SHORT_SIZE(v);
+					char	   *ptr;
+
+					enlargeStringInfo(values, len);
+					start = values->len;
+					ptr = values->data + start;
+					SET_VARSIZE_SHORT(ptr, len);
+					memcpy(ptr + 1, VARDATA(v), len - 1);
+					values->len += len;
+					values->data[values->len] = '\0';
+				}
+				else
+				{
+					while (values->len != INTALIGN(values->len))
+						appendStringInfoCharMacro(values, 0);
+					start = values->len;
+					appendBinaryStringInfo(values, (char *) v, VARSIZE(v));
+				}
+
+				if (shouldFree)
+					pfree(v);
+			}
+			appendBinaryStringInfo(&col->offsets, (char *) &start, sizeof(start));
+		}
+
+		batch->nbytes += values->len - oldlen;
+	}
+
+	batch->ntuples++;
+
+	return batch->ntuples >= pSerInfo->batch_size ||
+		batch->nbytes >= TUPLE_BATCH_MAX_BYTES;
+}
+
+/*
+ * Add one part of a batch to a chunk list, at the next MAXALIGN'ed offset.
+ */
+static void
+addBatchSectionToChunkList(TupleChunkList tcList, char *data, int datalen, TupleChunkListCache *chunkCache)
+{
+	static char zeros[MAXIMUM_ALIGNOF];
+	int			pad;
+
+	pad = MAXALIGN(tcList->serialized_data_length) - tcList->serialized_data_length;
+	if (pad > 0)
+		addByteStringToChunkList(tcList, zeros, pad, chunkCache);
+	if (datalen > 0)
+		addByteStringToChunkList(tcList, data, datalen, chunkCache);
+}
+
+/*
+ * Convert the batch of a route into a chunklist for transmission, and empty
+ * the batch.
+ *
+ * Returns the number of tuples in the batch, 0 if there were none and
+ * nothing was serialized.
+ */
+int
+SerializeTupleBatch(SerTupInfo *pSerInfo, int16 targetRoute, TupleChunkList tcList)
+{
+	int			idx = BatchIndex(targetRoute);
+	int			natts = pSerInfo->tupdesc->natts;
+	TupleBatch *batch;
+	TupleChunkListItem tcItem;
+	int32		tupbodylen = BATCH_MAGIC_TUPLEN;
+	int32		ntuples;
+
+	if (idx >= pSerInfo->nbatches || pSerInfo->batches[idx] == NULL)
+		return 0;
+	batch = pSerInfo->batches[idx];
+	ntuples = batch->ntuples;
+	if (ntuples == 0)
+		return 0;
+
+	tcList->p_first = NULL;
+	tcList->p_last = NULL;
+	tcList->num_chunks = 0;
+	tcList->serialized_data_length = 0;
+	tcList->max_chunk_length = Gp_max_tuple_chunk_size;
+
+	tcItem = getChunkFromCache(&pSerInfo->chunkCache);
+	SetChunkType(tcItem->chunk_data, TC_WHOLE);
+	tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE;
+	appendChunkToTCList(tcList, tcItem);
+
+	addInt32ToChunkList(tcList, tupbodylen, &pSerInfo->chunkCache);
+	addInt32ToChunkList(tcList, ntuples, &pSerInfo->chunkCache);
+	addInt32ToChunkList(tcList, natts, &pSerInfo->chunkCache);
+
+	for (int i = 0; i < natts; i++)
+	{
+		TupleBatchColumn *col = &batch->cols[i];
+
+		addBatchSectionToChunkList(tcList, col->nulls.data, col->nulls.len,
+								   &pSerInfo->chunkCache);
+		if (pSerInfo->myinfo[i].typlen == -1)
+		{
+			uint32		end = col->values.len;
+
+			appendBinaryStringInfo(&col->offsets, (char *) &end, sizeof(end));
+			addBatchSectionToChunkList(tcList, col->offsets.data, col->offsets.len,
+									   &pSerInfo->chunkCache);
+		}
+		addBatchSectionToChunkList(tcList, col->values.data, col->values.len,
+								   &pSerInfo->chunkCache);
+
+		resetStringInfo(&col->nulls);
+		resetStringInfo(&col->values);
+		resetStringInfo(&col->offsets);
+	}
+
+	batch->ntuples = 0;
+	batch->nbytes = 0;
+
+	/*
+	 * if we have more than 1 chunk we have to set the chunk types on our
+	 * first chunk and last chunk
+	 */
+	if (tcList->num_chunks > 1)
+	{
+		TupleChunkListItem first,
+					last;
+
+		first = tcList->p_first;
+		last = tcList->p_last;
+
+		Assert(first != NULL);
+		Assert(first != last);
+		Assert(last != NULL);
+
+		SetChunkType(first->chunk_data, TC_PARTIAL_START);
+		SetChunkType(last->chunk_data, TC_PARTIAL_END);
+
+		/*
+		 * any intervening chunks are already set to TC_PARTIAL_MID when
+		 * allocated
+		 */
+	}
+
+	return ntuples;
+}
+
+/*
+ * Find a route that has tuples waiting in its batch, to send them before
+ * the end-of-stream.
+ */
+bool
+GetPendingBatchRoute(SerTupInfo *pSerInfo, int16 *targetRoute)
+{
+	for (int i = 0; i < pSerInfo->nbatches; i++)
+	{
+		TupleBatch *batch = pSerInfo->batches[i];
+
+		if (batch != NULL && batch->ntuples > 0)
+		{
+			*targetRoute = BatchRoute(i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /*
  * Reassemble and deserialize a list of tuple chunks, into a tuple.
+ *
+ * If the chunks carry a batch of tuples, the first one is returned, and
+ * CvtBatchToTup() returns the others.
  */
 MinimalTuple
 CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remapper)
@@ -662,6 +1030,26 @@ CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remap
 
 			return NULL;
 		}
+		else if (tupbodylen == BATCH_MAGIC_TUPLEN)
+		{
+			/*
+			 * A batch of tuples.  The reader hangs on to it until it has
+			 * returned all of them, so it needs a copy of its own if the data
+			 * is still in the receive buffer.  The copy is also MAXALIGN'ed,
+			 * which the layout relies on.
+			 */
+			char	   *buf = serData.data;
+
+			if (!serDataMustFree)
+			{
+				buf = palloc(serData.len);
+				memcpy(buf, serData.data, serData.len);
+			}
+
+			initBatchReader(pSerInfo, buf, serData.len);
+
+			return CvtBatchToTup(pSerInfo);
+		}
 		else
 		{
 			/* A normal MinimalTuple */
@@ -682,3 +1070,141 @@ CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remap
 
 	return tup;
 }
+
+/*
+ * Find the parts of a batch of tuples received in 'buf', and get ready to
+ * return its tuples.  The reader takes over 'buf'.
+ */
+static void
+initBatchReader(SerTupInfo *pSerInfo, char *buf, int len)
+{
+	TupleBatchReader *reader = &pSerInfo->reader;
+	int			natts = pSerInfo->tupdesc->natts;
+	int32		ntuples;
+	int32		batchnatts;
+	Size		pos;
+
+	Assert(reader->buf == NULL);
+
+	if (len < 3 * sizeof(int32))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("tuple batch of %d bytes is too short", len)));
+
+	memcpy(&ntuples, buf + sizeof(int32), sizeof(int32));
+	memcpy(&batchnatts, buf + 2 * sizeof(int32), sizeof(int32));
+	pos = 3 * sizeof(int32);
+
+	if (ntuples <= 0 || ntuples > MaxAllocSize / sizeof(uint32) ||
+		batchnatts != natts)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("malformed tuple batch of %d tuples and %d columns, expected %d columns",
+						ntuples, batchnatts, natts)));
+
+	if (reader->nulls == NULL)
+	{
+		reader->nulls = palloc(natts * sizeof(bits8 *));
+		reader->values = palloc(natts * sizeof(char *));
+		reader->offsets = palloc(natts * sizeof(uint32 *));
+	}
+
+#define BATCH_SECTION(ptr, size) \
+	do { \
+		pos = MAXALIGN(pos); \
+		if (pos + (size) > len) \
+			ereport(ERROR, \
+					(errcode(ERRCODE_PROTOCOL_VIOLATION), \
+					 errmsg("tuple batch is truncated"))); \
+		(ptr) = (void *) (buf + pos); \
+		pos += (size); \
+	} while (0)
+
+	for (int i = 0; i < natts; i++)
+	{
+		int16		typlen = pSerInfo->myinfo[i].typlen;
+
+		BATCH_SECTION(reader->nulls[i], BITMAPLEN(ntuples));
+		if (typlen > 0)
+		{
+			reader->offsets[i] = NULL;
+			BATCH_SECTION(reader->values[i], (Size) ntuples * typlen);
+		}
+		else
+		{
+			BATCH_SECTION(reader->offsets[i], (ntuples + 1) * sizeof(uint32));
+			BATCH_SECTION(reader->values[i], reader->offsets[i][ntuples]);
+		}
+	}
+
+#undef BATCH_SECTION
+
+	reader->buf = buf;
+	reader->ntuples = ntuples;
+	reader->next = 0;
+}
+
+/*
+ * Return the next tuple of the batch that CvtChunksToTup() started to return,
+ * or NULL when there are no more.  The tuples are formed row by row out of
+ * the columns of the batch.
+ */
+MinimalTuple
+CvtBatchToTup(SerTupInfo *pSerInfo)
+{
+	TupleBatchReader *reader = &pSerInfo->reader;
+	int			natts = pSerInfo->tupdesc->natts;
+	MinimalTuple tup;
+	int			t;
+
+	if (reader->buf == NULL)
+		return NULL;
+
+	t = reader->next++;
+
+	for (int i = 0; i < natts; i++)
+	{
+		SerAttrInfo *attrInfo = &pSerInfo->myinfo[i];
+
+		if (att_isnull(t, reader->nulls[i]))
+		{
+			pSerInfo->values[i] = (Datum) 0;
+			pSerInfo->nulls[i] = true;
+			continue;
+		}
+
+		pSerInfo->nulls[i] = false;
+		if (attrInfo->typlen > 0)
+		{
+			char	   *ptr = reader->values[i] + (Size) t * attrInfo->typlen;
+
+			pSerInfo->values[i] = fetch_att(ptr, attrInfo->typbyval, attrInfo->typlen);
+		}
+		else
+		{
+			uint32		start = reader->offsets[i][t];
+			uint32		end = reader->offsets[i][reader->ntuples];
+			char	   *ptr = reader->values[i] + start;
+
+			if (start >= end ||
+				(!VARATT_IS_1B(ptr) && end - start < VARHDRSZ) ||
+				start + VARSIZE_ANY(ptr) > end)
+				ereport(ERROR,
+						(errcode(ERRCODE_PROTOCOL_VIOLATION),
+						 errmsg("malformed value in tuple batch")));
+
+			pSerInfo->values[i] = PointerGetDatum(ptr);
+		}
+	}
+
+	tup = heap_form_minimal_tuple(pSerInfo->tupdesc, pSerInfo->values, pSerInfo->nulls);
+
+	/* That was the last one, the batch can go */
+	if (reader->next >= reader->ntuples)
+	{
+		pfree(reader->buf);
+		reader->buf = NULL;
+	}
+
+	return tup;
+}
@@ -2664,6 +2664,16 @@ ExplainNode(PlanState *planstate, List *ancestors,
 									 "Hash Module: %d\n",
 									 pMotion->numHashSegments);
 				}
+				if (pMotion->hotKeyPolicy != MOTION_HOTKEY_NONE)
+				{
+					int			nhot = list_length(pMotion->hotKeyHashes);
+
+					ExplainPropertyText("Hot Keys",
+										psprintf("%d %s", nhot,
+												 pMotion->hotKeyPolicy == MOTION_HOTKEY_LOCAL ?
+												 "kept local" : "broadcast"),
+										es);
+				}
 			}
 			break;
 		case T_AssertOp:
@@ -19,9 +19,11 @@
 #include "postgres.h"
 
 #include "executor/executor.h"
+#include "executor/nodeHashjoin.h"
 #include "miscadmin.h"
 #include "utils/faultinjector.h"
 #include "utils/memutils.h"
+#include "utils/rel.h"
 
 
 
@@ -183,7 +185,7 @@ ExecScan(ScanState *node,
 	 * If we have neither a qual to check nor a projection to do, just skip
 	 * all the overhead and return the raw scan tuple.
 	 */
-	if (!qual && !projInfo)
+	if (!qual && !projInfo && node->ss_RuntimeFilters == NIL)
 	{
 		ResetExprContext(econtext);
 		return ExecScanFetch(node, accessMtd, recheckMtd);
@@ -224,6 +226,23 @@ ExecScan(ScanState *node,
 		 */
 		econtext->ecxt_scantuple = slot;
 
+		/*
+		 * Drop the tuple if a hash join above knows that it cannot find a
+		 * match.
+		 */
+		if (node->ss_RuntimeFilters != NIL &&
+			!ExecRuntimeFilterPass(node->ss_RuntimeFilters, econtext, slot))
+		{
+#ifdef FAULT_INJECTOR
+			FaultInjector_InjectFaultIfSet("runtime_filter_row_removed",
+										   DDLNotSpecified,
+										   "",	/* databaseName */
+										   RelationGetRelationName(node->ss_currentRelation));	/* tableName */
+#endif
+			ResetExprContext(econtext);
+			continue;
+		}
+
 		/*
 		 * check that the current tuple satisfies the qual-clause
 		 *
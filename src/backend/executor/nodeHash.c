@@ -37,6 +37,7 @@
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/atomics.h"
@@ -209,6 +210,11 @@ MultiExecPrivateHash(HashState *node)
 				ExecHashTableInsert(node, hashtable, slot, hashvalue);
 			}
 			hashtable->totalTuples += 1;
+
+			if (node->hs_runtimeFilter)
+				bloom_add_element(node->hs_runtimeFilter->bloom,
+								  (unsigned char *) &hashvalue,
+								  sizeof(hashvalue));
 		}
 
 		if (hashkeys_null)
@@ -115,8 +115,10 @@
 #include "executor/instrument.h"	/* Instrumentation */
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/sharedtuplestore.h"
 
@@ -163,8 +165,16 @@ static void SpillCurrentBatch(HashJoinState *node);
 static bool ExecHashJoinReloadHashTable(HashJoinState *hjstate);
 static void ExecEagerFreeHashJoin(HashJoinState *node);
 
+static void ExecInitRuntimeFilter(HashJoinState *hjstate, HashJoin *node);
+static ScanState *FindRuntimeFilterScan(PlanState *ps, AttrNumber *attnos,
+										int nkeys);
+static void ExecResetRuntimeFilter(HashState *hashNode);
+
 static inline void SaveWorkFileSetStatsInfo(HashJoinTable hashtable);
 
+/* Don't use a runtime filter with more bits set, too many false positives */
+#define RUNTIME_FILTER_MAX_BITS_SET		0.6
+
 /* ----------------------------------------------------------------
  *		ExecHashJoinImpl
  *
@@ -236,6 +246,13 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 				 */
 				Assert(hashtable == NULL);
 
+				/*
+				 * A runtime filter from an earlier hash table no longer
+				 * applies, not even to the outer tuple we may fetch below.
+				 */
+				if (hashNode->hs_runtimeFilter)
+					ExecResetRuntimeFilter(hashNode);
+
 				/*
 				 * MPP-4165: My fix for MPP-3300 was correct in that we avoided
 				 * the *deadlock* but had very unexpected (and painful)
@@ -350,6 +367,15 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 				hashNode->hashtable = hashtable;
 				(void) MultiExecProcNode((PlanState *) hashNode);
 
+				/*
+				 * The hash values of all inner tuples are in the runtime
+				 * filter now, let the scan use it if it is selective.
+				 */
+				if (hashNode->hs_runtimeFilter && !parallel)
+					hashNode->hs_runtimeFilter->active =
+						bloom_prop_bits_set(hashNode->hs_runtimeFilter->bloom) <=
+						RUNTIME_FILTER_MAX_BITS_SET;
+
 #ifdef HJDEBUG
 				elog(gp_workfile_caching_loglevel, "HashJoin built table with %.1f tuples by executing subplan for batch 0", hashtable->totalTuples);
 #endif
@@ -933,9 +959,260 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->hj_MatchedOuter = false;
 	hjstate->hj_OuterNotEmpty = false;
 
+	if (gp_enable_runtime_filter)
+		ExecInitRuntimeFilter(hjstate, node);
+
 	return hjstate;
 }
 
+/*
+ * Runtime filters
+ *
+ * Once the hash table is built, the hash join knows all the join keys that
+ * an outer tuple can match.  If the outer join keys come unchanged from a
+ * scan in the same slice, the scan can check its tuples against a Bloom
+ * filter of the inner hash values, and drop the ones that cannot find a
+ * match right away, rather than pass them up through the nodes in between.
+ * The filter is not sent across a Motion, so only the joins whose outer rel
+ * is not moved are filtered.  The inner rel may come through a Motion.
+ *
+ * The filter only drops tuples that the join would drop too, so it is only
+ * used by joins that don't emit unmatched outer tuples.  The nodes between
+ * the join and the scan must not emit rows without the outer row of the
+ * scan, or keep rows for a rescan, since the hash table and the filter can
+ * change between scans.
+ */
+static void
+ExecInitRuntimeFilter(HashJoinState *hjstate, HashJoin *node)
+{
+	HashState  *hashNode = (HashState *) innerPlanState(hjstate);
+	RuntimeFilterState *rf;
+	ScanState  *scan;
+	AttrNumber *attnos;
+	int			nkeys = list_length(node->hashkeys);
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			i;
+
+	switch (node->join.jointype)
+	{
+		case JOIN_INNER:
+		case JOIN_RIGHT:
+		case JOIN_SEMI:
+			break;
+		default:
+			return;
+	}
+
+	/* IS NOT DISTINCT FROM joins match NULLs, not worth the trouble */
+	if (hjstate->hj_nonequijoin || node->join.plan.parallel_aware)
+		return;
+
+	attnos = palloc(nkeys * sizeof(AttrNumber));
+	i = 0;
+	foreach(lc, node->hashkeys)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+
+		while (IsA(expr, RelabelType))
+			expr = ((RelabelType *) expr)->arg;
+
+		if (!IsA(expr, Var) || ((Var *) expr)->varno != OUTER_VAR)
+		{
+			pfree(attnos);
+			return;
+		}
+		attnos[i++] = ((Var *) expr)->varattno;
+	}
+
+	scan = FindRuntimeFilterScan(outerPlanState(hjstate), attnos, nkeys);
+	if (!scan)
+	{
+		pfree(attnos);
+		return;
+	}
+
+	rf = palloc0(sizeof(RuntimeFilterState));
+	rf->nkeys = nkeys;
+	rf->scanattnos = attnos;
+	rf->hashfunctions = palloc(nkeys * sizeof(FmgrInfo));
+	rf->collations = palloc(nkeys * sizeof(Oid));
+	rf->hashStrict = palloc(nkeys * sizeof(bool));
+
+	/* The same outer hash functions as ExecHashTableCreate() looks up */
+	i = 0;
+	forboth(lc, node->hashoperators, lc2, node->hashcollations)
+	{
+		Oid			hashop = lfirst_oid(lc);
+		Oid			left_hashfn;
+		Oid			right_hashfn;
+
+		if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 hashop);
+		fmgr_info(left_hashfn, &rf->hashfunctions[i]);
+		rf->collations[i] = lfirst_oid(lc2);
+		rf->hashStrict[i] = op_strict(hashop);
+		i++;
+	}
+
+	hashNode->hs_runtimeFilter = rf;
+	scan->ss_RuntimeFilters = lappend(scan->ss_RuntimeFilters, rf);
+}
+
+/*
+ * Find the scan that the outer join keys come from.  'attnos' are the
+ * attribute numbers of the keys in the output of 'ps', and are replaced with
+ * their attribute numbers in the scan tuple.  The search ends at a Motion,
+ * since the scans below it run in another slice.
+ */
+static ScanState *
+FindRuntimeFilterScan(PlanState *ps, AttrNumber *attnos, int nkeys)
+{
+	for (;;)
+	{
+		Plan	   *plan = ps->plan;
+		PlanState  *next;
+		Index		varno;
+
+		switch (nodeTag(plan))
+		{
+			case T_SeqScan:
+			case T_IndexScan:
+			case T_BitmapHeapScan:
+				varno = ((Scan *) plan)->scanrelid;
+				next = NULL;
+				break;
+
+			case T_HashJoin:
+			case T_NestLoop:
+			case T_MergeJoin:
+				/* each output row has an outer row, with the same keys */
+				switch (((Join *) plan)->jointype)
+				{
+					case JOIN_INNER:
+					case JOIN_LEFT:
+					case JOIN_SEMI:
+					case JOIN_ANTI:
+					case JOIN_LASJ_NOTIN:
+						break;
+					default:
+						return NULL;
+				}
+				varno = OUTER_VAR;
+				next = outerPlanState(ps);
+				break;
+
+			default:
+				return NULL;
+		}
+
+		for (int i = 0; i < nkeys; i++)
+		{
+			TargetEntry *tle;
+			Expr	   *expr;
+
+			if (attnos[i] < 1 || attnos[i] > list_length(plan->targetlist))
+				return NULL;
+			tle = (TargetEntry *) list_nth(plan->targetlist, attnos[i] - 1);
+			expr = tle->expr;
+
+			while (IsA(expr, RelabelType))
+				expr = ((RelabelType *) expr)->arg;
+
+			if (!IsA(expr, Var) ||
+				((Var *) expr)->varno != varno ||
+				((Var *) expr)->varattno < 1)
+				return NULL;
+			attnos[i] = ((Var *) expr)->varattno;
+		}
+
+		if (next == NULL)
+			return (ScanState *) ps;
+		ps = next;
+	}
+}
+
+/*
+ * Start a new, empty, runtime filter for the hash table to be built.
+ */
+static void
+ExecResetRuntimeFilter(HashState *hashNode)
+{
+	RuntimeFilterState *rf = hashNode->hs_runtimeFilter;
+	MemoryContext oldcxt;
+
+	rf->active = false;
+	if (rf->bloom)
+		bloom_free(rf->bloom);
+
+	oldcxt = MemoryContextSwitchTo(hashNode->ps.state->es_query_cxt);
+	rf->bloom = bloom_create(Max((int64) hashNode->ps.plan->plan_rows, 1),
+							 work_mem, 0);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Does a scan tuple pass the active runtime filters?  The hash value of its
+ * join keys is computed the same way as ExecHashGetHashValue() does for an
+ * outer tuple.
+ */
+bool
+ExecRuntimeFilterPass(List *filters, ExprContext *econtext,
+					  TupleTableSlot *slot)
+{
+	MemoryContext oldContext;
+	ListCell   *lc;
+	bool		pass = true;
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	foreach(lc, filters)
+	{
+		RuntimeFilterState *rf = (RuntimeFilterState *) lfirst(lc);
+		uint32		hashkey = 0;
+
+		if (!rf->active)
+			continue;
+
+		for (int i = 0; i < rf->nkeys; i++)
+		{
+			Datum		keyval;
+			bool		isNull;
+
+			/* rotate hashkey left 1 bit at each step */
+			hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+			keyval = slot_getattr(slot, rf->scanattnos[i], &isNull);
+			if (isNull)
+			{
+				/* can't match a strict join operator */
+				if (rf->hashStrict[i])
+				{
+					pass = false;
+					break;
+				}
+			}
+			else
+				hashkey ^= DatumGetUInt32(FunctionCall1Coll(&rf->hashfunctions[i],
+															rf->collations[i],
+															keyval));
+		}
+
+		if (pass &&
+			bloom_lacks_element(rf->bloom, (unsigned char *) &hashkey,
+								sizeof(hashkey)))
+			pass = false;
+
+		if (!pass)
+			break;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return pass;
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndHashJoin
  *
@@ -21,6 +21,7 @@
 #include "cdb/cdbutil.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbhash.h"
+#include "cdb/ml_ipc.h"
 #include "executor/executor.h"
 #include "executor/execdebug.h"
 #include "executor/execUtils.h"
@@ -28,6 +29,7 @@
 #include "lib/binaryheap.h"
 #include "utils/tuplesort.h"
 #include "miscadmin.h"
+#include "utils/faultinjector.h"
 #include "utils/memutils.h"
 
 
@@ -54,9 +56,16 @@ static TupleTableSlot *execMotionSortedReceiver(MotionState *node);
 
 static int	CdbMergeComparator(Datum lhs, Datum rhs, void *context);
 static uint32 evalHashKey(ExprContext *econtext, List *hashkeys, CdbHash *h);
+static int	cmp_hot_key_hash(const void *a, const void *b);
 
 static void doSendEndOfStream(Motion *motion, MotionState *node);
+static void ExecMotionExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 static void doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot);
+static void doAddToHashBatch(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot);
+static void doSendHashBatch(Motion *motion, MotionState *node);
+static int16 hotKeyRoute(Motion *motion, MotionState *node, uint32 hash, int16 targetRoute);
+static void sendTupleToRoute(Motion *motion, MotionState *node, TupleTableSlot *slot,
+							 int16 targetRoute);
 
 
 /*=========================================================================
@@ -247,7 +256,11 @@ execMotionSender(MotionState *node)
 
 		if (done || TupIsNull(outerTupleSlot))
 		{
-			doSendEndOfStream(motion, node);
+			/* the tuples still waiting in a batch go before the end-of-stream */
+			if (node->hashBatchCount > 0)
+				doSendHashBatch(motion, node);
+			if (!node->stopRequested)
+				doSendEndOfStream(motion, node);
 			done = true;
 		}
 		else if (motion->motionType == MOTIONTYPE_GATHER_SINGLE &&
@@ -261,8 +274,11 @@ execMotionSender(MotionState *node)
 		}
 		else
 		{
-			doSendTuple(motion, node, outerTupleSlot);
-			/* doSendTuple() may have set node->stopRequested as a side-effect */
+			if (node->hashBatchSize > 0)
+				doAddToHashBatch(motion, node, outerTupleSlot);
+			else
+				doSendTuple(motion, node, outerTupleSlot);
+			/* sending may have set node->stopRequested as a side-effect */
 
 			if (node->stopRequested)
 			{
@@ -770,6 +786,14 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 	motionstate->stopRequested = false;
 	motionstate->numInputSegs = list_length(sendSlice->segments);
 
+	/* The receiver reports the interconnect statistics for EXPLAIN ANALYZE */
+	if (motionstate->mstype == MOTIONSTATE_RECV &&
+		(estate->es_instrument & INSTRUMENT_CDB))
+	{
+		motionstate->ps.cdbexplainbuf = makeStringInfo();
+		motionstate->ps.cdbexplainfun = ExecMotionExplainEnd;
+	}
+
 	/*
 	 * Miscellaneous initialization
 	 *
@@ -820,6 +844,44 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 		motionstate->cdbhash = makeCdbHash(motionstate->numHashSegments,
 										   nkeys,
 										   node->hashFuncs);
+
+		/*
+		 * Hot keys of a hybrid redistribution, sorted for binary search.
+		 */
+		if (node->hotKeyPolicy != MOTION_HOTKEY_NONE)
+		{
+			ListCell   *lc;
+			int			i = 0;
+
+			motionstate->numHotKeyHashes = list_length(node->hotKeyHashes);
+			motionstate->hotKeyHashes = palloc(motionstate->numHotKeyHashes * sizeof(uint32));
+			foreach(lc, node->hotKeyHashes)
+				motionstate->hotKeyHashes[i++] = (uint32) lfirst_int(lc);
+			qsort(motionstate->hotKeyHashes, motionstate->numHotKeyHashes,
+				  sizeof(uint32), cmp_hot_key_hash);
+		}
+
+		/*
+		 * Hash the keys of gp_motion_hash_batch_size tuples at a time, see
+		 * doSendHashBatch().  Without keys, the tuples go to random segments
+		 * and there is nothing to hash.
+		 */
+		if (nkeys > 0 && gp_motion_hash_batch_size > 1)
+		{
+			int			n = gp_motion_hash_batch_size;
+
+			motionstate->hashBatchSize = n;
+			motionstate->hashBatchCount = 0;
+			motionstate->hashBatchSlots = palloc(n * sizeof(TupleTableSlot *));
+			for (int i = 0; i < n; i++)
+				motionstate->hashBatchSlots[i] =
+					ExecAllocTableSlot(&estate->es_tupleTable, tupDesc,
+									   &TTSOpsMinimalTuple);
+			motionstate->hashBatchValues = palloc(n * sizeof(Datum));
+			motionstate->hashBatchNulls = palloc(n * sizeof(bool));
+			motionstate->hashBatchHashes = palloc(n * sizeof(uint32));
+			motionstate->hashBatchSegs = palloc(n * sizeof(unsigned int));
+		}
 	}
 
 	/*
@@ -1048,6 +1110,22 @@ CdbMergeComparator(Datum lhs, Datum rhs, void *context)
 	return 0;
 }								/* CdbMergeComparator */
 
+/*
+ * qsort/bsearch comparator for the hot key hashes of a hybrid redistribution.
+ */
+static int
+cmp_hot_key_hash(const void *a, const void *b)
+{
+	uint32		ha = *(const uint32 *) a;
+	uint32		hb = *(const uint32 *) b;
+
+	if (ha < hb)
+		return -1;
+	if (ha > hb)
+		return 1;
+	return 0;
+}
+
 /*
  * Experimental code that will be replaced later with new hashing mechanism
  */
@@ -1119,6 +1197,52 @@ doSendEndOfStream(Motion *motion, MotionState *node)
 	node->sentEndOfStream = true;
 }
 
+/*
+ * ExecMotionExplainEnd
+ *      Called before ExecutorEnd to report what the receiver saw of the
+ *      interconnect for EXPLAIN ANALYZE.
+ *
+ * The packet counts are only shown if some packets came out of order,
+ * duplicated or were dropped, a healthy network has nothing to report.  The
+ * EXPLAIN ANALYZE statistics of a Motion node come from its receiving slice,
+ * so the sender's view of the connections is only kept in the history of
+ * gp_toolkit.gp_interconnect_connections.
+ */
+static void
+ExecMotionExplainEnd(PlanState *planstate, struct StringInfoData *buf)
+{
+	MotionState *node = (MotionState *) planstate;
+	Motion	   *motion = (Motion *) planstate->plan;
+	MotionTransportStats stats;
+
+	if (!GetMotionTransportStats(node->ps.state->interconnect_context,
+								 motion->motionID, &stats))
+		return;
+
+	if (stats.worstAnomalies > 0)
+	{
+		appendStringInfo(node->ps.cdbexplainbuf,
+						 "Interconnect: " UINT64_FORMAT " packets received from %d senders, "
+						 UINT64_FORMAT " out of order, " UINT64_FORMAT " duplicated, "
+						 UINT64_FORMAT " dropped; receive queue avg %.1f max %d packets.",
+						 stats.packets, stats.nconns,
+						 stats.disordered, stats.duplicated, stats.dropped,
+						 stats.queueSamples > 0 ?
+						 (double) stats.totalQueueSize / stats.queueSamples : 0.0,
+						 stats.maxQueueSize);
+		appendStringInfo(node->ps.cdbexplainbuf,
+						 " Most of them from seg%d (" UINT64_FORMAT ").\n",
+						 stats.worstContentId, stats.worstAnomalies);
+	}
+
+	if (stats.compressPkts > 0)
+		appendStringInfo(node->ps.cdbexplainbuf,
+						 "Interconnect compression: " UINT64_FORMAT " packets, %.0fkB received as %.0fkB.\n",
+						 stats.compressPkts,
+						 (double) stats.compressRawBytes / 1024.0,
+						 (double) stats.compressWireBytes / 1024.0);
+}
+
 /*
  * A crufty confusing part of the current code is how contentId is used within
  * the motion structures and then how that gets translated to targetRoutes by
@@ -1148,7 +1272,6 @@ void
 doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 {
 	int16		targetRoute;
-	SendReturnCode sendRC;
 	ExprContext *econtext = node->ps.ps_ExprContext;
 
 	/* We got a tuple from the child-plan. */
@@ -1199,6 +1322,14 @@ doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 		 * is passed around our system a fair amount!).
 		 */
 		Assert(targetRoute != BROADCAST_SEGIDX);
+
+		/*
+		 * The hash is still the one of the whole key, evalHashKey() leaves
+		 * it in the CdbHash.
+		 */
+		if (node->numHotKeyHashes > 0)
+			targetRoute = hotKeyRoute(motion, node, node->cdbhash->hash,
+									  targetRoute);
 	}
 	else if (motion->motionType == MOTIONTYPE_EXPLICIT)
 	{
@@ -1214,6 +1345,129 @@ doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 	else
 		elog(ERROR, "unknown motion type %d", motion->motionType);
 
+	sendTupleToRoute(motion, node, outerTupleSlot, targetRoute);
+}
+
+/*
+ * Add a tuple to the batch of a redistribute motion, and send the batch out
+ * once it is full.
+ */
+static void
+doAddToHashBatch(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
+{
+	Assert(motion->motionType == MOTIONTYPE_HASH);
+
+	/* We got a tuple from the child-plan. */
+	node->numTuplesFromChild++;
+
+	/* the child may reuse its slot for the next tuple */
+	ExecCopySlot(node->hashBatchSlots[node->hashBatchCount], outerTupleSlot);
+	node->hashBatchCount++;
+
+	if (node->hashBatchCount == node->hashBatchSize)
+		doSendHashBatch(motion, node);
+}
+
+/*
+ * Hash the keys of the tuples in the batch of a redistribute motion, and send
+ * the tuples out in the order they came from the child.
+ *
+ * The hash expressions are evaluated one key column at a time over the whole
+ * batch, into an array that cdbhashbatch() hashes in a loop specialized for
+ * the type of the column.  The segments are the same that evalHashKey() picks
+ * one tuple at a time.
+ */
+static void
+doSendHashBatch(Motion *motion, MotionState *node)
+{
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	CdbHash    *h = node->cdbhash;
+	int			n = node->hashBatchCount;
+	MemoryContext oldContext;
+	ListCell   *hk;
+	int			attno;
+
+	SIMPLE_FAULT_INJECTOR("motion_hash_batch");
+
+	ResetExprContext(econtext);
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	cdbhashbatchinit(h, node->hashBatchHashes, n);
+
+	attno = 1;
+	foreach(hk, node->hashExprs)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(hk);
+
+		for (int i = 0; i < n; i++)
+		{
+			econtext->ecxt_outertuple = node->hashBatchSlots[i];
+			node->hashBatchValues[i] = ExecEvalExpr(keyexpr, econtext,
+													&node->hashBatchNulls[i]);
+		}
+		cdbhashbatch(h, attno, node->hashBatchValues, node->hashBatchNulls,
+					 node->hashBatchHashes, n);
+		attno++;
+	}
+
+	cdbhashreducebatch(h, node->hashBatchHashes, node->hashBatchSegs, n);
+
+	MemoryContextSwitchTo(oldContext);
+
+	node->hashBatchCount = 0;
+
+	for (int i = 0; i < n && !node->stopRequested; i++)
+	{
+		int16		targetRoute = node->hashBatchSegs[i];
+
+		Assert(targetRoute < node->numHashSegments &&
+			   "redistribute destination outside segment array");
+
+		if (node->numHotKeyHashes > 0)
+			targetRoute = hotKeyRoute(motion, node, node->hashBatchHashes[i],
+									  targetRoute);
+
+		sendTupleToRoute(motion, node, node->hashBatchSlots[i], targetRoute);
+	}
+}
+
+/*
+ * A hot key of a hybrid redistribution either stays on this segment, or goes
+ * to all of them.  Return the route for a tuple whose key has the given hash,
+ * targetRoute if the key is not hot.
+ */
+static int16
+hotKeyRoute(Motion *motion, MotionState *node, uint32 hash, int16 targetRoute)
+{
+	if (bsearch(&hash, node->hotKeyHashes, node->numHotKeyHashes,
+				sizeof(uint32), cmp_hot_key_hash) == NULL)
+		return targetRoute;
+
+	if (motion->hotKeyPolicy == MOTION_HOTKEY_BROADCAST)
+		return BROADCAST_SEGIDX;
+
+	/*
+	 * The route of a hash motion is the contentid.  If this segment is not
+	 * among the receivers, the hashed route is as good as any other, the hot
+	 * inner rows are on all of them.
+	 */
+	if (GpIdentity.segindex >= 0 &&
+		GpIdentity.segindex < node->numHashSegments)
+		return GpIdentity.segindex;
+
+	return targetRoute;
+}
+
+/*
+ * Send a tuple of the child-plan to a route.
+ */
+static void
+sendTupleToRoute(Motion *motion, MotionState *node, TupleTableSlot *slot,
+				 int16 targetRoute)
+{
+	SendReturnCode sendRC;
+
 	CheckAndSendRecordCache(node->ps.state->motionlayer_context,
 							node->ps.state->interconnect_context,
 							motion->motionID,
@@ -1223,7 +1477,7 @@ doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 	sendRC = SendTuple(node->ps.state->motionlayer_context,
 					   node->ps.state->interconnect_context,
 					   motion->motionID,
-					   outerTupleSlot,
+					   slot,
 					   targetRoute);
 
 	Assert(sendRC == SEND_COMPLETE || sendRC == STOP_SENDING);
@@ -1242,7 +1496,7 @@ doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 						 motion->motionID,
 						 targetRoute,
 						 node->numTuplesToAMS);
-		formatTuple(&buf, outerTupleSlot, node->outputFunArray);
+		formatTuple(&buf, slot, node->outputFunArray);
 		elog(DEBUG3, "%s", buf.data);
 		pfree(buf.data);
 	}
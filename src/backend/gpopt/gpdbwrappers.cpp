@@ -48,6 +48,7 @@ extern "C" {
 #include "storage/lmgr.h"
 #include "utils/fmgroids.h"
 #include "utils/memutils.h"
+#include "utils/orcamdcache.h"
 #include "utils/partcache.h"
 }
 #define GP_WRAP_START                                            \
@@ -2236,6 +2237,17 @@ gpdb::EvaluateExpr(Expr *expr, Oid result_type, int32 typmod)
 	return nullptr;
 }
 
+List *
+gpdb::EvaluateExprs(List *exprs)
+{
+	GP_WRAP_START;
+	{
+		return evaluate_expr_list(exprs);
+	}
+	GP_WRAP_END;
+	return NIL;
+}
+
 char *
 gpdb::DefGetString(DefElem *defelem)
 {
@@ -2410,6 +2422,57 @@ gpdb::MDCacheNeedsReset(void)
 	return true;
 }
 
+bool
+gpdb::SharedMDCacheEnabled(void)
+{
+	// no GP_WRAP_START/END needed here, it cannot throw an ereport()
+	return OrcaMDCacheEnabled();
+}
+
+uint64
+gpdb::SharedMDCacheBeginFetch(void)
+{
+	GP_WRAP_START;
+	{
+		return OrcaMDCacheBeginFetch();
+	}
+	GP_WRAP_END;
+
+	return 0;
+}
+
+const void *
+gpdb::SharedMDCacheLookup(const char *key, Size *len)
+{
+	GP_WRAP_START;
+	{
+		return OrcaMDCacheLookup(key, len);
+	}
+	GP_WRAP_END;
+
+	return nullptr;
+}
+
+void
+gpdb::SharedMDCacheRelease(void)
+{
+	// no GP_WRAP_START/END needed here, it cannot throw an ereport()
+	OrcaMDCacheRelease();
+}
+
+bool
+gpdb::SharedMDCacheInsert(const char *key, uint64 version, const void *data,
+						  Size len)
+{
+	GP_WRAP_START;
+	{
+		return OrcaMDCacheInsert(key, version, data, len);
+	}
+	GP_WRAP_END;
+
+	return false;
+}
+
 // returns true if a query cancel is requested in GPDB
 bool
 gpdb::IsAbortRequested(void)
@@ -16,7 +16,12 @@
 
 extern "C" {
 #include "postgres.h"
+
+#include "utils/orcamdcache.h"
 }
+#include "gpos/common/CAutoP.h"
+
+#include "gpopt/gpdbwrappers.h"
 #include "gpopt/mdcache/CMDAccessor.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
@@ -35,15 +40,104 @@ CMDProviderRelcache::GetMDObjDXLStr(CMemoryPool *mp, CMDAccessor *md_accessor,
 	return nullptr;
 }
 
+// build the shared metadata cache key of an mdid, i.e. the narrow string
+// form of the mdid, which the cache qualifies with the current database;
+// returns false if the mdid cannot be used as a key
+static BOOL
+BuildSharedMDCacheKey(IMDId *mdid, CHAR *key)
+{
+	// CTAS objects have a fixed mdid but a different schema for every
+	// query, so they cannot be shared
+	if (IMDId::EmdidGPDBCtas == mdid->MdidType())
+	{
+		return false;
+	}
+
+	const WCHAR *wsz = mdid->GetBuffer();
+	ULONG ul = 0;
+	for (; L'\0' != wsz[ul]; ul++)
+	{
+		// mdids are plain ASCII
+		if (ORCA_MDCACHE_KEYLEN - 1 == ul || 0x7f < wsz[ul])
+		{
+			return false;
+		}
+		key[ul] = (CHAR) wsz[ul];
+	}
+	key[ul] = '\0';
+
+	return true;
+}
+
+// parse an object found in the shared metadata cache; the object stays
+// pinned in shared memory until we are done parsing it
+static IMDCacheObject *
+RetrieveFromSharedMDCache(CMemoryPool *mp, const CHAR *key)
+{
+	Size len = 0;
+	const void *data = gpdb::SharedMDCacheLookup(key, &len);
+	if (nullptr == data)
+	{
+		return nullptr;
+	}
+
+	IMDCacheObject *md_obj = nullptr;
+	GPOS_TRY
+	{
+		CWStringConst dxl_str((const WCHAR *) data);
+		md_obj = CDXLUtils::ParseDXLToIMDIdCacheObj(mp, &dxl_str,
+													nullptr /* XSD path */);
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		gpdb::SharedMDCacheRelease();
+		GPOS_RETHROW(ex);
+	}
+	GPOS_CATCH_END;
+
+	gpdb::SharedMDCacheRelease();
+
+	return md_obj;
+}
+
 // return the requested metadata object
 IMDCacheObject *
 CMDProviderRelcache::GetMDObj(CMemoryPool *mp, CMDAccessor *md_accessor,
 							  IMDId *mdid, IMDCacheObject::Emdtype mdtype) const
 {
+	CHAR key[ORCA_MDCACHE_KEYLEN];
+	BOOL use_shared_cache =
+		gpdb::SharedMDCacheEnabled() && BuildSharedMDCacheKey(mdid, key);
+
+	// before translating the object from the catalogs, check whether another
+	// backend has already done so
+	uint64 version = 0;
+	if (use_shared_cache)
+	{
+		IMDCacheObject *md_obj = RetrieveFromSharedMDCache(mp, key);
+		if (nullptr != md_obj)
+		{
+			return md_obj;
+		}
+
+		version = gpdb::SharedMDCacheBeginFetch();
+	}
+
 	IMDCacheObject *md_obj =
 		CTranslatorRelcacheToDXL::RetrieveObject(mp, md_accessor, mdid, mdtype);
 	GPOS_ASSERT(nullptr != md_obj);
 
+	if (use_shared_cache)
+	{
+		// publish the serialized object for other backends
+		CAutoP<CWStringDynamic> dxl_str(CDXLUtils::SerializeMDObj(
+			mp, md_obj, true /*serialize_document_header_footer*/,
+			false /*indentation*/));
+		gpdb::SharedMDCacheInsert(
+			key, version, dxl_str->GetBuffer(),
+			(dxl_str->Length() + 1) * GPOS_SIZEOF(WCHAR));
+	}
+
 	return md_obj;
 }
 
@@ -1745,8 +1745,8 @@ CTranslatorDXLToPlStmt::TranslateDXLTvfToRangeTblEntry(
 			CDXLScalarProjElem::Cast(proj_elem_dxlnode->GetOperator());
 
 		CHAR *col_name_char_array =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-				dxl_proj_elem->GetMdNameAlias()->GetMDName()->GetBuffer());
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+				dxl_proj_elem->GetMdNameAlias());
 
 		Value *val_colname = gpdb::MakeStringValue(col_name_char_array);
 		alias->colnames = gpdb::LAppend(alias->colnames, val_colname);
@@ -1883,8 +1883,8 @@ CTranslatorDXLToPlStmt::TranslateDXLValueScanToRangeTblEntry(
 			CDXLScalarProjElem::Cast(proj_elem_dxlnode->GetOperator());
 
 		CHAR *col_name_char_array =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-				dxl_proj_elem->GetMdNameAlias()->GetMDName()->GetBuffer());
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+				dxl_proj_elem->GetMdNameAlias());
 
 		Value *val_colname = gpdb::MakeStringValue(col_name_char_array);
 		alias->colnames = gpdb::LAppend(alias->colnames, val_colname);
@@ -2540,6 +2540,11 @@ CTranslatorDXLToPlStmt::TranslateDXLMotion(
 			motion->numHashSegments =
 				(int) motion_dxlop->GetOutputSegIdsArray()->Size();
 			GPOS_ASSERT(motion->numHashSegments > 0);
+
+			// hybrid redistribution of skewed join keys is only planned by
+			// the Postgres planner, see gp_enable_hybrid_redistribute
+			motion->hotKeyPolicy = MOTION_HOTKEY_NONE;
+			motion->hotKeyHashes = NIL;
 			break;
 		}
 		case EdxlopPhysicalMotionBroadcast:
@@ -3534,10 +3539,8 @@ SetupAliasParameter(const BOOL will_require_result_node,
 			GPOS_ASSERT(1 == proj_elem_dxlnode->Arity());
 
 			te->resname =
-				CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-					sc_proj_elem_dxlop->GetMdNameAlias()
-						->GetMDName()
-						->GetBuffer());
+				CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+					sc_proj_elem_dxlop->GetMdNameAlias());
 			ul++;
 		}
 	}
@@ -3940,8 +3943,8 @@ CTranslatorDXLToPlStmt::TranslateDXLAppend(
 		TargetEntry *target_entry = MakeNode(TargetEntry);
 		target_entry->expr = (Expr *) var;
 		target_entry->resname =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-				sc_proj_elem_dxlop->GetMdNameAlias()->GetMDName()->GetBuffer());
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+				sc_proj_elem_dxlop->GetMdNameAlias());
 		target_entry->resno = attno;
 
 		// add column mapping to output translation context
@@ -4143,8 +4146,8 @@ CTranslatorDXLToPlStmt::TranslateDXLCTEConsumerToSharedScan(
 			gpdb::MakeVar(OUTER_VAR, (AttrNumber)(ul + 1), oid_type,
 						  sc_ident_dxlop->TypeModifier(), 0 /* varlevelsup */);
 
-		CHAR *resname = CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-			sc_proj_elem_dxlop->GetMdNameAlias()->GetMDName()->GetBuffer());
+		CHAR *resname = CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+			sc_proj_elem_dxlop->GetMdNameAlias());
 		TargetEntry *target_entry = gpdb::MakeTargetEntry(
 			(Expr *) var, (AttrNumber)(ul + 1), resname, false /* resjunk */);
 		plan->targetlist = gpdb::LAppend(plan->targetlist, target_entry);
@@ -5225,8 +5228,8 @@ CTranslatorDXLToPlStmt::ProcessDXLTblDescr(
 	alias->colnames = NIL;
 
 	// get table alias
-	alias->aliasname = CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-		table_descr->MdName()->GetMDName()->GetBuffer());
+	alias->aliasname = CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+		table_descr->MdName());
 
 	// get column names
 	INT last_attno = 0;
@@ -5249,8 +5252,8 @@ CTranslatorDXLToPlStmt::ProcessDXLTblDescr(
 
 			// non-system attribute
 			CHAR *col_name_char_array =
-				CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-					dxl_col_descr->MdName()->GetMDName()->GetBuffer());
+				CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+					dxl_col_descr->MdName());
 			Value *val_colname = gpdb::MakeStringValue(col_name_char_array);
 
 			alias->colnames = gpdb::LAppend(alias->colnames, val_colname);
@@ -5380,8 +5383,8 @@ CTranslatorDXLToPlStmt::TranslateDXLProjList(
 		TargetEntry *target_entry = MakeNode(TargetEntry);
 		target_entry->expr = expr;
 		target_entry->resname =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-				sc_proj_elem_dxlop->GetMdNameAlias()->GetMDName()->GetBuffer());
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+				sc_proj_elem_dxlop->GetMdNameAlias());
 		target_entry->resno = (AttrNumber)(ul + 1);
 
 		if (IsA(expr, Var))
@@ -5516,9 +5519,9 @@ CTranslatorDXLToPlStmt::CreateTargetListWithNullsForDroppedCols(
 			last_tgt_elem++;
 		}
 
+		CMDName md_colname = md_col->Mdname();
 		CHAR *name_str =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-				md_col->Mdname().GetMDName()->GetBuffer());
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(&md_colname);
 		TargetEntry *te_new =
 			gpdb::MakeTargetEntry(expr, resno, name_str, false /*resjunk*/);
 		result_list = gpdb::LAppend(result_list, te_new);
@@ -5591,8 +5594,8 @@ CTranslatorDXLToPlStmt::TranslateDXLProjectListToHashTargetList(
 		var->varnoold = idx_varnoold;
 		var->varoattno = attno_old;
 
-		CHAR *resname = CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-			sc_proj_elem_dxlop->GetMdNameAlias()->GetMDName()->GetBuffer());
+		CHAR *resname = CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+			sc_proj_elem_dxlop->GetMdNameAlias());
 
 		TargetEntry *target_entry =
 			gpdb::MakeTargetEntry((Expr *) var, (AttrNumber)(ul + 1), resname,
@@ -6263,14 +6266,14 @@ CTranslatorDXLToPlStmt::TranslateDXLPhyCtasToIntoClause(
 										   ? RELPERSISTENCE_TEMP
 										   : RELPERSISTENCE_PERMANENT;
 	into_clause->rel->relname =
-		CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-			phy_ctas_dxlop->MdName()->GetMDName()->GetBuffer());
+		CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+			phy_ctas_dxlop->MdName());
 	into_clause->rel->schemaname = nullptr;
 	if (nullptr != phy_ctas_dxlop->GetMdNameSchema())
 	{
 		into_clause->rel->schemaname =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-				phy_ctas_dxlop->GetMdNameSchema()->GetMDName()->GetBuffer());
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+				phy_ctas_dxlop->GetMdNameSchema());
 	}
 
 	CDXLCtasStorageOptions *dxl_ctas_storage_option =
@@ -6278,11 +6281,9 @@ CTranslatorDXLToPlStmt::TranslateDXLPhyCtasToIntoClause(
 	if (nullptr != dxl_ctas_storage_option->GetMdNameTableSpace())
 	{
 		into_clause->tableSpaceName =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(
 				phy_ctas_dxlop->GetDxlCtasStorageOption()
-					->GetMdNameTableSpace()
-					->GetMDName()
-					->GetBuffer());
+					->GetMdNameTableSpace());
 	}
 
 	into_clause->onCommit =
@@ -6300,8 +6301,8 @@ CTranslatorDXLToPlStmt::TranslateDXLPhyCtasToIntoClause(
 		const CDXLColDescr *dxl_col_descr = (*dxl_col_descr_array)[ul];
 
 		CHAR *col_name_char_array =
-			CTranslatorUtils::CreateMultiByteCharStringFromWCString(
-				dxl_col_descr->MdName()->GetMDName()->GetBuffer());
+			CTranslatorUtils::CreateMultiByteCharStringFromMDName(
+				dxl_col_descr->MdName());
 
 		ColumnDef *col_def = MakeNode(ColumnDef);
 		col_def->colname = col_name_char_array;
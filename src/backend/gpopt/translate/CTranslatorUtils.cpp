@@ -1910,6 +1910,34 @@ CTranslatorUtils::CreateMultiByteCharStringFromWCString(const WCHAR *wcstr)
 	return str;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorUtils::CreateMultiByteCharStringFromMDName
+//
+//	@doc:
+//		Converts a metadata name into a character array; names that were
+//		created from a multi-byte string are copied without conversion
+//
+//---------------------------------------------------------------------------
+CHAR *
+CTranslatorUtils::CreateMultiByteCharStringFromMDName(const CMDName *mdname)
+{
+	GPOS_ASSERT(nullptr != mdname);
+
+	const CStringConst *utf8_name = mdname->GetMDNameUtf8();
+	if (nullptr == utf8_name)
+	{
+		return CreateMultiByteCharStringFromWCString(
+			mdname->GetMDName()->GetBuffer());
+	}
+
+	ULONG len = utf8_name->Length() + 1;
+	CHAR *str = (CHAR *) gpdb::GPDBAlloc(len);
+	clib::Memcpy(str, utf8_name->GetBuffer(), len);
+
+	return str;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CTranslatorUtils::MakeNewToOldColMapping
@@ -94,4 +94,61 @@ CConstExprEvaluatorProxy::EvaluateExpr(const CDXLNode *dxl_expr)
 	return dxl_result;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::EvaluateExprs
+//
+//	@doc:
+//		Evaluate 'exprs', assumed to be constant expressions, and return the DXL
+//		representation of the results. All expressions are evaluated in one
+//		executor context, instead of setting one up for each of them. Caller
+//		keeps ownership of 'exprs' and takes ownership of the returned array.
+//
+//---------------------------------------------------------------------------
+CDXLNodeArray *
+CConstExprEvaluatorProxy::EvaluateExprs(CMemoryPool *mp,
+										const CDXLNodeArray *dxl_exprs)
+{
+	// Translate DXL -> GPDB Expr
+	List *exprs = NIL;
+	for (ULONG ul = 0; ul < dxl_exprs->Size(); ul++)
+	{
+		Expr *expr = m_dxl2scalar_translator.TranslateDXLToScalar(
+			(*dxl_exprs)[ul], &m_emptymapcidvar);
+		GPOS_ASSERT(nullptr != expr);
+		exprs = gpdb::LAppend(exprs, expr);
+	}
+
+	// Evaluate the expressions
+	List *results = gpdb::EvaluateExprs(exprs);
+
+	CDXLNodeArray *dxl_results = GPOS_NEW(mp) CDXLNodeArray(mp);
+	ListCell *lc = nullptr;
+	ForEach(lc, results)
+	{
+		Expr *result = (Expr *) lfirst(lc);
+		if (!IsA(result, Const))
+		{
+#ifdef GPOS_DEBUG
+			elog(
+				NOTICE,
+				"Expression did not evaluate to Const, but to an expression of type %d",
+				result->type);
+#endif
+			dxl_results->Release();
+			GPOS_RAISE(gpdxl::ExmaConstExprEval,
+					   gpdxl::ExmiConstExprEvalNonConst);
+		}
+
+		CDXLDatum *datum_dxl = CTranslatorScalarToDXL::TranslateConstToDXL(
+			m_mp, m_md_accessor, (Const *) result);
+		dxl_results->Append(GPOS_NEW(m_mp) CDXLNode(
+			m_mp, GPOS_NEW(m_mp) CDXLScalarConstValue(m_mp, datum_dxl)));
+	}
+	gpdb::ListFreeDeep(results);
+	gpdb::ListFreeDeep(exprs);
+
+	return dxl_results;
+}
+
 // EOF
@@ -15,6 +15,8 @@
 #include "gpos/common/CDynamicPtrArray.h"
 #include "gpos/common/CHashMap.h"
 #include "gpos/common/CList.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/common/COpenHashMapIter.h"
 #include "gpos/common/DbgPrintMixin.h"
 
 #include "gpopt/metadata/CName.h"
@@ -34,16 +36,18 @@ using CColRef2dArray = CDynamicPtrArray<CColRefArray, CleanupRelease>;
 
 // hash map mapping ULONG -> CColRef
 using UlongToColRefMap =
-	CHashMap<ULONG, CColRef, gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
-			 CleanupDelete<ULONG>, CleanupNULL<CColRef>>;
+	COpenHashMap<ULONG, CColRef, gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
+				 CleanupDelete<ULONG>, CleanupNULL<CColRef>>;
 // hash map mapping ULONG -> const CColRef
 using UlongToConstColRefMap =
-	CHashMap<ULONG, const CColRef, gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
-			 CleanupDelete<ULONG>, CleanupNULL<const CColRef>>;
+	COpenHashMap<ULONG, const CColRef, gpos::HashValue<ULONG>,
+				 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
+				 CleanupNULL<const CColRef>>;
 // iterator
 using UlongToColRefMapIter =
-	CHashMapIter<ULONG, CColRef, gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
-				 CleanupDelete<ULONG>, CleanupNULL<CColRef>>;
+	COpenHashMapIter<ULONG, CColRef, gpos::HashValue<ULONG>,
+					 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
+					 CleanupNULL<CColRef>>;
 
 //---------------------------------------------------------------------------
 //	@class:
@@ -244,8 +248,8 @@ operator<<(IOstream &os, CColRef &cr)
 
 // hash map: CColRef -> ULONG
 using ColRefToUlongMap =
-	CHashMap<CColRef, ULONG, CColRef::HashValue, gpos::Equals<CColRef>,
-			 CleanupNULL<CColRef>, CleanupDelete<ULONG>>;
+	COpenHashMap<CColRef, ULONG, CColRef::HashValue, gpos::Equals<CColRef>,
+				 CleanupNULL<CColRef>, CleanupDelete<ULONG>>;
 
 using ColRefToUlongMapArray =
 	CDynamicPtrArray<ColRefToUlongMap, CleanupRelease>;
@@ -8,6 +8,7 @@
 
 #include "gpopt/base/IComparator.h"
 #include "gpopt/operators/CExpression.h"
+#include "gpopt/operators/CScalarArray.h"
 #include "naucrates/base/IDatum.h"
 
 namespace gpopt
@@ -19,10 +20,21 @@ class CDatumSortedSet : public IDatumArray
 private:
 	BOOL m_fIncludesNull;
 
+	// add a datum to the unsorted input, NULLs are only recorded
+	void AppendDatum(IDatumArray *pdrgpdatum, IDatum *datum);
+
+	// sort the collected datums and append the distinct ones to the set
+	void SortAndDedup(CMemoryPool *mp, IDatumArray *pdrgpdatum,
+					  const IComparator *pcomp);
+
 public:
 	CDatumSortedSet(CMemoryPool *mp, CExpression *pexprArray,
 					const IComparator *pcomp);
 
+	// build the set from the constants of a collapsed array
+	CDatumSortedSet(CMemoryPool *mp, CScalarConstArray *pdrgPconst,
+					const IComparator *pcomp);
+
 	BOOL FIncludesNull() const;
 };
 }  // namespace gpopt
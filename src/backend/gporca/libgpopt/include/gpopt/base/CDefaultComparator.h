@@ -43,6 +43,7 @@ using namespace gpnaucrates;
 using namespace gpos;
 
 // fwd declarations
+class CExpression;
 class IConstExprEvaluator;
 
 //---------------------------------------------------------------------------
@@ -60,6 +61,14 @@ private:
 	// constant expression evaluator
 	IConstExprEvaluator *m_pceeval;
 
+	// construct a comparison expression from the given components
+	static CExpression *PexprComparison(CMemoryPool *mp, const IDatum *datum1,
+										const IDatum *datum2,
+										IMDType::ECmpType cmp_type);
+
+	// extract the outcome of an evaluated comparison
+	static BOOL FComparisonResult(CExpression *pexprResult);
+
 	// construct a comparison expression from the given components and evaluate it
 	BOOL FEvalComparison(CMemoryPool *mp, const IDatum *datum1,
 						 const IDatum *datum2,
@@ -82,6 +91,12 @@ public:
 	// tests if the two arguments are equal
 	BOOL Equals(const IDatum *datum1, const IDatum *datum2) const override;
 
+	// tests pairs of arguments for equality, evaluating all comparisons
+	// that need the external evaluator in one batch
+	void EqualsBatch(const IDatumArray *pdrgpdatum1,
+					 const IDatumArray *pdrgpdatum2,
+					 BOOL *results) const override;
+
 	// tests if the first argument is less than the second
 	BOOL IsLessThan(const IDatum *datum1, const IDatum *datum2) const override;
 
@@ -20,15 +20,12 @@
 
 #include "gpos/base.h"
 
-namespace gpnaucrates
-{
-// fwd declarations
-class IDatum;
-}  // namespace gpnaucrates
+#include "naucrates/base/IDatum.h"
 
 namespace gpopt
 {
 using gpnaucrates::IDatum;
+using gpnaucrates::IDatumArray;
 
 //---------------------------------------------------------------------------
 //	@class:
@@ -47,6 +44,12 @@ public:
 	virtual gpos::BOOL Equals(const IDatum *datum1,
 							  const IDatum *datum2) const = 0;
 
+	// tests the arguments at the same positions of the two arrays for
+	// equality and stores the outcomes in 'results'
+	virtual void EqualsBatch(const IDatumArray *pdrgpdatum1,
+							 const IDatumArray *pdrgpdatum2,
+							 gpos::BOOL *results) const = 0;
+
 	// tests if the first argument is less than the second
 	virtual gpos::BOOL IsLessThan(const IDatum *datum1,
 								  const IDatum *datum2) const = 0;
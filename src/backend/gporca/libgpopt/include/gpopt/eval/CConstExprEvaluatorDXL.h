@@ -73,6 +73,11 @@ public:
 	// caller takes ownership of returned expression
 	CExpression *PexprEval(CExpression *pexpr) override;
 
+	// evaluate the given expressions with a single call to the DXL evaluator
+	// and return the results as new expressions
+	CExpressionArray *PdrgpexprEval(CMemoryPool *mp,
+									CExpressionArray *pdrgpexpr) override;
+
 	// Returns true iff the evaluator can evaluate expressions
 	BOOL FCanEvalExpressions() override;
 };
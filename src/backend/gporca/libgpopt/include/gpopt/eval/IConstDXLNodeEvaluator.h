@@ -20,11 +20,7 @@
 
 #include "gpos/base.h"
 
-// forward declaration
-namespace gpdxl
-{
-class CDXLNode;
-}
+#include "naucrates/dxl/operators/CDXLNode.h"
 
 namespace gpopt
 {
@@ -46,6 +42,22 @@ public:
 	// as DXL. caller takes ownership of returned DXL node
 	virtual gpdxl::CDXLNode *EvaluateExpr(const gpdxl::CDXLNode *pdxlnExpr) = 0;
 
+	// evaluate the given DXL nodes and return the results as DXL, in the
+	// same order; evaluators that can share work between expressions
+	// override this, the default evaluates them one at a time. caller
+	// takes ownership of returned array
+	virtual gpdxl::CDXLNodeArray *
+	EvaluateExprs(gpos::CMemoryPool *mp, const gpdxl::CDXLNodeArray *exprs)
+	{
+		gpdxl::CDXLNodeArray *results = GPOS_NEW(mp) gpdxl::CDXLNodeArray(mp);
+		for (gpos::ULONG ul = 0; ul < exprs->Size(); ul++)
+		{
+			results->Append(EvaluateExpr((*exprs)[ul]));
+		}
+
+		return results;
+	}
+
 	// returns true iff the evaluator can evaluate constant expressions without
 	// subqueries
 	virtual gpos::BOOL FCanEvalExpressions() = 0;
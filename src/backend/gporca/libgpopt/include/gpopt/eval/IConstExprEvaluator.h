@@ -21,12 +21,12 @@
 #include "gpos/base.h"
 #include "gpos/common/CRefCount.h"
 
+#include "gpopt/operators/CExpression.h"
+
 namespace gpopt
 {
 using namespace gpos;
 
-class CExpression;	// forward declaration
-
 //---------------------------------------------------------------------------
 //	@class:
 //		IConstExprEvaluator
@@ -47,6 +47,22 @@ public:
 	// caller takes ownership of returned expression
 	virtual CExpression *PexprEval(CExpression *pexpr) = 0;
 
+	// evaluate the given expressions and return the results as new
+	// expressions, in the same order; evaluators that can share work between
+	// expressions override this, the default evaluates them one at a time.
+	// caller takes ownership of returned array
+	virtual CExpressionArray *
+	PdrgpexprEval(CMemoryPool *mp, CExpressionArray *pdrgpexpr)
+	{
+		CExpressionArray *pdrgpexprResult = GPOS_NEW(mp) CExpressionArray(mp);
+		for (ULONG ul = 0; ul < pdrgpexpr->Size(); ul++)
+		{
+			pdrgpexprResult->Append(PexprEval((*pdrgpexpr)[ul]));
+		}
+
+		return pdrgpexprResult;
+	}
+
 	// returns true iff the evaluator can evaluate constant expressions without
 	// subqueries
 	virtual BOOL FCanEvalExpressions() = 0;
@@ -24,6 +24,10 @@ using namespace gpmd;
 
 using CScalarConstArray = CDynamicPtrArray<CScalarConst, CleanupRelease>;
 
+// fwd declarations
+class CDatumSortedSet;
+class IComparator;
+
 //---------------------------------------------------------------------------
 //	@class:
 //		CScalarArray
@@ -47,6 +51,11 @@ private:
 	// const values
 	CScalarConstArray *m_pdrgPconst;
 
+	// sorted and de-duplicated const values, built on first use; consumers
+	// such as constraint derivation ask for it repeatedly, and for very long
+	// IN lists sorting dominates the cost of each request
+	mutable CDatumSortedSet *m_pdatumsortedset;
+
 public:
 	CScalarArray(const CScalarArray &) = delete;
 
@@ -124,6 +133,9 @@ public:
 	// CScalarConst array
 	CScalarConstArray *PdrgPconst() const;
 
+	// sorted and de-duplicated const values of a collapsed array
+	CDatumSortedSet *PdatumsortedsetConst(const IComparator *pcomp) const;
+
 	// print
 	IOstream &OsPrint(IOstream &os) const override;
 
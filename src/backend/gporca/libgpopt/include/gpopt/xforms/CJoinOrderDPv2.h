@@ -14,6 +14,8 @@
 #include "gpos/base.h"
 #include "gpos/common/CBitSet.h"
 #include "gpos/common/CHashMap.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/common/COpenHashMapIter.h"
 #include "gpos/common/DbgPrintMixin.h"
 #include "gpos/io/IOstream.h"
 
@@ -395,13 +397,13 @@ private:
 
 	// dynamic array of SGroupInfos
 	using BitSetToGroupInfoMap =
-		CHashMap<CBitSet, SGroupInfo, UlHashBitSet, FEqualBitSet,
-				 CleanupRelease<CBitSet>, CleanupRelease<SGroupInfo>>;
+		COpenHashMap<CBitSet, SGroupInfo, UlHashBitSet, FEqualBitSet,
+					 CleanupRelease<CBitSet>, CleanupRelease<SGroupInfo>>;
 
 	// iterator over group infos in a level
 	using BitSetToGroupInfoMapIter =
-		CHashMapIter<CBitSet, SGroupInfo, UlHashBitSet, FEqualBitSet,
-					 CleanupRelease<CBitSet>, CleanupRelease<SGroupInfo>>;
+		COpenHashMapIter<CBitSet, SGroupInfo, UlHashBitSet, FEqualBitSet,
+						 CleanupRelease<CBitSet>, CleanupRelease<SGroupInfo>>;
 
 	// dynamic array of SLevelInfos, where each index represents the level
 	using DPv2Levels = CDynamicPtrArray<SLevelInfo, CleanupRelease<SLevelInfo>>;
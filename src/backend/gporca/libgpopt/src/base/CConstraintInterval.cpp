@@ -294,8 +294,20 @@ CConstraintInterval::PcnstrIntervalFromScalarArrayCmp(CMemoryPool *mp,
 	}
 
 	const IComparator *pcomp = COptCtxt::PoctxtFromTLS()->Pcomp();
-	gpos::CAutoRef<CDatumSortedSet> apdatumsortedset(
-		GPOS_NEW(mp) CDatumSortedSet(mp, pexprArray, pcomp));
+	// the constants of a collapsed array are sorted once and the result is
+	// cached in the array operator
+	CDatumSortedSet *pdatumsortedset = nullptr;
+	if (CUtils::FScalarArrayCollapsed(pexprArray))
+	{
+		pdatumsortedset = CScalarArray::PopConvert(pexprArray->Pop())
+							  ->PdatumsortedsetConst(pcomp);
+		pdatumsortedset->AddRef();
+	}
+	else
+	{
+		pdatumsortedset = GPOS_NEW(mp) CDatumSortedSet(mp, pexprArray, pcomp);
+	}
+	gpos::CAutoRef<CDatumSortedSet> apdatumsortedset(pdatumsortedset);
 	// construct ranges representing IN or NOT IN
 	CRangeArray *prgrng = GPOS_NEW(mp) CRangeArray(mp);
 
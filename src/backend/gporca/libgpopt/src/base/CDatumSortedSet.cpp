@@ -4,6 +4,7 @@
 #include "gpopt/base/CDatumSortedSet.h"
 
 #include "gpos/common/CAutoRef.h"
+#include "gpos/common/CAutoRg.h"
 
 #include "gpopt/base/CUtils.h"
 #include "gpopt/operators/COperator.h"
@@ -25,37 +26,81 @@ CDatumSortedSet::CDatumSortedSet(CMemoryPool *mp, CExpression *pexprArray,
 	{
 		CScalarConst *popScConst =
 			CUtils::PScalarArrayConstChildAt(pexprArray, ul);
-		IDatum *datum = popScConst->GetDatum();
-		if (datum->IsNull())
-		{
-			m_fIncludesNull = true;
-		}
-		else
-		{
-			datum->AddRef();
-			aprngdatum->Append(datum);
-		}
+		AppendDatum(aprngdatum.Value(), popScConst->GetDatum());
 	}
 
+	SortAndDedup(mp, aprngdatum.Value(), pcomp);
+}
+
+CDatumSortedSet::CDatumSortedSet(CMemoryPool *mp,
+								 CScalarConstArray *pdrgPconst,
+								 const IComparator *pcomp)
+	: IDatumArray(mp), m_fIncludesNull(false)
+{
+	GPOS_ASSERT(0 < pdrgPconst->Size());
+
+	gpos::CAutoRef<IDatumArray> aprngdatum(GPOS_NEW(mp) IDatumArray(mp));
+	for (ULONG ul = 0; ul < pdrgPconst->Size(); ul++)
+	{
+		AppendDatum(aprngdatum.Value(), (*pdrgPconst)[ul]->GetDatum());
+	}
+
+	SortAndDedup(mp, aprngdatum.Value(), pcomp);
+}
+
+// add a datum to the unsorted input, NULLs are only recorded
+void
+CDatumSortedSet::AppendDatum(IDatumArray *pdrgpdatum, IDatum *datum)
+{
+	if (datum->IsNull())
+	{
+		m_fIncludesNull = true;
+	}
+	else
+	{
+		datum->AddRef();
+		pdrgpdatum->Append(datum);
+	}
+}
+
+// sort the collected datums and append the distinct ones to the set
+void
+CDatumSortedSet::SortAndDedup(CMemoryPool *mp, IDatumArray *pdrgpdatum,
+							  const IComparator *pcomp)
+{
 	// ALL NULLs, just return empty set
-	if (aprngdatum->Size() == 0)
+	if (pdrgpdatum->Size() == 0)
 	{
 		return;
 	}
-	aprngdatum->Sort(&CUtils::IDatumCmp);
+	pdrgpdatum->Sort(&CUtils::IDatumCmp);
+
+	// de-duplicate; since the array is sorted, it is enough to compare each
+	// datum with its predecessor, so all the comparisons are independent and
+	// are handed to the comparator in one batch
+	const ULONG ulRangeArrayArity = pdrgpdatum->Size();
+	gpos::CAutoRef<IDatumArray> apdrgpdatumPrev(GPOS_NEW(mp) IDatumArray(mp));
+	gpos::CAutoRef<IDatumArray> apdrgpdatumCur(GPOS_NEW(mp) IDatumArray(mp));
+	for (ULONG ul = 1; ul < ulRangeArrayArity; ul++)
+	{
+		(*pdrgpdatum)[ul - 1]->AddRef();
+		apdrgpdatumPrev->Append((*pdrgpdatum)[ul - 1]);
+		(*pdrgpdatum)[ul]->AddRef();
+		apdrgpdatumCur->Append((*pdrgpdatum)[ul]);
+	}
+
+	CAutoRg<BOOL> apfEqual(GPOS_NEW_ARRAY(mp, BOOL, ulRangeArrayArity));
+	pcomp->EqualsBatch(apdrgpdatumCur.Value(), apdrgpdatumPrev.Value(),
+					   apfEqual.Rgt());
 
-	// de-duplicate
-	const ULONG ulRangeArrayArity = aprngdatum->Size();
-	IDatum *pdatumPrev = (*aprngdatum)[0];
-	pdatumPrev->AddRef();
-	Append(pdatumPrev);
+	(*pdrgpdatum)[0]->AddRef();
+	Append((*pdrgpdatum)[0]);
 	for (ULONG ul = 1; ul < ulRangeArrayArity; ul++)
 	{
-		if (!pcomp->Equals((*aprngdatum)[ul], pdatumPrev))
+		if (!apfEqual[ul - 1])
 		{
-			pdatumPrev = (*aprngdatum)[ul];
-			pdatumPrev->AddRef();
-			Append(pdatumPrev);
+			(*pdrgpdatum)[ul]->AddRef();
+			Append((*pdrgpdatum)[ul]);
 		}
 	}
 }
@@ -50,37 +50,68 @@ CDefaultComparator::CDefaultComparator(IConstExprEvaluator *pceeval)
 
 //---------------------------------------------------------------------------
 //	@function:
-//		CDefaultComparator::PexprEvalComparison
+//		CDefaultComparator::PexprComparison
 //
 //	@doc:
 //		Constructs a comparison expression of type cmp_type between the two given
-//		data and evaluates it.
+//		data.
 //
 //---------------------------------------------------------------------------
-BOOL
-CDefaultComparator::FEvalComparison(CMemoryPool *mp, const IDatum *datum1,
+CExpression *
+CDefaultComparator::PexprComparison(CMemoryPool *mp, const IDatum *datum1,
 									const IDatum *datum2,
-									IMDType::ECmpType cmp_type) const
+									IMDType::ECmpType cmp_type)
 {
-	GPOS_ASSERT(m_pceeval->FCanEvalExpressions());
-
 	IDatum *pdatum1Copy = datum1->MakeCopy(mp);
 	CExpression *pexpr1 = GPOS_NEW(mp)
 		CExpression(mp, GPOS_NEW(mp) CScalarConst(mp, pdatum1Copy));
 	IDatum *pdatum2Copy = datum2->MakeCopy(mp);
 	CExpression *pexpr2 = GPOS_NEW(mp)
 		CExpression(mp, GPOS_NEW(mp) CScalarConst(mp, pdatum2Copy));
-	CExpression *pexprComp =
-		CUtils::PexprScalarCmp(mp, pexpr1, pexpr2, cmp_type);
 
-	CExpression *pexprResult = m_pceeval->PexprEval(pexprComp);
-	pexprComp->Release();
+	return CUtils::PexprScalarCmp(mp, pexpr1, pexpr2, cmp_type);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDefaultComparator::FComparisonResult
+//
+//	@doc:
+//		Extracts the boolean outcome of an evaluated comparison
+//
+//---------------------------------------------------------------------------
+BOOL
+CDefaultComparator::FComparisonResult(CExpression *pexprResult)
+{
 	CScalarConst *popScalarConst = CScalarConst::PopConvert(pexprResult->Pop());
 	IDatum *datum = popScalarConst->GetDatum();
 
 	GPOS_ASSERT(IMDType::EtiBool == datum->GetDatumType());
 	IDatumBool *pdatumBool = dynamic_cast<IDatumBool *>(datum);
-	BOOL result = pdatumBool->GetValue();
+
+	return pdatumBool->GetValue();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDefaultComparator::PexprEvalComparison
+//
+//	@doc:
+//		Constructs a comparison expression of type cmp_type between the two given
+//		data and evaluates it.
+//
+//---------------------------------------------------------------------------
+BOOL
+CDefaultComparator::FEvalComparison(CMemoryPool *mp, const IDatum *datum1,
+									const IDatum *datum2,
+									IMDType::ECmpType cmp_type) const
+{
+	GPOS_ASSERT(m_pceeval->FCanEvalExpressions());
+
+	CExpression *pexprComp = PexprComparison(mp, datum1, datum2, cmp_type);
+	CExpression *pexprResult = m_pceeval->PexprEval(pexprComp);
+	pexprComp->Release();
+	BOOL result = FComparisonResult(pexprResult);
 	pexprResult->Release();
 
 	return result;
@@ -172,6 +203,79 @@ CDefaultComparator::Equals(const IDatum *datum1, const IDatum *datum2) const
 	return FEvalComparison(amp.Pmp(), datum1, datum2, IMDType::EcmptEq);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CDefaultComparator::EqualsBatch
+//
+//	@doc:
+//		Tests the pairs of arguments at the same positions for equality.
+//		Pairs which need the external evaluator are evaluated in one batch,
+//		so that the evaluator can handle them in a single round trip.
+//
+//---------------------------------------------------------------------------
+void
+CDefaultComparator::EqualsBatch(const IDatumArray *pdrgpdatum1,
+								const IDatumArray *pdrgpdatum2,
+								BOOL *results) const
+{
+	GPOS_ASSERT(pdrgpdatum1->Size() == pdrgpdatum2->Size());
+
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	// comparisons to evaluate externally, and the positions they belong to
+	CExpressionArray *pdrgpexprComp = GPOS_NEW(mp) CExpressionArray(mp);
+	ULongPtrArray *pdrgpulPos = GPOS_NEW(mp) ULongPtrArray(mp);
+
+	const ULONG size = pdrgpdatum1->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		const IDatum *datum1 = (*pdrgpdatum1)[ul];
+		const IDatum *datum2 = (*pdrgpdatum2)[ul];
+
+		// same logic as Equals()
+		BOOL can_use_external_evaluator = false;
+		if (FUseInternalEvaluator(datum1, datum2, &can_use_external_evaluator))
+		{
+			results[ul] = datum1->StatsAreEqual(datum2);
+		}
+		else if (!can_use_external_evaluator)
+		{
+			results[ul] = false;
+		}
+		else if (datum1->IsNull() && datum2->IsNull())
+		{
+			results[ul] = true;
+		}
+		else
+		{
+			results[ul] = false;
+			pdrgpexprComp->Append(
+				PexprComparison(mp, datum1, datum2, IMDType::EcmptEq));
+			pdrgpulPos->Append(GPOS_NEW(mp) ULONG(ul));
+		}
+	}
+
+	if (0 < pdrgpexprComp->Size())
+	{
+		GPOS_ASSERT(m_pceeval->FCanEvalExpressions());
+
+		CExpressionArray *pdrgpexprResult =
+			m_pceeval->PdrgpexprEval(mp, pdrgpexprComp);
+		GPOS_ASSERT(pdrgpexprResult->Size() == pdrgpulPos->Size());
+
+		for (ULONG ul = 0; ul < pdrgpulPos->Size(); ul++)
+		{
+			results[*(*pdrgpulPos)[ul]] =
+				FComparisonResult((*pdrgpexprResult)[ul]);
+		}
+		pdrgpexprResult->Release();
+	}
+
+	pdrgpulPos->Release();
+	pdrgpexprComp->Release();
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CDefaultComparator::IsLessThan
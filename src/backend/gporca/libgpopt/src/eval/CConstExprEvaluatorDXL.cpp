@@ -90,6 +90,59 @@ CConstExprEvaluatorDXL::PexprEval(CExpression *pexpr)
 	return pexprResult;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorDXL::PdrgpexprEval
+//
+//	@doc:
+//		Evaluate the given expressions and return the results as new
+//		expressions. All expressions are handed to the DXL evaluator at once,
+//		so that it can evaluate them in a single round trip.
+//		Caller takes ownership of returned array
+//
+//---------------------------------------------------------------------------
+CExpressionArray *
+CConstExprEvaluatorDXL::PdrgpexprEval(CMemoryPool *mp,
+									  CExpressionArray *pdrgpexpr)
+{
+	GPOS_ASSERT(nullptr != pdrgpexpr);
+
+	const ULONG size = pdrgpexpr->Size();
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		if (!CPredicateUtils::FCompareConstToConstIgnoreCast((*pdrgpexpr)[ul]))
+		{
+			GPOS_RAISE(gpopt::ExmaGPOPT, gpopt::ExmiEvalUnsupportedScalarExpr);
+		}
+	}
+
+	CDXLNodeArray *pdrgpdxlnExpr = GPOS_NEW(mp) CDXLNodeArray(mp);
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		pdrgpdxlnExpr->Append(m_trexpr2dxl.PdxlnScalar((*pdrgpexpr)[ul]));
+	}
+
+	CDXLNodeArray *pdrgpdxlnResult =
+		m_pconstdxleval->EvaluateExprs(mp, pdrgpdxlnExpr);
+	GPOS_ASSERT(size == pdrgpdxlnResult->Size());
+
+	CExpressionArray *pdrgpexprResult = GPOS_NEW(mp) CExpressionArray(mp);
+	for (ULONG ul = 0; ul < size; ul++)
+	{
+		CDXLNode *pdxlnResult = (*pdrgpdxlnResult)[ul];
+		GPOS_ASSERT(EdxloptypeScalar ==
+					pdxlnResult->GetOperator()->GetDXLOperatorType());
+
+		pdrgpexprResult->Append(m_trdxl2expr.PexprTranslateScalar(
+			pdxlnResult, nullptr /*colref_array*/));
+	}
+
+	pdrgpdxlnResult->Release();
+	pdrgpdxlnExpr->Release();
+
+	return pdrgpexprResult;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CConstExprEvaluatorDXL::FCanEvalExpressions
@@ -14,6 +14,7 @@
 #include "gpos/base.h"
 
 #include "gpopt/base/CColRefSet.h"
+#include "gpopt/base/CDatumSortedSet.h"
 #include "gpopt/base/CDrvdPropScalar.h"
 #include "gpopt/operators/CExpressionHandle.h"
 #include "naucrates/md/IMDAggregate.h"
@@ -28,7 +29,8 @@ CScalarArray::CScalarArray(CMemoryPool *mp, IMDId *elem_type_mdid,
 	: CScalar(mp),
 	  m_pmdidElem(elem_type_mdid),
 	  m_pmdidArray(array_type_mdid),
-	  m_fMultiDimensional(is_multidimenstional)
+	  m_fMultiDimensional(is_multidimenstional),
+	  m_pdatumsortedset(nullptr)
 {
 	GPOS_ASSERT(elem_type_mdid->IsValid());
 	GPOS_ASSERT(array_type_mdid->IsValid());
@@ -44,7 +46,8 @@ CScalarArray::CScalarArray(CMemoryPool *mp, IMDId *elem_type_mdid,
 	  m_pmdidElem(elem_type_mdid),
 	  m_pmdidArray(array_type_mdid),
 	  m_fMultiDimensional(is_multidimenstional),
-	  m_pdrgPconst(pdrgPconst)
+	  m_pdrgPconst(pdrgPconst),
+	  m_pdatumsortedset(nullptr)
 {
 	GPOS_ASSERT(elem_type_mdid->IsValid());
 	GPOS_ASSERT(array_type_mdid->IsValid());
@@ -56,6 +59,7 @@ CScalarArray::~CScalarArray()
 	m_pmdidElem->Release();
 	m_pmdidArray->Release();
 	m_pdrgPconst->Release();
+	CRefCount::SafeRelease(m_pdatumsortedset);
 }
 
 //---------------------------------------------------------------------------
@@ -174,6 +178,30 @@ CScalarArray::PdrgPconst() const
 	return m_pdrgPconst;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CScalarArray::PdatumsortedsetConst
+//
+//	@doc:
+//		Sorted and de-duplicated const values of a collapsed array. The set
+//		is built once and cached in the operator, the caller does not own
+//		the returned set
+//
+//---------------------------------------------------------------------------
+CDatumSortedSet *
+CScalarArray::PdatumsortedsetConst(const IComparator *pcomp) const
+{
+	GPOS_ASSERT(0 < m_pdrgPconst->Size());
+
+	if (nullptr == m_pdatumsortedset)
+	{
+		m_pdatumsortedset =
+			GPOS_NEW(m_mp) CDatumSortedSet(m_mp, m_pdrgPconst, pcomp);
+	}
+
+	return m_pdatumsortedset;
+}
+
 IOstream &
 CScalarArray::OsPrint(IOstream &os) const
 {
@@ -0,0 +1,404 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2023 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		COpenHashMap.h
+//
+//	@doc:
+//		Open addressing hash map, a drop-in replacement for CHashMap
+//		* same template signature and interface as CHashMap
+//		* entries are kept in a dense array in insertion order, which is
+//		  also the iteration order, as in CHashMap
+//		* the hash index is a Robin Hood open addressing table of entry
+//		  positions, so inserts do not allocate per element and lookups
+//		  probe a contiguous array instead of chasing chain pointers
+//---------------------------------------------------------------------------
+#ifndef GPOS_COpenHashMap_H
+#define GPOS_COpenHashMap_H
+
+#include "gpos/base.h"
+#include "gpos/common/CRefCount.h"
+
+namespace gpos
+{
+// fwd declaration
+template <class K, class T, ULONG (*HashFn)(const K *),
+		  BOOL (*EqFn)(const K *, const K *), void (*DestroyKFn)(K *),
+		  void (*DestroyTFn)(T *)>
+class COpenHashMapIter;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		COpenHashMap
+//
+//	@doc:
+//		Open addressing hash map
+//
+//---------------------------------------------------------------------------
+template <class K, class T, ULONG (*HashFn)(const K *),
+		  BOOL (*EqFn)(const K *, const K *), void (*DestroyKFn)(K *),
+		  void (*DestroyTFn)(T *)>
+class COpenHashMap : public CRefCount
+{
+	// fwd declaration
+	friend class COpenHashMapIter<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>;
+
+private:
+	// key/value pair, a deleted entry has a NULL key
+	struct SEntry
+	{
+		K *m_key;
+		T *m_value;
+	};
+
+	// slot of the hash index
+	struct SSlot
+	{
+		// position of the entry plus one, zero for an empty slot
+		ULONG m_entry;
+
+		// mixed hash value of the entry's key
+		ULONG m_hash;
+	};
+
+	// smallest index allocated
+	static const ULONG m_min_slots = 8;
+
+	// memory pool
+	CMemoryPool *const m_mp;
+
+	// requested initial size
+	const ULONG m_size_hint;
+
+	// number of live entries
+	ULONG m_size;
+
+	// entries in insertion order, including deleted ones
+	SEntry *m_entries;
+
+	// number of used positions in the entries array
+	ULONG m_num_entries;
+
+	// hash index, its size is a power of two
+	SSlot *m_slots;
+	ULONG m_num_slots;
+
+	// mix the client hash, so that the low bits used to address the index
+	// depend on all bits of the hash value; e.g. pointer hashes have
+	// constant low bits
+	static ULONG
+	MixHash(ULONG hash)
+	{
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bU;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35U;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	// home slot of a hash value
+	ULONG
+	HomeSlot(ULONG hash) const
+	{
+		return hash & (m_num_slots - 1);
+	}
+
+	// distance of a slot from the home slot of its entry
+	ULONG
+	ProbeDistance(ULONG slot) const
+	{
+		return (slot - HomeSlot(m_slots[slot].m_hash)) & (m_num_slots - 1);
+	}
+
+	// maximum number of entries, including deleted ones, for the current
+	// index size; keeps the load factor at or below 7/8
+	ULONG
+	MaxEntries() const
+	{
+		return m_num_slots - m_num_slots / 8;
+	}
+
+	// find the slot of a key, or gpos::ulong_max if not present
+	ULONG
+	LookupSlot(const K *key) const
+	{
+		if (0 == m_size)
+		{
+			return gpos::ulong_max;
+		}
+
+		const ULONG hash = MixHash(HashFn(key));
+		ULONG slot = HomeSlot(hash);
+		for (ULONG dist = 0;; dist++)
+		{
+			// in a Robin Hood table, the key cannot be further away from its
+			// home slot than the entry occupying the current slot
+			if (0 == m_slots[slot].m_entry || ProbeDistance(slot) < dist)
+			{
+				return gpos::ulong_max;
+			}
+
+			if (hash == m_slots[slot].m_hash &&
+				EqFn(m_entries[m_slots[slot].m_entry - 1].m_key, key))
+			{
+				return slot;
+			}
+
+			slot = (slot + 1) & (m_num_slots - 1);
+		}
+	}
+
+	// lookup an entry by its key
+	SEntry *
+	Lookup(const K *key) const
+	{
+		ULONG slot = LookupSlot(key);
+		if (gpos::ulong_max == slot)
+		{
+			return nullptr;
+		}
+
+		return &m_entries[m_slots[slot].m_entry - 1];
+	}
+
+	// add a slot for the entry at the given position to the index
+	void
+	InsertSlot(ULONG entry, ULONG hash)
+	{
+		SSlot new_slot = {entry + 1, hash};
+		ULONG slot = HomeSlot(hash);
+		ULONG dist = 0;
+		while (0 != m_slots[slot].m_entry)
+		{
+			// steal the slot from entries closer to their home slot
+			ULONG cur_dist = ProbeDistance(slot);
+			if (cur_dist < dist)
+			{
+				SSlot tmp = m_slots[slot];
+				m_slots[slot] = new_slot;
+				new_slot = tmp;
+				dist = cur_dist;
+			}
+
+			slot = (slot + 1) & (m_num_slots - 1);
+			dist++;
+		}
+		m_slots[slot] = new_slot;
+	}
+
+	// remove a slot from the index, shifting back the following slots
+	void
+	DeleteSlot(ULONG slot)
+	{
+		ULONG next = (slot + 1) & (m_num_slots - 1);
+		while (0 != m_slots[next].m_entry && 0 != ProbeDistance(next))
+		{
+			m_slots[slot] = m_slots[next];
+			slot = next;
+			next = (next + 1) & (m_num_slots - 1);
+		}
+		m_slots[slot].m_entry = 0;
+	}
+
+	// resize the index to the given number of slots, dropping deleted
+	// entries and rebuilding the index
+	void
+	Resize(ULONG num_slots)
+	{
+		GPOS_ASSERT(0 == (num_slots & (num_slots - 1)));
+
+		SEntry *old_entries = m_entries;
+		ULONG old_num_entries = m_num_entries;
+
+		GPOS_DELETE_ARRAY(m_slots);
+		m_num_slots = num_slots;
+		m_slots = GPOS_NEW_ARRAY(m_mp, SSlot, m_num_slots);
+		(void) clib::Memset(m_slots, 0, m_num_slots * sizeof(SSlot));
+		m_entries = GPOS_NEW_ARRAY(m_mp, SEntry, MaxEntries());
+
+		m_num_entries = 0;
+		for (ULONG ul = 0; ul < old_num_entries; ul++)
+		{
+			if (nullptr != old_entries[ul].m_key)
+			{
+				m_entries[m_num_entries] = old_entries[ul];
+				InsertSlot(m_num_entries,
+						   MixHash(HashFn(old_entries[ul].m_key)));
+				m_num_entries++;
+			}
+		}
+		GPOS_ASSERT(m_num_entries == m_size);
+
+		GPOS_DELETE_ARRAY(old_entries);
+	}
+
+	// make room for one more entry
+	void
+	Reserve()
+	{
+		if (nullptr == m_slots)
+		{
+			ULONG num_slots = m_min_slots;
+			while (num_slots - num_slots / 8 < m_size_hint)
+			{
+				num_slots *= 2;
+			}
+			m_num_slots = num_slots;
+			m_slots = GPOS_NEW_ARRAY(m_mp, SSlot, m_num_slots);
+			(void) clib::Memset(m_slots, 0, m_num_slots * sizeof(SSlot));
+			m_entries = GPOS_NEW_ARRAY(m_mp, SEntry, MaxEntries());
+			return;
+		}
+
+		if (m_num_entries < MaxEntries())
+		{
+			return;
+		}
+
+		if (m_size < MaxEntries() / 2)
+		{
+			// mostly deleted entries, compact them away
+			Resize(m_num_slots);
+		}
+		else
+		{
+			Resize(m_num_slots * 2);
+		}
+	}
+
+	// clear elements
+	void
+	Clear()
+	{
+		for (ULONG ul = 0; ul < m_num_entries; ul++)
+		{
+			if (nullptr != m_entries[ul].m_key)
+			{
+				DestroyKFn(m_entries[ul].m_key);
+				DestroyTFn(m_entries[ul].m_value);
+			}
+		}
+		m_size = 0;
+		m_num_entries = 0;
+	}
+
+public:
+	COpenHashMap(const COpenHashMap<K, T, HashFn, EqFn, DestroyKFn,
+									DestroyTFn> &) = delete;
+
+	// ctor; the index is allocated on first insertion, big enough to hold
+	// size_hint entries
+	COpenHashMap<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>(
+		CMemoryPool *mp, ULONG size_hint = 0)
+		: m_mp(mp),
+		  m_size_hint(size_hint),
+		  m_size(0),
+		  m_entries(nullptr),
+		  m_num_entries(0),
+		  m_slots(nullptr),
+		  m_num_slots(0)
+	{
+	}
+
+	// dtor
+	~COpenHashMap<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>() override
+	{
+		Clear();
+
+		GPOS_DELETE_ARRAY(m_entries);
+		GPOS_DELETE_ARRAY(m_slots);
+	}
+
+	// insert an element if key is not yet present
+	BOOL
+	Insert(K *key, T *value)
+	{
+		GPOS_ASSERT(nullptr != key);
+
+		if (nullptr != Lookup(key))
+		{
+			return false;
+		}
+
+		Reserve();
+
+		m_entries[m_num_entries].m_key = key;
+		m_entries[m_num_entries].m_value = value;
+		InsertSlot(m_num_entries, MixHash(HashFn(key)));
+
+		m_num_entries++;
+		m_size++;
+
+		return true;
+	}
+
+	// lookup a value by its key
+	T *
+	Find(const K *key) const
+	{
+		SEntry *entry = Lookup(key);
+		if (nullptr != entry)
+		{
+			return entry->m_value;
+		}
+
+		return nullptr;
+	}
+
+	// replace the value in a map entry with a new given value
+	BOOL
+	Replace(const K *key, T *ptNew)
+	{
+		GPOS_ASSERT(nullptr != key);
+
+		SEntry *entry = Lookup(key);
+		if (nullptr == entry)
+		{
+			return false;
+		}
+
+		DestroyTFn(entry->m_value);
+		entry->m_value = ptNew;
+
+		return true;
+	}
+
+	// delete an element, destroying its key and value
+	BOOL
+	Delete(const K *key)
+	{
+		ULONG slot = LookupSlot(key);
+		if (gpos::ulong_max == slot)
+		{
+			return false;
+		}
+
+		SEntry *entry = &m_entries[m_slots[slot].m_entry - 1];
+		DeleteSlot(slot);
+
+		// the key may be owned by the entry, destroy it last
+		K *entry_key = entry->m_key;
+		entry->m_key = nullptr;
+		m_size--;
+
+		DestroyTFn(entry->m_value);
+		DestroyKFn(entry_key);
+
+		return true;
+	}
+
+	// return number of map entries
+	ULONG
+	Size() const
+	{
+		return m_size;
+	}
+};	// class COpenHashMap
+
+}  // namespace gpos
+
+#endif	// !GPOS_COpenHashMap_H
+
+// EOF
@@ -0,0 +1,97 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2023 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		COpenHashMapIter.h
+//
+//	@doc:
+//		Open addressing hash map iterator
+//---------------------------------------------------------------------------
+#ifndef GPOS_COpenHashMapIter_H
+#define GPOS_COpenHashMapIter_H
+
+#include "gpos/base.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/common/CStackObject.h"
+
+namespace gpos
+{
+//---------------------------------------------------------------------------
+//	@class:
+//		COpenHashMapIter
+//
+//	@doc:
+//		Open addressing hash map iterator, visits the entries in insertion
+//		order
+//
+//---------------------------------------------------------------------------
+template <class K, class T, ULONG (*HashFn)(const K *),
+		  BOOL (*EqFn)(const K *, const K *), void (*DestroyKFn)(K *),
+		  void (*DestroyTFn)(T *)>
+class COpenHashMapIter : public CStackObject
+{
+	// short hand for hashmap type
+	using TMap = COpenHashMap<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>;
+
+private:
+	// map to iterate
+	const TMap *m_map;
+
+	// position of the current entry plus one
+	ULONG m_entry_idx;
+
+public:
+	COpenHashMapIter(const COpenHashMapIter<K, T, HashFn, EqFn, DestroyKFn,
+											DestroyTFn> &) = delete;
+
+	// ctor
+	COpenHashMapIter<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>(TMap *ptm)
+		: m_map(ptm), m_entry_idx(0)
+	{
+		GPOS_ASSERT(nullptr != ptm);
+	}
+
+	// dtor
+	virtual ~COpenHashMapIter<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>() =
+		default;
+
+	// advance iterator to next element, skipping deleted entries
+	BOOL
+	Advance()
+	{
+		while (m_entry_idx < m_map->m_num_entries)
+		{
+			m_entry_idx++;
+			if (nullptr != m_map->m_entries[m_entry_idx - 1].m_key)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// current key
+	const K *
+	Key() const
+	{
+		GPOS_ASSERT(0 < m_entry_idx);
+		return m_map->m_entries[m_entry_idx - 1].m_key;
+	}
+
+	// current value
+	const T *
+	Value() const
+	{
+		GPOS_ASSERT(0 < m_entry_idx);
+		return m_map->m_entries[m_entry_idx - 1].m_value;
+	}
+
+};	// class COpenHashMapIter
+
+}  // namespace gpos
+
+#endif	// !GPOS_COpenHashMapIter_H
+
+// EOF
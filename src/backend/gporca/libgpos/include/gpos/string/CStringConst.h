@@ -0,0 +1,103 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2023 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CStringConst.h
+//
+//	@doc:
+//		Constant UTF-8 string class
+//---------------------------------------------------------------------------
+#ifndef GPOS_CStringConst_H
+#define GPOS_CStringConst_H
+
+#include "gpos/base.h"
+
+namespace gpos
+{
+//---------------------------------------------------------------------------
+//	@class:
+//		CStringConst
+//
+//	@doc:
+//		Constant narrow string class.
+//		The class represents constant, null-terminated multi-byte strings,
+//		such as the UTF-8 names handed to ORCA by the database, which cannot
+//		be modified after creation. Unlike CWStringConst, no conversion to
+//		wide characters takes place when the string is created from a
+//		CHAR buffer. The length of the string is its length in bytes.
+//		The class can either own its own memory, or be supplied with an
+//		external memory buffer holding the string bytes.
+//
+//---------------------------------------------------------------------------
+class CStringConst
+{
+private:
+	// null terminated character buffer
+	const CHAR *m_str_buffer;
+
+	// length of the string in bytes, not counting the terminator
+	ULONG m_length;
+
+	// whether the string owns its buffer
+	BOOL m_owns_memory;
+
+	// buffer of empty strings
+	static const CHAR m_empty_str;
+
+public:
+	// ctors
+	CStringConst(const CHAR *str_buffer);
+	CStringConst(CMemoryPool *mp, const CHAR *str_buffer);
+	CStringConst(CMemoryPool *mp, const WCHAR *w_str_buffer);
+
+	// shallow copy ctor
+	CStringConst(const CStringConst &);
+
+	// dtor
+	~CStringConst();
+
+	// returns the character buffer storing the string
+	const CHAR *
+	GetBuffer() const
+	{
+		return m_str_buffer;
+	}
+
+	// length of the string in bytes
+	ULONG
+	Length() const
+	{
+		return m_length;
+	}
+
+	// checks whether the string is empty
+	BOOL
+	IsEmpty() const
+	{
+		return 0 == m_length;
+	}
+
+	// checks whether the string is byte-wise equal to another string
+	BOOL Equals(const CStringConst *str) const;
+
+	// checks whether the string is byte-wise equal to a character buffer
+	BOOL Equals(const CHAR *str_buffer) const;
+
+	// equality
+	static BOOL Equals(const CStringConst *string1,
+					   const CStringConst *string2);
+
+	// hash function
+	static ULONG HashValue(const CStringConst *string);
+
+#ifdef GPOS_DEBUG
+	// checks whether the string is properly null-terminated
+	BOOL IsValid() const;
+#endif	// GPOS_DEBUG
+};
+}  // namespace gpos
+
+#endif	// #ifndef GPOS_CStringConst_H
+
+// EOF
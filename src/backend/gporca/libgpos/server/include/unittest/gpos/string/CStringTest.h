@@ -6,7 +6,7 @@
 //		CStringTest.h
 //
 //	@doc:
-//		Tests for the CStringStatic class
+//		Tests for the CStringStatic and CStringConst classes
 //---------------------------------------------------------------------------
 #ifndef GPOS_CStringTest_H
 #define GPOS_CStringTest_H
@@ -31,6 +31,7 @@ public:
 	static GPOS_RESULT EresUnittest_Equals();
 	static GPOS_RESULT EresUnittest_Append();
 	static GPOS_RESULT EresUnittest_AppendFormat();
+	static GPOS_RESULT EresUnittest_Const();
 };	// class CStringTest
 }  // namespace gpos
 
@@ -0,0 +1,417 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2023 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		COpenHashMapTest.cpp
+//
+//	@doc:
+//		Test for COpenHashMap
+//---------------------------------------------------------------------------
+
+#include "unittest/gpos/common/COpenHashMapTest.h"
+
+#include "gpos/base.h"
+#include "gpos/common/CHashMap.h"
+#include "gpos/common/CHashMapIter.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/common/COpenHashMapIter.h"
+#include "gpos/common/CTimerUser.h"
+#include "gpos/error/CAutoTrace.h"
+#include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/test/CUnittest.h"
+
+using namespace gpos;
+
+// number of entries used by the benchmark
+#define GPOS_OPEN_HASHMAP_BENCHMARK_SIZE 100000
+
+// number of lookup rounds of the benchmark
+#define GPOS_OPEN_HASHMAP_BENCHMARK_ROUNDS 10
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest
+//
+//	@doc:
+//		Unittest for open addressing hash map
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest()
+{
+	CUnittest rgut[] = {
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Basic),
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Ownership),
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Delete),
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Iterator),
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Benchmark),
+	};
+
+	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Basic
+//
+//	@doc:
+//		Basic insertion/lookup for hash map
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Basic()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	// test with CHAR array
+	ULONG_PTR rgul[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+	CHAR rgsz[][5] = {"abc",  "def", "ghi", "qwe", "wer",
+					  "wert", "dfg", "xcv", "zxc"};
+
+	GPOS_UNITTEST_ASSERT(GPOS_ARRAY_SIZE(rgul) == GPOS_ARRAY_SIZE(rgsz));
+	const ULONG ulCnt = GPOS_ARRAY_SIZE(rgul);
+
+	using UlongPtrToCharMap =
+		COpenHashMap<ULONG_PTR, CHAR, HashPtr<ULONG_PTR>,
+					 gpos::Equals<ULONG_PTR>, CleanupNULL<ULONG_PTR>,
+					 CleanupNULL<CHAR>>;
+
+	// start small to exercise growing the index
+	UlongPtrToCharMap *phm = GPOS_NEW(mp) UlongPtrToCharMap(mp);
+	GPOS_UNITTEST_ASSERT(nullptr == phm->Find(&rgul[0]));
+
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		BOOL fSuccess GPOS_ASSERTS_ONLY =
+			phm->Insert(&rgul[i], (CHAR *) rgsz[i]);
+		GPOS_UNITTEST_ASSERT(fSuccess);
+
+		for (ULONG j = 0; j <= i; ++j)
+		{
+			GPOS_UNITTEST_ASSERT(rgsz[j] == phm->Find(&rgul[j]));
+		}
+	}
+	GPOS_UNITTEST_ASSERT(ulCnt == phm->Size());
+
+	// test replacing entry values of existing keys
+	CHAR rgszNew[][10] = {"abc_",  "def_", "ghi_", "qwe_", "wer_",
+						  "wert_", "dfg_", "xcv_", "zxc_"};
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		BOOL fSuccess GPOS_ASSERTS_ONLY = phm->Replace(&rgul[i], rgszNew[i]);
+		GPOS_UNITTEST_ASSERT(fSuccess);
+		GPOS_UNITTEST_ASSERT(rgszNew[i] == phm->Find(&rgul[i]));
+
+		fSuccess = phm->Replace(&rgul[i], rgsz[i]);
+		GPOS_UNITTEST_ASSERT(fSuccess);
+	}
+	GPOS_UNITTEST_ASSERT(ulCnt == phm->Size());
+
+	// test replacing entry value of a non-existing key
+	ULONG_PTR ulp = 0;
+	BOOL fSuccess GPOS_ASSERTS_ONLY = phm->Replace(&ulp, rgsz[0]);
+	GPOS_UNITTEST_ASSERT(!fSuccess);
+
+	phm->Release();
+
+	// test replacing values and triggering their release
+	using UlongToUlongMap =
+		COpenHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+					 CleanupDelete<ULONG>, CleanupDelete<ULONG>>;
+	UlongToUlongMap *phm2 = GPOS_NEW(mp) UlongToUlongMap(mp, 128);
+
+	ULONG *pulKey = GPOS_NEW(mp) ULONG(1);
+	ULONG *pulVal1 = GPOS_NEW(mp) ULONG(2);
+	ULONG *pulVal2 = GPOS_NEW(mp) ULONG(3);
+
+	fSuccess = phm2->Insert(pulKey, pulVal1);
+	GPOS_UNITTEST_ASSERT(fSuccess);
+
+	ULONG *pulVal = phm2->Find(pulKey);
+	GPOS_UNITTEST_ASSERT(*pulVal == 2);
+
+	fSuccess = phm2->Replace(pulKey, pulVal2);
+	GPOS_UNITTEST_ASSERT(fSuccess);
+
+	pulVal = phm2->Find(pulKey);
+	GPOS_UNITTEST_ASSERT(*pulVal == 3);
+
+	phm2->Release();
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Ownership
+//
+//	@doc:
+//		Basic hash map test with ownership
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Ownership()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	ULONG ulCnt = 256;
+
+	using UlongPtrToCharMap =
+		COpenHashMap<ULONG_PTR, CHAR, HashPtr<ULONG_PTR>,
+					 gpos::Equals<ULONG_PTR>, CleanupDelete<ULONG_PTR>,
+					 CleanupDeleteArray<CHAR>>;
+
+	UlongPtrToCharMap *phm = GPOS_NEW(mp) UlongPtrToCharMap(mp, 32);
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		ULONG_PTR *pulp = GPOS_NEW(mp) ULONG_PTR(i);
+		CHAR *sz = GPOS_NEW_ARRAY(mp, CHAR, 3);
+
+		BOOL fSuccess GPOS_ASSERTS_ONLY = phm->Insert(pulp, sz);
+
+		GPOS_UNITTEST_ASSERT(fSuccess);
+		GPOS_UNITTEST_ASSERT(sz == phm->Find(pulp));
+
+		// can't insert existing keys
+		GPOS_UNITTEST_ASSERT(!phm->Insert(pulp, sz));
+	}
+
+	phm->Release();
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Delete
+//
+//	@doc:
+//		Deletion of entries, interleaved with insertions, so that the index
+//		gets compacted and grown while it contains deleted entries
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Delete()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	using UlongToUlongMap =
+		COpenHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+					 CleanupDelete<ULONG>, CleanupDelete<ULONG>>;
+	UlongToUlongMap *phm = GPOS_NEW(mp) UlongToUlongMap(mp);
+
+	const ULONG ulCnt = 1000;
+	for (ULONG ul = 0; ul < ulCnt; ul++)
+	{
+		BOOL fSuccess GPOS_ASSERTS_ONLY =
+			phm->Insert(GPOS_NEW(mp) ULONG(ul), GPOS_NEW(mp) ULONG(ul * 2));
+		GPOS_UNITTEST_ASSERT(fSuccess);
+
+		// delete every other key inserted so far
+		if (1 == ul % 2)
+		{
+			ULONG key = ul - 1;
+			fSuccess = phm->Delete(&key);
+			GPOS_UNITTEST_ASSERT(fSuccess);
+
+			// can't delete a key twice
+			GPOS_UNITTEST_ASSERT(!phm->Delete(&key));
+		}
+	}
+	GPOS_UNITTEST_ASSERT(ulCnt / 2 == phm->Size());
+
+	for (ULONG ul = 0; ul < ulCnt; ul++)
+	{
+		ULONG *pulVal = phm->Find(&ul);
+		if (0 == ul % 2)
+		{
+			GPOS_UNITTEST_ASSERT(nullptr == pulVal);
+		}
+		else
+		{
+			GPOS_UNITTEST_ASSERT(nullptr != pulVal && ul * 2 == *pulVal);
+		}
+	}
+
+	// deleted keys can be inserted again
+	ULONG key = 0;
+	GPOS_UNITTEST_ASSERT(
+		phm->Insert(GPOS_NEW(mp) ULONG(key), GPOS_NEW(mp) ULONG(42)));
+	GPOS_UNITTEST_ASSERT(42 == *phm->Find(&key));
+	GPOS_UNITTEST_ASSERT(ulCnt / 2 + 1 == phm->Size());
+
+	phm->Release();
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Iterator
+//
+//	@doc:
+//		Iteration visits live entries in insertion order, like CHashMapIter
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Iterator()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	// test data, not in hash order
+	ULONG rgul[] = {9, 3, 7, 1, 8, 2, 6, 4, 5};
+	const ULONG ulCnt = GPOS_ARRAY_SIZE(rgul);
+
+	using Map = COpenHashMap<ULONG, ULONG, HashPtr<ULONG>, gpos::Equals<ULONG>,
+							 CleanupNULL<ULONG>, CleanupNULL<ULONG>>;
+
+	using MapIter =
+		COpenHashMapIter<ULONG, ULONG, HashPtr<ULONG>, gpos::Equals<ULONG>,
+						 CleanupNULL<ULONG>, CleanupNULL<ULONG>>;
+
+	Map *pm = GPOS_NEW(mp) Map(mp);
+
+	// iteration over empty map
+	MapIter miEmpty(pm);
+	GPOS_UNITTEST_ASSERT(!miEmpty.Advance());
+
+	for (ULONG ul = 0; ul < ulCnt; ++ul)
+	{
+		(void) pm->Insert(&rgul[ul], &rgul[ul]);
+	}
+
+	// delete the first and some middle entry
+	(void) pm->Delete(&rgul[0]);
+	(void) pm->Delete(&rgul[4]);
+
+	ULONG ulPos = 1;
+	MapIter mi(pm);
+	while (mi.Advance())
+	{
+		if (4 == ulPos)
+		{
+			ulPos++;
+		}
+
+		GPOS_UNITTEST_ASSERT(ulPos < ulCnt);
+		GPOS_UNITTEST_ASSERT(&rgul[ulPos] == mi.Key());
+		GPOS_UNITTEST_ASSERT(&rgul[ulPos] == mi.Value());
+		ulPos++;
+	}
+	GPOS_UNITTEST_ASSERT(ulCnt == ulPos);
+
+	pm->Release();
+
+	return GPOS_OK;
+}
+
+
+// insert all keys into the given map, then look all of them up a number of
+// times; returns elapsed time in microseconds for both phases
+template <class Map>
+static void
+RunBenchmark(CMemoryPool *mp, ULONG *keys, ULONG num_keys,
+			 ULONG *insert_time_us, ULONG *lookup_time_us)
+{
+	CTimerUser timer;
+
+	Map *map = GPOS_NEW(mp) Map(mp, num_keys);
+
+	timer.Restart();
+	for (ULONG ul = 0; ul < num_keys; ul++)
+	{
+		(void) map->Insert(&keys[ul], &keys[ul]);
+	}
+	*insert_time_us = timer.ElapsedUS();
+
+	ULONG found = 0;
+	timer.Restart();
+	for (ULONG round = 0; round < GPOS_OPEN_HASHMAP_BENCHMARK_ROUNDS; round++)
+	{
+		for (ULONG ul = 0; ul < num_keys; ul++)
+		{
+			if (nullptr != map->Find(&keys[ul]))
+			{
+				found++;
+			}
+		}
+	}
+	*lookup_time_us = timer.ElapsedUS();
+
+	GPOS_RTL_ASSERT(num_keys * GPOS_OPEN_HASHMAP_BENCHMARK_ROUNDS == found);
+	GPOS_RTL_ASSERT(num_keys == map->Size());
+
+	map->Release();
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Benchmark
+//
+//	@doc:
+//		Compare insert and lookup throughput of CHashMap and COpenHashMap;
+//		only checks the results, the timings are traced for inspection
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Benchmark()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	using ChainedMap =
+		CHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+				 CleanupNULL<ULONG>, CleanupNULL<ULONG>>;
+	using OpenMap =
+		COpenHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+					 CleanupNULL<ULONG>, CleanupNULL<ULONG>>;
+
+	const ULONG num_keys = GPOS_OPEN_HASHMAP_BENCHMARK_SIZE;
+	ULONG *keys = GPOS_NEW_ARRAY(mp, ULONG, num_keys);
+	for (ULONG ul = 0; ul < num_keys; ul++)
+	{
+		// spread the keys, colids and mdids are not dense
+		keys[ul] = ul * 7919;
+	}
+
+	ULONG chained_insert_us = 0;
+	ULONG chained_lookup_us = 0;
+	ULONG open_insert_us = 0;
+	ULONG open_lookup_us = 0;
+	RunBenchmark<ChainedMap>(mp, keys, num_keys, &chained_insert_us,
+							 &chained_lookup_us);
+	RunBenchmark<OpenMap>(mp, keys, num_keys, &open_insert_us,
+						  &open_lookup_us);
+
+	{
+		CAutoTrace at(mp);
+		at.Os() << "Hash map benchmark, " << num_keys << " keys, "
+				<< GPOS_OPEN_HASHMAP_BENCHMARK_ROUNDS << " lookup rounds"
+				<< std::endl
+				<< "CHashMap:     insert " << chained_insert_us
+				<< "us, lookup " << chained_lookup_us << "us" << std::endl
+				<< "COpenHashMap: insert " << open_insert_us << "us, lookup "
+				<< open_lookup_us << "us";
+	}
+
+	GPOS_DELETE_ARRAY(keys);
+
+	return GPOS_OK;
+}
+
+// EOF
@@ -6,12 +6,14 @@
 //		CStringTest.cpp
 //
 //	@doc:
-//		Tests for CStringStatic
+//		Tests for CStringStatic and CStringConst
 //---------------------------------------------------------------------------
 
 #include "unittest/gpos/string/CStringTest.h"
 
 #include "gpos/base.h"
+#include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/string/CStringConst.h"
 #include "gpos/string/CStringStatic.h"
 #include "gpos/test/CUnittest.h"
 
@@ -33,6 +35,7 @@ CStringTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CStringTest::EresUnittest_Equals),
 		GPOS_UNITTEST_FUNC(CStringTest::EresUnittest_Append),
 		GPOS_UNITTEST_FUNC(CStringTest::EresUnittest_AppendFormat),
+		GPOS_UNITTEST_FUNC(CStringTest::EresUnittest_Const),
 	};
 
 	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
@@ -142,4 +145,49 @@ CStringTest::EresUnittest_Equals()
 	return GPOS_OK;
 }
 
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStringTest::EresUnittest_Const
+//
+//	@doc:
+//		Test constant UTF-8 strings
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CStringTest::EresUnittest_Const()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	// multi-byte characters are kept as they are, the length is in bytes
+	const CHAR *utf8 = "caf\xc3\xa9";
+	CStringConst str1(utf8);
+	CStringConst str2(mp, utf8);
+	CStringConst str3(mp, "cafe");
+	CStringConst str4(str2);
+
+	GPOS_UNITTEST_ASSERT(5 == str1.Length());
+	GPOS_UNITTEST_ASSERT(utf8 == str1.GetBuffer());
+	GPOS_UNITTEST_ASSERT(utf8 != str2.GetBuffer());
+	GPOS_UNITTEST_ASSERT(str4.GetBuffer() == str2.GetBuffer());
+
+	GPOS_UNITTEST_ASSERT(str1.Equals(&str2));
+	GPOS_UNITTEST_ASSERT(CStringConst::Equals(&str2, &str4));
+	GPOS_UNITTEST_ASSERT(!str1.Equals(&str3));
+	GPOS_UNITTEST_ASSERT(str3.Equals("cafe"));
+	GPOS_UNITTEST_ASSERT(!str3.Equals("caf"));
+	GPOS_UNITTEST_ASSERT(CStringConst::HashValue(&str1) ==
+						 CStringConst::HashValue(&str2));
+
+	// conversion from wide character strings
+	CStringConst str5(mp, GPOS_WSZ_LIT("cafe"));
+	CStringConst str6(mp, GPOS_WSZ_LIT(""));
+	GPOS_UNITTEST_ASSERT(str5.Equals(&str3));
+	GPOS_UNITTEST_ASSERT(str6.IsEmpty());
+	GPOS_UNITTEST_ASSERT(str6.Equals(""));
+
+	return GPOS_OK;
+}
+
 // EOF
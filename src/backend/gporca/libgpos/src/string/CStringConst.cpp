@@ -0,0 +1,197 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2023 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CStringConst.cpp
+//
+//	@doc:
+//		Implementation of the constant UTF-8 string class
+//---------------------------------------------------------------------------
+
+#include "gpos/string/CStringConst.h"
+
+#include "gpos/base.h"
+#include "gpos/common/clibwrapper.h"
+#include "gpos/utils.h"
+
+using namespace gpos;
+
+// buffer of empty strings
+const CHAR CStringConst::m_empty_str = '\0';
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStringConst::CStringConst
+//
+//	@doc:
+//		Initializes a constant string with a given character buffer. The string
+//		does not own the memory
+//
+//---------------------------------------------------------------------------
+CStringConst::CStringConst(const CHAR *str_buffer)
+	: m_str_buffer(str_buffer),
+	  m_length(GPOS_SZ_LENGTH(str_buffer)),
+	  m_owns_memory(false)
+{
+	GPOS_ASSERT(nullptr != str_buffer);
+	GPOS_ASSERT(IsValid());
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStringConst::CStringConst
+//
+//	@doc:
+//		Initializes a constant string by making a copy of the given character
+//		buffer. The string owns the memory.
+//
+//---------------------------------------------------------------------------
+CStringConst::CStringConst(CMemoryPool *mp, const CHAR *str_buffer)
+	: m_str_buffer(nullptr),
+	  m_length(GPOS_SZ_LENGTH(str_buffer)),
+	  m_owns_memory(true)
+{
+	GPOS_ASSERT(nullptr != mp);
+	GPOS_ASSERT(nullptr != str_buffer);
+
+	if (0 == m_length)
+	{
+		// string is empty
+		m_str_buffer = &m_empty_str;
+	}
+	else
+	{
+		// make a copy of the string
+		CHAR *str_temp_buffer = GPOS_NEW_ARRAY(mp, CHAR, m_length + 1);
+		clib::Memcpy(str_temp_buffer, str_buffer, m_length + 1);
+		m_str_buffer = str_temp_buffer;
+	}
+
+	GPOS_ASSERT(IsValid());
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStringConst::CStringConst
+//
+//	@doc:
+//		Initializes a constant string by converting the given wide character
+//		buffer to the multi-byte encoding of the current locale.
+//		The string owns the memory.
+//
+//---------------------------------------------------------------------------
+CStringConst::CStringConst(CMemoryPool *mp, const WCHAR *w_str_buffer)
+	: m_str_buffer(nullptr), m_length(0), m_owns_memory(true)
+{
+	GPOS_ASSERT(nullptr != mp);
+	GPOS_ASSERT(nullptr != w_str_buffer);
+
+	ULONG w_length = GPOS_WSZ_LENGTH(w_str_buffer);
+	if (0 == w_length)
+	{
+		// string is empty
+		m_str_buffer = &m_empty_str;
+	}
+	else
+	{
+		ULONG max_len = w_length * GPOS_SIZEOF(WCHAR) + 1;
+		CHAR *str_buffer = GPOS_NEW_ARRAY(mp, CHAR, max_len);
+#ifdef GPOS_DEBUG
+		LINT li = (INT)
+#endif
+			clib::Wcstombs(str_buffer, const_cast<WCHAR *>(w_str_buffer),
+						   max_len);
+		GPOS_ASSERT(0 <= li);
+
+		str_buffer[max_len - 1] = '\0';
+		m_str_buffer = str_buffer;
+		m_length = GPOS_SZ_LENGTH(str_buffer);
+	}
+
+	GPOS_ASSERT(IsValid());
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStringConst::CStringConst
+//
+//	@doc:
+//		Shallow copy constructor.
+//
+//---------------------------------------------------------------------------
+CStringConst::CStringConst(const CStringConst &str)
+	: m_str_buffer(str.GetBuffer()),
+	  m_length(str.Length()),
+	  m_owns_memory(false)
+{
+	GPOS_ASSERT(nullptr != m_str_buffer);
+	GPOS_ASSERT(IsValid());
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStringConst::~CStringConst
+//
+//	@doc:
+//		Destroys a constant string. This involves releasing the character
+//		buffer provided the string owns it.
+//
+//---------------------------------------------------------------------------
+CStringConst::~CStringConst()
+{
+	if (m_owns_memory && m_str_buffer != &m_empty_str)
+	{
+		GPOS_DELETE_ARRAY(m_str_buffer);
+	}
+}
+
+// checks whether the string is byte-wise equal to another string
+BOOL
+CStringConst::Equals(const CStringConst *str) const
+{
+	GPOS_ASSERT(nullptr != str);
+	return Length() == str->Length() &&
+		   0 == clib::Memcmp(GetBuffer(), str->GetBuffer(), Length());
+}
+
+// checks whether the string is byte-wise equal to a character buffer
+BOOL
+CStringConst::Equals(const CHAR *str_buffer) const
+{
+	GPOS_ASSERT(nullptr != str_buffer);
+	return Length() == GPOS_SZ_LENGTH(str_buffer) &&
+		   0 == clib::Memcmp(GetBuffer(), str_buffer, Length());
+}
+
+// equality
+BOOL
+CStringConst::Equals(const CStringConst *string1, const CStringConst *string2)
+{
+	return string1->Equals(string2);
+}
+
+// hash function
+ULONG
+CStringConst::HashValue(const CStringConst *string)
+{
+	return gpos::HashByteArray((BYTE *) string->GetBuffer(), string->Length());
+}
+
+#ifdef GPOS_DEBUG
+//---------------------------------------------------------------------------
+//	@function:
+//		CStringConst::IsValid
+//
+//	@doc:
+//		Checks whether the string is properly null-terminated
+//
+//---------------------------------------------------------------------------
+BOOL
+CStringConst::IsValid() const
+{
+	return (m_length == GPOS_SZ_LENGTH(m_str_buffer));
+}
+#endif	// GPOS_DEBUG
+
+// EOF
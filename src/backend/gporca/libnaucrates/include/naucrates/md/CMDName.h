@@ -14,6 +14,7 @@
 
 #include "gpos/base.h"
 #include "gpos/common/CDynamicPtrArray.h"
+#include "gpos/string/CStringConst.h"
 #include "gpos/string/CWStringConst.h"
 
 namespace gpmd
@@ -26,21 +27,40 @@ using namespace gpos;
 //
 //	@doc:
 //		Class for representing metadata names.
+//		A name created from a multi-byte string, such as a catalog name,
+//		keeps that string as is and only creates the wide character
+//		version when it is first asked for, so that names which are read
+//		from the catalog and written back to the plan are not converted.
 //
 //---------------------------------------------------------------------------
 class CMDName
 {
 private:
-	// the string holding the name
-	const CWStringConst *m_name;
+	// memory pool used to create the wide character name on demand
+	CMemoryPool *m_mp;
+
+	// the string holding the name, created on demand for names built
+	// from a multi-byte string
+	mutable const CWStringConst *m_name;
 
 	// keep track of copy status
-	BOOL m_deep_copy;
+	mutable BOOL m_deep_copy;
+
+	// the multi-byte string holding the name, if any
+	const CStringConst *m_utf8_name;
+
+	// does the object own the multi-byte string
+	BOOL m_owns_utf8_name;
+
+	// for a copy, the name that owns the strings shared by the copy; the
+	// wide character name is created there, so that it outlives the copy
+	const CMDName *m_owner;
 
 public:
 	// ctor/dtor
 	CMDName(CMemoryPool *mp, const CWStringBase *str);
 	CMDName(const CWStringConst *, BOOL fOwnsMemory = false);
+	CMDName(CMemoryPool *mp, const CHAR *str);
 
 	// shallow copy ctor
 	CMDName(const CMDName &);
@@ -48,10 +68,13 @@ public:
 	~CMDName();
 
 	// accessors
-	const CWStringConst *
-	GetMDName() const
+	const CWStringConst *GetMDName() const;
+
+	// multi-byte name, NULL if the name was created from a wide string
+	const CStringConst *
+	GetMDNameUtf8() const
 	{
-		return m_name;
+		return m_utf8_name;
 	}
 };
 
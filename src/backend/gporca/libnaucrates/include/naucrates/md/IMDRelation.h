@@ -65,6 +65,7 @@ public:
 		AORelationVersion_None,
 		AORelationVersion_GP6,
 		AORelationVersion_GP7,
+		AORelationVersion_GP7_ZoneMaps,
 		MaxAORelationVersion
 	};
 
@@ -1515,13 +1515,10 @@ CDXLUtils::CreateMDNameFromCharArray(CMemoryPool *mp, const CHAR *c)
 {
 	GPOS_ASSERT(nullptr != c);
 
-	// The CMDName will take ownership of the buffer. This ensures we minimize allocations
-	// and improves performance for this very hot code path
-	const CWStringConst *str = GPOS_NEW(mp) CWStringConst(mp, c);
-
-	CMDName *mdname = GPOS_NEW(mp) CMDName(str, true /* owns_memory */);
-
-	return mdname;
+	// keep the multi-byte name as is, the wide character name is only
+	// created if the optimizer asks for it; this very hot code path then
+	// avoids the conversion for names that are only written back to the plan
+	return GPOS_NEW(mp) CMDName(mp, c);
 }
 
 //---------------------------------------------------------------------------
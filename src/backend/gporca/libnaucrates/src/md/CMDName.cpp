@@ -27,7 +27,12 @@ using namespace gpmd;
 //
 //---------------------------------------------------------------------------
 CMDName::CMDName(CMemoryPool *mp, const CWStringBase *str)
-	: m_name(nullptr), m_deep_copy(true)
+	: m_mp(mp),
+	  m_name(nullptr),
+	  m_deep_copy(true),
+	  m_utf8_name(nullptr),
+	  m_owns_utf8_name(false),
+	  m_owner(nullptr)
 {
 	m_name = GPOS_NEW(mp) CWStringConst(mp, str->GetBuffer());
 }
@@ -43,25 +48,92 @@ CMDName::CMDName(CMemoryPool *mp, const CWStringBase *str)
 //
 //---------------------------------------------------------------------------
 CMDName::CMDName(const CWStringConst *str, BOOL owns_memory)
-	: m_name(str), m_deep_copy(owns_memory)
+	: m_mp(nullptr),
+	  m_name(str),
+	  m_deep_copy(owns_memory),
+	  m_utf8_name(nullptr),
+	  m_owns_utf8_name(false),
+	  m_owner(nullptr)
 {
 	GPOS_ASSERT(nullptr != m_name);
 	GPOS_ASSERT(m_name->IsValid());
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDName::CMDName
+//
+//	@doc:
+//		ctor
+//		Creates a deep copy of the provided multi-byte string; the wide
+//		character name is only created if it is asked for
+//
+//---------------------------------------------------------------------------
+CMDName::CMDName(CMemoryPool *mp, const CHAR *str)
+	: m_mp(mp),
+	  m_name(nullptr),
+	  m_deep_copy(false),
+	  m_utf8_name(nullptr),
+	  m_owns_utf8_name(true),
+	  m_owner(nullptr)
+{
+	GPOS_ASSERT(nullptr != mp);
+	GPOS_ASSERT(nullptr != str);
+
+	m_utf8_name = GPOS_NEW(mp) CStringConst(mp, str);
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMDName::CMDName
 //
 //	@doc:
 //		Shallow copy constructor
+//		A name built from a multi-byte string is copied without its wide
+//		character name.  If the copy is asked for it, the copied name
+//		creates and keeps it: copies are often temporaries, and callers
+//		keep the string past them
 //
 //---------------------------------------------------------------------------
 CMDName::CMDName(const CMDName &name)
-	: m_name(name.GetMDName()), m_deep_copy(false)
+	: m_mp(name.m_mp),
+	  m_name(name.m_name),
+	  m_deep_copy(false),
+	  m_utf8_name(name.m_utf8_name),
+	  m_owns_utf8_name(false),
+	  m_owner(nullptr != name.m_owner ? name.m_owner : &name)
 {
-	GPOS_ASSERT(nullptr != m_name->GetBuffer());
-	GPOS_ASSERT(m_name->IsValid());
+	GPOS_ASSERT(nullptr != m_name || nullptr != m_utf8_name);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDName::GetMDName
+//
+//	@doc:
+//		Returns the wide character name, converting the multi-byte name on
+//		first use
+//
+//---------------------------------------------------------------------------
+const CWStringConst *
+CMDName::GetMDName() const
+{
+	if (nullptr == m_name && nullptr != m_owner)
+	{
+		// the name shares the multi-byte string of its owner, so it may as
+		// well share the wide one
+		m_name = m_owner->GetMDName();
+	}
+	else if (nullptr == m_name)
+	{
+		GPOS_ASSERT(nullptr != m_utf8_name);
+		GPOS_ASSERT(nullptr != m_mp);
+
+		m_name = GPOS_NEW(m_mp) CWStringConst(m_mp, m_utf8_name->GetBuffer());
+		m_deep_copy = true;
+	}
+
+	return m_name;
 }
 
 
@@ -75,12 +147,17 @@ CMDName::CMDName(const CMDName &name)
 //---------------------------------------------------------------------------
 CMDName::~CMDName()
 {
-	GPOS_ASSERT(m_name->IsValid());
+	GPOS_ASSERT(nullptr == m_name || m_name->IsValid());
 
 	if (m_deep_copy)
 	{
 		GPOS_DELETE(m_name);
 	}
+
+	if (m_owns_utf8_name)
+	{
+		GPOS_DELETE(m_utf8_name);
+	}
 }
 
 // EOF
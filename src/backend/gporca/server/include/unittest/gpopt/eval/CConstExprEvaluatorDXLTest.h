@@ -99,6 +99,9 @@ public:
 
 	// test that evaluation fails for a scalar with variables
 	static GPOS_RESULT EresUnittest_ScalarContainingVariables();
+
+	// test evaluating a batch of expressions
+	static GPOS_RESULT EresUnittest_Batch();
 };
 }  // namespace gpopt
 
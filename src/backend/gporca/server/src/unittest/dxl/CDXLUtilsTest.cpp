@@ -25,11 +25,13 @@
 #include "naucrates/dxl/CDXLUtils.h"
 #include "naucrates/dxl/xml/CDXLMemoryManager.h"
 #include "naucrates/dxl/xml/CXMLSerializer.h"
+#include "naucrates/md/CMDName.h"
 
 XERCES_CPP_NAMESPACE_USE
 
 using namespace gpos;
 using namespace gpdxl;
+using namespace gpmd;
 
 static const char *szQueryFile =
 	"../data/dxl/expressiontests/TableScanQuery.xml";
@@ -50,6 +52,7 @@ CDXLUtilsTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_SerializeQuery),
 		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_SerializePlan),
 		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_Encoding),
+		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_MDNameCopy),
 	};
 
 	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
@@ -231,4 +234,39 @@ CDXLUtilsTest::EresUnittest_Encoding()
 	return GPOS_OK;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtilsTest::EresUnittest_MDNameCopy
+//
+//	@doc:
+//		The wide character name of a shallow copy of a name created from a
+//		multi-byte string outlives the copy, including copies of copies
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLUtilsTest::EresUnittest_MDNameCopy()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CWStringConst strExpected(GPOS_WSZ_LIT("colname"));
+	CMDName *pmdname = CDXLUtils::CreateMDNameFromCharArray(mp, "colname");
+
+	CMDName *pmdnameCopy = GPOS_NEW(mp) CMDName(*pmdname);
+	CMDName *pmdnameCopyOfCopy = GPOS_NEW(mp) CMDName(*pmdnameCopy);
+	GPOS_DELETE(pmdnameCopy);
+
+	const CWStringConst *pstr = pmdnameCopyOfCopy->GetMDName();
+	GPOS_DELETE(pmdnameCopyOfCopy);
+
+	// the string belongs to the original name
+	GPOS_UNITTEST_ASSERT(pstr == pmdname->GetMDName());
+	GPOS_UNITTEST_ASSERT(pstr->Equals(&strExpected));
+	GPOS_UNITTEST_ASSERT(pmdname->GetMDNameUtf8()->Equals("colname"));
+
+	GPOS_DELETE(pmdname);
+
+	return GPOS_OK;
+}
+
 // EOF
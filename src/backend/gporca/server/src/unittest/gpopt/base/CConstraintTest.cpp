@@ -19,11 +19,13 @@
 
 #include "gpos/task/CAutoTraceFlag.h"
 
+#include "gpopt/base/CDatumSortedSet.h"
 #include "gpopt/base/CDefaultComparator.h"
 #include "gpopt/base/CUtils.h"
 #include "gpopt/eval/CConstExprEvaluatorDefault.h"
 #include "gpopt/exception.h"
 #include "gpopt/operators/CPredicateUtils.h"
+#include "gpopt/operators/CScalarArray.h"
 #include "naucrates/base/CDatumInt8GPDB.h"
 #include "naucrates/md/CMDIdGPDB.h"
 #include "naucrates/md/IMDScalarOp.h"
@@ -906,9 +908,34 @@ CConstraintTest::EresUnittest_CConstraintIntervalFromArrayExpr()
 		CConstraintInterval::PciIntervalFromScalarExpr(mp, pexprArrayCmpRepeats,
 													   pcrInRepeats);
 	GPOS_UNITTEST_ASSERT(5 == pcnstInRepeats->Pdrgprng()->Size());
-	pexprInRepeatsSelect->Release();
 	pcnstInRepeats->Release();
 
+	// the same IN expression with a collapsed array; the sorted constants
+	// are cached in the array operator and reused by later derivations
+	CExpression *pexprCollapsedRepeats =
+		CUtils::PexprCollapseConstArray(mp, pexprArrayCmpRepeats);
+	CExpression *pexprCollapsedArray =
+		CUtils::PexprScalarArrayChild(pexprCollapsedRepeats);
+	GPOS_UNITTEST_ASSERT(CUtils::FScalarArrayCollapsed(pexprCollapsedArray));
+	for (ULONG ul = 0; ul < 2; ul++)
+	{
+		CConstraintInterval *pcnstCollapsed =
+			CConstraintInterval::PciIntervalFromScalarExpr(
+				mp, pexprCollapsedRepeats, pcrInRepeats);
+		GPOS_UNITTEST_ASSERT(5 == pcnstCollapsed->Pdrgprng()->Size());
+		pcnstCollapsed->Release();
+	}
+	CScalarArray *popCollapsedArray =
+		CScalarArray::PopConvert(pexprCollapsedArray->Pop());
+	const IComparator *pcomp = COptCtxt::PoctxtFromTLS()->Pcomp();
+	CDatumSortedSet *pdatumsortedset =
+		popCollapsedArray->PdatumsortedsetConst(pcomp);
+	GPOS_UNITTEST_ASSERT(5 == pdatumsortedset->Size());
+	GPOS_UNITTEST_ASSERT(pdatumsortedset ==
+						 popCollapsedArray->PdatumsortedsetConst(pcomp));
+	pexprCollapsedRepeats->Release();
+	pexprInRepeatsSelect->Release();
+
 	// create a NOT IN expression with repeated values
 	CExpression *pexprNotInRepeatsSelect =
 		CTestUtils::PexprLogicalSelectArrayCmp(mp, CScalarArrayCmp::EarrcmpAll,
@@ -23,6 +23,8 @@
 #include "gpopt/exception.h"
 #include "gpopt/mdcache/CMDAccessor.h"
 #include "gpopt/operators/CExpression.h"
+#include "gpopt/operators/CScalarConst.h"
+#include "naucrates/base/IDatumInt4.h"
 #include "naucrates/dxl/operators/CDXLDatumInt4.h"
 #include "naucrates/dxl/operators/CDXLNode.h"
 #include "naucrates/dxl/operators/CDXLScalarConstValue.h"
@@ -85,6 +87,7 @@ CConstExprEvaluatorDXLTest::EresUnittest()
 										 EresUnittest_ScalarContainingVariables,
 									 gpdxl::ExmaGPOPT,
 									 gpdxl::ExmiEvalUnsupportedScalarExpr),
+			GPOS_UNITTEST_FUNC(CConstExprEvaluatorDXLTest::EresUnittest_Batch),
 		};
 
 		return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
@@ -191,4 +194,53 @@ CConstExprEvaluatorDXLTest::EresUnittest_ScalarContainingVariables()
 	return GPOS_OK;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorDXLTest::EresUnittest_Batch
+//
+//	@doc:
+//		Test that a batch of expressions is evaluated in order and produces
+//		one result per expression.
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CConstExprEvaluatorDXLTest::EresUnittest_Batch()
+{
+	CTestUtils::CTestSetup testsetup;
+	CMemoryPool *mp = testsetup.Pmp();
+	CDummyConstDXLNodeEvaluator consteval(mp, testsetup.Pmda(),
+										  m_iDefaultEvalValue);
+	CConstExprEvaluatorDXL *pceeval =
+		GPOS_NEW(mp) CConstExprEvaluatorDXL(mp, testsetup.Pmda(), &consteval);
+
+	const ULONG ulExprs = 5;
+	CExpressionArray *pdrgpexpr = GPOS_NEW(mp) CExpressionArray(mp);
+	for (ULONG ul = 0; ul < ulExprs; ul++)
+	{
+		pdrgpexpr->Append(CUtils::PexprScalarEqCmp(
+			mp, CUtils::PexprScalarConstInt4(mp, 100 /*val*/),
+			CUtils::PexprScalarConstInt4(mp, ul /*val*/)));
+	}
+
+	CExpressionArray *pdrgpexprResult = pceeval->PdrgpexprEval(mp, pdrgpexpr);
+	GPOS_UNITTEST_ASSERT(ulExprs == pdrgpexprResult->Size());
+	for (ULONG ul = 0; ul < ulExprs; ul++)
+	{
+		CExpression *pexprResult = (*pdrgpexprResult)[ul];
+		GPOS_UNITTEST_ASSERT(COperator::EopScalarConst ==
+							 pexprResult->Pop()->Eopid());
+
+		CScalarConst *popConst = CScalarConst::PopConvert(pexprResult->Pop());
+		IDatumInt4 *datum = dynamic_cast<IDatumInt4 *>(popConst->GetDatum());
+		GPOS_UNITTEST_ASSERT(nullptr != datum);
+		GPOS_UNITTEST_ASSERT(m_iDefaultEvalValue == datum->Value());
+	}
+
+	pdrgpexprResult->Release();
+	pdrgpexpr->Release();
+	pceeval->Release();
+
+	return GPOS_OK;
+}
+
 // EOF
@@ -181,6 +181,30 @@ jit_compile_expr(struct ExprState *state)
 	return false;
 }
 
+/*
+ * Attempt to JIT compile a function deforming the memtuples of the given
+ * binding, for the storage layers that don't go through the executor's
+ * expression machinery, e.g. scans of append-optimized tables.
+ *
+ * The JIT context is created in *context if it's NULL, and has to be
+ * released by the caller with jit_release_context(). Returns NULL if no
+ * function could be compiled, the caller has to fall back to
+ * memtuple_deform() then.
+ */
+void *
+jit_compile_memtuple_deform(JitContext **context, struct MemTupleBinding *pbind)
+{
+	/* or if deforming isn't JITed */
+	if (!jit_tuple_deforming)
+		return NULL;
+
+	/* this also takes !jit_enabled into account */
+	if (provider_init() && provider.compile_memtuple_deform != NULL)
+		return provider.compile_memtuple_deform(context, pbind);
+
+	return NULL;
+}
+
 /* Aggregate JIT instrumentation information */
 void
 InstrJitAgg(JitInstrumentation *dst, JitInstrumentation *add)
@@ -1,7 +1,7 @@
 /*-------------------------------------------------------------------------
  *
  * llvmjit_deform.c
- *	  Generate code for deforming a heap tuple.
+ *	  Generate code for deforming a heap tuple or a memtuple.
  *
  * This gains performance benefits over unJITed deforming from compile-time
  * knowledge of the tuple descriptor. Fixed column widths, NOT NULLness, etc
@@ -21,12 +21,14 @@
 #include <llvm-c/Core.h>
 
 #include "access/htup_details.h"
+#include "access/memtup.h"
 #include "access/tupdesc_details.h"
 #include "catalog/pg_subscription.h"
 #include "catalog/pg_subscription_rel.h"
 #include "executor/tuptable.h"
 #include "jit/llvmjit.h"
 #include "jit/llvmjit_emit.h"
+#include "portability/instr_time.h"
 
 
 /*
@@ -770,3 +772,334 @@ slot_compile_deform(LLVMJitContext *context, TupleDesc desc,
 
 	return v_deform_fn;
 }
+
+
+/*
+ * Emit the code to fetch an attribute of a memtuple, found at offset
+ * 'v_off' from 'v_start', into values[attnum] and isnull[attnum].
+ */
+static void
+memtuple_compile_fetch(LLVMBuilderRef b, MemTupleAttrBinding *bind,
+					   LLVMValueRef v_start, LLVMValueRef v_off,
+					   LLVMValueRef v_values, LLVMValueRef v_isnull, int attnum)
+{
+	LLVMValueRef l_attno = l_int32_const(attnum);
+	LLVMValueRef v_attp;
+	LLVMValueRef v_datum;
+
+	v_attp = LLVMBuildGEP(b, v_start, &v_off, 1, "attp");
+
+	switch (bind->flag)
+	{
+		case MTB_ByVal_Native:
+			v_datum = LLVMBuildLoad(b,
+									LLVMBuildPointerCast(b, v_attp,
+														 l_ptr(LLVMIntType(bind->len * 8)),
+														 ""),
+									"attr_byval");
+			v_datum = LLVMBuildZExt(b, v_datum, TypeSizeT, "");
+			break;
+		case MTB_ByVal_Ptr:
+			v_datum = LLVMBuildPtrToInt(b, v_attp, TypeSizeT, "attr_ptr");
+			break;
+		case MTB_ByRef:
+		case MTB_ByRef_CStr:
+			{
+				LLVMValueRef v_varoff;
+
+				/* the attribute holds the offset of the data from the start */
+				Assert(bind->len == 2 || bind->len == 4);
+				v_varoff = LLVMBuildLoad(b,
+										 LLVMBuildPointerCast(b, v_attp,
+															  l_ptr(LLVMIntType(bind->len * 8)),
+															  ""),
+										 "varoff");
+				v_varoff = LLVMBuildZExt(b, v_varoff, LLVMInt32Type(), "");
+				v_datum = LLVMBuildPtrToInt(b,
+											LLVMBuildGEP(b, v_start, &v_varoff, 1, ""),
+											TypeSizeT, "attr_ptr");
+			}
+			break;
+		default:
+			elog(ERROR, "unrecognized memtuple binding flag: %d", bind->flag);
+			pg_unreachable();
+	}
+
+	LLVMBuildStore(b, v_datum, LLVMBuildGEP(b, v_values, &l_attno, 1, ""));
+	LLVMBuildStore(b, l_sbool_const(0), LLVMBuildGEP(b, v_isnull, &l_attno, 1, ""));
+}
+
+/*
+ * Emit the code computing the bytes saved by the null attributes
+ * represented by the null bitmap byte 'v_byte' at 'byteno', see
+ * compute_null_save_b().
+ */
+static LLVMValueRef
+memtuple_compile_null_save(LLVMBuilderRef b, LLVMValueRef v_null_saves,
+						   int byteno, LLVMValueRef v_byte)
+{
+	LLVMValueRef v_idx[2];
+	LLVMValueRef v_low;
+	LLVMValueRef v_high;
+
+	v_byte = LLVMBuildZExt(b, v_byte, LLVMInt32Type(), "");
+
+	v_idx[0] = l_int32_const(0);
+	v_idx[1] = LLVMBuildAdd(b, l_int32_const(byteno * 32),
+							LLVMBuildAnd(b, v_byte, l_int32_const(0xF), ""), "");
+	v_low = LLVMBuildLoad(b, LLVMBuildGEP(b, v_null_saves, v_idx, 2, ""), "");
+
+	v_idx[1] = LLVMBuildAdd(b, l_int32_const(byteno * 32 + 16),
+							LLVMBuildLShr(b, v_byte, l_int32_const(4), ""), "");
+	v_high = LLVMBuildLoad(b, LLVMBuildGEP(b, v_null_saves, v_idx, 2, ""), "");
+
+	return LLVMBuildAdd(b,
+						LLVMBuildSExt(b, v_low, LLVMInt32Type(), ""),
+						LLVMBuildSExt(b, v_high, LLVMInt32Type(), ""),
+						"null_save");
+}
+
+/*
+ * Emit the code deforming memtuples using the given column bindings, i.e.
+ * the bindings of either small or large memtuples, starting at block
+ * 'b_start'.
+ *
+ * Without nulls, every attribute is at a fixed offset. With nulls, the
+ * offset of an attribute is reduced by the space saved by the null
+ * attributes physically preceding it, as in memtuple_get_attr_ptr().
+ */
+static void
+memtuple_compile_deform_cols(LLVMJitContext *context, LLVMModuleRef mod,
+							 LLVMBuilderRef b, LLVMValueRef v_deform_fn,
+							 LLVMBasicBlockRef b_start,
+							 MemTupleBinding *pbind, MemTupleBindingCols *colbind,
+							 const char *name)
+{
+	LLVMValueRef v_tuple = LLVMGetParam(v_deform_fn, 0);
+	LLVMValueRef v_values = LLVMGetParam(v_deform_fn, 1);
+	LLVMValueRef v_isnull = LLVMGetParam(v_deform_fn, 2);
+	LLVMValueRef v_len;
+	LLVMValueRef v_hasnull;
+	LLVMValueRef v_start;
+	LLVMValueRef v_nullp;
+	LLVMValueRef v_null_saves;
+	LLVMValueRef *v_prefix_saves;
+	LLVMBasicBlockRef b_nonulls;
+	LLVMBasicBlockRef b_nulls;
+	int			natts = pbind->natts;
+	int			nbytes = (natts + 7) / 8;
+
+	b_nonulls = l_bb_append_v(v_deform_fn, "%s.nonulls", name);
+	b_nulls = l_bb_append_v(v_deform_fn, "%s.nulls", name);
+
+	LLVMPositionBuilderAtEnd(b, b_start);
+	v_len = LLVMBuildLoad(b,
+						  LLVMBuildPointerCast(b, v_tuple, l_ptr(LLVMInt32Type()), ""),
+						  "mt_len");
+	v_hasnull = LLVMBuildICmp(b, LLVMIntNE,
+							  LLVMBuildAnd(b, v_len, l_int32_const(MEMTUP_HASNULL), ""),
+							  l_int32_const(0), "hasnull");
+	LLVMBuildCondBr(b, v_hasnull, b_nulls, b_nonulls);
+
+	/* without nulls, all attributes are at their binding's offset */
+	LLVMPositionBuilderAtEnd(b, b_nonulls);
+	for (int attnum = 0; attnum < natts; attnum++)
+		memtuple_compile_fetch(b, &colbind->bindings[attnum], v_tuple,
+							   l_int32_const(colbind->bindings[attnum].offset),
+							   v_values, v_isnull, attnum);
+	LLVMBuildRetVoid(b);
+
+	/*
+	 * With nulls, the data starts after the extra space of the null bitmap.
+	 * Embed the null saves of the bindings as a constant array.
+	 */
+	{
+		int			nsaves = nbytes * 32;
+		LLVMValueRef *v_saves = palloc(sizeof(LLVMValueRef) * nsaves);
+		LLVMTypeRef t_saves = LLVMArrayType(LLVMInt16Type(), nsaves);
+		char	   *savesname = psprintf("%s_null_saves_%s",
+										 LLVMGetValueName(v_deform_fn), name);
+
+		for (int i = 0; i < nsaves; i++)
+			v_saves[i] = l_int16_const(colbind->null_saves[i]);
+
+		v_null_saves = LLVMAddGlobal(mod, t_saves, savesname);
+		LLVMSetInitializer(v_null_saves, LLVMConstArray(LLVMInt16Type(), v_saves, nsaves));
+		LLVMSetGlobalConstant(v_null_saves, true);
+		LLVMSetLinkage(v_null_saves, LLVMPrivateLinkage);
+		pfree(v_saves);
+		pfree(savesname);
+	}
+
+	LLVMPositionBuilderAtEnd(b, b_nulls);
+	{
+		LLVMValueRef v_extra = l_int32_const(pbind->null_bitmap_extra_size);
+		LLVMValueRef v_bitsoff = l_int32_const(offsetof(MemTupleData, PRIVATE_mt_bits));
+
+		v_start = LLVMBuildGEP(b, v_tuple, &v_extra, 1, "start");
+		v_nullp = LLVMBuildGEP(b, v_tuple, &v_bitsoff, 1, "nullp");
+	}
+
+	/* space saved by the null attributes of all preceding null bitmap bytes */
+	v_prefix_saves = palloc(sizeof(LLVMValueRef) * nbytes);
+	v_prefix_saves[0] = l_int32_const(0);
+	for (int byteno = 1; byteno < nbytes; byteno++)
+	{
+		LLVMValueRef l_byteno = l_int32_const(byteno - 1);
+		LLVMValueRef v_byte = l_load_gep1(b, v_nullp, l_byteno, "");
+
+		v_prefix_saves[byteno] =
+			LLVMBuildAdd(b, v_prefix_saves[byteno - 1],
+						 memtuple_compile_null_save(b, v_null_saves, byteno - 1, v_byte),
+						 "");
+	}
+
+	for (int attnum = 0; attnum < natts; attnum++)
+	{
+		MemTupleAttrBinding *bind = &colbind->bindings[attnum];
+		LLVMValueRef l_attno = l_int32_const(attnum);
+		LLVMBasicBlockRef b_isnull;
+		LLVMBasicBlockRef b_notnull;
+		LLVMBasicBlockRef b_next;
+		LLVMValueRef v_byte;
+		LLVMValueRef v_ns;
+		LLVMValueRef v_off;
+
+		b_isnull = l_bb_append_v(v_deform_fn, "%s.attr.%d.isnull", name, attnum);
+		b_notnull = l_bb_append_v(v_deform_fn, "%s.attr.%d.notnull", name, attnum);
+		b_next = l_bb_append_v(v_deform_fn, "%s.attr.%d.next", name, attnum);
+
+		v_byte = l_load_gep1(b, v_nullp, l_int32_const(bind->null_byte), "nullbyte");
+		LLVMBuildCondBr(b,
+						LLVMBuildICmp(b, LLVMIntNE,
+									  LLVMBuildAnd(b, v_byte, l_int8_const(bind->null_mask), ""),
+									  l_int8_const(0), ""),
+						b_isnull, b_notnull);
+
+		LLVMPositionBuilderAtEnd(b, b_isnull);
+		LLVMBuildStore(b, l_sizet_const(0), LLVMBuildGEP(b, v_values, &l_attno, 1, ""));
+		LLVMBuildStore(b, l_sbool_const(1), LLVMBuildGEP(b, v_isnull, &l_attno, 1, ""));
+		LLVMBuildBr(b, b_next);
+
+		LLVMPositionBuilderAtEnd(b, b_notnull);
+		v_ns = memtuple_compile_null_save(b, v_null_saves, bind->null_byte,
+										  LLVMBuildAnd(b, v_byte,
+													   l_int8_const(bind->null_mask - 1), ""));
+		v_ns = LLVMBuildAdd(b, v_prefix_saves[bind->null_byte], v_ns, "");
+		v_off = LLVMBuildSub(b, l_int32_const(bind->offset), v_ns, "off");
+		memtuple_compile_fetch(b, bind, v_start, v_off, v_values, v_isnull, attnum);
+		LLVMBuildBr(b, b_next);
+
+		LLVMPositionBuilderAtEnd(b, b_next);
+	}
+	LLVMBuildRetVoid(b);
+
+	pfree(v_prefix_saves);
+}
+
+/*
+ * Create a function that deforms the memtuples of the given binding, with
+ * the signature of MemTupleDeformFunc.
+ *
+ * Like memtuple_deform(), but the offsets, lengths and null saves of the
+ * bindings are compiled in, for both small and large memtuples.
+ */
+static LLVMValueRef
+memtuple_compile_deform(LLVMJitContext *context, MemTupleBinding *pbind)
+{
+	char	   *funcname;
+	LLVMModuleRef mod;
+	LLVMBuilderRef b;
+	LLVMTypeRef deform_sig;
+	LLVMValueRef v_deform_fn;
+	LLVMValueRef v_len;
+	LLVMBasicBlockRef b_entry;
+	LLVMBasicBlockRef b_small;
+	LLVMBasicBlockRef b_large;
+
+	mod = llvm_mutable_module(context);
+
+	funcname = llvm_expand_funcname(context, "deform_memtuple");
+
+	/* Create the signature and function */
+	{
+		LLVMTypeRef param_types[3];
+
+		param_types[0] = l_ptr(LLVMInt8Type());
+		param_types[1] = l_ptr(TypeSizeT);
+		param_types[2] = l_ptr(TypeStorageBool);
+
+		deform_sig = LLVMFunctionType(LLVMVoidType(), param_types,
+									  lengthof(param_types), 0);
+	}
+	v_deform_fn = LLVMAddFunction(mod, funcname, deform_sig);
+	LLVMSetParamAlignment(LLVMGetParam(v_deform_fn, 0), MAXIMUM_ALIGNOF);
+	llvm_copy_attributes(AttributeTemplate, v_deform_fn);
+
+	b_entry = LLVMAppendBasicBlock(v_deform_fn, "entry");
+	b_small = LLVMAppendBasicBlock(v_deform_fn, "small");
+	b_large = LLVMAppendBasicBlock(v_deform_fn, "large");
+
+	b = LLVMCreateBuilder();
+
+	/* the bindings differ in the width of the varlena offsets */
+	LLVMPositionBuilderAtEnd(b, b_entry);
+	v_len = LLVMBuildLoad(b,
+						  LLVMBuildPointerCast(b, LLVMGetParam(v_deform_fn, 0),
+											   l_ptr(LLVMInt32Type()), ""),
+						  "mt_len");
+	LLVMBuildCondBr(b,
+					LLVMBuildICmp(b, LLVMIntNE,
+								  LLVMBuildAnd(b, v_len, l_int32_const(MEMTUP_LARGETUP), ""),
+								  l_int32_const(0), "islarge"),
+					b_large, b_small);
+
+	memtuple_compile_deform_cols(context, mod, b, v_deform_fn, b_small,
+								 pbind, &pbind->bind, "small");
+	memtuple_compile_deform_cols(context, mod, b, v_deform_fn, b_large,
+								 pbind, &pbind->large_bind, "large");
+
+	LLVMDisposeBuilder(b);
+
+	return v_deform_fn;
+}
+
+/*
+ * JIT compile a function deforming the memtuples of the given binding,
+ * which must cover all attributes of its tuple descriptor.
+ *
+ * A JIT context is created in *jit_context if it is NULL. The function
+ * lives as long as the context, and doesn't reference the binding.
+ */
+void *
+llvm_compile_memtuple_deform(JitContext **jit_context, MemTupleBinding *pbind)
+{
+	LLVMJitContext *context;
+	LLVMValueRef v_deform_fn;
+	void	   *func;
+	instr_time	starttime;
+	instr_time	endtime;
+
+	Assert(pbind->natts == pbind->tupdesc->natts);
+
+	if (pbind->natts == 0)
+		return NULL;
+
+	llvm_enter_fatal_on_oom();
+
+	if (*jit_context == NULL)
+		*jit_context = &llvm_create_context(PGJIT_PERFORM | PGJIT_OPT3 | PGJIT_DEFORM)->base;
+	context = (LLVMJitContext *) *jit_context;
+
+	INSTR_TIME_SET_CURRENT(starttime);
+	v_deform_fn = memtuple_compile_deform(context, pbind);
+	INSTR_TIME_SET_CURRENT(endtime);
+	INSTR_TIME_ACCUM_DIFF(context->base.instr.generation_counter,
+						  endtime, starttime);
+
+	func = llvm_get_function(context, LLVMGetValueName(v_deform_fn));
+
+	llvm_leave_fatal_on_oom();
+
+	return func;
+}
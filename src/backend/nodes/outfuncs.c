@@ -1354,6 +1354,8 @@ _outMotion(StringInfo str, const Motion *node)
 	WRITE_INT_FIELD(segidColIdx);
 
 	WRITE_INT_FIELD(numHashSegments);
+	WRITE_ENUM_FIELD(hotKeyPolicy, MotionHotKeyPolicy);
+	WRITE_NODE_FIELD(hotKeyHashes);
 
 	/* senderSliceInfo is intentionally omitted. It's only used during planning */
 
@@ -2705,6 +2707,8 @@ _outCdbMotionPath(StringInfo str, const CdbMotionPath *node)
     _outPathInfo(str, &node->path);
 
     WRITE_NODE_FIELD(subpath);
+	WRITE_ENUM_FIELD(hotKeyPolicy, MotionHotKeyPolicy);
+	WRITE_NODE_FIELD(hotKeyHashes);
 }
 
 static void
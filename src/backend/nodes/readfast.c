@@ -1060,6 +1060,8 @@ _readMotion(void)
 
 	READ_INT_FIELD(segidColIdx);
 	READ_INT_FIELD(numHashSegments);
+	READ_ENUM_FIELD(hotKeyPolicy, MotionHotKeyPolicy);
+	READ_NODE_FIELD(hotKeyHashes);
 
 	ReadCommonPlan(&local_node->plan);
 
@@ -8177,6 +8177,10 @@ cdbpathtoplan_create_motion_plan(PlannerInfo *root,
 									hashExprs,
 									hashOpfamilies,
 									numHashSegments);
+
+		/* Hot keys of a hybrid redistribution */
+		motion->hotKeyPolicy = path->hotKeyPolicy;
+		motion->hotKeyHashes = path->hotKeyHashes;
     }
 	/* Hashed redistribution to all QEs in gang above... */
 	else if (CdbPathLocus_IsStrewn(path->path.locus))
@@ -5224,6 +5224,75 @@ evaluate_expr(Expr *expr, Oid result_type, int32 result_typmod,
 							  resultTypByVal);
 }
 
+/*
+ * evaluate_expr_list: pre-evaluate a list of constant expressions
+ *
+ * Like evaluate_expr(), but all the expressions share a single executor
+ * state, so that callers folding many expressions at once (such as ORCA's
+ * constant expression evaluator) don't pay for setting up and tearing down
+ * an EState for each of them.  The result type, typmod and collation of each
+ * expression are taken from the expression itself.  Returns a list of Consts,
+ * in the same order as the input.
+ */
+List *
+evaluate_expr_list(List *exprs)
+{
+	EState	   *estate;
+	ExprContext *econtext;
+	List	   *result = NIL;
+	ListCell   *lc;
+
+	estate = CreateExecutorState();
+	econtext = GetPerTupleExprContext(estate);
+
+	foreach(lc, exprs)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+		Oid			result_type = exprType((Node *) expr);
+		int32		result_typmod = exprTypmod((Node *) expr);
+		Oid			result_collation = exprCollation((Node *) expr);
+		ExprState  *exprstate;
+		MemoryContext oldcontext;
+		Datum		const_val;
+		bool		const_is_null;
+		int16		resultTypLen;
+		bool		resultTypByVal;
+
+		oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+
+		fix_opfuncids((Node *) expr);
+		exprstate = ExecInitExpr(expr, NULL);
+		const_val = ExecEvalExprSwitchContext(exprstate, econtext,
+											  &const_is_null);
+
+		get_typlenbyval(result_type, &resultTypLen, &resultTypByVal);
+
+		MemoryContextSwitchTo(oldcontext);
+
+		/* copy the result out of the per-tuple context, see evaluate_expr() */
+		if (!const_is_null)
+		{
+			if (resultTypLen == -1)
+				const_val = PointerGetDatum(PG_DETOAST_DATUM_COPY(const_val));
+			else
+				const_val = datumCopy(const_val, resultTypByVal, resultTypLen);
+		}
+
+		/* the next expression doesn't need the junk this one left behind */
+		ResetExprContext(econtext);
+
+		result = lappend(result,
+						 makeConst(result_type, result_typmod, result_collation,
+								   resultTypLen,
+								   const_val, const_is_null,
+								   resultTypByVal));
+	}
+
+	FreeExecutorState(estate);
+
+	return result;
+}
+
 
 /*
  * inline_set_returning_function
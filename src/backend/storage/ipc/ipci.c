@@ -56,6 +56,7 @@
 #include "utils/faultinjector.h"
 #include "utils/sharedsnapshot.h"
 #include "utils/gpexpand.h"
+#include "utils/orcamdcache.h"
 #include "utils/snapmgr.h"
 
 #include "libpq-fe.h"
@@ -71,6 +72,8 @@
 #include "cdb/cdbendpoint.h"
 #include "replication/gp_replication.h"
 #include "cdb/ic_proxy_bgworker.h"
+#include "cdb/ic_stats.h"
+#include "cdb/ml_ipc.h"
 
 /* GUCs */
 int			shared_memory_type = DEFAULT_SHARED_MEMORY_TYPE;
@@ -198,6 +201,7 @@ CreateSharedMemoryAndSemaphores(int port)
 		size = add_size(size, CancelBackendMsgShmemSize());
 		size = add_size(size, WorkFileShmemSize());
 		size = add_size(size, ShareInputShmemSize());
+		size = add_size(size, ICStatsShmemSize());
 
 #ifdef FAULT_INJECTOR
 		size = add_size(size, FaultInjector_ShmemSize());
@@ -233,6 +237,9 @@ CreateSharedMemoryAndSemaphores(int port)
 		/* size of parallel cursor count */
 		size = add_size(size, ParallelCursorCountSize());
 
+		/* size of ORCA shared metadata cache */
+		size = add_size(size, OrcaMDCacheShmemSize());
+
 		elog(DEBUG3, "invoking IpcMemoryCreate(size=%zu)", size);
 
 		/*
@@ -376,6 +383,7 @@ CreateSharedMemoryAndSemaphores(int port)
 	BackendCancelShmemInit();
 	WorkFileShmemInit();
 	ShareInputShmemInit();
+	ICStatsShmemInit();
 
 	/*
 	 * Set up Instrumentation free list
@@ -401,6 +409,10 @@ CreateSharedMemoryAndSemaphores(int port)
 	if (!IsUnderPostmaster)
 		dsm_postmaster_startup(shim);
 
+	/* Remove the interconnect rings that crashed backends left behind */
+	if (!IsUnderPostmaster)
+		CleanupShmRingsUDPIFC();
+
 	/* Initialize shared memory for parallel retrieve cursor */
 	if (!IsUnderPostmaster)
 		EndpointShmemInit();
@@ -408,6 +420,9 @@ CreateSharedMemoryAndSemaphores(int port)
 	if (Gp_role == GP_ROLE_DISPATCH)
 		ParallelCursorCountInit();
 
+	/* Initialize ORCA shared metadata cache, if enabled */
+	OrcaMDCacheShmemInit();
+
 	/*
 	 * Now give loadable modules a chance to set up their shmem allocations
 	 */
@@ -21,6 +21,7 @@
 #include "storage/proc.h"
 #include "storage/sinvaladt.h"
 #include "utils/inval.h"
+#include "utils/orcamdcache.h"
 
 #include "cdb/cdbtm.h"          /* DtxContext */
 
@@ -50,11 +51,16 @@ volatile int in_process_catchup_event = 0;
 /*
  * SendSharedInvalidMessages
  *	Add shared-cache-invalidation message(s) to the global SI message queue.
+ *
+ * The messages are sent once the changes are committed, so this is also where
+ * the ORCA shared metadata cache is invalidated, for all backends at once.
  */
 void
 SendSharedInvalidMessages(const SharedInvalidationMessage *msgs, int n)
 {
 	SIInsertDataEntries(msgs, n);
+
+	OrcaMDCacheInvalidate();
 }
 
 /*
@@ -991,6 +991,17 @@ ProcessCommittedInvalidationMessages(SharedInvalidationMessage *msgs,
 		RelationCacheInitFilePostInvalidate();
 }
 
+/*
+ * TransactionHasPendingInvalidations
+ *		Has the current transaction queued invalidation messages, that is,
+ *		changed the catalogs in a way that other backends do not see yet?
+ */
+bool
+TransactionHasPendingInvalidations(void)
+{
+	return transInvalInfo != NULL;
+}
+
 /*
  * AtEOXact_Inval
  *		Process queued-up invalidation messages at end of main transaction.
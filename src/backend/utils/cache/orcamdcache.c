@@ -0,0 +1,386 @@
+/*-------------------------------------------------------------------------
+ *
+ * orcamdcache.c
+ *	  Coordinator-wide shared memory cache of serialized ORCA metadata
+ *	  objects.
+ *
+ * ORCA keeps its metadata cache (CMDCache) in backend-private memory, so
+ * every new session starts cold and has to translate every relation, type,
+ * operator and statistics object it touches from the relcache again.  This
+ * module provides a second-level cache in shared memory, shared by all
+ * backends on the coordinator, that holds the serialized (DXL) form of the
+ * metadata objects.  The relcache metadata provider consults it before
+ * translating an object from the catalogs, and publishes every object it
+ * translates.
+ *
+ * The cache consists of a fixed-size arena, sized by
+ * optimizer_shared_mdcache_size, and a hash table mapping the database and
+ * the string form of an mdid to a slice of the arena.  The database is part
+ * of the key because OIDs only identify objects within a database: the
+ * databases created from the same template share the OIDs of all objects
+ * copied from it, while the objects themselves may have diverged since.  Objects are immutable once stored;
+ * the arena is a simple bump allocator that is recycled as a whole.
+ *
+ * Invalidation is version based.  A backend that commits catalog changes
+ * bumps a shared version counter right after it has sent the invalidation
+ * messages for them, see SendSharedInvalidMessages(), whether or not it ever
+ * ran ORCA.  Each entry remembers the version that was current when its
+ * content was read from the catalogs, and entries with an older version are
+ * treated as missing.  A backend fetching an object reads the version
+ * before processing pending invalidations, so that an object translated
+ * from a stale catalog snapshot can never be stored under a newer version.
+ *
+ * A transaction that has changed the catalogs itself sees them differently
+ * than everybody else until it commits, so it neither reads from nor
+ * publishes to the shared cache.
+ *
+ * Readers do not copy the serialized object out of the arena; they parse it
+ * in place.  To make that safe, readers are reference counted: a lookup
+ * pins the arena and OrcaMDCacheRelease() unpins it.  The arena is only
+ * recycled, when it is full or after an invalidation, while no reader holds
+ * a pin.  If it cannot be recycled, new objects are simply not cached.
+ *
+ * Portions Copyright (c) 2023-Present VMware, Inc. or its affiliates.
+ *
+ * IDENTIFICATION
+ *		src/backend/utils/cache/orcamdcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "cdb/cdbvars.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/orcamdcache.h"
+
+/*
+ * Expected average size of a serialized object, used to size the hash
+ * table for a given arena size.
+ */
+#define ORCA_MDCACHE_AVG_ENTRY_SIZE		2048
+#define ORCA_MDCACHE_MIN_ENTRIES		64
+
+typedef struct OrcaMDCacheKey
+{
+	Oid			dbid;			/* database the object belongs to */
+	char		mdid[ORCA_MDCACHE_KEYLEN];
+} OrcaMDCacheKey;
+
+typedef struct OrcaMDCacheEntry
+{
+	OrcaMDCacheKey key;			/* hash key, must be first */
+	uint64		version;		/* catalog version the object was read at */
+	Size		offset;			/* offset of the object in the arena */
+	Size		len;			/* length of the object in bytes */
+} OrcaMDCacheEntry;
+
+typedef struct OrcaMDCacheControl
+{
+	pg_atomic_uint64 version;	/* bumped on catalog invalidation */
+	pg_atomic_uint32 nreaders;	/* number of pins on the arena */
+	uint64		arena_version;	/* version at last recycle of the arena */
+	Size		arena_size;
+	Size		arena_used;
+	char		arena[FLEXIBLE_ARRAY_MEMBER];
+} OrcaMDCacheControl;
+
+static OrcaMDCacheControl *orcaMDCache = NULL;
+static HTAB *orcaMDCacheHash = NULL;
+
+/* pins held by this backend, released at exit if still held */
+static int	orcaMDCachePins = 0;
+static bool orcaMDCacheExitRegistered = false;
+
+static Size
+OrcaMDCacheArenaSize(void)
+{
+	if (Gp_role != GP_ROLE_DISPATCH)
+		return 0;
+
+	return (Size) optimizer_shared_mdcache_size * 1024L;
+}
+
+static long
+OrcaMDCacheMaxEntries(void)
+{
+	return Max(OrcaMDCacheArenaSize() / ORCA_MDCACHE_AVG_ENTRY_SIZE,
+			   ORCA_MDCACHE_MIN_ENTRIES);
+}
+
+/*
+ * Report shared memory space needed by OrcaMDCacheShmemInit
+ */
+Size
+OrcaMDCacheShmemSize(void)
+{
+	Size		size;
+
+	if (OrcaMDCacheArenaSize() == 0)
+		return 0;
+
+	size = add_size(offsetof(OrcaMDCacheControl, arena), OrcaMDCacheArenaSize());
+	size = add_size(size, hash_estimate_size(OrcaMDCacheMaxEntries(),
+											 sizeof(OrcaMDCacheEntry)));
+	return size;
+}
+
+/*
+ * Allocate and initialize the shared metadata cache, if enabled
+ */
+void
+OrcaMDCacheShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+	Size		arena_size = OrcaMDCacheArenaSize();
+
+	if (arena_size == 0)
+		return;
+
+	orcaMDCache = (OrcaMDCacheControl *)
+		ShmemInitStruct("ORCA shared metadata cache",
+						offsetof(OrcaMDCacheControl, arena) + arena_size,
+						&found);
+	if (!found)
+	{
+		pg_atomic_init_u64(&orcaMDCache->version, 0);
+		pg_atomic_init_u32(&orcaMDCache->nreaders, 0);
+		orcaMDCache->arena_version = 0;
+		orcaMDCache->arena_size = arena_size;
+		orcaMDCache->arena_used = 0;
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(OrcaMDCacheKey);
+	info.entrysize = sizeof(OrcaMDCacheEntry);
+
+	orcaMDCacheHash = ShmemInitHash("ORCA shared metadata cache hash",
+									OrcaMDCacheMaxEntries(),
+									OrcaMDCacheMaxEntries(),
+									&info,
+									HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * Can this backend use the shared cache right now?
+ */
+bool
+OrcaMDCacheEnabled(void)
+{
+	return orcaMDCache != NULL && !TransactionHasPendingInvalidations();
+}
+
+/*
+ * Start fetching an object from the catalogs, with the intent to publish it
+ * in the shared cache afterwards.
+ *
+ * Returns the version to pass to OrcaMDCacheInsert().  The version is read
+ * before processing pending invalidations: any invalidation that we process
+ * here bumps the version again, so that an object built from catalog
+ * contents older than the returned version is rejected by the insert.
+ */
+uint64
+OrcaMDCacheBeginFetch(void)
+{
+	uint64		version;
+
+	Assert(orcaMDCache != NULL);
+
+	version = pg_atomic_read_u64(&orcaMDCache->version);
+	pg_memory_barrier();
+	AcceptInvalidationMessages();
+
+	return version;
+}
+
+/*
+ * Invalidate all entries in the shared cache.  Called when invalidation
+ * messages are sent, so it must not throw.
+ */
+void
+OrcaMDCacheInvalidate(void)
+{
+	if (orcaMDCache == NULL)
+		return;
+
+	pg_atomic_fetch_add_u64(&orcaMDCache->version, 1);
+}
+
+static void
+OrcaMDCacheReleaseAtExit(int code, Datum arg)
+{
+	if (orcaMDCachePins > 0)
+		pg_atomic_fetch_sub_u32(&orcaMDCache->nreaders, orcaMDCachePins);
+	orcaMDCachePins = 0;
+}
+
+static void
+OrcaMDCacheMakeKey(OrcaMDCacheKey *hkey, const char *key)
+{
+	MemSet(hkey, 0, sizeof(*hkey));
+	hkey->dbid = MyDatabaseId;
+	strlcpy(hkey->mdid, key, sizeof(hkey->mdid));
+}
+
+/*
+ * Look up the serialized object for an mdid.
+ *
+ * On a hit, returns a pointer into shared memory and pins the cache; the
+ * caller may read the object in place, and must call OrcaMDCacheRelease()
+ * when done with it.  Returns NULL on a miss.
+ */
+const void *
+OrcaMDCacheLookup(const char *key, Size *len)
+{
+	OrcaMDCacheKey hkey;
+	OrcaMDCacheEntry *entry;
+	const void *result = NULL;
+
+	Assert(orcaMDCache != NULL);
+
+	if (strlen(key) >= ORCA_MDCACHE_KEYLEN)
+		return NULL;
+	OrcaMDCacheMakeKey(&hkey, key);
+
+	if (!orcaMDCacheExitRegistered)
+	{
+		before_shmem_exit(OrcaMDCacheReleaseAtExit, (Datum) 0);
+		orcaMDCacheExitRegistered = true;
+	}
+
+	LWLockAcquire(OrcaMDCacheLock, LW_SHARED);
+
+	entry = (OrcaMDCacheEntry *) hash_search(orcaMDCacheHash, &hkey,
+											 HASH_FIND, NULL);
+	if (entry != NULL &&
+		entry->version == pg_atomic_read_u64(&orcaMDCache->version))
+	{
+		/* pin while holding the lock, so that the arena cannot be recycled */
+		pg_atomic_fetch_add_u32(&orcaMDCache->nreaders, 1);
+		orcaMDCachePins++;
+
+		result = orcaMDCache->arena + entry->offset;
+		*len = entry->len;
+	}
+
+	LWLockRelease(OrcaMDCacheLock);
+
+	return result;
+}
+
+/*
+ * Release the pin taken by a successful OrcaMDCacheLookup()
+ */
+void
+OrcaMDCacheRelease(void)
+{
+	Assert(orcaMDCachePins > 0);
+
+	orcaMDCachePins--;
+	pg_atomic_fetch_sub_u32(&orcaMDCache->nreaders, 1);
+}
+
+/*
+ * Discard all entries and start filling the arena from the beginning.
+ * Caller must hold OrcaMDCacheLock exclusively, and there must be no readers.
+ */
+static void
+OrcaMDCacheRecycle(uint64 version)
+{
+	HASH_SEQ_STATUS status;
+	OrcaMDCacheEntry *entry;
+
+	Assert(pg_atomic_read_u32(&orcaMDCache->nreaders) == 0);
+
+	hash_seq_init(&status, orcaMDCacheHash);
+	while ((entry = (OrcaMDCacheEntry *) hash_seq_search(&status)) != NULL)
+		hash_search(orcaMDCacheHash, &entry->key, HASH_REMOVE, NULL);
+
+	orcaMDCache->arena_used = 0;
+	orcaMDCache->arena_version = version;
+}
+
+/*
+ * Publish a serialized object in the shared cache.
+ *
+ * 'version' is the value returned by OrcaMDCacheBeginFetch() before the
+ * object was read from the catalogs.  Returns true if the object was stored.
+ * Failing to store an object is not an error: the cache may be full and
+ * pinned by readers, or the catalogs may have changed in the meantime.
+ */
+bool
+OrcaMDCacheInsert(const char *key, uint64 version, const void *data, Size len)
+{
+	OrcaMDCacheKey hkey;
+	OrcaMDCacheEntry *entry;
+	Size		alloc_len = MAXALIGN(len);
+	bool		found;
+
+	Assert(orcaMDCache != NULL);
+
+	if (strlen(key) >= ORCA_MDCACHE_KEYLEN ||
+		alloc_len > orcaMDCache->arena_size ||
+		TransactionHasPendingInvalidations())
+		return false;
+	OrcaMDCacheMakeKey(&hkey, key);
+
+	LWLockAcquire(OrcaMDCacheLock, LW_EXCLUSIVE);
+
+	if (version != pg_atomic_read_u64(&orcaMDCache->version))
+	{
+		LWLockRelease(OrcaMDCacheLock);
+		return false;
+	}
+
+	/*
+	 * All entries stored before the last invalidation are dead, reclaim
+	 * their space if we can.  Likewise if the arena is full.
+	 */
+	if ((orcaMDCache->arena_version != version ||
+		 orcaMDCache->arena_used + alloc_len > orcaMDCache->arena_size) &&
+		pg_atomic_read_u32(&orcaMDCache->nreaders) == 0)
+		OrcaMDCacheRecycle(version);
+
+	if (orcaMDCache->arena_used + alloc_len > orcaMDCache->arena_size)
+	{
+		LWLockRelease(OrcaMDCacheLock);
+		return false;
+	}
+
+	entry = (OrcaMDCacheEntry *) hash_search(orcaMDCacheHash, &hkey,
+											 HASH_ENTER_NULL, &found);
+	if (entry == NULL)
+	{
+		/* out of hash table entries, try to recycle the whole cache */
+		if (pg_atomic_read_u32(&orcaMDCache->nreaders) != 0)
+		{
+			LWLockRelease(OrcaMDCacheLock);
+			return false;
+		}
+		OrcaMDCacheRecycle(version);
+		entry = (OrcaMDCacheEntry *) hash_search(orcaMDCacheHash, &hkey,
+												 HASH_ENTER, &found);
+	}
+
+	/*
+	 * An existing entry is either stale, or a concurrent backend has just
+	 * stored the same object.  Either way, the new copy replaces it; readers
+	 * of the old copy are protected by their pin on the arena.
+	 */
+	memcpy(orcaMDCache->arena + orcaMDCache->arena_used, data, len);
+	entry->version = version;
+	entry->offset = orcaMDCache->arena_used;
+	entry->len = len;
+	orcaMDCache->arena_used += alloc_len;
+
+	LWLockRelease(OrcaMDCacheLock);
+
+	return true;
+}
@@ -31,6 +31,7 @@
 #include "cdb/cdbappendonlystoragewrite.h"
 #include "utils/datumstream.h"
 #include "utils/guc.h"
+#include "utils/typcache.h"
 #include "catalog/pg_compression.h"
 #include "utils/faultinjector.h"
 
@@ -296,6 +297,34 @@ datumstreamread_nthlarge(DatumStreamRead * acc)
 }
 
 
+/*
+ * Add a value that was put in the current block to its zone map.
+ */
+static void
+datumstreamwrite_zonemap_add(DatumStreamWrite * acc, Datum d, bool null)
+{
+	MinipageZoneMap *zoneMap = &acc->zoneMap;
+
+	if (null)
+		zoneMap->flags |= ZONEMAP_HAS_NULLS;
+	else if ((zoneMap->flags & ZONEMAP_HAS_VALUES) == 0)
+	{
+		zoneMap->minValue = (int64) d;
+		zoneMap->maxValue = (int64) d;
+		zoneMap->flags |= ZONEMAP_HAS_VALUES;
+	}
+	else if (DatumGetInt32(FunctionCall2Coll(acc->zoneMapCmp,
+											 acc->zoneMapCollation,
+											 d,
+											 (Datum) zoneMap->minValue)) < 0)
+		zoneMap->minValue = (int64) d;
+	else if (DatumGetInt32(FunctionCall2Coll(acc->zoneMapCmp,
+											 acc->zoneMapCollation,
+											 d,
+											 (Datum) zoneMap->maxValue)) > 0)
+		zoneMap->maxValue = (int64) d;
+}
+
 int
 datumstreamwrite_put(
 					 DatumStreamWrite * acc,
@@ -303,7 +332,13 @@ datumstreamwrite_put(
 					 bool null,
 					 void **toFree)
 {
-	return DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+	int			result;
+
+	result = DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+	if (result >= 0 && acc->zoneMapCmp != NULL)
+		datumstreamwrite_zonemap_add(acc, d, null);
+
+	return result;
 }
 
 int
@@ -579,6 +614,22 @@ create_datumstreamwrite(
 	acc->ao_write.verifyWriteCompressionState = verifyBlockCompressionState;
 	acc->title = title;
 
+	/*
+	 * Keep zone maps for the types whose values fit in one, and that can be
+	 * ordered.
+	 */
+	if (attr->attbyval && attr->attlen > 0)
+	{
+		TypeCacheEntry *typentry;
+
+		typentry = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC_FINFO);
+		if (OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+		{
+			acc->zoneMapCmp = &typentry->cmp_proc_finfo;
+			acc->zoneMapCollation = attr->attcollation;
+		}
+	}
+
 	/*
 	 * Temporarily set the firstRowNum for the block so that we can
 	 * calculate the correct header length.
@@ -854,6 +905,8 @@ datumstreamread_open_file(DatumStreamRead * ds, char *fn, int64 eof, int64 eofUn
 void
 datumstreamwrite_close_file(DatumStreamWrite * ds)
 {
+	datumstreamwrite_complete_pending(ds);
+
 	AppendOnlyStorageWrite_TransactionFlushAndCloseFile(
 														&ds->ao_write,
 														&ds->eof,
@@ -883,6 +936,62 @@ datumstreamread_close_file(DatumStreamRead * ds)
 	ds->need_close_file = false;
 }
 
+/*
+ * Write out the block, or hand it to the compression workers.
+ */
+static void
+datumstreamwrite_finish_buffer(DatumStreamWrite * acc, int32 writesz, int32 rowCount)
+{
+	if (AppendOnlyStorageWrite_IsCompressAsync(&acc->ao_write))
+	{
+		AppendOnlyStorageWrite_SubmitBuffer(&acc->ao_write,
+											writesz,
+											AOCSBK_BLOCK,
+											rowCount);
+		return;
+	}
+
+	acc->ao_write.logicalBlockStartOffset =
+		BufferedAppendNextBufferPosition(&(acc->ao_write.bufferedAppend));
+
+	AppendOnlyStorageWrite_FinishBuffer(&acc->ao_write,
+										writesz,
+										AOCSBK_BLOCK,
+										rowCount);
+}
+
+/*
+ * Write out the block handed to the compression workers by
+ * datumstreamwrite_block(), if any, and record it in the block directory.
+ *
+ * Must be called before anything else is written to the file.
+ */
+void
+datumstreamwrite_complete_pending(DatumStreamWrite * acc)
+{
+	if (!AppendOnlyStorageWrite_CompletePendingBuffer(&acc->ao_write))
+		return;
+
+	Assert(acc->pendingBlock);
+	acc->pendingBlock = false;
+
+	if (acc->pendingZoneMap.flags & ZONEMAP_VALID)
+		AppendOnlyBlockDirectory_InsertEntryWithZoneMap(
+			acc->pendingBlockDirectory,
+			acc->pendingColumnGroupNo,
+			acc->pendingFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			acc->pendingItemCount,
+			&acc->pendingZoneMap);
+	else
+		AppendOnlyBlockDirectory_InsertEntry(
+			acc->pendingBlockDirectory,
+			acc->pendingColumnGroupNo,
+			acc->pendingFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			acc->pendingItemCount);
+}
+
 static int64
 datumstreamwrite_block_orig(DatumStreamWrite * acc)
 {
@@ -908,15 +1017,8 @@ datumstreamwrite_block_orig(DatumStreamWrite * acc)
 										  &acc->blockWrite,
 										  buffer);
 
-	acc->ao_write.logicalBlockStartOffset =
-		BufferedAppendNextBufferPosition(&(acc->ao_write.bufferedAppend));
-
 	/* Write it out */
-	AppendOnlyStorageWrite_FinishBuffer(
-										&acc->ao_write,
-										(int32) writesz,
-										AOCSBK_BLOCK,
-										rowCount);
+	datumstreamwrite_finish_buffer(acc, (int32) writesz, rowCount);
 
 	/* Set up our write block information */
 	DatumStreamBlockWrite_GetReady(&acc->blockWrite);
@@ -962,15 +1064,8 @@ datumstreamwrite_block_dense(DatumStreamWrite * acc)
 										  &acc->blockWrite,
 										  buffer);
 
-	acc->ao_write.logicalBlockStartOffset =
-		BufferedAppendNextBufferPosition(&(acc->ao_write.bufferedAppend));
-
 	/* Write it out */
-	AppendOnlyStorageWrite_FinishBuffer(
-										&acc->ao_write,
-										(int32) writesz,
-										AOCSBK_BLOCK,
-										rowCount);
+	datumstreamwrite_finish_buffer(acc, (int32) writesz, rowCount);
 
 	/* Set up our write block information */
 	DatumStreamBlockWrite_GetReady(&acc->blockWrite);
@@ -992,6 +1087,8 @@ datumstreamwrite_block(DatumStreamWrite *acc,
 		return 0;
 	}
 
+	datumstreamwrite_complete_pending(acc);
+
 	switch (acc->datumStreamVersion)
 	{
 		case DatumStreamVersion_Original:
@@ -1010,13 +1107,49 @@ datumstreamwrite_block(DatumStreamWrite *acc,
 			/* Never reaches here. */
 	}
 
+	/*
+	 * If the block went to the compression workers, its block directory entry
+	 * is inserted when it is written out.
+	 */
+	if (AppendOnlyStorageWrite_IsCompressAsync(&acc->ao_write))
+	{
+		acc->pendingBlock = true;
+		acc->pendingBlockDirectory = blockDirectory;
+		acc->pendingColumnGroupNo = columnGroupNo;
+		acc->pendingFirstRowNum = acc->blockFirstRowNum;
+		acc->pendingItemCount = itemCount;
+		if (acc->zoneMapCmp != NULL)
+		{
+			acc->pendingZoneMap = acc->zoneMap;
+			acc->pendingZoneMap.flags |= ZONEMAP_VALID;
+			MemSet(&acc->zoneMap, 0, sizeof(MinipageZoneMap));
+		}
+		else
+			MemSet(&acc->pendingZoneMap, 0, sizeof(MinipageZoneMap));
+
+		return writesz;
+	}
+
 	/* Insert an entry to the block directory */
-	AppendOnlyBlockDirectory_InsertEntry(
-		blockDirectory,
-		columnGroupNo,
-		acc->blockFirstRowNum,
-		AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
-		itemCount);
+	if (acc->zoneMapCmp != NULL)
+	{
+		acc->zoneMap.flags |= ZONEMAP_VALID;
+		AppendOnlyBlockDirectory_InsertEntryWithZoneMap(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount,
+			&acc->zoneMap);
+		MemSet(&acc->zoneMap, 0, sizeof(MinipageZoneMap));
+	}
+	else
+		AppendOnlyBlockDirectory_InsertEntry(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount);
 
 	return writesz;
 }
@@ -1075,6 +1208,9 @@ datumstreamwrite_lob(DatumStreamWrite *acc,
 												  p);
 	}
 
+	/* The pending block comes first in the file */
+	datumstreamwrite_complete_pending(acc);
+
 	/* Set the BlockFirstRowNum */
 	AppendOnlyStorageWrite_SetFirstRowNum(&acc->ao_write,
 										  acc->blockFirstRowNum);
@@ -1300,10 +1436,15 @@ datumstreamread_block_content(DatumStreamRead * acc)
 }
 
 
-int
-datumstreamread_block(DatumStreamRead * acc,
-					  AppendOnlyBlockDirectory *blockDirectory,
-					  int colGroupNo)
+/*
+ * Read the header of the next block, and advance blockFirstRowNum past the
+ * current one. Returns false at the end of the segment file.
+ *
+ * The caller either reads the content with datumstreamread_block_content(),
+ * or skips the block.
+ */
+bool
+datumstreamread_next_block_info(DatumStreamRead * acc)
 {
 	bool		readOK = false;
 
@@ -1319,7 +1460,7 @@ datumstreamread_block(DatumStreamRead * acc,
 												&acc->getBlockInfo.isLarge,
 											&acc->getBlockInfo.isCompressed);
 	if (!readOK)
-		return -1;
+		return false;
 
 	if (Debug_appendonly_print_datumstream)
 		elog(LOG,
@@ -1361,6 +1502,17 @@ datumstreamread_block(DatumStreamRead * acc,
 			 acc->blockFileOffset,
 			 acc->blockRowCount);
 
+	return true;
+}
+
+int
+datumstreamread_block(DatumStreamRead * acc,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo)
+{
+	if (!datumstreamread_next_block_info(acc))
+		return -1;
+
 	datumstreamread_block_content(acc);
 
 	if (blockDirectory)
@@ -1375,6 +1527,35 @@ datumstreamread_block(DatumStreamRead * acc,
 	return 0;
 }
 
+/*
+ * Like datumstreamread_block(), but the blocks whose rows are all among the
+ * next *skipRows rows of the stream are passed over without reading (and
+ * decompressing) their content. *skipRows is decreased by the number of rows
+ * in the skipped blocks.
+ *
+ * The block directory is not maintained, so this must not be used by scans
+ * that build one.
+ */
+int
+datumstreamread_block_skip(DatumStreamRead * acc, int64 *skipRows)
+{
+	Assert(*skipRows >= 0);
+
+	while (datumstreamread_next_block_info(acc))
+	{
+		if (acc->blockRowCount > *skipRows)
+		{
+			datumstreamread_block_content(acc);
+			return 0;
+		}
+
+		*skipRows -= acc->blockRowCount;
+		AppendOnlyStorageRead_SkipCurrentBlock(&acc->ao_read);
+	}
+
+	return -1;
+}
+
 void
 datumstreamread_rewind_block(DatumStreamRead * datumStream)
 {
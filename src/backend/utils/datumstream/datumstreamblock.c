@@ -15,6 +15,7 @@
 #include "postgres.h"
 #include "access/tupmacs.h"
 #include "access/tuptoaster.h"
+#include "common/hashfn.h"
 #include "utils/datumstreamblock.h"
 #include "utils/guc.h"
 
@@ -43,6 +44,8 @@ static void DatumStreamBlock_IntegrityCheckDense(
 							 int (*errcontextCallback) (void *errcontextArg),
 									 void *errcontextArg);
 
+static void DatumStreamBlockRead_UnpackDictionary(DatumStreamBlockRead * dsr);
+
 /* Proper align with zero padding */
 static inline char *
 att_align_zero(char *data, char alignchar)
@@ -403,7 +406,148 @@ void
 DatumStreamBlockRead_Finish(
 							DatumStreamBlockRead * dsr)
 {
-	/* Place holder. */
+	if (dsr->dictionary_entries != NULL)
+	{
+		pfree(dsr->dictionary_entries);
+		dsr->dictionary_entries = NULL;
+	}
+}
+
+/*
+ * Decode the next rows of the block, up to maxrows of them, into the values
+ * and nulls arrays. If codes is not NULL and the block is dictionary encoded,
+ * the dictionary code of each non-NULL row is stored in it too.
+ *
+ * This is equivalent to calling DatumStreamBlockRead_Advance and
+ * DatumStreamBlockRead_Get once per row, and leaves the reader positioned on
+ * the last row decoded. Returns the number of rows decoded, 0 when the block
+ * is exhausted.
+ *
+ * Blocks of fixed-length pass-by-value items without NULLs, RLE_TYPE or
+ * delta compression are an array of items, which is copied in one tight
+ * loop the compiler can vectorize. For RLE_TYPE compressed blocks, the
+ * copies of a repeated item are filled in without going through the
+ * bit-maps once per row.
+ */
+int
+DatumStreamBlockRead_GetBatch(
+							  DatumStreamBlockRead * dsr,
+							  Datum *values,
+							  bool *nulls,
+							  uint8 *codes,
+							  int maxrows)
+{
+	int			nrows;
+	bool		rle_compressed;
+	bool		delta_compressed;
+	bool		dictionary_compressed;
+
+	Assert(maxrows > 0);
+
+	/* Only Dense blocks can be compressed. */
+	rle_compressed = (dsr->datumStreamVersion != DatumStreamVersion_Original &&
+					  dsr->rle_block_was_compressed);
+	delta_compressed = (dsr->datumStreamVersion != DatumStreamVersion_Original &&
+						dsr->delta_block_was_compressed);
+	dictionary_compressed = (codes != NULL &&
+							 dsr->datumStreamVersion != DatumStreamVersion_Original &&
+							 dsr->dictionary_block_was_compressed);
+
+	if (dsr->typeInfo.byval &&
+		!dsr->has_null &&
+		!rle_compressed &&
+		!delta_compressed)
+	{
+		int32		datumlen = dsr->typeInfo.datumlen;
+		uint8	   *firstp;
+
+		nrows = Min(maxrows, dsr->logical_row_count - (dsr->nth + 1));
+		if (nrows <= 0)
+		{
+			/* Advance out of bounds, as DatumStreamBlockRead_Advance does. */
+			dsr->nth++;
+			return 0;
+		}
+
+		/* The block read pre-positions the item pointer to the first item. */
+		if (dsr->physical_datum_index == -1)
+			firstp = dsr->datump;
+		else
+			firstp = dsr->datump + datumlen;
+
+		Assert(firstp + (nrows - 1) * datumlen < dsr->datum_afterp);
+
+		if (datumlen == 1)
+		{
+			uint8	   *p = firstp;
+
+			for (int i = 0; i < nrows; i++)
+				values[i] = p[i];
+		}
+		else if (datumlen == 2)
+		{
+			uint16	   *p = (uint16 *) firstp;
+
+			Assert(IsAligned(firstp, 2));
+			for (int i = 0; i < nrows; i++)
+				values[i] = p[i];
+		}
+		else if (datumlen == 4)
+		{
+			uint32	   *p = (uint32 *) firstp;
+
+			Assert(IsAligned(firstp, 4));
+			for (int i = 0; i < nrows; i++)
+				values[i] = p[i];
+		}
+		else
+		{
+			Assert(datumlen == 8);
+			memcpy(values, firstp, nrows * sizeof(Datum));
+		}
+		memset(nulls, 0, nrows * sizeof(bool));
+
+		dsr->nth += nrows;
+		dsr->physical_datum_index += nrows;
+		dsr->datump = firstp + (nrows - 1) * datumlen;
+
+		return nrows;
+	}
+
+	nrows = 0;
+	while (nrows < maxrows && DatumStreamBlockRead_Advance(dsr) > 0)
+	{
+		DatumStreamBlockRead_Get(dsr, &values[nrows], &nulls[nrows]);
+		if (dictionary_compressed)
+			codes[nrows] = (nulls[nrows] ? 0 :
+							dsr->dictionary_codesp[dsr->physical_datum_index]);
+		nrows++;
+
+		if (rle_compressed && dsr->rle_in_repeated_item)
+		{
+			int32		ncopies;
+
+			Assert(!nulls[nrows - 1]);
+
+			ncopies = Min(dsr->rle_repeated_item_count, maxrows - nrows);
+			for (int i = 0; i < ncopies; i++)
+			{
+				values[nrows + i] = values[nrows - 1];
+				nulls[nrows + i] = false;
+			}
+			if (dictionary_compressed)
+				memset(&codes[nrows], codes[nrows - 1], ncopies);
+			nrows += ncopies;
+
+			dsr->nth += ncopies;
+			dsr->rle_repeated_item_count -= ncopies;
+			dsr->rle_total_repeat_items_read += ncopies;
+			if (dsr->rle_repeated_item_count <= 0)
+				dsr->rle_in_repeated_item = false;
+		}
+	}
+
+	return nrows;
 }
 
 /*
@@ -609,6 +753,11 @@ DatumStreamBlockRead_ResetDense(DatumStreamBlockRead * dsr)
 
 	dsr->delta_block_was_compressed = false;
 	dsr->delta_item = false;
+
+	dsr->dictionary_block_was_compressed = false;
+	dsr->dictionary_codesp = NULL;
+	dsr->dictionary_count = 0;
+	dsr->dictionary_codes_size = 0;
 }
 
 void
@@ -630,6 +779,7 @@ DatumStreamBlockRead_GetReadyDense(
 	DatumStreamBlock_Dense *blockDense;
 	DatumStreamBlock_Rle_Extension *rleExtension;
 	DatumStreamBlock_Delta_Extension *deltaExtension;
+	DatumStreamBlock_Dictionary_Extension *dictionaryExtension;
 
 	/*
 	 * PERFORMANCE EXPERIMENT: Only do integrity and trace checking for DEBUG
@@ -718,6 +868,21 @@ DatumStreamBlockRead_GetReadyDense(
 		deltaExtension = NULL;
 	}
 
+	/* Dictionary */
+	dsr->dictionary_block_was_compressed = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0);
+	if (dsr->dictionary_block_was_compressed)
+	{
+		dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) p;
+		p += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+		dsr->dictionary_count = dictionaryExtension->dictionary_count;
+		dsr->dictionary_codes_size = dictionaryExtension->codes_size;
+	}
+	else
+	{
+		dictionaryExtension = NULL;
+	}
+
 	/* Set up acc */
 	dsr->nth = -1;				/* put it before first entry.  Caller will
 								 * advance */
@@ -942,9 +1107,89 @@ DatumStreamBlockRead_GetReadyDense(
 					 errcontext_datumstreamblockread(dsr)));
 		}
 	}
+
+	if (dsr->dictionary_block_was_compressed)
+	{
+		/*
+		 * Dictionary encoding was used for this block. The codes follow the
+		 * other meta-data.
+		 */
+		dsr->dictionary_codesp = p;
+		p += dsr->dictionary_codes_size;
+
+		unalignedHeaderSize = p - dsr->buffer_beginp;
+		alignedHeaderSize = MAXALIGN(unalignedHeaderSize);
+
+		/*
+		 * Skip over alignment padding.
+		 */
+		dsr->datum_beginp = dsr->buffer_beginp + alignedHeaderSize;
+		dsr->datum_afterp = dsr->datum_beginp + dsr->physical_data_size;
+
+		DatumStreamBlockRead_UnpackDictionary(dsr);
+	}
 	dsr->datump = dsr->datum_beginp;
 }
 
+/*
+ * Locate the items of the dictionary of the current block, and check the
+ * codes refer to them.
+ */
+static void
+DatumStreamBlockRead_UnpackDictionary(DatumStreamBlockRead * dsr)
+{
+	uint8	   *item;
+	uint8		maxCode;
+	int32		i;
+
+	if (dsr->dictionary_entries == NULL)
+		dsr->dictionary_entries =
+			MemoryContextAlloc(dsr->memctxt,
+							   DATUMSTREAM_DICTIONARY_MAX_COUNT * sizeof(uint8 *));
+
+	/*
+	 * Walk the items the same way DatumStreamBlockRead_AdvanceDense does:
+	 * zero padding precedes an aligned item.
+	 */
+	item = dsr->datum_beginp;
+	for (i = 0; i < dsr->dictionary_count; i++)
+	{
+		if (i > 0)
+		{
+			item += VARSIZE_ANY(dsr->dictionary_entries[i - 1]);
+			if (item < dsr->datum_afterp && *item == 0)
+				item = (uint8 *) att_align_nominal(item, dsr->typeInfo.align);
+		}
+
+		if (item >= dsr->datum_afterp)
+			ereport(ERROR,
+					(errmsg("Datum stream block read dictionary item %d of %d is past the end of the datum data (physical data size %d)",
+							i,
+							dsr->dictionary_count,
+							dsr->physical_data_size),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+
+		dsr->dictionary_entries[i] = item;
+	}
+
+	maxCode = 0;
+	for (i = 0; i < dsr->dictionary_codes_size; i++)
+		maxCode = Max(maxCode, dsr->dictionary_codesp[i]);
+
+	if (maxCode >= dsr->dictionary_count)
+		ereport(ERROR,
+				(errmsg("Datum stream block read dictionary code %d is not less than dictionary count %d",
+						maxCode,
+						dsr->dictionary_count),
+				 errdetail_datumstreamblockread(dsr),
+				 errcontext_datumstreamblockread(dsr)));
+
+	/* Zero means no dictionary to callers. */
+	if (++dsr->dictionary_generation == 0)
+		dsr->dictionary_generation = 1;
+}
+
 static int
 errdetail_datumstreamblockwrite(
 								DatumStreamBlockWrite * dsw)
@@ -3765,6 +4010,112 @@ DatumStreamBlockWrite_BlockOrig(
 	return writesz;
 }
 
+/*
+ * Collect the distinct items of the block being written, and decide whether
+ * storing them once plus a one byte code per physical datum is smaller than
+ * the datum data.
+ *
+ * On success, the dictionary_* fields describe the dictionary: entry i is
+ * dictionary_sizes[i] bytes at dictionary_offsets[i] in the datum buffer, and
+ * dictionary_data_size is the size of the entries when formatted.
+ */
+static bool
+DatumStreamBlockWrite_DictionaryBuild(
+									  DatumStreamBlockWrite * dsw,
+									  int32 metadataSize)
+{
+	int16		slots[DATUMSTREAM_DICTIONARY_MAX_COUNT * 2];
+	uint32		mask = lengthof(slots) - 1;
+	uint8	   *item;
+	int32		itemSize;
+	int32		dataSize;
+	int32		i;
+
+	if (!dsw->dictionary_want_compression || dsw->physical_datum_count < 2)
+		return false;
+
+	Assert(dsw->typeInfo->datumlen == -1);
+
+	if (dsw->dictionary_codes_maxcount < dsw->physical_datum_count)
+	{
+		MemoryContext oldCtxt;
+
+		oldCtxt = MemoryContextSwitchTo(dsw->memctxt);
+		if (dsw->dictionary_codes != NULL)
+			pfree(dsw->dictionary_codes);
+		dsw->dictionary_codes_maxcount =
+			Max(dsw->physical_datum_count, dsw->initialMaxDatumPerBlock);
+		dsw->dictionary_codes = palloc(dsw->dictionary_codes_maxcount);
+		MemoryContextSwitchTo(oldCtxt);
+	}
+
+	memset(slots, -1, sizeof(slots));
+	dsw->dictionary_count = 0;
+
+	/*
+	 * Walk the items the same way DatumStreamBlockRead_AdvanceDense does:
+	 * zero padding precedes an aligned item.
+	 */
+	item = dsw->datum_buffer;
+	itemSize = 0;
+	for (i = 0; i < dsw->physical_datum_count; i++)
+	{
+		uint32		slot;
+		int16		entry;
+
+		if (i > 0)
+		{
+			item += itemSize;
+			if (*item == 0)
+				item = (uint8 *) att_align_nominal(item, dsw->typeInfo->align);
+		}
+		Assert(item < dsw->datump);
+
+		itemSize = VARSIZE_ANY(item);
+
+		slot = DatumGetUInt32(hash_any(item, itemSize)) & mask;
+		while ((entry = slots[slot]) != -1)
+		{
+			if (dsw->dictionary_sizes[entry] == itemSize &&
+				memcmp(dsw->datum_buffer + dsw->dictionary_offsets[entry],
+					   item, itemSize) == 0)
+				break;
+			slot = (slot + 1) & mask;
+		}
+
+		if (entry == -1)
+		{
+			if (dsw->dictionary_count == DATUMSTREAM_DICTIONARY_MAX_COUNT)
+				return false;
+
+			entry = dsw->dictionary_count++;
+			dsw->dictionary_offsets[entry] = item - dsw->datum_buffer;
+			dsw->dictionary_sizes[entry] = itemSize;
+			slots[slot] = entry;
+		}
+
+		dsw->dictionary_codes[i] = (uint8) entry;
+	}
+
+	/*
+	 * The entries start at a MAXALIGN boundary, so aligning their offsets is
+	 * the same as aligning their addresses.
+	 */
+	dataSize = 0;
+	for (i = 0; i < dsw->dictionary_count; i++)
+	{
+		if (!VARATT_IS_SHORT(dsw->datum_buffer + dsw->dictionary_offsets[i]))
+			dataSize = att_align_nominal(dataSize, dsw->typeInfo->align);
+		dataSize += dsw->dictionary_sizes[i];
+	}
+	dsw->dictionary_data_size = dataSize;
+
+	return (MAXALIGN(metadataSize +
+					 sizeof(DatumStreamBlock_Dictionary_Extension) +
+					 dsw->physical_datum_count) + dataSize <
+			MAXALIGN(metadataSize) + (dsw->datump - dsw->datum_buffer));
+}
+
 static int64
 DatumStreamBlockWrite_BlockDense(
 								 DatumStreamBlockWrite * dsw,
@@ -3775,10 +4126,12 @@ DatumStreamBlockWrite_BlockDense(
 	DatumStreamBlock_Dense dense;
 	DatumStreamBlock_Rle_Extension rle_extension;
 	DatumStreamBlock_Delta_Extension delta_extension;
+	DatumStreamBlock_Dictionary_Extension dictionary_extension;
 	int32		headerSize;
 	int32		nullSize;
 	int32		rleSize;
 	int32		deltaSize;
+	int32		dictionarySize;
 	int32		metadataSize;
 	int32		metadataMaxAlignSize;
 	int32		nullPadSize;
@@ -3917,10 +4270,42 @@ DatumStreamBlockWrite_BlockDense(
 		deltaSize = 0;
 	}
 
+	/*
+	 * Replace the datum data with a dictionary of the distinct items and
+	 * their codes, if that makes the block smaller.
+	 */
+	if (DatumStreamBlockWrite_DictionaryBuild(
+								  dsw,
+								  headerSize + nullSize + rleSize + deltaSize))
+	{
+		Assert(!dsw->delta_has_compression);
+
+		dense.orig_4_bytes.flags |= DSB_HAS_DICTIONARY_COMPRESSION;
+
+		headerSize += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+		dictionarySize = dsw->physical_datum_count;
+
+		dictionary_extension.dictionary_count = dsw->dictionary_count;
+		dictionary_extension.codes_size = dictionarySize;
+
+		/*
+		 * The savings are the datum bytes we no longer store, less the codes.
+		 */
+		dsw->savings += (dense.physical_data_size - dsw->dictionary_data_size) -
+			(sizeof(DatumStreamBlock_Dictionary_Extension) + dictionarySize);
+
+		dense.physical_data_size = dsw->dictionary_data_size;
+	}
+	else
+	{
+		dictionarySize = 0;
+	}
+
 	/*
 	 * Align headers and meta-data (e.g. NULL bit-maps, etc).
 	 */
-	metadataSize = headerSize + nullSize + rleSize + deltaSize;
+	metadataSize = headerSize + nullSize + rleSize + deltaSize + dictionarySize;
 	metadataMaxAlignSize = MAXALIGN(metadataSize);
 
 	memcpy(p, &dense, sizeof(DatumStreamBlock_Dense));
@@ -3938,6 +4323,12 @@ DatumStreamBlockWrite_BlockDense(
 		p += sizeof(DatumStreamBlock_Delta_Extension);
 	}
 
+	if (dictionarySize > 0)
+	{
+		memcpy(p, &dictionary_extension, sizeof(DatumStreamBlock_Dictionary_Extension));
+		p += sizeof(DatumStreamBlock_Dictionary_Extension);
+	}
+
 	if (dsw->has_null)
 	{
 		memcpy(p, dsw->null_bitmap_buffer, DatumStreamBitMapWrite_Size(&dsw->null_bitmap));
@@ -4001,6 +4392,13 @@ DatumStreamBlockWrite_BlockDense(
 		}
 	}
 
+	/* Add dictionary codes, one byte per physical datum */
+	if (dictionarySize > 0)
+	{
+		memcpy(p, dsw->dictionary_codes, dictionarySize);
+		p += dictionarySize;
+	}
+
 	/*
 	 * Were our meta-data size calculations correct?
 	 */
@@ -4042,8 +4440,39 @@ DatumStreamBlockWrite_BlockDense(
 				 errcontext_datumstreamblockwrite(dsw)));
 	}
 
-	memcpy(p, dsw->datum_buffer, dense.physical_data_size);
-	p += dense.physical_data_size;
+	if (dictionarySize > 0)
+	{
+		uint8	   *datum_beginp = p;
+		int			i;
+
+		/*
+		 * Write the dictionary entries, aligning the non-short varlena items
+		 * the same way DatumStreamBlockWrite_PutDense does.
+		 */
+		for (i = 0; i < dsw->dictionary_count; i++)
+		{
+			uint8	   *item = dsw->datum_buffer + dsw->dictionary_offsets[i];
+
+			if (!VARATT_IS_SHORT(item))
+				p = (uint8 *) att_align_zero((char *) p, dsw->typeInfo->align);
+
+			memcpy(p, item, dsw->dictionary_sizes[i]);
+			p += dsw->dictionary_sizes[i];
+		}
+
+		if (p - datum_beginp != dense.physical_data_size)
+			ereport(ERROR,
+					(errmsg("Formatted datum stream write dictionary size different (expected %d, found " INT64_FORMAT ")",
+							dense.physical_data_size,
+							(int64) (p - datum_beginp)),
+					 errdetail_datumstreamblockwrite(dsw),
+					 errcontext_datumstreamblockwrite(dsw)));
+	}
+	else
+	{
+		memcpy(p, dsw->datum_buffer, dense.physical_data_size);
+		p += dense.physical_data_size;
+	}
 
 	/* Calculate write size. */
 	writesz = p - buffer;
@@ -4253,6 +4682,16 @@ DatumStreamBlockWrite_Init(
 	dsw->rle_want_compression = rle_want_compression;
 	dsw->delta_want_compression = delta_want_compression;
 
+	/*
+	 * Dictionary encoding is only considered for variable-length types of
+	 * RLE_TYPE compressed columns.
+	 */
+	dsw->dictionary_want_compression =
+		(rle_want_compression &&
+		 datumStreamVersion == DatumStreamVersion_Dense_Enhanced &&
+		 typeInfo->datumlen == -1 &&
+		 gp_enable_aocs_dictionary_encoding);
+
 	dsw->initialMaxDatumPerBlock = initialMaxDatumPerBlock;
 	dsw->maxDatumPerBlock = maxDatumPerBlock;
 
@@ -4483,6 +4922,12 @@ DatumStreamBlockWrite_Finish(
 		dsw->delta_sign = NULL;
 	}
 
+	if (dsw->dictionary_codes != NULL)
+	{
+		pfree(dsw->dictionary_codes);
+		dsw->dictionary_codes = NULL;
+	}
+
 	MemoryContextSwitchTo(oldCtxt);
 }
 
@@ -4921,14 +5366,17 @@ DatumStreamBlock_IntegrityCheckDense(
 	bool		hasNull;
 	bool		hasRleCompression;
 	bool		hasDeltaCompression;
+	bool		hasDictionaryCompression;
 
 	int32		alignedHeaderSize;
 	int32		deltaOnCount;
 	DatumStreamBlock_Delta_Extension *deltaExtension;
 	DatumStreamBlock_Rle_Extension *rleExtension;
+	DatumStreamBlock_Dictionary_Extension *dictionaryExtension;
 
 	deltaExtension = NULL;
 	rleExtension = NULL;
+	dictionaryExtension = NULL;
 
 	alignedHeaderSize = 0;
 
@@ -4967,6 +5415,20 @@ DatumStreamBlock_IntegrityCheckDense(
 	hasNull = ((blockDense->orig_4_bytes.flags & DSB_HAS_NULLBITMAP) != 0);
 	hasRleCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_RLE_COMPRESSION) != 0);
 	hasDeltaCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DELTA_COMPRESSION) != 0);
+	hasDictionaryCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0);
+
+	if (hasDictionaryCompression)
+	{
+		if (typeInfo->datumlen != -1 || hasDeltaCompression)
+		{
+			ereport(ERROR,
+					(errmsg("Dictionary encoding is only expected for variable-length items without DELTA compression (datum length %d, DELTA compression %s)",
+							typeInfo->datumlen,
+							(hasDeltaCompression ? "true" : "false")),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+	}
 
 	/*
 	 * Verify logical row count.
@@ -5043,8 +5505,10 @@ DatumStreamBlock_IntegrityCheckDense(
 
 		/*
 		 * This check will make it safer to do multiplication of datum count and datum length.
+		 * With dictionary encoding, the data only holds the distinct items.
 		 */
-		if (blockDense->physical_datum_count > blockDense->physical_data_size)
+		if (!hasDictionaryCompression &&
+			blockDense->physical_datum_count > blockDense->physical_data_size)
 		{
 			ereport(ERROR,
 					(errmsg("More physical items %d than physical bytes %d",
@@ -5116,6 +5580,24 @@ DatumStreamBlock_IntegrityCheckDense(
 		{
 			deltaOnCount = 0;
 		}
+
+		if (hasDictionaryCompression)
+		{
+			headerSize += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+			if (bufferSize < headerSize)
+			{
+				ereport(ERROR,
+						(errmsg("Bad datum stream Dictionary block header extension size. Found %d and expected the size to be at least %d",
+								bufferSize,
+								headerSize),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+
+			dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) p;
+			p += sizeof(DatumStreamBlock_Dictionary_Extension);
+		}
 		total_datum_count = blockDense->physical_datum_count + deltaOnCount;
 
 		if (!hasNull)
@@ -5291,6 +5773,24 @@ DatumStreamBlock_IntegrityCheckDense(
 			p += sizeof(DatumStreamBlock_Delta_Extension);
 		}
 
+		if (hasDictionaryCompression)
+		{
+			headerSize += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+			if (bufferSize < headerSize)
+			{
+				ereport(ERROR,
+						(errmsg("Bad datum stream RLE_TYPE Dictionary block header extension size. Found %d and expected the size to be at least %d",
+								bufferSize,
+								headerSize),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+
+			dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) p;
+			p += sizeof(DatumStreamBlock_Dictionary_Extension);
+		}
+
 		if (!hasNull)
 		{
 			actualNullOnCount = 0;
@@ -5455,6 +5955,61 @@ DatumStreamBlock_IntegrityCheckDense(
 												  errcontextArg);
 	}
 
+	if (hasDictionaryCompression)
+	{
+		int			i;
+
+		if (dictionaryExtension->codes_size != blockDense->physical_datum_count)
+		{
+			ereport(ERROR,
+					(errmsg("Dictionary codes size %d is expected to match physical datum count %d",
+							dictionaryExtension->codes_size,
+							blockDense->physical_datum_count),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		if (dictionaryExtension->dictionary_count <= 0 ||
+			dictionaryExtension->dictionary_count > DATUMSTREAM_DICTIONARY_MAX_COUNT ||
+			dictionaryExtension->dictionary_count > blockDense->physical_datum_count)
+		{
+			ereport(ERROR,
+					(errmsg("Dictionary count %d is expected to be greater than 0 and at most %d and the physical datum count %d",
+							dictionaryExtension->dictionary_count,
+							DATUMSTREAM_DICTIONARY_MAX_COUNT,
+							blockDense->physical_datum_count),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		headerSize += dictionaryExtension->codes_size;
+		alignedHeaderSize = MAXALIGN(headerSize);
+
+		if (bufferSize < alignedHeaderSize)
+		{
+			ereport(ERROR,
+					(errmsg("Expected Dictionary header size %d including codes is larger than buffer size %d",
+							alignedHeaderSize,
+							bufferSize),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		for (i = 0; i < dictionaryExtension->codes_size; i++)
+		{
+			if (p[i] >= dictionaryExtension->dictionary_count)
+			{
+				ereport(ERROR,
+						(errmsg("Dictionary code %d at position %d is not less than dictionary count %d",
+								p[i],
+								i,
+								dictionaryExtension->dictionary_count),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+		}
+	}
+
 	if (typeInfo->datumlen == -1)
 	{
 		/*
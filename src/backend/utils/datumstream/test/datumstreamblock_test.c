@@ -5,6 +5,8 @@
 
 #include "../datumstreamblock.c"
 
+#include "utils/memutils.h"
+
 /* 
  * Unit test function to test the routines added for
  * Delta Compression
@@ -167,13 +169,274 @@ test__DeltaCompression__Core(void **state)
 	free(dsw);
 }
 
+/*
+ * Unit test function to test batch decoding of a block of fixed-length
+ * pass-by-value items, checking that it stays in step with the row at a
+ * time reading routines.
+ */
+static void
+test__GetBatch__FixedLength(void **state)
+{
+	DatumStreamBlockRead *dsr = malloc(sizeof(DatumStreamBlockRead));
+	uint32		items[10];
+	Datum		values[4];
+	bool		nulls[4];
+	Datum		datum;
+	bool		null;
+	int			nrows;
+
+	for (int i = 0; i < 10; i++)
+		items[i] = 100 + i;
+
+	/* A block of 10 int4 items without NULLs, positioned before the first */
+	memset(dsr, 0, sizeof(DatumStreamBlockRead));
+	strncpy(dsr->eyecatcher, DatumStreamBlockRead_Eyecatcher, DatumStreamBlockRead_EyecatcherLen);
+	dsr->datumStreamVersion = DatumStreamVersion_Original;
+	dsr->typeInfo.datumlen = 4;
+	dsr->typeInfo.typid = INT4OID;
+	dsr->typeInfo.byval = true;
+	dsr->logical_row_count = 10;
+	dsr->physical_datum_count = 10;
+	dsr->nth = -1;
+	dsr->physical_datum_index = -1;
+	dsr->datum_beginp = (uint8 *) items;
+	dsr->datum_afterp = (uint8 *) (items + 10);
+	dsr->datump = dsr->datum_beginp;
+
+	nrows = DatumStreamBlockRead_GetBatch(dsr, values, nulls, NULL, 4);
+	assert_int_equal(nrows, 4);
+	for (int i = 0; i < 4; i++)
+	{
+		assert_int_equal(DatumGetUInt32(values[i]), 100 + i);
+		assert_false(nulls[i]);
+	}
+	assert_int_equal(DatumStreamBlockRead_Nth(dsr), 3);
+
+	/* the row at a time routines continue where the batch stopped */
+	assert_int_equal(DatumStreamBlockRead_Advance(dsr), 1);
+	DatumStreamBlockRead_Get(dsr, &datum, &null);
+	assert_int_equal(DatumGetUInt32(datum), 104);
+	assert_false(null);
+
+	nrows = DatumStreamBlockRead_GetBatch(dsr, values, nulls, NULL, 4);
+	assert_int_equal(nrows, 4);
+	for (int i = 0; i < 4; i++)
+		assert_int_equal(DatumGetUInt32(values[i]), 105 + i);
+
+	/* the last batch is cut short by the end of the block */
+	nrows = DatumStreamBlockRead_GetBatch(dsr, values, nulls, NULL, 4);
+	assert_int_equal(nrows, 1);
+	assert_int_equal(DatumGetUInt32(values[0]), 109);
+	assert_int_equal(DatumStreamBlockRead_Nth(dsr), 9);
+
+	nrows = DatumStreamBlockRead_GetBatch(dsr, values, nulls, NULL, 4);
+	assert_int_equal(nrows, 0);
+
+	free(dsr);
+}
+
+/*
+ * Helpers for the dictionary encoding tests: write a block of text values
+ * (NULL for a SQL NULL) with an RLE_TYPE compressed datum stream, then read
+ * it back and check every row.
+ */
+static DatumStreamTypeInfo textTypeInfo = {
+	-1,							/* datumlen */
+	TEXTOID,					/* typid */
+	'x',						/* typstorage */
+	'i',						/* align */
+	false						/* byval */
+};
+
+static Datum
+make_text(const char *value)
+{
+	int			len = strlen(value);
+	text	   *t = palloc(VARHDRSZ + len);
+
+	SET_VARSIZE(t, VARHDRSZ + len);
+	memcpy(VARDATA(t), value, len);
+
+	return PointerGetDatum(t);
+}
+
+static int16
+write_and_read_block(char **values, int nrows)
+{
+	DatumStreamBlockWrite *dsw = palloc0(sizeof(DatumStreamBlockWrite));
+	DatumStreamBlockRead *dsr = palloc0(sizeof(DatumStreamBlockRead));
+	uint8	   *buffer = palloc0(32768);
+	int64		writesz;
+	bool		hadToAdjustRowCount;
+	int32		adjustedRowCount;
+	int16		flags;
+
+	gp_enable_aocs_dictionary_encoding = true;
+
+	DatumStreamBlockWrite_Init(dsw, &textTypeInfo,
+							   DatumStreamVersion_Dense_Enhanced,
+							   true,	/* rle_want_compression */
+							   false,	/* delta_want_compression */
+							   1024, 8192, 32768,
+							   NULL, NULL, NULL, NULL);
+	assert_true(dsw->dictionary_want_compression);
+
+	for (int i = 0; i < nrows; i++)
+	{
+		void	   *toFree;
+		Datum		d = values[i] ? make_text(values[i]) : (Datum) 0;
+
+		assert_true(DatumStreamBlockWrite_Put(dsw, d, values[i] == NULL, &toFree) >= 0);
+		assert_true(toFree == NULL);
+	}
+	assert_int_equal(DatumStreamBlockWrite_Nth(dsw), nrows);
+
+	writesz = DatumStreamBlockWrite_Block(dsw, buffer);
+	assert_true(writesz > 0 && writesz <= 32768);
+	flags = ((DatumStreamBlock_Dense *) buffer)->orig_4_bytes.flags;
+
+	DatumStreamBlockRead_Init(dsr, &textTypeInfo,
+							  DatumStreamVersion_Dense_Enhanced,
+							  true,		/* rle_can_have_compression */
+							  NULL, NULL, NULL, NULL);
+	DatumStreamBlockRead_GetReady(dsr, buffer, writesz, 1, nrows,
+								  &hadToAdjustRowCount, &adjustedRowCount);
+	assert_false(hadToAdjustRowCount);
+	assert_int_equal(dsr->dictionary_block_was_compressed,
+					 (flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0);
+
+	for (int i = 0; i < nrows; i++)
+	{
+		Datum		d;
+		bool		null;
+
+		assert_int_equal(DatumStreamBlockRead_Advance(dsr), 1);
+		DatumStreamBlockRead_Get(dsr, &d, &null);
+
+		if (values[i] == NULL)
+		{
+			assert_true(null);
+			continue;
+		}
+
+		assert_false(null);
+		/* the 4-byte headers are aligned, like in a block without dictionary */
+		if (!VARATT_IS_SHORT(DatumGetPointer(d)))
+			assert_true(DatumGetPointer(d) ==
+						(char *) att_align_nominal(DatumGetPointer(d), 'i'));
+		assert_int_equal(VARSIZE_ANY_EXHDR(DatumGetPointer(d)), strlen(values[i]));
+		assert_true(memcmp(VARDATA_ANY(DatumGetPointer(d)), values[i],
+						   strlen(values[i])) == 0);
+	}
+	assert_int_equal(DatumStreamBlockRead_Advance(dsr), 0);
+
+	DatumStreamBlockRead_Finish(dsr);
+	DatumStreamBlockWrite_Finish(dsw);
+	pfree(buffer);
+	pfree(dsr);
+	pfree(dsw);
+
+	return flags;
+}
+
+/*
+ * Unit test function to test a dictionary encoded block that also has runs
+ * of repeated values and NULLs.
+ */
+static void
+test__Dictionary__RleAndNulls(void **state)
+{
+	static const char *distinct[] = {"red apple", "green pear", "yellow banana"};
+	char	   *values[600];
+	int16		flags;
+
+	for (int i = 0; i < 600; i++)
+	{
+		if (i % 7 == 3)
+			values[i] = NULL;
+		else
+			values[i] = (char *) distinct[(i / 3) % 3];
+	}
+
+	flags = write_and_read_block(values, 600);
+	assert_true(flags & DSB_HAS_DICTIONARY_COMPRESSION);
+	assert_true(flags & DSB_HAS_RLE_COMPRESSION);
+	assert_true(flags & DSB_HAS_NULLBITMAP);
+}
+
+/*
+ * Unit test function to test that a dictionary holds at most
+ * DATUMSTREAM_DICTIONARY_MAX_COUNT values, and that a block with more is
+ * written without one.
+ */
+static void
+test__Dictionary__MaxCount(void **state)
+{
+	char	   *values[2000];
+	int16		flags;
+
+	for (int i = 0; i < 2000; i++)
+		values[i] = psprintf("value %03d", i % DATUMSTREAM_DICTIONARY_MAX_COUNT);
+	flags = write_and_read_block(values, 2000);
+	assert_true(flags & DSB_HAS_DICTIONARY_COMPRESSION);
+
+	for (int i = 0; i < 2000; i++)
+		values[i] = psprintf("value %03d", i % (DATUMSTREAM_DICTIONARY_MAX_COUNT + 1));
+	flags = write_and_read_block(values, 2000);
+	assert_false(flags & DSB_HAS_DICTIONARY_COMPRESSION);
+}
+
+/*
+ * Unit test function to test a dictionary of short varlena values and of
+ * values too long for a short header, which are aligned.
+ */
+static void
+test__Dictionary__VarlenaAlignment(void **state)
+{
+	char	   *longValue = palloc(201);
+	char	   *values[200];
+	int16		flags;
+
+	memset(longValue, 'z', 200);
+	longValue[200] = '\0';
+
+	for (int i = 0; i < 200; i++)
+	{
+		switch (i % 4)
+		{
+			case 0:
+				values[i] = "x";
+				break;
+			case 1:
+				values[i] = longValue;
+				break;
+			case 2:
+				values[i] = "yy";
+				break;
+			default:
+				values[i] = (i % 8 == 3) ? longValue + 1 : "zzz";
+				break;
+		}
+	}
+
+	flags = write_and_read_block(values, 200);
+	assert_true(flags & DSB_HAS_DICTIONARY_COMPRESSION);
+}
+
 int 
 main(int argc, char* argv[]) 
 {
 	cmockery_parse_arguments(argc, argv);
 
 	const UnitTest tests[] = {
-			unit_test(test__DeltaCompression__Core)
+			unit_test(test__DeltaCompression__Core),
+			unit_test(test__GetBatch__FixedLength),
+			unit_test(test__Dictionary__RleAndNulls),
+			unit_test(test__Dictionary__MaxCount),
+			unit_test(test__Dictionary__VarlenaAlignment)
 	};
+
+	MemoryContextInit();
+
 	return run_tests(tests);
 }
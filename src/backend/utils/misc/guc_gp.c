@@ -25,6 +25,7 @@
 #include "access/url.h"
 #include "access/xlog_internal.h"
 #include "cdb/cdbappendonlyam.h"
+#include "cdb/cdbappendonlystoragecompress.h"
 #include "cdb/cdbendpoint.h"
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdisp_query.h"
@@ -142,7 +143,10 @@ int			gp_max_local_distributed_cache = 1024;
 bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_compaction = true;
+bool		gp_enable_aocs_late_materialization = false;
+bool		gp_enable_aocs_dictionary_encoding = false;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_read_ahead = 4;
 bool		gp_heap_require_relhasoids_match = true;
 bool		gp_local_distributed_cache_stats = false;
 bool		debug_xlog_record_read = false;
@@ -283,6 +287,7 @@ int			optimizer_minidump;
 int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
+int			optimizer_shared_mdcache_size;
 bool		optimizer_use_gpdb_allocators;
 
 /* Optimizer debugging GUCs */
@@ -540,6 +545,30 @@ static const struct config_enum_entry gp_interconnect_fc_methods[] = {
 	{NULL, 0}
 };
 
+static const struct config_enum_entry gp_interconnect_compressions[] = {
+	{"none", INTERCONNECT_COMPRESSION_NONE},
+#ifdef HAVE_LIBZ
+	{"zlib", INTERCONNECT_COMPRESSION_ZLIB},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", INTERCONNECT_COMPRESSION_ZSTD},
+#endif
+	{NULL, 0}
+};
+
+static const struct config_enum_entry gp_interconnect_local_shm_options[] = {
+	{"loopback", INTERCONNECT_LOCAL_SHM_LOOPBACK, false},
+	{"on", INTERCONNECT_LOCAL_SHM_ON, false},
+	{"off", INTERCONNECT_LOCAL_SHM_OFF, false},
+	{"true", INTERCONNECT_LOCAL_SHM_ON, true},
+	{"false", INTERCONNECT_LOCAL_SHM_OFF, true},
+	{"yes", INTERCONNECT_LOCAL_SHM_ON, true},
+	{"no", INTERCONNECT_LOCAL_SHM_OFF, true},
+	{"1", INTERCONNECT_LOCAL_SHM_ON, true},
+	{"0", INTERCONNECT_LOCAL_SHM_OFF, true},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry gp_interconnect_types[] = {
 	{"udpifc", INTERCONNECT_TYPE_UDPIFC},
 	{"tcp", INTERCONNECT_TYPE_TCP},
@@ -715,6 +744,27 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"gp_enable_hybrid_redistribute", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the Postgres planner's use of hybrid redistribution for joins on skewed keys."),
+			gettext_noop("The outer rows of the hot keys stay on their segment, "
+						 "and the inner rows of the hot keys are broadcast. "
+						 "GPORCA does not use hybrid redistribution.")
+		},
+		&gp_enable_hybrid_redistribute,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"gp_enable_runtime_filter", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables Bloom filters from hash joins to the scans on their outer side."),
+			gettext_noop("The scan drops the rows whose join key is not on the inner side "
+						 "of the hash join, before they reach the join.")
+		},
+		&gp_enable_runtime_filter,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"debug_print_prelim_plan", PGC_USERSET, LOGGING_WHAT,
 			gettext_noop("Prints the preliminary execution plan to server log."),
@@ -957,6 +1007,31 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_enable_aocs_late_materialization", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Evaluate simple quals of a column oriented table scan before reading the other columns."),
+			gettext_noop("Column values are only decoded for the rows that pass the quals, "
+						 "and blocks holding no such rows are skipped."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_aocs_late_materialization,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_enable_aocs_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Dictionary encode blocks of RLE_TYPE compressed column oriented tables with few distinct values."),
+			gettext_noop("Applies to variable-length columns. Each distinct value of a block "
+						 "is stored once, and rows refer to it with a one byte code. "
+						 "Older binaries cannot read the blocks written this way."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_aocs_dictionary_encoding,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_heap_require_relhasoids_match", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Issue an error on discovery of a mismatch between relhasoids and a tuple header."),
@@ -3296,6 +3371,30 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_compress_workers", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Number of threads compressing append-optimized blocks in the background on insert."),
+			gettext_noop("Only zlib and zstd compression is done in the background. "
+						 "Zero compresses the blocks in the inserting backend itself."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_compress_workers,
+		0, 0, 64,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_read_ahead", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Number of large reads ahead of the current one to prefetch when reading an append-optimized segment file."),
+			gettext_noop("The operating system is asked to start reading them while the current "
+						 "one is processed. Zero disables prefetching."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_read_ahead,
+		4, 0, 64,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_max_entries", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Sets the maximum number of entries that can be stored in the workfile directory"),
@@ -3492,6 +3591,38 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the maximum number of packets sent or received with one system call in the UDP interconnect"),
+			gettext_noop("The receive side uses the value in effect when the backend set up its interconnect.")
+		},
+		&Gp_interconnect_batch_size,
+		16, 1, 64,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_tuple_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of tuples an unordered motion packs column by column into one message."),
+			gettext_noop("0 sends every tuple on its own.  The receiver accepts either format."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&Gp_interconnect_tuple_batch_size,
+		0, 0, 8192,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_motion_hash_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of tuples a redistribute motion hashes at once."),
+			gettext_noop("0 hashes every tuple on its own."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_motion_hash_batch_size,
+		0, 0, 8192,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_cursor_ic_table_size", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Sets the size of Cursor History Table in the UDP interconnect"),
@@ -4049,6 +4180,18 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_blockdirectory_minipage_cache_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Number of block directory minipages an append-optimized table scan keeps in memory."),
+			gettext_noop("Spares index and index-only scans searching the block directory "
+						 "again for the minipages they have already read. Zero disables the cache."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_blockdirectory_minipage_cache_size,
+		32, 0, 1024,
+		NULL, NULL, NULL
+	},
+
 
 	{
 		{"gp_segworker_relative_priority", PGC_POSTMASTER, RESOURCES_MGM,
@@ -4247,6 +4390,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_shared_mdcache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the MDCache shared by all sessions on the coordinator."),
+			gettext_noop("0 disables the shared MDCache."),
+			GUC_UNIT_KB
+		},
+		&optimizer_shared_mdcache_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"memory_profiler_dataset_size", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Set the size in GB"),
@@ -4474,6 +4628,17 @@ struct config_real ConfigureNamesReal_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_hybrid_redistribute_skew_ratio", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets how skewed a join key must be for hybrid redistribution."),
+			gettext_noop("A key is hot if its rows are at least this many times "
+						 "an even share of the rows for one segment.")
+		},
+		&gp_hybrid_redistribute_skew_ratio,
+		1.0, 0.01, DBL_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_selectivity_damping_factor", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Factor used in selectivity damping."),
@@ -4950,6 +5115,29 @@ struct config_enum ConfigureNamesEnum_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_compression", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the method used to compress the tuple chunks sent by the interconnect."),
+			gettext_noop("Valid values are \"none\", \"zlib\" and \"zstd\", depending on the build."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&Gp_interconnect_compression,
+		INTERCONNECT_COMPRESSION_NONE, gp_interconnect_compressions,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_local_shm", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Pass the interconnect packets between processes on the same host through shared memory."),
+			gettext_noop("Valid values are \"off\", \"loopback\" (processes of the same segment) and \"on\" (any process "
+						 "on the host). Only used by the UDP interconnect, other connections go through the network."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_interconnect_local_shm,
+		INTERCONNECT_LOCAL_SHM_OFF, gp_interconnect_local_shm_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_type", PGC_BACKEND, GP_ARRAY_TUNING,
 			gettext_noop("Sets the protocol used for inter-node communication."),
@@ -42,6 +42,66 @@
 #define APPENDONLY_VISIMAP_MAX_BITMAP_WORD_COUNT \
 	(APPENDONLY_VISIMAP_MAX_BITMAP_SIZE / sizeof(bitmapword))
 
+/*
+ * Number of 64-bit words of a bitmap container, covering the rows of one
+ * visibility map entry.
+ */
+#define APPENDONLY_VISIMAP_CONTAINER_WORDS (APPENDONLY_VISIMAP_MAX_RANGE / 64)
+
+/*
+ * Up to this many hidden rows, an array container is not larger than a
+ * bitmap container.
+ */
+#define APPENDONLY_VISIMAP_ARRAY_MAX_HIDDEN \
+	(APPENDONLY_VISIMAP_CONTAINER_WORDS * sizeof(uint64) / sizeof(uint16))
+
+/*
+ * The hidden rows of one visibility map entry of a loaded segment file.
+ *
+ * Like the containers of a roaring bitmap, the rows are kept as a sorted
+ * array of offsets when there are few of them, or as a bitmap otherwise.
+ * If all rows of the entry are hidden, neither is allocated.
+ */
+typedef struct AppendOnlyVisimapContainer
+{
+	/* first row number covered, a multiple of APPENDONLY_VISIMAP_MAX_RANGE */
+	int64		firstRowNum;
+
+	int32		hiddenCount;
+
+	/* offsets of the hidden rows, if hiddenCount <= APPENDONLY_VISIMAP_ARRAY_MAX_HIDDEN */
+	uint16	   *offsets;
+
+	/* bitmap of the hidden rows, if there are more of them */
+	uint64	   *words;
+} AppendOnlyVisimapContainer;
+
+/*
+ * All visibility map entries of a segment file, loaded at once by
+ * AppendOnlyVisimap_LoadSegmentFile() for sequential scans. Entries
+ * without hidden rows have no container.
+ */
+typedef struct AppendOnlyVisimapSegment
+{
+	MemoryContext memoryContext;
+
+	int32		segno;
+
+	/* containers in ascending order of firstRowNum */
+	AppendOnlyVisimapContainer *containers;
+	int			numContainers;
+
+	/* container of the last lookup, scans go through them in order */
+	int			currentContainer;
+
+	/*
+	 * Range of rows [visibleFrom, visibleTo) known to be visible from the
+	 * last lookup, so that the following rows need no container lookup.
+	 */
+	int64		visibleFrom;
+	int64		visibleTo;
+} AppendOnlyVisimapSegment;
+
 /*
  * Data structure for the ao visibility map processing.
  *
@@ -64,6 +124,12 @@ typedef struct AppendOnlyVisimap
 	 */
 	AppendOnlyVisimapStore visimapStore;
 
+	/*
+	 * Visibility map entries of the segment file being scanned, if loaded
+	 * with AppendOnlyVisimap_LoadSegmentFile(). NULL otherwise.
+	 */
+	AppendOnlyVisimapSegment *segmentMap;
+
 } AppendOnlyVisimap;
 
 /*
@@ -119,6 +185,16 @@ void AppendOnlyVisimap_Finish(
 						 AppendOnlyVisimap *visiMap,
 						 LOCKMODE lockmode);
 
+bool AppendOnlyVisimap_LoadSegmentFile(
+								  AppendOnlyVisimap *visiMap,
+								  int segno);
+
+int64 AppendOnlyVisimap_GetHiddenTupleCountInRange(
+											 AppendOnlyVisimap *visiMap,
+											 int segno,
+											 int64 firstRowNum,
+											 int64 numRows);
+
 void AppendOnlyVisimap_DeleteSegmentFile(
 									AppendOnlyVisimap *visiMap,
 									int segno);
@@ -61,6 +61,9 @@ typedef struct MemTupleData
 
 typedef MemTupleData *MemTuple;
 
+/* JIT compiled memtuple_deform() of a binding, see jit_compile_memtuple_deform() */
+typedef void (*MemTupleDeformFunc) (MemTuple mtup, Datum *datum, bool *isnull);
+
 #define MEMTUP_LEAD_BIT 0x80000000
 #define MEMTUP_LEN_MASK 0x3FFFFFF8
 #define MEMTUP_HASNULL   1
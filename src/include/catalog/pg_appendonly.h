@@ -59,10 +59,11 @@ typedef enum AORelationVersion
 	AORelationVersion_None = 0,
 	AORelationVersion_GP6 = 1,
 	AORelationVersion_GP7 = 2,
+	AORelationVersion_GP7_ZoneMaps = 3,	/* minipages may carry zone maps */
 	MaxAORelationVersion
 } AORelationVersion;
 
-#define AORelationVersion_GetLatest() AORelationVersion_GP7
+#define AORelationVersion_GetLatest() AORelationVersion_GP7_ZoneMaps
 #define AORelationVersion_Get(relation) (relation)->rd_appendonly->version
 #define AORelationVersion_Validate(relation, version) \
 	(AORelationVersion_Get((relation)) >= (version))
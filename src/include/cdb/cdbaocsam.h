@@ -112,6 +112,56 @@ typedef enum AOCSProjectionKind
 	AOCS_PROJ_ALL 		/* all of the columns */
 } AOCSProjectionKind;
 
+/*
+ * Values of one column decoded ahead of the current row by a sequential scan.
+ * A batch never spans datum stream blocks, so by-reference values keep
+ * pointing into the current block of the column.
+ */
+#define AOCS_SCAN_BATCH_ROWS 64
+
+typedef struct AOCSColumnBatch
+{
+	Datum		values[AOCS_SCAN_BATCH_ROWS];
+	bool		nulls[AOCS_SCAN_BATCH_ROWS];
+	uint8		codes[AOCS_SCAN_BATCH_ROWS];	/* of a dictionary encoded block */
+	int			count;		/* number of values decoded */
+	int			pos;		/* index of the current row's value */
+	int64		firstNth;	/* position of values[0] in the block */
+	int64		skip;		/* rows to pass over before the next value */
+} AOCSColumnBatch;
+
+/*
+ * A simple qual of the form "column op constant" that a sequential scan
+ * evaluates as soon as the column has been read. The other projected columns
+ * are only decoded for the rows that pass, see aocs_getnext.
+ *
+ * If the operator is a btree comparison, strategy and cmpfinfo, the btree
+ * comparison function of the column type and the constant type, are also set
+ * to check the filter against the zone maps of the block directory.
+ *
+ * A qual of the form "column op ANY (array constant)", such as an IN list,
+ * is kept as the elems of the array instead of constval.
+ *
+ * In a dictionary encoded block, rows with the same code have the same
+ * value, so the result of the filter is remembered per code for as long as
+ * the column stays on the same dictionary.
+ */
+typedef struct AOCSScanFilter
+{
+	AttrNumber	attno;		/* zero based column number */
+	bool		constFirst;	/* is the constant the left operand? */
+	Datum		constval;
+	Datum	   *elems;		/* non-null array elements, or NULL */
+	int			nelems;
+	Oid			collation;
+	FmgrInfo	finfo;
+	StrategyNumber strategy;	/* for "column op constant", or invalid */
+	FmgrInfo	cmpfinfo;
+
+	uint32		dictionaryGeneration;	/* see datumstreamread_dictionary_generation */
+	int8		dictionaryResults[DATUMSTREAM_DICTIONARY_MAX_COUNT];	/* 1 pass, -1 fail, 0 unknown */
+} AOCSScanFilter;
+
 /*
  * Used for fetch individual tuples from specified by TID of append only relations
  * using the AO Block Directory.
@@ -258,6 +308,22 @@ typedef struct AOCSScanDescData
 		int64 			   *attnum_to_rownum;
 
 		struct DatumStreamRead **ds;
+
+		/* per column values decoded ahead of the current row, by attnum */
+		AOCSColumnBatch *batches;
+
+		/*
+		 * Quals evaluated while scanning. The columns they reference are
+		 * placed right after the anchor column in proj_atts, and the first
+		 * num_filter_atts columns are read before the quals are checked,
+		 * in filterCtx. num_filter_atts is 0 if the rows are not filtered
+		 * one by one, the filters are then only checked against the zone
+		 * maps.
+		 */
+		AOCSScanFilter *filters;
+		int			num_filters;
+		AttrNumber	num_filter_atts;
+		MemoryContext filterCtx;
 	} columnScanInfo;
 
 	struct AOCSFileSegInfo **seginfo;
@@ -280,6 +346,14 @@ typedef struct AOCSScanDescData
 	AppendOnlyBlockDirectory *blockDirectory;
 	AppendOnlyVisimap visibilityMap;
 
+	/*
+	 * Block directory of the table opened for search, to skip the blocks of
+	 * the anchor column whose rows the zone maps show the scan filters
+	 * reject. NULL if the table has no block directory, or no filter can
+	 * use zone maps.
+	 */
+	AppendOnlyBlockDirectory *zoneMapDirectory;
+
 	/*
 	 * The total number of bytes read, compressed, across all segment files, and
 	 * across all columns projected, so far. It is used for scan progress reporting.
@@ -423,6 +497,7 @@ aocs_beginrangescan(Relation relation,
 					int segfile_count,
 					bool *proj);
 
+extern void aocs_set_scan_filters(AOCSScanDesc scan, List *qual);
 extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
@@ -28,6 +28,7 @@
 #include "access/xlog.h"
 #include "access/appendonly_visimap.h"
 #include "executor/tuptable.h"
+#include "jit/jit.h"
 #include "nodes/primnodes.h"
 #include "nodes/bitmapset.h"
 #include "storage/block.h"
@@ -122,6 +123,13 @@ typedef struct AppendOnlyInsertDescData
 	/* The block directory for the appendonly relation. */
 	AppendOnlyBlockDirectory blockDirectory;
 	Oid segrelid;
+
+	/*
+	 * The block handed to the compression workers, not yet written out and
+	 * recorded in the block directory.
+	 */
+	int64			pendingBlockFirstRowNum;
+	int				pendingBlockItemCount;
 } AppendOnlyInsertDescData;
 
 typedef AppendOnlyInsertDescData *AppendOnlyInsertDesc;
@@ -135,6 +143,21 @@ typedef struct AppendOnlyExecutorReadBlock
 	AttrNumber 		curLargestAttnum; /* the largest attnum stored in memtuple currently being read */
 	int64 			*attnum_to_rownum; /*attnum to rownum mapping, used in building memtuple binding */
 	MemTupleBinding *mt_bind;
+
+	/*
+	 * JIT compiled deforming of memtuples, for bindings covering all
+	 * attributes of the slot. Only used by sequential scans that pass the
+	 * jit_above_cost threshold, see AppendOnlyScan_UseJitDeform().
+	 *
+	 * mt_deform is the function for the current binding, or NULL.  The
+	 * function compiled for the slot descriptor mt_jit_tupdesc is kept in
+	 * mt_jit_deform across the blocks, which recreate the binding.
+	 */
+	bool			jitDeform;
+	MemTupleDeformFunc mt_deform;
+	MemTupleDeformFunc mt_jit_deform;
+	TupleDesc		mt_jit_tupdesc;
+	JitContext	   *mt_jit_context;
 	/*
 	 * When reading a segfile that's using version < AOSegfileFormatVersion_GP5,
 	 * that is, was created before GPDB 5.0 and upgraded with pg_upgrade, we need
@@ -216,6 +239,9 @@ typedef struct AppendOnlyScanDescData
 	/* current scan state */
 	bool		needNextBuffer;
 
+	/* the visimap hides no tuple of the current block */
+	bool		blockAllVisible;
+
 	bool	initedStorageRoutines;
 
 	AppendOnlyStorageAttributes	storageAttributes;
@@ -22,6 +22,7 @@
 
 extern int gp_blockdirectory_entry_min_range;
 extern int gp_blockdirectory_minipage_size;
+extern int gp_blockdirectory_minipage_cache_size;
 
 /*
  * In-memory equivalent of on-disk data structure MinipageEntry, used to
@@ -60,8 +61,31 @@ typedef struct MinipageEntry
 	int64 rowCount;
 } MinipageEntry;
 
+/*
+ * Summary of the values in the block of a minipage entry: a zone map.
+ *
+ * Zone maps are recorded when column oriented tables write blocks of a
+ * fixed-length, pass-by-value type that has a default btree opclass. The
+ * bounds are compared with the support function of that opclass. Scans use
+ * them to skip the blocks that cannot hold rows satisfying their quals.
+ */
+typedef struct MinipageZoneMap
+{
+	int64 minValue;
+	int64 maxValue;
+	int32 flags;
+	int32 reserved;
+} MinipageZoneMap;
+
+#define ZONEMAP_VALID		0x01	/* the zone map was recorded */
+#define ZONEMAP_HAS_VALUES	0x02	/* minValue and maxValue are set */
+#define ZONEMAP_HAS_NULLS	0x04
+
 /*
  * Define a varlena type for a minipage.
+ *
+ * From MINIPAGE_VERSION_ZONEMAP on, the entries are followed by an array of
+ * nEntry zone maps.
  */
 typedef struct Minipage
 {
@@ -74,6 +98,8 @@ typedef struct Minipage
 	MinipageEntry entry[1];
 } Minipage;
 
+#define MINIPAGE_VERSION_ZONEMAP 1
+
 /*
  * Define the relevant info for a minipage for each
  * column group.
@@ -81,6 +107,8 @@ typedef struct Minipage
 typedef struct MinipagePerColumnGroup
 {
 	Minipage *minipage;
+	/* zone maps of the entries, kept apart from the minipage in memory */
+	MinipageZoneMap *zoneMaps;
 	uint32 numMinipageEntries;
 	ItemPointerData tupleTid;
 	/* cached entry number from last call to find_minipage_entry() */
@@ -99,6 +127,21 @@ typedef struct MinipagePerColumnGroup
 
 #define InvalidEntryNum (-1)
 
+/*
+ * A minipage kept in the minipage cache of a block directory, covering the
+ * rows [firstRowNum, lastRowNum] of a column group of a segment file.
+ */
+typedef struct MinipageCacheEntry
+{
+	int segmentFileNum;
+	int columnGroupNo;
+	int64 firstRowNum;
+	int64 lastRowNum;
+	/* for the least recently used replacement */
+	uint64 lastUsed;
+	MinipagePerColumnGroup minipageInfo;
+} MinipageCacheEntry;
+
 /*
  * Define a structure for the append-only relation block directory.
  */
@@ -128,6 +171,19 @@ typedef struct AppendOnlyBlockDirectory
 	 */
 	MinipagePerColumnGroup *minipages;
 
+	/*
+	 * Up to minipageCacheSize minipages read before, so that lookups going
+	 * back and forth between minipages don't need to search the block
+	 * directory relation each time. Only used by lookups with an MVCC
+	 * snapshot, for which the minipages stay the same. Zero size disables it.
+	 */
+	MinipageCacheEntry *minipageCache;
+	int minipageCacheSize;
+	int minipageCacheCount;
+	uint64 minipageCacheClock;
+	int64 minipageCacheHits;
+	int64 minipageCacheMisses;
+
 	/*
 	 * Some temporary space to help form tuples to be inserted into
 	 * the block directory, and to help the index scan.
@@ -268,6 +324,20 @@ AppendOnlyBlockDirectory_InsertEntry(AppendOnlyBlockDirectory *blockDirectory,
 									 int64 firstRowNum,
 									 int64 fileOffset,
 									 int64 rowCount);
+extern bool
+AppendOnlyBlockDirectory_InsertEntryWithZoneMap(AppendOnlyBlockDirectory *blockDirectory,
+												int columnGroupNo,
+												int64 firstRowNum,
+												int64 fileOffset,
+												int64 rowCount,
+												MinipageZoneMap *zoneMap);
+extern bool
+AppendOnlyBlockDirectory_GetZoneMap(AppendOnlyBlockDirectory *blockDirectory,
+									AOTupleId *aoTupleId,
+									int columnGroupNo,
+									int64 *attnum_to_rownum,
+									MinipageZoneMap *zoneMap,
+									int64 *lastRowNum);
 extern void
 AppendOnlyBlockDirectory_DeleteSegmentFile(AppendOnlyBlockDirectory *blockDirectory,
 										   int columnGroupNo,
@@ -338,6 +408,26 @@ minipage_size(uint32 nEntry)
 	return offsetof(Minipage, entry) + sizeof(MinipageEntry) * nEntry;
 }
 
+/* size of a minipage with zone maps */
+static inline uint32
+minipage_zonemap_size(uint32 nEntry)
+{
+	return minipage_size(nEntry) + sizeof(MinipageZoneMap) * nEntry;
+}
+
+/*
+ * Allocate the in-memory minipage of a column group, in the current memory
+ * context.
+ */
+static inline void
+alloc_minipage(MinipagePerColumnGroup *minipageInfo)
+{
+	minipageInfo->minipage =
+		palloc0(minipage_zonemap_size(NUM_MINIPAGE_ENTRIES));
+	minipageInfo->zoneMaps =
+		palloc0(sizeof(MinipageZoneMap) * NUM_MINIPAGE_ENTRIES);
+}
+
 /*
  * copy_out_minipage
  *
@@ -356,7 +446,7 @@ copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
 	value = (struct varlena *)
 		DatumGetPointer(minipage_value);
 	detoast_value = pg_detoast_datum(value);
-	Assert(VARSIZE(detoast_value) <= minipage_size(NUM_MINIPAGE_ENTRIES));
+	Assert(VARSIZE(detoast_value) <= minipage_zonemap_size(NUM_MINIPAGE_ENTRIES));
 
 	memcpy(minipageInfo->minipage, detoast_value, VARSIZE(detoast_value));
 	if (detoast_value != value)
@@ -366,6 +456,14 @@ copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
 
 	minipageInfo->numMinipageEntries = minipageInfo->minipage->nEntry;
 	minipageInfo->cached_entry_no = InvalidEntryNum;
+
+	if (minipageInfo->minipage->version >= MINIPAGE_VERSION_ZONEMAP)
+		memcpy(minipageInfo->zoneMaps,
+			   &minipageInfo->minipage->entry[minipageInfo->numMinipageEntries],
+			   sizeof(MinipageZoneMap) * minipageInfo->numMinipageEntries);
+	else
+		MemSet(minipageInfo->zoneMaps, 0,
+			   sizeof(MinipageZoneMap) * minipageInfo->numMinipageEntries);
 }
 
 static inline void
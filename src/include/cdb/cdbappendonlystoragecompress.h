@@ -0,0 +1,37 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbappendonlystoragecompress.h
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/cdbappendonlystoragecompress.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef CDBAPPENDONLYSTORAGECOMPRESS_H
+#define CDBAPPENDONLYSTORAGECOMPRESS_H
+
+/*
+ * A block handed to the compression worker threads.  Consider the fields
+ * private to cdbappendonlystoragecompress.c.
+ */
+typedef struct AppendOnlyCompressJob AppendOnlyCompressJob;
+
+/* GUC: number of compression worker threads per backend, 0 disables them */
+extern int	gp_appendonly_compress_workers;
+
+extern bool AppendOnlyCompressPool_Supports(char *compressType);
+extern AppendOnlyCompressJob *AppendOnlyCompressPool_Submit(char *compressType,
+															int compressLevel,
+															uint8 *sourceData,
+															int32 sourceLen,
+															int32 compressedBufferLen);
+extern void AppendOnlyCompressPool_Wait(AppendOnlyCompressJob *job,
+										uint8 **sourceData,
+										uint8 **compressedData,
+										int32 *compressedLen);
+extern void AppendOnlyCompressPool_Release(AppendOnlyCompressJob *job);
+
+#endif   /* CDBAPPENDONLYSTORAGECOMPRESS_H */
@@ -17,6 +17,7 @@
 #include "catalog/pg_appendonly.h"
 #include "catalog/pg_compression.h"
 #include "cdb/cdbappendonlystorage.h"
+#include "cdb/cdbappendonlystoragecompress.h"
 #include "cdb/cdbappendonlystoragelayer.h"
 #include "cdb/cdbbufferedappend.h"
 #include "utils/palloc.h"
@@ -176,6 +177,21 @@ typedef struct AppendOnlyStorageWrite
 
 	bool needsWAL;
 
+	/*
+	 * When compressAsync is set, blocks are compressed by the worker threads
+	 * of cdbappendonlystoragecompress.c.  At most one block is pending; it
+	 * is written out by ~_CompletePendingBuffer, and these remember what
+	 * ~_FinishBuffer would have needed to write it.
+	 */
+	bool		compressAsync;
+	AppendOnlyCompressJob *pendingJob;
+	AoHeaderKind pendingAoHeaderKind;
+	bool		pendingIsFirstRowNumSet;
+	int64		pendingFirstRowNum;
+	int32		pendingContentLen;
+	int			pendingExecutorBlockKind;
+	int			pendingRowCount;
+
 } AppendOnlyStorageWrite;
 
 extern void AppendOnlyStorageWrite_Init(AppendOnlyStorageWrite *storageWrite,
@@ -221,6 +237,13 @@ extern void AppendOnlyStorageWrite_FinishBuffer(
 
 extern void AppendOnlyStorageWrite_CancelLastBuffer(AppendOnlyStorageWrite *storageWrite);
 
+extern bool AppendOnlyStorageWrite_IsCompressAsync(AppendOnlyStorageWrite *storageWrite);
+extern void AppendOnlyStorageWrite_SubmitBuffer(AppendOnlyStorageWrite *storageWrite,
+									int32 contentLen,
+									int executorBlockKind,
+									int rowCount);
+extern bool AppendOnlyStorageWrite_CompletePendingBuffer(AppendOnlyStorageWrite *storageWrite);
+
 extern void AppendOnlyStorageWrite_Content(AppendOnlyStorageWrite *storageWrite,
 							   uint8 *content,
 							   int32 contentLen,
@@ -30,6 +30,19 @@ typedef enum
 	REDUCE_JUMP_HASH
 } CdbHashReduce;
 
+/*
+ * Hash functions of distribution key types that are computed inline rather
+ * than called through the function manager.
+ */
+typedef enum
+{
+	CDBHASH_FAST_NONE = 0,
+	CDBHASH_FAST_INT2,			/* hashint2 */
+	CDBHASH_FAST_INT4,			/* hashint4, also used for date */
+	CDBHASH_FAST_INT8,			/* hashint8 and timestamp_hash */
+	CDBHASH_FAST_UUID			/* uuid_hash */
+} CdbHashFastFunc;
+
 /*
  * Structure that holds Greenplum Database hashing information.
  */
@@ -43,6 +56,7 @@ typedef struct CdbHash
 
 	int			natts;
 	FmgrInfo   *hashfuncs;
+	CdbHashFastFunc *fastfuncs;
 } CdbHash;
 
 /*
@@ -67,6 +81,18 @@ extern void cdbhash(CdbHash *h, int attno, Datum datum, bool isnull);
  */
 extern unsigned int cdbhashreduce(CdbHash *h);
 
+/*
+ * Hash a batch of n tuples one distribution key column at a time, and reduce
+ * all their hashes to segment numbers at once.  This gives the same results
+ * as cdbhashinit(), cdbhash() and cdbhashreduce() for each tuple, minus the
+ * per-call overhead.  isnulls may be NULL if the column has no NULLs.
+ */
+extern void cdbhashbatchinit(CdbHash *h, uint32 *hashes, int n);
+extern void cdbhashbatch(CdbHash *h, int attno, const Datum *datums,
+						 const bool *isnulls, uint32 *hashes, int n);
+extern void cdbhashreducebatch(CdbHash *h, const uint32 *hashes,
+							   unsigned int *segs, int n);
+
 /*
  * Return a random segment number, for a randomly distributed policy.
  */
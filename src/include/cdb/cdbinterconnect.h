@@ -26,6 +26,7 @@
 #include "cdb/tupchunk.h"
 #include "cdb/tupchunklist.h"
 #include "cdb/tupleremap.h"
+#include "cdb/ic_stats.h"
 
 struct CdbProcess;                          /* #include "nodes/execnodes.h" */
 struct ExecSlice;                           /* #include "nodes/execnodes.h" */
@@ -283,6 +284,33 @@ struct MotionConn
 	int			pkt_q_tail;
 	uint8		**pkt_q;
 
+	/*
+	 * used by the UDP interconnect when the peer is on the same host.
+	 *
+	 * the shared memory ring the packets go through instead of the network,
+	 * created by the receiver and attached by the sender when it flushes its
+	 * first packet (shmChecked), NULL if not used.
+	 */
+	struct ICShmRing *shmRing;
+	bool		shmChecked;
+
+	/*
+	 * used by the sender when gp_interconnect_compression is set.
+	 *
+	 * number of packets in a row that did not compress well, and number of
+	 * packets still to be sent as they are before trying again.
+	 */
+	int			compressMisses;
+	int			compressSkip;
+
+	/*
+	 * used by the receiver: packets that came compressed, with their size
+	 * before and after compression.
+	 */
+	uint64 stat_compress_pkts;
+	uint64 stat_compress_raw_bytes;
+	uint64 stat_compress_wire_bytes;
+
 	uint64 stat_total_ack_time;
 	uint64 stat_count_acks;
 	uint64 stat_max_ack_time;
@@ -291,6 +319,26 @@ struct MotionConn
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
 
+	/*
+	 * Telemetry of the UDP interconnect, for EXPLAIN ANALYZE and the history
+	 * of ic_stats.c.
+	 *
+	 * stat_count_pkts counts the packets sent by the sender, or received by
+	 * the receiver.  stat_rtt_hist is the histogram of the ack times of the
+	 * packets that were sent only once.  A stall is a wait of the sender for
+	 * acks to get a send buffer.  The receiver samples the depth of its queue
+	 * each time it looks for a packet.
+	 */
+	uint64 stat_count_pkts;
+	uint64 stat_rtt_hist[IC_RTT_HIST_BUCKETS];
+	uint64 stat_count_stalls;
+	uint64 stat_stall_time;
+	uint64 stat_count_disordered;
+	uint64 stat_count_duplicated;
+	uint64 stat_total_queue_size;
+	uint64 stat_count_queue_samples;
+	int stat_max_queue_size;
+
 	/*
 	 * used by the sender.
 	 *
@@ -344,6 +392,9 @@ typedef struct ChunkTransportStateEntry
 
 	bool		sendingEos;
 
+	/* number of connections with a shared memory ring (UDP interconnect) */
+	int			numShmConns;
+
 	/* Statistics info for this motion on the interconnect level */
 	uint64 stat_total_ack_time;
 	uint64 stat_count_acks;
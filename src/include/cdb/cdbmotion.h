@@ -35,11 +35,16 @@ typedef enum SendReturnCode
  * SerializeTupleDirect() (in cdbmotion.c).
  *
  * Simplified somewhat in 4.0 to remove mirror-data.
+ *
+ * flushlen is the room of an empty packet if the connection can send the
+ * current one early for free (it goes through shared memory to a process on
+ * the same host), 0 otherwise.
  */
 struct directTransportBuffer
 {
 	unsigned char		*pri;
 	int					prilen;
+	int					flushlen;
 };
 
 /* Max message size */
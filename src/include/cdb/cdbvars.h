@@ -332,6 +332,24 @@ typedef enum GpVars_Interconnect_Method
 
 extern int Gp_interconnect_fc_method;
 
+/*
+ * Parameter Gp_interconnect_compression
+ *
+ * Compression method applied by the sender to the packets of tuple chunks
+ * before they go onto the wire.  Packets that do not shrink enough are sent
+ * as they are, and after a run of those the sender stops trying for a while.
+ * The receiver decodes whatever method the packet says, so the setting only
+ * matters on the sending side.
+ */
+typedef enum GpVars_Interconnect_Compression
+{
+	INTERCONNECT_COMPRESSION_NONE = 0,
+	INTERCONNECT_COMPRESSION_ZLIB,
+	INTERCONNECT_COMPRESSION_ZSTD,
+} GpVars_Interconnect_Compression;
+
+extern int Gp_interconnect_compression;
+
 /*
  * Parameter Gp_interconnect_queue_depth
  *
@@ -372,6 +390,34 @@ extern int  Gp_interconnect_transmit_timeout;
 extern int	Gp_interconnect_min_retries_before_timeout;
 extern int	Gp_interconnect_debug_retry_interval;
 
+/*
+ * Parameter Gp_interconnect_batch_size
+ *
+ * The maximum number of packets the UDP interconnect hands to the kernel
+ * with a single sendmmsg() or recvmmsg() call.  1 sends and receives the
+ * packets one by one.
+ */
+extern int	Gp_interconnect_batch_size;
+
+/*
+ * Parameter Gp_interconnect_tuple_batch_size
+ *
+ * Number of tuples the sender of an unordered motion packs column by column
+ * into one message to a receiver, instead of sending them one at a time.
+ * 0 sends every tuple on its own.  Only used for tuple descriptors without
+ * record types or cstrings.
+ */
+extern int	Gp_interconnect_tuple_batch_size;
+
+/*
+ * Parameter gp_motion_hash_batch_size
+ *
+ * Number of tuples the sender of a redistribute motion collects before it
+ * hashes their distribution keys, one key column at a time.  0 hashes every
+ * tuple on its own.
+ */
+extern int	gp_motion_hash_batch_size;
+
 /* UDP recv buf size in KB.  For testing */
 extern int 	Gp_udp_bufsize_k;
 
@@ -400,6 +446,25 @@ extern bool gp_interconnect_log_stats;
 
 extern bool gp_interconnect_cache_future_packets;
 
+/*
+ * Parameter gp_interconnect_local_shm
+ *
+ * Let the UDP interconnect pass the packets between two processes on the
+ * same host through a ring in shared memory instead of the network.  With
+ * "loopback" only the connections between the processes of one segment do,
+ * such as the share of a redistribute motion that hashes back to the
+ * segment that sent it.  The tuples are still serialized into the ring, the
+ * two ends of a connection are different processes.  Off by default.
+ */
+typedef enum GpVars_Interconnect_Local_Shm
+{
+	INTERCONNECT_LOCAL_SHM_OFF = 0,
+	INTERCONNECT_LOCAL_SHM_LOOPBACK,
+	INTERCONNECT_LOCAL_SHM_ON,
+} GpVars_Interconnect_Local_Shm;
+
+extern int	gp_interconnect_local_shm;
+
 #define UNDEF_SEGMENT -2
 
 /*
@@ -509,6 +574,26 @@ extern int gp_log_interconnect;
  */
 extern double   gp_motion_cost_per_row;
 
+/*
+ * "gp_enable_hybrid_redistribute"
+ *
+ * If true, a join that redistributes its outer rel on a skewed key keeps
+ * the outer rows of the hot keys on their segment, and broadcasts the inner
+ * rows of those keys instead.
+ *
+ * Only the Postgres planner does this.  Plans from GPORCA never have hot
+ * keys, whatever the setting.
+ */
+extern bool gp_enable_hybrid_redistribute;
+
+/*
+ * "gp_hybrid_redistribute_skew_ratio"
+ *
+ * A key is hot if, by the statistics, the rows with that key alone are at
+ * least this many times an even share of the rows for one segment.
+ */
+extern double gp_hybrid_redistribute_skew_ratio;
+
 /*
  * "gp_segments_for_planner"
  *
@@ -548,6 +633,16 @@ extern bool gp_adjust_selectivity_for_outerjoins;
  */
 extern int gp_hashjoin_tuples_per_bucket;
 
+/*
+ * "gp_enable_runtime_filter"
+ *
+ * If true, a hash join builds a Bloom filter of its inner join keys, and a
+ * scan below its outer side in the same slice drops the rows that cannot
+ * find a match.  The filter is not sent across a Motion, so a join whose
+ * outer rel is moved gets no filter.
+ */
+extern bool gp_enable_runtime_filter;
+
 /*
  * Damping of selectivities of clauses which pertain to the same base
  * relation; compensates for undetected correlation
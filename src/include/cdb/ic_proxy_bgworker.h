@@ -18,6 +18,39 @@
 /* flag (in SHM) for incidaing if peer listener bind/listen failed */
 extern pg_atomic_uint32 *ic_proxy_peer_listener_failed;
 
+/*
+ * Traffic statistics of a peer of the proxy bgworker, kept in SHM so that
+ * backends can report them.  Only the proxy bgworker writes them.
+ *
+ * The counters are updated as the packets go, the queue depths and the rates
+ * are sampled once per second.
+ */
+typedef struct ICProxyPeerStats
+{
+	pg_atomic_uint32 dbid;		/* dbid of the peer, 0 if the slot is free */
+	int32		content;
+
+	pg_atomic_uint64 queued_packets;	/* packets not yet handed to the socket */
+	pg_atomic_uint64 queued_bytes;		/* bytes the socket did not take yet */
+	pg_atomic_uint64 send_rate;			/* bytes per second */
+	pg_atomic_uint64 recv_rate;			/* bytes per second */
+
+	pg_atomic_uint64 packets_sent;
+	pg_atomic_uint64 bytes_sent;
+	pg_atomic_uint64 writes;			/* packets are coalesced into writes */
+	pg_atomic_uint64 packets_received;
+	pg_atomic_uint64 bytes_received;
+
+	/* the byte counters at the last sample, private to the proxy bgworker */
+	uint64		last_bytes_sent;
+	uint64		last_bytes_received;
+} ICProxyPeerStats;
+
+/* Max number of peers to keep statistics for */
+#define IC_PROXY_MAX_PEER_STATS 1024
+
+extern ICProxyPeerStats *ic_proxy_peer_stats;
+
 extern bool ICProxyStartRule(Datum main_arg);
 extern void ICProxyMain(Datum main_arg);
 extern Size ICProxyShmemSize(void);
@@ -0,0 +1,90 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_stats.h
+ *	  History of the statistics of the recent interconnect connections.
+ *
+ * Copyright (c) 2024-Present VMware, Inc. or its affiliates.
+ *
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef IC_STATS_H
+#define IC_STATS_H
+
+#include "datatype/timestamp.h"
+#include "port/pg_bitutils.h"
+
+/*
+ * The ack times of the UDP interconnect are counted in IC_RTT_HIST_BUCKETS
+ * buckets of doubling width: bucket i counts the acks that came in less than
+ * IC_RTT_HIST_MIN << i microseconds, and the last one all the slower ones.
+ */
+#define IC_RTT_HIST_BUCKETS		(16)
+#define IC_RTT_HIST_MIN			(32)
+
+static inline int
+ic_stats_rtt_bucket(uint64 usec)
+{
+	int			bucket;
+
+	usec /= IC_RTT_HIST_MIN;
+	if (usec == 0)
+		return 0;
+
+	bucket = pg_leftmost_one_pos64(usec) + 1;
+	return Min(bucket, IC_RTT_HIST_BUCKETS - 1);
+}
+
+/* Number of connections kept in the history of each segment */
+#define IC_STATS_HISTORY_SIZE	(2048)
+
+/* Max length of the address of the peer, including the terminating zero */
+#define IC_STATS_ADDR_LEN		(64)
+
+/*
+ * Statistics of one end of an interconnect connection, recorded when the
+ * interconnect of the query is torn down.
+ *
+ * The sender fills in the packets it sent, their ack times, retransmits and
+ * stalls, which are the waits for acks to get a send buffer.  The receiver
+ * fills in the packets it received, the ones out of order, duplicated or
+ * dropped, and the depth of its receive queue.
+ */
+typedef struct ICConnStats
+{
+	int			sessionId;
+	int			commandCount;
+	int			motNodeId;
+	int			localContentId;
+	int			remoteContentId;
+	int			remotePid;
+	bool		isSender;
+	bool		viaShm;			/* went through a same-host ring */
+	TimestampTz endTime;
+	char		remoteAddr[IC_STATS_ADDR_LEN];
+
+	uint64		packets;
+	uint64		minRtt;			/* ack times, in microseconds */
+	uint64		maxRtt;
+	uint64		totalRtt;
+	uint64		rttHist[IC_RTT_HIST_BUCKETS];
+	uint64		retransmits;
+	uint64		stalls;
+	uint64		stallTime;		/* in microseconds */
+
+	uint64		disordered;
+	uint64		duplicated;
+	uint64		dropped;
+	uint64		totalQueueSize;
+	uint64		queueSamples;
+	int			maxQueueSize;
+} ICConnStats;
+
+extern Size ICStatsShmemSize(void);
+extern void ICStatsShmemInit(void);
+
+extern void ic_stats_record(const ICConnStats *stats);
+extern bool ic_stats_read(int slot, ICConnStats *stats);
+
+#endif   /* IC_STATS_H */
@@ -263,6 +263,16 @@ extern void putTransportDirectBuffer(ChunkTransportState *transportStates,
 									 int16 motNodeID,
 									 int16 targetRoute, int serializedLength);
 
+/*
+ * Send the current packet of a connection whose direct buffer has a flushlen,
+ * and return the direct buffer of the next packet.  Returns false if no
+ * receiver of the motion is interested any more.
+ */
+extern bool flushTransportDirectBuffer(ChunkTransportState *transportStates,
+									   int16 motNodeID,
+									   int16 targetRoute,
+									   struct directTransportBuffer *b);
+
 /* doBroadcast() is used to send a TupleChunk to all recipients.
  *
  * PARAMETERS
@@ -305,10 +315,51 @@ extern ChunkTransportStateEntry *removeChunkTransportState(ChunkTransportState *
 														   int16 motNodeID);
 
 extern TupleChunkListItem RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates);
+extern void compressChunkPacket(MotionConn *conn, int hdrSize);
+
+/*
+ * What the receiver of a motion node saw of the interconnect, summed over the
+ * connections from its senders, for EXPLAIN ANALYZE.
+ *
+ * The packet and queue counts are only kept by the UDP interconnect.  The
+ * worst sender is the one with the most packets out of order, duplicated or
+ * dropped; worstAnomalies is 0 if there were none.
+ */
+typedef struct MotionTransportStats
+{
+	int			nconns;
+	uint64		packets;
+	uint64		disordered;
+	uint64		duplicated;
+	uint64		dropped;
+	uint64		totalQueueSize;
+	uint64		queueSamples;
+	int			maxQueueSize;
+
+	int			worstContentId;
+	uint64		worstAnomalies;
+
+	/* packets that came compressed, with their size before and after */
+	uint64		compressPkts;
+	uint64		compressRawBytes;
+	uint64		compressWireBytes;
+} MotionTransportStats;
+
+/*
+ * GetMotionTransportStats
+ *		Interconnect statistics of the receiving motion node.
+ *
+ * Returns false if this process does not receive the motion.
+ */
+extern bool GetMotionTransportStats(ChunkTransportState *transportStates, int16 motNodeID,
+									MotionTransportStats *stats);
 
 extern void InitMotionTCP(int *listenerSocketFd, uint16 *listenerPort);
 extern void InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort);
 extern void markUDPConnInactiveIFC(MotionConn *conn);
+extern void CleanupShmRingsUDPIFC(void);
+extern bool flushShmConnUDPIFC(ChunkTransportState *transportStates,
+							   ChunkTransportStateEntry *pEntry, MotionConn *conn);
 extern void CleanupMotionTCP(void);
 extern void CleanupMotionUDPIFC(void);
 extern void WaitInterconnectQuitUDPIFC(void);
@@ -26,6 +26,7 @@ typedef enum TupleChunkType
 	TC_PARTIAL_END,				/* Contains the final portion of a tuple. */
 	TC_END_OF_STREAM,			/* Indicates "end of tuples" from this source. */
 	TC_EMPTY,					/* Empty tuple */
+	TC_COMPRESSED,				/* The rest of the packet, compressed. */
 	TC_MAXVAL					/* For range checks on type values. */
 } TupleChunkType;
 
@@ -48,6 +49,18 @@ typedef enum TupleChunkType
 
 #define TUPLE_CHUNK_HEADER_SIZE 4
 
+/* A TC_COMPRESSED chunk takes the whole packet and is never passed up to the
+ * motion layer, the interconnect expands it when the packet is received.  Its
+ * data starts with a small header of its own:
+ *
+ *	  Offset	  Description			Size
+ *		0	 Compression Method		  2 bytes
+ *		2	 Uncompressed Size		  2 bytes
+ *
+ * followed by the compressed tuple chunks.
+ */
+#define COMPRESSED_CHUNK_HEADER_SIZE (TUPLE_CHUNK_HEADER_SIZE + 4)
+
 /* see MPP-2099, let's not run into this one again! NOTE: the
  * definition of BROADCAST_SEGIDX is *key*.
  *
@@ -43,6 +43,40 @@ typedef struct SerAttrInfo
 	bool		typbyval;
 }	SerAttrInfo;
 
+/*
+ * Tuples to one route that are waiting to be sent as a batch, kept column by
+ * column.  'nulls' is a bitmap with a bit set for every non-NULL value, like
+ * the one of a heap tuple.  'values' holds the values of a fixed-width column
+ * one after the other, with a zeroed slot for a NULL, or the bytes of the
+ * values of a varlena column, whose ends are in 'offsets'.
+ */
+typedef struct TupleBatchColumn
+{
+	StringInfoData nulls;
+	StringInfoData values;
+	StringInfoData offsets;
+}	TupleBatchColumn;
+
+typedef struct TupleBatch
+{
+	int			ntuples;
+	Size		nbytes;			/* bytes in all the columns so far */
+	TupleBatchColumn *cols;
+}	TupleBatch;
+
+/*
+ * A batch received and not yet returned in full, see CvtBatchToTup().
+ */
+typedef struct TupleBatchReader
+{
+	char	   *buf;			/* the batch, or NULL if there is none */
+	int			ntuples;
+	int			next;			/* next tuple to return */
+	bits8	  **nulls;			/* per column */
+	char	  **values;
+	uint32	  **offsets;		/* NULL for a fixed-width column */
+}	TupleBatchReader;
+
 /* The information for sending and receiving tuples that match a particular
  * description.
  */
@@ -60,6 +94,18 @@ typedef struct SerTupInfo
 
 	/* true if tupdesc contains record types */
 	bool		has_record_types;
+
+	/*
+	 * Number of tuples sent in one batch, or 0 if they are sent one by one.
+	 * The batches being filled are indexed by route, with the broadcast one
+	 * first.
+	 */
+	int			batch_size;
+	int			nbatches;
+	TupleBatch **batches;
+
+	/* Batch that is being received */
+	TupleBatchReader reader;
 }	SerTupInfo;
 
 /*
@@ -84,9 +130,24 @@ extern void SerializeRecordCacheIntoChunks(SerTupInfo *pSerInfo,
 /* Convert a tuple into chunks directly in a set of transport buffers */
 extern int SerializeTuple(TupleTableSlot *tuple, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute);
 
+/* Send tuples in batches of the given size, if the tuple-descriptor allows. */
+extern void InitSerTupBatches(SerTupInfo *pSerInfo, int batch_size);
+
+/* Add a tuple to the batch of a route.  Returns true if the batch is full. */
+extern bool AddTupleToBatch(TupleTableSlot *slot, SerTupInfo *pSerInfo, int16 targetRoute);
+
+/* Convert the batch of a route into chunks, and empty it */
+extern int SerializeTupleBatch(SerTupInfo *pSerInfo, int16 targetRoute, TupleChunkList tcList);
+
+/* Find a route with tuples waiting in its batch.  Returns false if none. */
+extern bool GetPendingBatchRoute(SerTupInfo *pSerInfo, int16 *targetRoute);
+
 /* Convert a sequence of chunks containing serialized tuple data into a
  * MinimalTuple.
  */
 extern MinimalTuple CvtChunksToTup(TupleChunkList tclist, SerTupInfo *pSerInfo, TupleRemapper *remapper);
 
+/* Next tuple of a batch that CvtChunksToTup() started to return */
+extern MinimalTuple CvtBatchToTup(SerTupInfo *pSerInfo);
+
 #endif   /* TUPSER_H */
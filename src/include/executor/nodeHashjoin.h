@@ -33,4 +33,7 @@ extern void ExecHashJoinSaveTuple(PlanState *ps, MinimalTuple tuple, uint32 hash
 								  MemoryContext bfCxt);
 extern void ExecSquelchHashJoin(HashJoinState *node);
 
+extern bool ExecRuntimeFilterPass(List *filters, ExprContext *econtext,
+								  TupleTableSlot *slot);
+
 #endif							/* NODEHASHJOIN_H */
@@ -597,6 +597,11 @@ Oid GetBaseType(Oid typid);
 // and takes ownership of the result
 Expr *EvaluateExpr(Expr *expr, Oid result_type, int32 typmod);
 
+// returns the results of evaluating the expressions in 'exprs' as a list of
+// Consts, sharing one executor state. Caller keeps ownership of 'exprs' and
+// takes ownership of the result
+List *EvaluateExprs(List *exprs);
+
 // extract string value from defelem's value
 char *DefGetString(DefElem *defelem);
 
@@ -615,6 +620,22 @@ FaultInjectorType_e InjectFaultInOptTasks(const char *fault_name);
 // table has been changed?)
 bool MDCacheNeedsReset(void);
 
+// is the metadata cache shared by all backends on the coordinator enabled?
+bool SharedMDCacheEnabled(void);
+
+// start fetching an object to be published in the shared metadata cache
+uint64 SharedMDCacheBeginFetch(void);
+
+// look up a serialized object in the shared metadata cache, and pin it
+const void *SharedMDCacheLookup(const char *key, Size *len);
+
+// release the pin taken by SharedMDCacheLookup
+void SharedMDCacheRelease(void);
+
+// publish a serialized object in the shared metadata cache
+bool SharedMDCacheInsert(const char *key, uint64 version, const void *data,
+						 Size len);
+
 // returns true if a query cancel is requested in GPDB
 bool IsAbortRequested(void);
 
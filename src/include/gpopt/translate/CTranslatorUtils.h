@@ -304,6 +304,9 @@ public:
 	// create a multi-byte character string from a wide character string
 	static CHAR *CreateMultiByteCharStringFromWCString(const WCHAR *wcstr);
 
+	// create a multi-byte character string from a metadata name
+	static CHAR *CreateMultiByteCharStringFromMDName(const CMDName *mdname);
+
 	static UlongToUlongMap *MakeNewToOldColMapping(CMemoryPool *mp,
 												   ULongPtrArray *old_colids,
 												   ULongPtrArray *new_colids);
@@ -93,6 +93,12 @@ public:
 	// caller keeps ownership of 'expr_dxlnode' and takes ownership of the returned pointer
 	CDXLNode *EvaluateExpr(const CDXLNode *expr) override;
 
+	// evaluate the given constant expressions in a single executor context and
+	// return the DXL representation of the results, in the same order.
+	// caller keeps ownership of 'exprs' and takes ownership of the returned array
+	CDXLNodeArray *EvaluateExprs(CMemoryPool *mp,
+								 const CDXLNodeArray *exprs) override;
+
 	// returns true iff the evaluator can evaluate constant expressions without subqueries
 	BOOL
 	FCanEvalExpressions() override
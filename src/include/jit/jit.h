@@ -69,12 +69,16 @@ typedef void (*JitProviderResetAfterErrorCB) (void);
 typedef void (*JitProviderReleaseContextCB) (JitContext *context);
 struct ExprState;
 typedef bool (*JitProviderCompileExprCB) (struct ExprState *state);
+struct MemTupleBinding;
+typedef void *(*JitProviderCompileMemTupleDeformCB) (JitContext **context,
+													 struct MemTupleBinding *pbind);
 
 struct JitProviderCallbacks
 {
 	JitProviderResetAfterErrorCB reset_after_error;
 	JitProviderReleaseContextCB release_context;
 	JitProviderCompileExprCB compile_expr;
+	JitProviderCompileMemTupleDeformCB compile_memtuple_deform;
 };
 
 
@@ -103,6 +107,8 @@ extern void jit_release_context(JitContext *context);
  * not be able to perform JIT (i.e. return false).
  */
 extern bool jit_compile_expr(struct ExprState *state);
+extern void *jit_compile_memtuple_deform(JitContext **context,
+										 struct MemTupleBinding *pbind);
 extern void InstrJitAgg(JitInstrumentation *dst, JitInstrumentation *add);
 
 
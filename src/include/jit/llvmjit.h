@@ -120,6 +120,9 @@ extern bool llvm_compile_expr(struct ExprState *state);
 struct TupleTableSlotOps;
 extern LLVMValueRef slot_compile_deform(struct LLVMJitContext *context, TupleDesc desc,
 										const struct TupleTableSlotOps *ops, int natts);
+struct MemTupleBinding;
+extern void *llvm_compile_memtuple_deform(JitContext **context,
+										  struct MemTupleBinding *pbind);
 
 /*
  ****************************************************************************
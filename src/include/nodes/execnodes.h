@@ -1482,8 +1482,29 @@ typedef struct ScanState
 	Relation	ss_currentRelation;
 	struct TableScanDescData *ss_currentScanDesc;
 	TupleTableSlot *ss_ScanTupleSlot;
+	List	   *ss_RuntimeFilters;	/* RuntimeFilterStates from hash joins */
 } ScanState;
 
+/* ----------------
+ *	 RuntimeFilterState information
+ *
+ *		A Bloom filter of the hash values of the inner tuples of a hash
+ *		join.  It is checked by a scan below the outer side of the join, in
+ *		the same slice, to drop the rows that cannot find a match before
+ *		they go through the nodes in between.  See nodeHashjoin.c.
+ * ----------------
+ */
+typedef struct RuntimeFilterState
+{
+	struct bloom_filter *bloom;
+	bool		active;			/* is the hash table built into 'bloom'? */
+	int			nkeys;
+	AttrNumber *scanattnos;		/* scan tuple attributes of the join keys */
+	FmgrInfo   *hashfunctions;	/* outer hash functions of the join */
+	Oid		   *collations;
+	bool	   *hashStrict;		/* is the join operator strict? */
+} RuntimeFilterState;
+
 /* ----------------
  *	 SeqScanState information
  * ----------------
@@ -2806,6 +2827,8 @@ typedef struct HashState
 	bool		hs_hashkeys_null;	/* found an instance wherein hashkeys are all null */
 	/* hashkeys is same as parent's hj_InnerHashKeys */
 
+	RuntimeFilterState *hs_runtimeFilter;	/* filter to add the hash values to */
+
 	SharedHashInfo *shared_info;	/* one entry per worker * Greenplum: per QE */
 	HashInstrumentation *hinstrument;	/* this worker's entry */
 
@@ -2955,6 +2978,17 @@ typedef struct MotionState
 	List	   *hashExprs;		/* state struct used for evaluating the hash expressions */
 	struct CdbHash *cdbhash;	/* hash api object */
 	int			numHashSegments;	/* number of segments to use when calculating hash */
+	uint32	   *hotKeyHashes;	/* sorted cdbhash values of the hot keys */
+	int			numHotKeyHashes;
+
+	/* For motion send, the tuples a redistribute motion hashes at once */
+	int			hashBatchSize;	/* 0 if tuples are hashed one at a time */
+	int			hashBatchCount;	/* number of tuples in the batch */
+	TupleTableSlot **hashBatchSlots;
+	Datum	   *hashBatchValues;	/* one key column of the batch */
+	bool	   *hashBatchNulls;
+	uint32	   *hashBatchHashes;
+	unsigned int *hashBatchSegs;
 
 	/* For Motion recv */
 	int			routeIdNext;	/* for a sorted motion node, the routeId to get next (same as
@@ -1625,6 +1625,13 @@ typedef struct CdbMotionPath
 	bool		is_explicit_motion;
 
 	GpPolicy   *policy;
+
+	/*
+	 * Hot keys of a hybrid redistribution, see cdbpath_motion_for_join().
+	 * The locus is that of the tuples that are not hot.
+	 */
+	MotionHotKeyPolicy hotKeyPolicy;
+	List	   *hotKeyHashes;
 } CdbMotionPath;
 
 /*
@@ -1487,6 +1487,18 @@ typedef enum MotionType
 	MOTIONTYPE_OUTER_QUERY	/* Gather or Broadcast to outer query's slice, don't know which one yet */
 } MotionType;
 
+/*
+ * What a Hash Motion does with the tuples whose distribution key hashes to
+ * one of its hot keys, the heavy hitters of a skewed join key.  The other
+ * tuples are redistributed as usual.
+ */
+typedef enum MotionHotKeyPolicy
+{
+	MOTION_HOTKEY_NONE,		/* no hot keys, redistribute everything */
+	MOTION_HOTKEY_LOCAL,	/* keep the hot tuples on the sending segment */
+	MOTION_HOTKEY_BROADCAST	/* send the hot tuples to all segments */
+} MotionHotKeyPolicy;
+
 /*
  * Motion Node
  *
@@ -1503,6 +1515,9 @@ typedef struct Motion
 	List		*hashExprs;			/* list of hash expressions */
 	Oid			*hashFuncs;			/* corresponding hash functions */
 	int         numHashSegments;	/* the module number of the hash function */
+	MotionHotKeyPolicy hotKeyPolicy;	/* routing of the hot keys */
+	List	   *hotKeyHashes;		/* integer list of cdbhash values of the
+									 * hot keys, before reduction */
 
 	/* For Explicit */
 	AttrNumber segidColIdx;			/* index of the segid column in the target list */
@@ -16,6 +16,8 @@
 #define DATUMSTREAM_H
 
 #include "catalog/pg_attribute.h"
+#include "cdb/cdbappendonlyblockdirectory.h"
+#include "fmgr.h"
 #include "utils/datumstreamblock.h"
 
 /*
@@ -65,6 +67,26 @@ typedef struct DatumStreamWrite
 
 	DatumStreamBlockWrite blockWrite;
 
+	/*
+	 * Zone map of the current block, recorded in the block directory when
+	 * the block is written. Only maintained if zoneMapCmp, the btree
+	 * comparison function of the type, is set.
+	 */
+	FmgrInfo   *zoneMapCmp;
+	Oid			zoneMapCollation;
+	MinipageZoneMap zoneMap;
+
+	/*
+	 * The block handed to the compression workers, recorded in the block
+	 * directory once it is written out, see datumstreamwrite_complete_pending().
+	 */
+	bool		pendingBlock;
+	AppendOnlyBlockDirectory *pendingBlockDirectory;
+	int			pendingColumnGroupNo;
+	int64		pendingFirstRowNum;
+	int			pendingItemCount;
+	MinipageZoneMap pendingZoneMap;
+
 	/*
 	 * EOFs of current segment file.
 	 */
@@ -243,6 +265,53 @@ datumstreamread_nth(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Advance over the next rows of the current block, up to maxrows of them,
+ * and return their values. The stream is left positioned on the last row
+ * returned. Returns 0 when the block is exhausted.
+ *
+ * If codes is not NULL, the dictionary codes of the rows are returned too
+ * when the block is dictionary encoded; see
+ * datumstreamread_dictionary_generation.
+ */
+inline static int
+datumstreamread_get_batch(DatumStreamRead * acc, Datum *values, bool *nulls,
+						  uint8 *codes, int maxrows)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+	{
+		/*
+		 * Small objects are handled by the DatumStreamBlockRead module.
+		 */
+		return DatumStreamBlockRead_GetBatch(&acc->blockRead, values, nulls,
+											 codes, maxrows);
+	}
+	else
+	{
+		/* A large object block holds a single value. */
+		if (datumstreamread_advancelarge(acc) == 0)
+			return 0;
+
+		datumstreamread_getlarge(acc, values, nulls);
+		return 1;
+	}
+}
+
+/*
+ * Identify the dictionary of the current block, or return 0 if the block is
+ * not dictionary encoded. Equal rows of a block have equal codes, so callers
+ * may cache per code results until the generation changes.
+ */
+inline static uint32
+datumstreamread_dictionary_generation(DatumStreamRead * acc)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None &&
+		acc->blockRead.dictionary_block_was_compressed)
+		return acc->blockRead.dictionary_generation;
+
+	return 0;
+}
+
 /* ------------------------------------------------------------------------------ */
 
 extern int datumstreamwrite_put(
@@ -291,6 +360,7 @@ extern void datumstreamread_open_file(
 						  int version);
 
 extern void datumstreamwrite_close_file(DatumStreamWrite * ds);
+extern void datumstreamwrite_complete_pending(DatumStreamWrite * acc);
 extern void datumstreamread_close_file(DatumStreamRead * ds);
 extern void destroy_datumstreamwrite(DatumStreamWrite * ds);
 extern void destroy_datumstreamread(DatumStreamRead * ds);
@@ -308,6 +378,8 @@ datumstreamwrite_lob(DatumStreamWrite *acc,
 extern int	datumstreamread_block(DatumStreamRead * ds,
 								  AppendOnlyBlockDirectory *blockDirectory,
 								  int colGroupNo);
+extern int	datumstreamread_block_skip(DatumStreamRead * ds, int64 *skipRows);
+extern bool datumstreamread_next_block_info(DatumStreamRead * ds);
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
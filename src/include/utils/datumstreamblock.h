@@ -196,6 +196,31 @@ typedef struct DatumStreamBlock_Delta_Extension
 	 */
 }	DatumStreamBlock_Delta_Extension;
 
+/*
+ * Datum Stream Block extension to DatumStreamBlock_Dense with Dictionary
+ * encoding, after the Rle_Extension and Delta_Extension if any.
+ * 8 bytes more.
+ *
+ * The block writer picks dictionary encoding for a block of variable-length
+ * items with few distinct values. The datum area then holds each distinct
+ * item once, and one code per physical datum, the index of its item in the
+ * datum area, is stored after the other meta-data.
+ */
+typedef struct DatumStreamBlock_Dictionary_Extension
+{
+	int32		dictionary_count;
+	/*
+	 * Number of distinct items in the datum area.
+	 */
+
+	int32		codes_size;
+	/*
+	 * Total size of the codes array, one byte per physical datum.
+	 */
+}	DatumStreamBlock_Dictionary_Extension;
+
+/* Maximum number of items in a dictionary, so that a code fits in a byte */
+#define DATUMSTREAM_DICTIONARY_MAX_COUNT 256
 
 /* Flags */
 enum
@@ -203,6 +228,7 @@ enum
 	DSB_HAS_NULLBITMAP = 0x1,
 	DSB_HAS_RLE_COMPRESSION = 0x2,
 	DSB_HAS_DELTA_COMPRESSION = 0x4,
+	DSB_HAS_DICTIONARY_COMPRESSION = 0x8,
 };
 
 typedef struct DatumStreamBitMapWrite
@@ -1058,6 +1084,9 @@ typedef struct DatumStreamBlockWrite
 	int32		deltas_count;
 	int32		deltas_current_size;
 
+	/* Dictionary variables */
+	bool		dictionary_want_compression;
+
 	/* Common buffers */
 	MemoryContext memctxt;
 
@@ -1083,6 +1112,15 @@ typedef struct DatumStreamBlockWrite
 	bool	   *delta_sign;
 	int32		deltas_maxcount;
 
+	/* Dictionary buffers */
+	uint8	   *dictionary_codes;
+	int32		dictionary_codes_maxcount;
+
+	int32		dictionary_count;
+	int32		dictionary_offsets[DATUMSTREAM_DICTIONARY_MAX_COUNT];
+	int32		dictionary_sizes[DATUMSTREAM_DICTIONARY_MAX_COUNT];
+	int32		dictionary_data_size;
+
 	/* EOF of current file */
 	int64		savings;
 	int64		remember_savings;
@@ -1165,6 +1203,20 @@ typedef struct DatumStreamBlockRead
 	bool		delta_block_was_compressed;
 	DatumStreamBitMapRead delta_bitmap;
 
+	/* Dictionary variables */
+	bool		dictionary_block_was_compressed;
+	uint8	   *dictionary_codesp;
+	int32		dictionary_count;
+	int32		dictionary_codes_size;
+
+	/*
+	 * Items of the dictionary, indexed by code. dictionary_generation is
+	 * bumped each time a dictionary is unpacked, to let callers that cache
+	 * per code information know that the codes changed meaning.
+	 */
+	uint8	  **dictionary_entries;
+	uint32		dictionary_generation;
+
 	/*
 	 * Keep less frequently accessed fields down here for possible better CPU data cache
 	 * performance.
@@ -1925,6 +1977,18 @@ DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 	++dsr->physical_datum_index;
 	//Initially, -1.
 
+	if (dsr->dictionary_block_was_compressed)
+	{
+		/*
+		 * The physical datum is a code, pointing to its item in the datum
+		 * area.
+		 */
+		Assert(dsr->physical_datum_index < dsr->dictionary_codes_size);
+		dsr->datump =
+			dsr->dictionary_entries[dsr->dictionary_codesp[dsr->physical_datum_index]];
+		return 1;
+	}
+
 		if (dsr->physical_datum_index == 0)
 	{
 		/* Pre-positioned by block read to first item. */
@@ -2146,6 +2210,12 @@ extern void DatumStreamBlockRead_Init(
 						  void *errcontextArg);
 extern void DatumStreamBlockRead_Finish(
 							DatumStreamBlockRead * dsr);
+extern int DatumStreamBlockRead_GetBatch(
+							 DatumStreamBlockRead * dsr,
+							 Datum *values,
+							 bool *nulls,
+							 uint8 *codes,
+							 int maxrows);
 
 extern void DatumStreamBlockWrite_Init(
 						   DatumStreamBlockWrite * dsw,
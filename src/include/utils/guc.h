@@ -288,6 +288,8 @@ extern bool gp_local_distributed_cache_stats;
 extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
 extern bool gp_appendonly_compaction;
+extern bool gp_enable_aocs_late_materialization;
+extern bool gp_enable_aocs_dictionary_encoding;
 
 /*
  * Threshold of the ratio of dirty data in a segment file
@@ -298,6 +300,7 @@ extern bool gp_appendonly_compaction;
  * 10% of the tuples are hidden.
  */
 extern int  gp_appendonly_compaction_threshold;
+extern int  gp_appendonly_read_ahead;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	debug_xlog_record_read;
 extern bool Debug_cancel_print;
@@ -452,6 +455,7 @@ extern int optimizer_minidump;
 extern int  optimizer_cost_model;
 extern bool optimizer_metadata_caching;
 extern int	optimizer_mdcache_size;
+extern int	optimizer_shared_mdcache_size;
 
 /* Optimizer debugging GUCs */
 extern bool optimizer_print_query;
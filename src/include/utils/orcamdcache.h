@@ -0,0 +1,32 @@
+/*-------------------------------------------------------------------------
+ *
+ * orcamdcache.h
+ *	  Coordinator-wide shared memory cache of serialized ORCA metadata
+ *	  objects.
+ *
+ * Portions Copyright (c) 2023-Present VMware, Inc. or its affiliates.
+ *
+ * IDENTIFICATION
+ *		src/include/utils/orcamdcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef ORCAMDCACHE_H
+#define ORCAMDCACHE_H
+
+/* maximum length of a cache key, i.e. the string form of an ORCA mdid */
+#define ORCA_MDCACHE_KEYLEN		128
+
+extern Size OrcaMDCacheShmemSize(void);
+extern void OrcaMDCacheShmemInit(void);
+
+extern bool OrcaMDCacheEnabled(void);
+extern uint64 OrcaMDCacheBeginFetch(void);
+extern void OrcaMDCacheInvalidate(void);
+
+extern const void *OrcaMDCacheLookup(const char *key, Size *len);
+extern void OrcaMDCacheRelease(void);
+extern bool OrcaMDCacheInsert(const char *key, uint64 version,
+							  const void *data, Size len);
+
+#endif   /* ORCAMDCACHE_H */
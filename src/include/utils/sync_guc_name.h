@@ -38,17 +38,23 @@
 		"gp_allow_date_field_width_5digits",
 		"gp_appendonly_compaction",
 		"gp_appendonly_compaction_threshold",
+		"gp_appendonly_compress_workers",
+		"gp_appendonly_read_ahead",
 		"gp_appendonly_verify_block_checksums",
 		"gp_appendonly_verify_write_block",
 		"gp_blockdirectory_entry_min_range",
+		"gp_blockdirectory_minipage_cache_size",
 		"gp_blockdirectory_minipage_size",
 		"gp_cpu_decompress_cost",
 		"gp_debug_linger",
 		"gp_default_storage_options",
 		"gp_detect_data_correctness",
 		"gp_disable_tuple_hints",
+		"gp_enable_aocs_dictionary_encoding",
+		"gp_enable_aocs_late_materialization",
 		"gp_enable_blkdir_sampling",
 		"gp_enable_interconnect_aggressive_retry",
+		"gp_enable_runtime_filter",
 		"gp_enable_segment_copy_checking",
 		"gp_external_enable_filter_pushdown",
 		"gp_hashjoin_tuples_per_bucket",
@@ -56,12 +62,15 @@
 		"gp_indexcheck_insert",
 		"gp_initial_bad_row_limit",
 		"gp_interconnect_address_type",
+		"gp_interconnect_batch_size",
 		"gp_interconnect_cache_future_packets",
+		"gp_interconnect_compression",
 		"gp_interconnect_cursor_ic_table_size",
 		"gp_interconnect_debug_retry_interval",
 		"gp_interconnect_default_rtt",
 		"gp_interconnect_fc_method",
 		"gp_interconnect_full_crc",
+		"gp_interconnect_local_shm",
 		"gp_interconnect_log_stats",
 		"gp_interconnect_min_retries_before_timeout",
 		"gp_interconnect_min_rto",
@@ -73,6 +82,7 @@
 		"gp_interconnect_timer_checking_period",
 		"gp_interconnect_timer_period",
 		"gp_interconnect_transmit_timeout",
+		"gp_interconnect_tuple_batch_size",
 		"gp_interconnect_type",
 		"gp_log_endpoints",
 		"gp_log_interconnect",
@@ -82,6 +92,7 @@
 		"gp_log_suboverflow_statement",
 		"gp_max_alloc_size",
 		"gp_max_packet_size",
+		"gp_motion_hash_batch_size",
 		"gp_motion_slice_noop",
 		"gp_quicklz_fallback",
 		"gp_resgroup_debug_wait_queue",
@@ -165,6 +165,7 @@
 		"gp_enable_groupext_distinct_gather",
 		"gp_enable_groupext_distinct_pruning",
 		"gp_enable_hashjoin_size_heuristic",
+		"gp_enable_hybrid_redistribute",
 		"gp_enable_minmax_optimization",
 		"gp_enable_motion_deadlock_sanity",
 		"gp_enable_multiphase_agg",
@@ -191,6 +192,7 @@
 		"gp_global_deadlock_detector_period",
 		"gp_gxid_prefetch_num",
 		"gp_heap_require_relhasoids_match",
+		"gp_hybrid_redistribute_skew_ratio",
 		"gp_instrument_shmem_size",
 		"gp_is_writer",
 		"gp_local_distributed_cache_stats",
@@ -445,6 +447,7 @@
 		"optimizer_samples_number",
 		"optimizer_search_strategy_path",
 		"optimizer_segments",
+		"optimizer_shared_mdcache_size",
 		"optimizer_skew_factor",
 		"optimizer_sort_factor",
 		"optimizer_trace_fallback",
@@ -0,0 +1,74 @@
+-- Test that the shared memory rings of the UDP interconnect, see
+-- gp_interconnect_local_shm, do not outlive the queries that use them when a
+-- query is cancelled in the middle of a stream, and that the rings left
+-- behind by a crashed segment are removed when it restarts.
+
+CREATE TABLE ic_shm_cleanup (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO ic_shm_cleanup SELECT i, i FROM generate_series(1, 100000) i;
+
+-- Number of rings created by the backends of this segment
+CREATE OR REPLACE FUNCTION ic_shm_rings() RETURNS bigint AS $$ SELECT count(*) FROM pg_ls_dir('/dev/shm') f WHERE f LIKE 'gpic.' || current_setting('gp_dbid') || '.%' $$ LANGUAGE sql;
+
+-- Wait for the rings of the whole cluster to go away
+CREATE OR REPLACE FUNCTION ic_shm_rings_left() RETURNS bigint AS $$
+declare
+	n bigint; /* in func */
+begin
+	for i in 1..600 loop
+		SELECT ic_shm_rings() + (SELECT sum(ic_shm_rings()) FROM gp_dist_random('gp_id')) INTO n; /* in func */
+		if n = 0 then
+			return n; /* in func */
+		end if; /* in func */
+		perform pg_sleep(0.1); /* in func */
+	end loop; /* in func */
+	return n; /* in func */
+end; /* in func */
+$$ LANGUAGE plpgsql;
+
+1: SET gp_interconnect_local_shm = on;
+1: SELECT count(*) FROM ic_shm_cleanup t1 JOIN ic_shm_cleanup t2 ON t1.a = t2.b;
+
+-- Stop a scan of segment 0 in the middle of the stream, and cancel the query
+SELECT gp_inject_fault('before_exec_scan', 'suspend', '', '', '', 1000, 1000, 0, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+1&: SELECT count(*) FROM ic_shm_cleanup t1 JOIN ic_shm_cleanup t2 ON t1.a = t2.b;
+SELECT gp_wait_until_triggered_fault('before_exec_scan', 1, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+SELECT pg_cancel_backend(pid) FROM pg_stat_activity WHERE query LIKE 'SELECT count(*) FROM ic_shm_cleanup%';
+SELECT gp_inject_fault('before_exec_scan', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+1<:
+
+SELECT ic_shm_rings_left();
+1: SELECT count(*) FROM ic_shm_cleanup t1 JOIN ic_shm_cleanup t2 ON t1.a = t2.b;
+
+-- Same with the rings only between the processes of a segment
+1: SET gp_interconnect_local_shm = loopback;
+SELECT gp_inject_fault('before_exec_scan', 'suspend', '', '', '', 1000, 1000, 0, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+1&: SELECT count(*) FROM ic_shm_cleanup t1 JOIN ic_shm_cleanup t2 ON t1.a = t2.b;
+SELECT gp_wait_until_triggered_fault('before_exec_scan', 1, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+SELECT pg_cancel_backend(pid) FROM pg_stat_activity WHERE query LIKE 'SELECT count(*) FROM ic_shm_cleanup%';
+SELECT gp_inject_fault('before_exec_scan', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+1<:
+
+SELECT ic_shm_rings_left();
+1: SELECT count(*) FROM ic_shm_cleanup t1 JOIN ic_shm_cleanup t2 ON t1.a = t2.b;
+
+-- Leave a ring behind on segment 0, as a backend killed before its sender
+-- attached to the ring would, and crash the segment in the middle of a stream
+0U: DO $$ BEGIN EXECUTE format('COPY (SELECT 1) TO %L', '/dev/shm/gpic.' || current_setting('gp_dbid') || '.0.0.0.0.0'); END $$;
+0U: SELECT ic_shm_rings();
+0Uq:
+
+SELECT gp_inject_fault('before_exec_scan', 'panic', '', '', '', 1000, 1000, 0, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+-- start_ignore
+1: SELECT count(*) FROM ic_shm_cleanup t1 JOIN ic_shm_cleanup t2 ON t1.a = t2.b;
+-- end_ignore
+1q:
+
+-- The segment removed the rings when it restarted
+1: SELECT count(*) FROM ic_shm_cleanup t1 JOIN ic_shm_cleanup t2 ON t1.a = t2.b;
+1: SELECT gp_inject_fault('before_exec_scan', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+1q:
+SELECT ic_shm_rings_left();
+
+DROP FUNCTION ic_shm_rings_left();
+DROP FUNCTION ic_shm_rings();
+DROP TABLE ic_shm_cleanup;
@@ -0,0 +1,26 @@
+-- Test the traffic statistics of the ic-proxy of each segment to each of its
+-- peers, in gp_toolkit.gp_interconnect_proxy_peers, and that the packets to
+-- a peer are coalesced into fewer writes.
+
+CREATE TABLE ic_proxy_peer_stats (a int, b text) DISTRIBUTED BY (a);
+INSERT INTO ic_proxy_peer_stats SELECT i, repeat(md5(i::text), 8) FROM generate_series(1, 100000) i;
+-- Will ensure that all peer setup is done.
+SELECT count(*) FROM ic_proxy_peer_stats;
+
+SELECT * FROM gp_toolkit.gp_interconnect_proxy_peers LIMIT 0;
+
+-- The proxies have talked to each other, and know the hosts of their peers
+SELECT count(*) > 0 AS peers, bool_and(segindex <> peer_segindex) AS others, bool_and(hostname IS NOT NULL AND peer_hostname IS NOT NULL) AS hosts, bool_and(queued_packets >= 0 AND queued_bytes >= 0 AND send_bps >= 0 AND recv_bps >= 0) AS sampled, bool_and(writes <= packets_sent) AS writes FROM gp_toolkit.gp_interconnect_proxy_peers;
+
+-- The counters of all the proxies, summed up
+CREATE FUNCTION ic_proxy_peer_totals(OUT packets_sent numeric, OUT bytes_sent numeric, OUT writes numeric, OUT packets_received numeric, OUT bytes_received numeric) AS $$ SELECT sum(packets_sent), sum(bytes_sent), sum(writes), sum(packets_received), sum(bytes_received) FROM gp_toolkit.gp_interconnect_proxy_peers $$ LANGUAGE sql;
+CREATE TEMP TABLE ic_proxy_peer_totals_before AS SELECT * FROM ic_proxy_peer_totals();
+
+-- Move most of the table to other segments
+CREATE TABLE ic_proxy_peer_stats_b AS SELECT * FROM ic_proxy_peer_stats DISTRIBUTED BY (b);
+
+-- The counters moved, and some writes carried more than one packet
+SELECT a.packets_sent > b.packets_sent AS packets_sent, a.bytes_sent > b.bytes_sent + 1000000 AS bytes_sent, a.packets_received > b.packets_received AS packets_received, a.bytes_received > b.bytes_received + 1000000 AS bytes_received, a.writes > b.writes AS writes, a.packets_sent - b.packets_sent > a.writes - b.writes AS coalesced FROM ic_proxy_peer_totals() a, ic_proxy_peer_totals_before b;
+
+DROP TABLE ic_proxy_peer_stats, ic_proxy_peer_stats_b;
+DROP FUNCTION ic_proxy_peer_totals();
@@ -0,0 +1,71 @@
+-- Test that the ORCA metadata cache shared by the sessions on the coordinator
+-- does not serve the metadata of objects that another session has changed.
+
+!\retcode gpconfig -c optimizer_shared_mdcache_size -v 1024 --skipvalidation;
+!\retcode gpstop -ari;
+
+1: set optimizer = on;
+1: create table shared_mdcache_t (a int, b int) distributed by (a);
+1: insert into shared_mdcache_t values (1, 1);
+-- this puts the table in the shared cache
+1: select * from shared_mdcache_t;
+
+-- A session that never ran ORCA changes the table.
+2: set optimizer = off;
+2: alter table shared_mdcache_t add column c int default 42;
+
+-- A new session starts with an empty private cache, and must not find the old
+-- definition of the table in the shared cache.
+3: set optimizer = on;
+3: select * from shared_mdcache_t;
+1: select * from shared_mdcache_t;
+
+-- A transaction sees its own changes, but does not publish them to other
+-- sessions, not even after it is rolled back.
+2: begin;
+2: alter table shared_mdcache_t add column d int default 7;
+2: set optimizer = on;
+2: select * from shared_mdcache_t;
+2: abort;
+4: set optimizer = on;
+4: select * from shared_mdcache_t;
+
+-- Same once the change is committed.
+2: alter table shared_mdcache_t drop column b;
+5: set optimizer = on;
+5: select * from shared_mdcache_t;
+4: select * from shared_mdcache_t;
+
+-- The cache is shared by all databases, but the databases created from the
+-- same template share the OIDs of the objects copied from it.  A change to
+-- such an object in one database must not show in the other.
+1: create database shared_mdcache_tmpl;
+6:@db_name shared_mdcache_tmpl: create table shared_mdcache_t (a int, b int) distributed by (a);
+6: insert into shared_mdcache_t values (1, 1);
+6q:
+1: create database shared_mdcache_db1 template shared_mdcache_tmpl;
+1: create database shared_mdcache_db2 template shared_mdcache_tmpl;
+7:@db_name shared_mdcache_db1: set optimizer = on;
+7: alter table shared_mdcache_t add column c int default 42;
+-- this puts db1's definition of the table in the shared cache
+7: select * from shared_mdcache_t;
+8:@db_name shared_mdcache_db2: set optimizer = on;
+8: select * from shared_mdcache_t;
+9:@db_name shared_mdcache_db1: set optimizer = on;
+9: select * from shared_mdcache_t;
+7q:
+8q:
+9q:
+1: drop database shared_mdcache_db1;
+1: drop database shared_mdcache_db2;
+1: drop database shared_mdcache_tmpl;
+
+1: drop table shared_mdcache_t;
+1q:
+2q:
+3q:
+4q:
+5q:
+
+!\retcode gpconfig -r optimizer_shared_mdcache_size --skipvalidation;
+!\retcode gpstop -ari;
@@ -0,0 +1,7 @@
+CREATE EXTENSION test_cdbhash;
+
+--
+-- All the logic is in the test_cdbhash() function. It will throw
+-- an error if something fails.
+--
+SELECT test_cdbhash();
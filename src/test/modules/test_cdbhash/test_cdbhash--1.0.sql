@@ -0,0 +1,8 @@
+/* src/test/modules/test_cdbhash/test_cdbhash--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_cdbhash" to load this file. \quit
+
+CREATE FUNCTION test_cdbhash()
+RETURNS pg_catalog.void STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
@@ -0,0 +1,302 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_cdbhash.c
+ *		Test distribution key hashing.
+ *
+ * Portions Copyright (c) 2024-Present VMware, Inc. or its affiliates.
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_cdbhash/test_cdbhash.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/pg_collation.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbhash.h"
+#include "fmgr.h"
+#include "portability/instr_time.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/uuid.h"
+
+/*
+ * If you enable this, the tests will print how long it takes to hash the
+ * test values through the function manager, with cdbhash() and with the
+ * batch interface.  That can be used as micro-benchmark of the hashing of
+ * the different types (you might want to increase NUM_VALUES, if you do
+ * that, to reduce noise).
+ *
+ * The information is printed to the server's stderr.
+ */
+static const bool cdbhash_test_stats = false;
+
+/* Number of values hashed for each type, and the batch size */
+#define NUM_VALUES		100000
+#define BATCH_SIZE		1024
+
+/* Every NULL_INTERVAL'th value is a NULL */
+#define NULL_INTERVAL	7
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_cdbhash);
+
+/*
+ * A distribution key type, with its default hash function.
+ */
+typedef struct
+{
+	char	   *test_name;		/* type name, for humans */
+	Oid			typid;
+	Oid			hashfunc;
+} test_spec;
+
+static const test_spec test_specs[] = {
+	{"int2", INT2OID, F_HASHINT2},
+	{"int4", INT4OID, F_HASHINT4},
+	{"int8", INT8OID, F_HASHINT8},
+	{"date", DATEOID, F_HASHINT4},
+	{"timestamp", TIMESTAMPOID, F_TIMESTAMP_HASH},
+	{"uuid", UUIDOID, F_UUID_HASH},
+	{"numeric", NUMERICOID, F_HASH_NUMERIC},
+};
+
+/* A simple xorshift generator, so that the test values are the same each run */
+static uint64
+next_random(uint64 *state)
+{
+	uint64		x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+/*
+ * Fill the arrays with NUM_VALUES test values of the type.
+ */
+static void
+make_values(const test_spec *spec, Datum *values, bool *nulls)
+{
+	uint64		state = 0x9e3779b97f4a7c15;
+
+	for (int i = 0; i < NUM_VALUES; i++)
+	{
+		uint64		r = next_random(&state);
+
+		nulls[i] = (i % NULL_INTERVAL) == 0;
+
+		switch (spec->typid)
+		{
+			case INT2OID:
+				values[i] = Int16GetDatum((int16) r);
+				break;
+			case INT4OID:
+			case DATEOID:
+				values[i] = Int32GetDatum((int32) r);
+				break;
+			case INT8OID:
+			case TIMESTAMPOID:
+				values[i] = Int64GetDatum((int64) r);
+				break;
+			case UUIDOID:
+				{
+					pg_uuid_t  *uuid = palloc(sizeof(pg_uuid_t));
+
+					memcpy(uuid->data, &r, sizeof(r));
+					r = next_random(&state);
+					memcpy(uuid->data + sizeof(r), &r, sizeof(r));
+					values[i] = UUIDPGetDatum(uuid);
+					break;
+				}
+			case NUMERICOID:
+				values[i] = DirectFunctionCall1(int8_numeric, Int64GetDatum((int64) r));
+				break;
+			default:
+				elog(ERROR, "unexpected type %u", spec->typid);
+		}
+	}
+}
+
+static void
+test_type(const test_spec *spec, int numsegs)
+{
+	Datum	   *values;
+	bool	   *nulls;
+	uint32	   *expected;
+	uint32	   *hashes;
+	unsigned int *segs;
+	unsigned int *batchsegs;
+	CdbHash    *h;
+	Oid			hashfunc = spec->hashfunc;
+	instr_time	starttime;
+	instr_time	endtime;
+
+	elog(NOTICE, "testing cdbhash with type %s on %d segments", spec->test_name, numsegs);
+
+	values = palloc(NUM_VALUES * sizeof(Datum));
+	nulls = palloc(NUM_VALUES * sizeof(bool));
+	expected = palloc(NUM_VALUES * sizeof(uint32));
+	hashes = palloc(NUM_VALUES * sizeof(uint32));
+	segs = palloc(NUM_VALUES * sizeof(unsigned int));
+	batchsegs = palloc(NUM_VALUES * sizeof(unsigned int));
+
+	make_values(spec, values, nulls);
+
+	h = makeCdbHash(numsegs, 1, &hashfunc);
+
+	/*
+	 * The hash of a single column key is the hash of the value, or 0 for a
+	 * NULL.  Compute that through the function manager first.
+	 */
+	INSTR_TIME_SET_CURRENT(starttime);
+	for (int i = 0; i < NUM_VALUES; i++)
+	{
+		if (nulls[i])
+			expected[i] = 0;
+		else
+			expected[i] = DatumGetUInt32(OidFunctionCall1Coll(hashfunc,
+															  DEFAULT_COLLATION_OID,
+															  values[i]));
+	}
+	INSTR_TIME_SET_CURRENT(endtime);
+	INSTR_TIME_SUBTRACT(endtime, starttime);
+
+	if (cdbhash_test_stats)
+		fprintf(stderr, "%s: function manager %.3f ms\n",
+				spec->test_name, INSTR_TIME_GET_MILLISEC(endtime));
+
+	/* cdbhash(), one value at a time */
+	INSTR_TIME_SET_CURRENT(starttime);
+	for (int i = 0; i < NUM_VALUES; i++)
+	{
+		cdbhashinit(h);
+		cdbhash(h, 1, values[i], nulls[i]);
+		hashes[i] = h->hash;
+		segs[i] = cdbhashreduce(h);
+	}
+	INSTR_TIME_SET_CURRENT(endtime);
+	INSTR_TIME_SUBTRACT(endtime, starttime);
+
+	if (cdbhash_test_stats)
+		fprintf(stderr, "%s: cdbhash %.3f ms\n",
+				spec->test_name, INSTR_TIME_GET_MILLISEC(endtime));
+
+	for (int i = 0; i < NUM_VALUES; i++)
+	{
+		if (hashes[i] != expected[i])
+			elog(ERROR, "cdbhash of %s value %d is %u, expected %u",
+				 spec->test_name, i, hashes[i], expected[i]);
+		if (segs[i] >= numsegs)
+			elog(ERROR, "cdbhashreduce of %s value %d is segment %u of %d",
+				 spec->test_name, i, segs[i], numsegs);
+	}
+
+	/* and the batch interface, which must agree on the segments too */
+	INSTR_TIME_SET_CURRENT(starttime);
+	for (int i = 0; i < NUM_VALUES; i += BATCH_SIZE)
+	{
+		int			n = Min(BATCH_SIZE, NUM_VALUES - i);
+
+		cdbhashbatchinit(h, hashes + i, n);
+		cdbhashbatch(h, 1, values + i, nulls + i, hashes + i, n);
+		cdbhashreducebatch(h, hashes + i, batchsegs + i, n);
+	}
+	INSTR_TIME_SET_CURRENT(endtime);
+	INSTR_TIME_SUBTRACT(endtime, starttime);
+
+	if (cdbhash_test_stats)
+		fprintf(stderr, "%s: cdbhashbatch %.3f ms\n",
+				spec->test_name, INSTR_TIME_GET_MILLISEC(endtime));
+
+	for (int i = 0; i < NUM_VALUES; i++)
+	{
+		cdbhashinit(h);
+		cdbhash(h, 1, values[i], nulls[i]);
+		if (hashes[i] != h->hash)
+			elog(ERROR, "cdbhashbatch of %s value %d is %u, expected %u",
+				 spec->test_name, i, hashes[i], h->hash);
+		if (batchsegs[i] != segs[i])
+			elog(ERROR, "cdbhashreducebatch of %s value %d is segment %u, expected %u",
+				 spec->test_name, i, batchsegs[i], segs[i]);
+	}
+
+	freeCdbHash(h);
+	pfree(values);
+	pfree(nulls);
+	pfree(expected);
+	pfree(hashes);
+	pfree(segs);
+	pfree(batchsegs);
+}
+
+/*
+ * A key of several columns, hashed a batch at a time, must give the same
+ * hashes as cdbhash() does tuple by tuple.
+ */
+static void
+test_multi_column(int numsegs)
+{
+	const test_spec *specs[] = {&test_specs[2], &test_specs[5], &test_specs[6]};
+	int			natts = lengthof(specs);
+	Oid			hashfuncs[lengthof(specs)];
+	Datum	   *values[lengthof(specs)];
+	bool	   *nulls[lengthof(specs)];
+	uint32	   *hashes;
+	unsigned int *segs;
+	CdbHash    *h;
+
+	elog(NOTICE, "testing cdbhash with a key of %d columns on %d segments", natts, numsegs);
+
+	for (int j = 0; j < natts; j++)
+	{
+		hashfuncs[j] = specs[j]->hashfunc;
+		values[j] = palloc(NUM_VALUES * sizeof(Datum));
+		nulls[j] = palloc(NUM_VALUES * sizeof(bool));
+		make_values(specs[j], values[j], nulls[j]);
+	}
+	hashes = palloc(NUM_VALUES * sizeof(uint32));
+	segs = palloc(NUM_VALUES * sizeof(unsigned int));
+
+	h = makeCdbHash(numsegs, natts, hashfuncs);
+
+	cdbhashbatchinit(h, hashes, NUM_VALUES);
+	for (int j = 0; j < natts; j++)
+		cdbhashbatch(h, j + 1, values[j], nulls[j], hashes, NUM_VALUES);
+	cdbhashreducebatch(h, hashes, segs, NUM_VALUES);
+
+	for (int i = 0; i < NUM_VALUES; i++)
+	{
+		unsigned int seg;
+
+		cdbhashinit(h);
+		for (int j = 0; j < natts; j++)
+			cdbhash(h, j + 1, values[j][i], nulls[j][i]);
+		seg = cdbhashreduce(h);
+
+		if (hashes[i] != h->hash || segs[i] != seg)
+			elog(ERROR, "cdbhashbatch of tuple %d is %u on segment %u, expected %u on segment %u",
+				 i, hashes[i], segs[i], h->hash, seg);
+	}
+
+	freeCdbHash(h);
+}
+
+/*
+ * SQL-callable entry point to perform all tests.
+ */
+Datum
+test_cdbhash(PG_FUNCTION_ARGS)
+{
+	for (int i = 0; i < lengthof(test_specs); i++)
+		test_type(&test_specs[i], 3);
+
+	test_multi_column(3);
+	test_multi_column(8);
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,279 @@
+--
+-- Test compressing the blocks of AO tables in background threads on insert,
+-- with gp_appendonly_compress_workers > 0.  The tables must come out the
+-- same, block for block, as when the inserting backend compresses the blocks
+-- itself, and so must their block directories.  The blocks handed to the
+-- workers are counted with the appendonly_compress_async fault.
+--
+CREATE SCHEMA ao_compress_workers;
+SET search_path = ao_compress_workers;
+
+-- The block directory entries of a table, on all segments.
+CREATE FUNCTION blkdir(rel regclass)
+RETURNS TABLE (segment int, segno int, columngroup_no int, entry_no int,
+               first_row_no bigint, file_offset bigint, row_count bigint)
+AS $$
+  SELECT gp_segment_id, segno, columngroup_no, entry_no,
+         first_row_no, file_offset, row_count
+  FROM (SELECT gp_segment_id, (gp_toolkit.__gp_aoblkdir(rel)).*
+        FROM gp_dist_random('gp_id')) e
+$$ LANGUAGE sql;
+
+CREATE FUNCTION same_blkdir(rel1 regclass, rel2 regclass) RETURNS bool
+AS $$
+  SELECT NOT EXISTS (SELECT * FROM blkdir(rel1) EXCEPT ALL SELECT * FROM blkdir(rel2))
+     AND NOT EXISTS (SELECT * FROM blkdir(rel2) EXCEPT ALL SELECT * FROM blkdir(rel1))
+$$ LANGUAGE sql;
+
+-- Entries that overlap the rows or the blocks of the one before.
+CREATE FUNCTION bad_blkdir_entries(rel regclass) RETURNS bigint
+AS $$
+  SELECT count(*) FROM (
+    SELECT first_row_no, file_offset, row_count,
+           lag(first_row_no + row_count) OVER w AS next_row_no,
+           lag(file_offset) OVER w AS prev_file_offset
+    FROM blkdir(rel)
+    WINDOW w AS (PARTITION BY segment, segno, columngroup_no ORDER BY first_row_no)) e
+  WHERE row_count <= 0 OR first_row_no < next_row_no OR file_offset <= prev_file_offset
+$$ LANGUAGE sql;
+
+CREATE FUNCTION segfiles_size(rel regclass) RETURNS bigint
+AS $$
+  SELECT sum(pg_relation_size(rel)) FROM gp_dist_random('gp_id')
+$$ LANGUAGE sql;
+
+-- Blocks handed to the compression workers on content 1 since the last call,
+-- which starts counting the ones of the given table
+CREATE FUNCTION async_blocks(rel text) RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('appendonly_compress_async', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('appendonly_compress_async', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('appendonly_compress_async', 'skip', '', '', rel, 1, -1, 0, dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+-- A block directory is kept for the tables, because of the indexes.  Every
+-- 5000th row is larger than a block, and so written as large content,
+-- after the block in flight.
+CREATE TABLE ao_zlib_sync (a int, b text, c int)
+  WITH (appendonly=true, compresstype=zlib, compresslevel=1, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON ao_zlib_sync (a);
+CREATE TABLE ao_zlib_async (a int, b text, c int)
+  WITH (appendonly=true, compresstype=zlib, compresslevel=1, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON ao_zlib_async (a);
+CREATE TABLE ao_zstd_sync (a int, b text, c int)
+  WITH (appendonly=true, compresstype=zstd, compresslevel=3, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON ao_zstd_sync (a);
+CREATE TABLE ao_zstd_async (a int, b text, c int)
+  WITH (appendonly=true, compresstype=zstd, compresslevel=3, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON ao_zstd_async (a);
+CREATE TABLE co_zlib_sync (a int, b text, c int)
+  WITH (appendonly=true, orientation=column, compresstype=zlib, compresslevel=1, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON co_zlib_sync (a);
+CREATE TABLE co_zlib_async (a int, b text, c int)
+  WITH (appendonly=true, orientation=column, compresstype=zlib, compresslevel=1, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON co_zlib_async (a);
+CREATE TABLE co_zstd_sync (a int, b text, c int)
+  WITH (appendonly=true, orientation=column, compresstype=zstd, compresslevel=3, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON co_zstd_sync (a);
+CREATE TABLE co_zstd_async (a int, b text, c int)
+  WITH (appendonly=true, orientation=column, compresstype=zstd, compresslevel=3, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON co_zstd_async (a);
+
+-- The AO column table with a column that isn't compressed by the workers.
+CREATE TABLE co_mixed_sync (a int, b text ENCODING (compresstype=zstd), c int ENCODING (compresstype=rle_type))
+  WITH (appendonly=true, orientation=column, compresstype=zlib, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON co_mixed_sync (a);
+CREATE TABLE co_mixed_async (a int, b text ENCODING (compresstype=zstd), c int ENCODING (compresstype=rle_type))
+  WITH (appendonly=true, orientation=column, compresstype=zlib, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON co_mixed_async (a);
+
+SELECT gp_inject_fault('appendonly_compress_async', 'skip', '', '', 'ao_zlib_sync', 1, -1, 0, dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+SET gp_appendonly_compress_workers = 0;
+INSERT INTO ao_zlib_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('ao_zstd_sync') AS async;
+INSERT INTO ao_zstd_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('co_zlib_sync') AS async;
+INSERT INTO co_zlib_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('co_zstd_sync') AS async;
+INSERT INTO co_zstd_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('co_mixed_sync') AS async;
+INSERT INTO co_mixed_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('ao_zlib_async') AS async;
+SET gp_appendonly_compress_workers = 4;
+INSERT INTO ao_zlib_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('ao_zstd_async') > 0 AS async;
+INSERT INTO ao_zstd_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('co_zlib_async') > 0 AS async;
+INSERT INTO co_zlib_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('co_zstd_async') > 0 AS async;
+INSERT INTO co_zstd_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('co_mixed_async') > 0 AS async;
+INSERT INTO co_mixed_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(1, 100000) i;
+SELECT async_blocks('') > 0 AS async;
+SELECT gp_inject_fault('appendonly_compress_async', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zlib_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zlib_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zlib_async) AS same_data;
+SELECT segfiles_size('ao_zlib_sync') = segfiles_size('ao_zlib_async') AS same_size,
+       same_blkdir('ao_zlib_sync', 'ao_zlib_async');
+SELECT (SELECT count(*) FROM blkdir('ao_zlib_async')) > 0 AS has_entries,
+       bad_blkdir_entries('ao_zlib_async');
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zstd_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zstd_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zstd_async) AS same_data;
+SELECT segfiles_size('ao_zstd_sync') = segfiles_size('ao_zstd_async') AS same_size,
+       same_blkdir('ao_zstd_sync', 'ao_zstd_async');
+SELECT (SELECT count(*) FROM blkdir('ao_zstd_async')) > 0 AS has_entries,
+       bad_blkdir_entries('ao_zstd_async');
+SELECT count(*), sum(length(b)), sum(c) FROM co_zlib_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zlib_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zlib_async) AS same_data;
+SELECT segfiles_size('co_zlib_sync') = segfiles_size('co_zlib_async') AS same_size,
+       same_blkdir('co_zlib_sync', 'co_zlib_async');
+SELECT (SELECT count(*) FROM blkdir('co_zlib_async')) > 0 AS has_entries,
+       bad_blkdir_entries('co_zlib_async');
+SELECT count(*), sum(length(b)), sum(c) FROM co_zstd_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zstd_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zstd_async) AS same_data;
+SELECT segfiles_size('co_zstd_sync') = segfiles_size('co_zstd_async') AS same_size,
+       same_blkdir('co_zstd_sync', 'co_zstd_async');
+SELECT (SELECT count(*) FROM blkdir('co_zstd_async')) > 0 AS has_entries,
+       bad_blkdir_entries('co_zstd_async');
+SELECT count(*), sum(length(b)), sum(c) FROM co_mixed_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_mixed_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_mixed_async) AS same_data;
+SELECT segfiles_size('co_mixed_sync') = segfiles_size('co_mixed_async') AS same_size,
+       same_blkdir('co_mixed_sync', 'co_mixed_async');
+SELECT (SELECT count(*) FROM blkdir('co_mixed_async')) > 0 AS has_entries,
+       bad_blkdir_entries('co_mixed_async');
+
+-- Look rows up through the indexes, and so the block directories.
+SET enable_seqscan = off;
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zlib_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800;
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zstd_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800;
+SELECT count(*), sum(length(b)), sum(c) FROM co_zlib_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800;
+SELECT count(*), sum(length(b)), sum(c) FROM co_zstd_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800;
+SELECT count(*), sum(length(b)), sum(c) FROM co_mixed_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800;
+RESET enable_seqscan;
+
+-- Aborted inserts, one after it finished and one halfway through.  The
+-- blocks of the aborted inserts still in flight are discarded, and the next
+-- insert goes on as usual.
+BEGIN;
+INSERT INTO ao_zlib_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+ABORT;
+INSERT INTO ao_zlib_async SELECT i, repeat(md5(i::text), i % 20), i % 1000 + 0 / (i - 105000)
+  FROM generate_series(100001, 110000) i;
+INSERT INTO ao_zlib_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+BEGIN;
+INSERT INTO ao_zstd_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+ABORT;
+INSERT INTO ao_zstd_async SELECT i, repeat(md5(i::text), i % 20), i % 1000 + 0 / (i - 105000)
+  FROM generate_series(100001, 110000) i;
+INSERT INTO ao_zstd_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+BEGIN;
+INSERT INTO co_zlib_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+ABORT;
+INSERT INTO co_zlib_async SELECT i, repeat(md5(i::text), i % 20), i % 1000 + 0 / (i - 105000)
+  FROM generate_series(100001, 110000) i;
+INSERT INTO co_zlib_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+BEGIN;
+INSERT INTO co_zstd_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+ABORT;
+INSERT INTO co_zstd_async SELECT i, repeat(md5(i::text), i % 20), i % 1000 + 0 / (i - 105000)
+  FROM generate_series(100001, 110000) i;
+INSERT INTO co_zstd_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+BEGIN;
+INSERT INTO co_mixed_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+ABORT;
+INSERT INTO co_mixed_async SELECT i, repeat(md5(i::text), i % 20), i % 1000 + 0 / (i - 105000)
+  FROM generate_series(100001, 110000) i;
+INSERT INTO co_mixed_async SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+SET gp_appendonly_compress_workers = 0;
+INSERT INTO ao_zlib_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+INSERT INTO ao_zstd_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+INSERT INTO co_zlib_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+INSERT INTO co_zstd_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+INSERT INTO co_mixed_sync SELECT i, repeat(md5(i::text), CASE WHEN i % 5000 = 0 THEN 2000 ELSE i % 20 END), i % 1000
+  FROM generate_series(100001, 110000) i;
+
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zlib_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zlib_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zlib_async) AS same_data;
+SELECT (SELECT count(*) FROM blkdir('ao_zlib_async')) > 0 AS has_entries,
+       bad_blkdir_entries('ao_zlib_async');
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zstd_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zstd_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM ao_zstd_async) AS same_data;
+SELECT (SELECT count(*) FROM blkdir('ao_zstd_async')) > 0 AS has_entries,
+       bad_blkdir_entries('ao_zstd_async');
+SELECT count(*), sum(length(b)), sum(c) FROM co_zlib_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zlib_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zlib_async) AS same_data;
+SELECT (SELECT count(*) FROM blkdir('co_zlib_async')) > 0 AS has_entries,
+       bad_blkdir_entries('co_zlib_async');
+SELECT count(*), sum(length(b)), sum(c) FROM co_zstd_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zstd_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_zstd_async) AS same_data;
+SELECT (SELECT count(*) FROM blkdir('co_zstd_async')) > 0 AS has_entries,
+       bad_blkdir_entries('co_zstd_async');
+SELECT count(*), sum(length(b)), sum(c) FROM co_mixed_async;
+SELECT (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_mixed_sync) =
+       (SELECT md5(string_agg(a || ':' || md5(b) || ':' || c, ',' ORDER BY a)) FROM co_mixed_async) AS same_data;
+SELECT (SELECT count(*) FROM blkdir('co_mixed_async')) > 0 AS has_entries,
+       bad_blkdir_entries('co_mixed_async');
+
+SET enable_seqscan = off;
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zlib_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800 OR a BETWEEN 104990 AND 105010;
+SELECT count(*), sum(length(b)), sum(c) FROM ao_zstd_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800 OR a BETWEEN 104990 AND 105010;
+SELECT count(*), sum(length(b)), sum(c) FROM co_zlib_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800 OR a BETWEEN 104990 AND 105010;
+SELECT count(*), sum(length(b)), sum(c) FROM co_zstd_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800 OR a BETWEEN 104990 AND 105010;
+SELECT count(*), sum(length(b)), sum(c) FROM co_mixed_async
+  WHERE a BETWEEN 4990 AND 5010 OR a BETWEEN 77770 AND 77800 OR a BETWEEN 104990 AND 105010;
+RESET enable_seqscan;
+
+RESET gp_appendonly_compress_workers;
+DROP SCHEMA ao_compress_workers CASCADE;
@@ -0,0 +1,70 @@
+--
+-- Test the JIT compiled deforming of the memtuples of AO row tables.  With
+-- jit_above_cost = 0, every sequential scan of an AO row table deforms its
+-- tuples with a compiled function, if the server was built with LLVM.  The
+-- results must be the same as with jit off.
+--
+CREATE SCHEMA ao_jit_deform;
+SET search_path = ao_jit_deform;
+
+-- more than 8 columns, for a null bitmap of more than a byte, short and long
+-- varlenas, and compressed and toasted ones
+CREATE TABLE ao_jit (c1 int, c2 int2, c3 int8, c4 float8, c5 bool, c6 text, c7 numeric(10,2), c8 int,
+  c9 text, c10 int8, c11 bool, c12 text) WITH (appendonly = true) DISTRIBUTED BY (c1);
+INSERT INTO ao_jit SELECT c1,
+  CASE WHEN c1 % 7 = 0 THEN NULL ELSE c1 % 100 END,
+  CASE WHEN c1 % 9 = 0 THEN NULL ELSE c1 * 100000 END,
+  c1 * 0.5,
+  CASE WHEN c1 % 5 = 0 THEN NULL ELSE c1 % 2 = 0 END,
+  CASE WHEN c1 % 11 = 0 THEN NULL ELSE repeat('x', c1 % 20) END,
+  c1 * 0.01,
+  CASE WHEN c1 % 3 = 0 THEN c1 END,
+  CASE WHEN c1 % 13 = 0 THEN NULL ELSE repeat(md5(c1::text), 4) END,
+  -c1,
+  CASE WHEN c1 % 4 = 0 THEN NULL ELSE c1 % 3 = 0 END,
+  CASE WHEN c1 % 500 = 0 THEN repeat('toast', 4000) ELSE 's' || c1 END
+  FROM generate_series(1, 5000) c1;
+UPDATE ao_jit SET c12 = (SELECT string_agg(md5(c1::text || j), '' ORDER BY j) FROM generate_series(1, 625) j) WHERE c1 % 777 = 0;
+-- memtuples of more than 64kB use the large layout
+CREATE TABLE ao_jit_large (a int, b text, c int, d text, e int8) WITH (appendonly = true, blocksize = 2097152) DISTRIBUTED BY (a);
+INSERT INTO ao_jit_large SELECT a, repeat(md5(a::text), 2500),
+  CASE WHEN a % 3 = 0 THEN NULL ELSE a * 7 END,
+  CASE WHEN a % 5 = 0 THEN NULL ELSE repeat('d', a % 10) END,
+  CASE WHEN a % 4 = 0 THEN NULL ELSE a * 1000000007 END
+  FROM generate_series(1, 50) a;
+
+SET jit = off;
+SELECT count(*), md5(string_agg(concat_ws('|', coalesce(c1::text, '-'), coalesce(c2::text, '-'), coalesce(c3::text, '-'), coalesce(c4::text, '-'), coalesce(c5::text, '-'), coalesce(c6::text, '-'), coalesce(c7::text, '-'), coalesce(c8::text, '-'), coalesce(c9::text, '-'), coalesce(c10::text, '-'), coalesce(c11::text, '-'), coalesce(md5(c12), '-')), ',' ORDER BY c1)) FROM ao_jit;
+SELECT count(*), sum(c3), sum(c10), count(c11) FROM ao_jit WHERE c5;
+SELECT count(*), md5(string_agg(concat_ws('|', a, md5(b), coalesce(c::text, '-'), coalesce(d, '-'), coalesce(e::text, '-')), ',' ORDER BY a)) FROM ao_jit_large;
+SET jit = on;
+SET jit_above_cost = 0;
+SELECT count(*), md5(string_agg(concat_ws('|', coalesce(c1::text, '-'), coalesce(c2::text, '-'), coalesce(c3::text, '-'), coalesce(c4::text, '-'), coalesce(c5::text, '-'), coalesce(c6::text, '-'), coalesce(c7::text, '-'), coalesce(c8::text, '-'), coalesce(c9::text, '-'), coalesce(c10::text, '-'), coalesce(c11::text, '-'), coalesce(md5(c12), '-')), ',' ORDER BY c1)) FROM ao_jit;
+SELECT count(*), sum(c3), sum(c10), count(c11) FROM ao_jit WHERE c5;
+SELECT count(*), md5(string_agg(concat_ws('|', a, md5(b), coalesce(c::text, '-'), coalesce(d, '-'), coalesce(e::text, '-')), ',' ORDER BY a)) FROM ao_jit_large;
+
+-- a dropped column stays in the memtuples
+ALTER TABLE ao_jit DROP COLUMN c8;
+SET jit = off;
+SELECT count(*), md5(string_agg(concat_ws('|', coalesce(c1::text, '-'), coalesce(c2::text, '-'), coalesce(c3::text, '-'), coalesce(c4::text, '-'), coalesce(c5::text, '-'), coalesce(c6::text, '-'), coalesce(c7::text, '-'), coalesce(c9::text, '-'), coalesce(c10::text, '-'), coalesce(c11::text, '-'), coalesce(md5(c12), '-')), ',' ORDER BY c1)) FROM ao_jit;
+SELECT count(*), sum(c3), sum(c10), count(c11) FROM ao_jit WHERE c5;
+SET jit = on;
+SELECT count(*), md5(string_agg(concat_ws('|', coalesce(c1::text, '-'), coalesce(c2::text, '-'), coalesce(c3::text, '-'), coalesce(c4::text, '-'), coalesce(c5::text, '-'), coalesce(c6::text, '-'), coalesce(c7::text, '-'), coalesce(c9::text, '-'), coalesce(c10::text, '-'), coalesce(c11::text, '-'), coalesce(md5(c12), '-')), ',' ORDER BY c1)) FROM ao_jit;
+SELECT count(*), sum(c3), sum(c10), count(c11) FROM ao_jit WHERE c5;
+
+-- the rows inserted before a column was added miss it, they are not deformed
+-- by the compiled function
+ALTER TABLE ao_jit ADD COLUMN c13 int DEFAULT 42;
+INSERT INTO ao_jit SELECT c1, c1 % 100, c1 * 100000, c1 * 0.5, c1 % 2 = 0, repeat('x', c1 % 20), c1 * 0.01,
+  repeat(md5(c1::text), 4), -c1, c1 % 3 = 0, 's' || c1, c1
+  FROM generate_series(5001, 5100) c1;
+SET jit = off;
+SELECT count(*), md5(string_agg(concat_ws('|', coalesce(c1::text, '-'), coalesce(c2::text, '-'), coalesce(c3::text, '-'), coalesce(c4::text, '-'), coalesce(c5::text, '-'), coalesce(c6::text, '-'), coalesce(c7::text, '-'), coalesce(c9::text, '-'), coalesce(c10::text, '-'), coalesce(c11::text, '-'), coalesce(md5(c12), '-'), coalesce(c13::text, '-')), ',' ORDER BY c1)) FROM ao_jit;
+SELECT count(*), sum(c3), sum(c10), count(c11) FROM ao_jit WHERE c5;
+SET jit = on;
+SELECT count(*), md5(string_agg(concat_ws('|', coalesce(c1::text, '-'), coalesce(c2::text, '-'), coalesce(c3::text, '-'), coalesce(c4::text, '-'), coalesce(c5::text, '-'), coalesce(c6::text, '-'), coalesce(c7::text, '-'), coalesce(c9::text, '-'), coalesce(c10::text, '-'), coalesce(c11::text, '-'), coalesce(md5(c12), '-'), coalesce(c13::text, '-')), ',' ORDER BY c1)) FROM ao_jit;
+SELECT count(*), sum(c3), sum(c10), count(c11) FROM ao_jit WHERE c5;
+
+RESET jit_above_cost;
+RESET jit;
+DROP SCHEMA ao_jit_deform CASCADE;
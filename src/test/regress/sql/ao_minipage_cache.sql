@@ -0,0 +1,96 @@
+--
+-- Test the cache of block directory minipages of AO index scans
+-- (gp_blockdirectory_minipage_cache_size).  The index scans below go back and
+-- forth between segment files and minipages, and come back to the ones read
+-- before.  The results must be the same with the cache disabled, with a
+-- cache of a single minipage, which is evicted all the time, and with the
+-- default cache.  The cache hits are counted with the ao_minipage_cache_hit
+-- fault.
+--
+CREATE SCHEMA ao_minipage_cache;
+SET search_path = ao_minipage_cache;
+
+-- Minipage cache hits on content 1 since the last call
+CREATE FUNCTION mc_cache_hits() RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('ao_minipage_cache_hit', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('ao_minipage_cache_hit', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('ao_minipage_cache_hit', 'skip', '', '', '', 1, -1, 0, dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Small blocks and minipages of 4 entries, so that there are many minipages.
+SET gp_blockdirectory_minipage_size = 4;
+CREATE TABLE mc_ao (a int, b text, c int) WITH (appendonly=true, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON mc_ao (a);
+INSERT INTO mc_ao SELECT a, repeat(md5(a::text), a % 30), a % 1000 FROM generate_series(1, 60000) a;
+CREATE TABLE mc_co (a int, b text, c int) WITH (appendonly=true, orientation=column, blocksize=8192) DISTRIBUTED BY (a);
+CREATE INDEX ON mc_co (a);
+INSERT INTO mc_co SELECT a, repeat(md5(a::text), a % 30), a % 1000 FROM generate_series(1, 60000) a;
+
+-- Spread the rows over two segment files.
+DELETE FROM mc_ao WHERE a % 4 = 0;
+VACUUM mc_ao;
+INSERT INTO mc_ao SELECT a, repeat(md5(a::text), a % 30), a % 1000 FROM generate_series(60001, 90000) a;
+DELETE FROM mc_co WHERE a % 4 = 0;
+VACUUM mc_co;
+INSERT INTO mc_co SELECT a, repeat(md5(a::text), a % 30), a % 1000 FROM generate_series(60001, 90000) a;
+RESET gp_blockdirectory_minipage_size;
+
+-- Look up 200 keys scattered over the tables, twice, through nested loop
+-- index scans and index-only scans.
+CREATE VIEW mc_keys AS
+  SELECT ((j % 200) * 7919) % 90000 + 1 AS k FROM generate_series(0, 399) j;
+
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SET gp_blockdirectory_minipage_cache_size = 0;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT count(*), sum(t.a) FROM mc_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_keys v JOIN mc_co t ON t.a = v.k;
+SELECT count(*), sum(t.a) FROM mc_keys v JOIN mc_co t ON t.a = v.k;
+
+SET gp_blockdirectory_minipage_cache_size = 1;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT count(*), sum(t.a) FROM mc_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_keys v JOIN mc_co t ON t.a = v.k;
+SELECT count(*), sum(t.a) FROM mc_keys v JOIN mc_co t ON t.a = v.k;
+
+RESET gp_blockdirectory_minipage_cache_size;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT count(*), sum(t.a) FROM mc_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_keys v JOIN mc_co t ON t.a = v.k;
+SELECT count(*), sum(t.a) FROM mc_keys v JOIN mc_co t ON t.a = v.k;
+
+-- Look up 20 of the keys, 20 times each.  Their minipages stay in the default
+-- cache, so most of the lookups are hits.
+CREATE VIEW mc_few_keys AS
+  SELECT ((j % 20) * 7919) % 90000 + 1 AS k FROM generate_series(0, 399) j;
+SELECT gp_inject_fault('ao_minipage_cache_hit', 'skip', '', '', '', 1, -1, 0, dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+SET gp_blockdirectory_minipage_cache_size = 0;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_few_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT mc_cache_hits() AS hits;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_few_keys v JOIN mc_co t ON t.a = v.k;
+SELECT mc_cache_hits() AS hits;
+RESET gp_blockdirectory_minipage_cache_size;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_few_keys v JOIN mc_ao t ON t.a = v.k;
+SELECT mc_cache_hits() > 20 AS hits;
+SELECT count(*), sum(length(t.b)), sum(t.c) FROM mc_few_keys v JOIN mc_co t ON t.a = v.k;
+SELECT mc_cache_hits() > 20 AS hits;
+SELECT gp_inject_fault('ao_minipage_cache_hit', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+DROP SCHEMA ao_minipage_cache CASCADE;
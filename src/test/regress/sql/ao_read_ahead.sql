@@ -0,0 +1,171 @@
+--
+-- Test reading AO segment files with and without prefetching the large reads
+-- ahead of the current one (gp_appendonly_read_ahead).  Sequential scans read
+-- the files through, across segment files; index and bitmap scans seek back
+-- and forth, and read the ranges of blocks of block directory entries.  The
+-- results must be the same with any read-ahead.  The prefetch requests are
+-- counted with the ao_read_ahead_prefetch fault.
+--
+CREATE SCHEMA ao_read_ahead;
+SET search_path = ao_read_ahead;
+
+-- Prefetches issued on content 1 since the last call
+CREATE FUNCTION ra_prefetches() RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('ao_read_ahead_prefetch', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('ao_read_ahead_prefetch', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('ao_read_ahead_prefetch', 'skip', '', '', '', 1, -1, 0, dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Small blocks, so that the files span many large reads.  Every 7919th row is
+-- larger than a block, and so split over several large reads.
+CREATE TABLE ra_ao (a int, b text, c int) WITH (appendonly=true, blocksize=32768) DISTRIBUTED BY (a);
+CREATE INDEX ON ra_ao (a);
+INSERT INTO ra_ao SELECT a, repeat(md5(a::text), CASE WHEN a % 7919 = 0 THEN 6000 ELSE a % 50 END), a % 1000
+  FROM generate_series(1, 100000) a;
+CREATE TABLE ra_ao_zlib (a int, b text, c int) WITH (appendonly=true, compresstype=zlib, compresslevel=1, blocksize=32768) DISTRIBUTED BY (a);
+CREATE INDEX ON ra_ao_zlib (a);
+INSERT INTO ra_ao_zlib SELECT a, repeat(md5(a::text), CASE WHEN a % 7919 = 0 THEN 6000 ELSE a % 50 END), a % 1000
+  FROM generate_series(1, 100000) a;
+CREATE TABLE ra_co (a int, b text, c int) WITH (appendonly=true, orientation=column, blocksize=32768) DISTRIBUTED BY (a);
+CREATE INDEX ON ra_co (a);
+INSERT INTO ra_co SELECT a, repeat(md5(a::text), CASE WHEN a % 7919 = 0 THEN 6000 ELSE a % 50 END), a % 1000
+  FROM generate_series(1, 100000) a;
+
+-- Move the rest of the rows to another segment file, and add more rows to
+-- another one.
+DELETE FROM ra_ao WHERE a % 3 = 0;
+VACUUM ra_ao;
+INSERT INTO ra_ao SELECT a, repeat(md5(a::text), CASE WHEN a % 7919 = 0 THEN 6000 ELSE a % 50 END), a % 1000
+  FROM generate_series(100001, 150000) a;
+DELETE FROM ra_ao_zlib WHERE a % 3 = 0;
+VACUUM ra_ao_zlib;
+INSERT INTO ra_ao_zlib SELECT a, repeat(md5(a::text), CASE WHEN a % 7919 = 0 THEN 6000 ELSE a % 50 END), a % 1000
+  FROM generate_series(100001, 150000) a;
+DELETE FROM ra_co WHERE a % 3 = 0;
+VACUUM ra_co;
+INSERT INTO ra_co SELECT a, repeat(md5(a::text), CASE WHEN a % 7919 = 0 THEN 6000 ELSE a % 50 END), a % 1000
+  FROM generate_series(100001, 150000) a;
+
+SELECT gp_inject_fault('ao_read_ahead_prefetch', 'skip', '', '', '', 1, -1, 0, dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+SET gp_appendonly_read_ahead = 0;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_ao t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_ao_zlib t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_co t ON t.a = v.k;
+RESET enable_bitmapscan;
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+SET enable_indexscan = off;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao_zlib
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_co
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+RESET enable_indexscan;
+RESET enable_seqscan;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_ao;
+SELECT ra_prefetches() AS prefetches;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao_zlib;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_ao_zlib;
+SELECT ra_prefetches() AS prefetches;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_co;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_co;
+SELECT ra_prefetches() AS prefetches;
+
+RESET gp_appendonly_read_ahead;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_ao t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_ao_zlib t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_co t ON t.a = v.k;
+RESET enable_bitmapscan;
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+SET enable_indexscan = off;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao_zlib
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_co
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+RESET enable_indexscan;
+RESET enable_seqscan;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_ao;
+SELECT ra_prefetches() > 0 AS prefetched;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao_zlib;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_ao_zlib;
+SELECT ra_prefetches() > 0 AS prefetched;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_co;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_co;
+SELECT ra_prefetches() > 0 AS prefetched;
+
+SET gp_appendonly_read_ahead = 64;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_ao t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_ao_zlib t ON t.a = v.k;
+SELECT count(*), sum(length(t.b)), sum(t.c)
+  FROM (VALUES (149999), (3), (75001), (7919), (120000), (2), (99999), (15838), (100001), (50000), (1), (140000), (118785), (47514), (4)) v(k)
+  JOIN ra_co t ON t.a = v.k;
+RESET enable_bitmapscan;
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+SET enable_indexscan = off;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao_zlib
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_co
+  WHERE a BETWEEN 7900 AND 7930 OR a BETWEEN 99990 AND 100010 OR a BETWEEN 149990 AND 150000 OR a BETWEEN 55000 AND 55100;
+RESET enable_indexscan;
+RESET enable_seqscan;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_ao;
+SELECT ra_prefetches() > 0 AS prefetched;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_ao_zlib;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_ao_zlib;
+SELECT ra_prefetches() > 0 AS prefetched;
+SELECT count(*), sum(length(b)), sum(c) FROM ra_co;
+SELECT md5(string_agg(md5(b), ',' ORDER BY a)) FROM ra_co;
+SELECT ra_prefetches() > 0 AS prefetched;
+
+SELECT gp_inject_fault('ao_read_ahead_prefetch', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+RESET gp_appendonly_read_ahead;
+DROP SCHEMA ao_read_ahead CASCADE;
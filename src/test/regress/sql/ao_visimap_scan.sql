@@ -0,0 +1,105 @@
+--
+-- Test the visibility checks of sequential scans of AO tables, which load
+-- the visimap of a segment file at once, against index and bitmap scans,
+-- which look up the visimap entries one by one.  A visimap entry covers
+-- 32768 rows; the deletes below leave entries with few hidden rows, with
+-- most rows hidden, and with all rows hidden.  The loads are counted with
+-- the ao_visimap_segment_loaded fault.
+--
+CREATE SCHEMA ao_visimap_scan;
+SET search_path = ao_visimap_scan;
+
+-- Segment files whose visimap was loaded on content 1 since the last call,
+-- which starts counting the ones of the given table
+CREATE FUNCTION vm_segments_loaded(rel text) RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('ao_visimap_segment_loaded', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('ao_visimap_segment_loaded', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('ao_visimap_segment_loaded', 'skip', '', '', rel, 1, -1, 0, dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TABLE vm_ao (a int, b text, c int) WITH (appendonly=true) DISTRIBUTED BY (a);
+CREATE INDEX ON vm_ao (a);
+INSERT INTO vm_ao SELECT a, 'row ' || a, a % 1000 FROM generate_series(1, 400000) a;
+-- sparse
+DELETE FROM vm_ao WHERE a <= 100000 AND a % 1000 = 0;
+UPDATE vm_ao SET c = -c WHERE a <= 100000 AND a % 777 = 0;
+-- full entries
+DELETE FROM vm_ao WHERE a BETWEEN 100001 AND 300000;
+-- dense
+DELETE FROM vm_ao WHERE a > 300000 AND a % 4 <> 0;
+
+CREATE TABLE vm_co (a int, b text, c int) WITH (appendonly=true, orientation=column) DISTRIBUTED BY (a);
+CREATE INDEX ON vm_co (a);
+INSERT INTO vm_co SELECT a, 'row ' || a, a % 1000 FROM generate_series(1, 400000) a;
+-- sparse
+DELETE FROM vm_co WHERE a <= 100000 AND a % 1000 = 0;
+UPDATE vm_co SET c = -c WHERE a <= 100000 AND a % 777 = 0;
+-- full entries
+DELETE FROM vm_co WHERE a BETWEEN 100001 AND 300000;
+-- dense
+DELETE FROM vm_co WHERE a > 300000 AND a % 4 <> 0;
+
+SELECT gp_inject_fault('ao_visimap_segment_loaded', 'skip', '', '', 'vm_ao', 1, -1, 0, dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+-- Sequential scans, with the visimap loaded
+SET enable_indexscan = off;
+SET enable_indexonlyscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 1 AND 400000;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 90000 AND 310000;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 299990 AND 300100;
+SELECT a / 100000 AS r, count(*) FROM vm_ao WHERE a BETWEEN 1 AND 400000 GROUP BY 1 ORDER BY 1;
+SELECT count(b) FROM vm_ao;
+SELECT vm_segments_loaded('vm_co') > 0 AS loaded;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 1 AND 400000;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 90000 AND 310000;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 299990 AND 300100;
+SELECT a / 100000 AS r, count(*) FROM vm_co WHERE a BETWEEN 1 AND 400000 GROUP BY 1 ORDER BY 1;
+SELECT count(b) FROM vm_co;
+SELECT vm_segments_loaded('vm_ao') > 0 AS loaded;
+RESET enable_indexscan;
+RESET enable_indexonlyscan;
+RESET enable_bitmapscan;
+
+-- Bitmap scans, with the per-entry lookups
+SET enable_seqscan = off;
+SET enable_indexscan = off;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 1 AND 400000;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 90000 AND 310000;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 299990 AND 300100;
+SELECT a / 100000 AS r, count(*) FROM vm_ao WHERE a BETWEEN 1 AND 400000 GROUP BY 1 ORDER BY 1;
+SELECT vm_segments_loaded('vm_co') AS loaded;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 1 AND 400000;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 90000 AND 310000;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 299990 AND 300100;
+SELECT a / 100000 AS r, count(*) FROM vm_co WHERE a BETWEEN 1 AND 400000 GROUP BY 1 ORDER BY 1;
+SELECT vm_segments_loaded('vm_ao') AS loaded;
+RESET enable_indexscan;
+
+-- Index scans, with the per-entry lookups
+SET enable_bitmapscan = off;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 1 AND 400000;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 90000 AND 310000;
+SELECT count(*), sum(a), sum(c) FROM vm_ao WHERE a BETWEEN 299990 AND 300100;
+SELECT a / 100000 AS r, count(*) FROM vm_ao WHERE a BETWEEN 1 AND 400000 GROUP BY 1 ORDER BY 1;
+SELECT vm_segments_loaded('vm_co') AS loaded;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 1 AND 400000;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 90000 AND 310000;
+SELECT count(*), sum(a), sum(c) FROM vm_co WHERE a BETWEEN 299990 AND 300100;
+SELECT a / 100000 AS r, count(*) FROM vm_co WHERE a BETWEEN 1 AND 400000 GROUP BY 1 ORDER BY 1;
+SELECT vm_segments_loaded('vm_ao') AS loaded;
+RESET enable_bitmapscan;
+RESET enable_seqscan;
+
+SELECT gp_inject_fault('ao_visimap_segment_loaded', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+DROP SCHEMA ao_visimap_scan CASCADE;
@@ -0,0 +1,63 @@
+--
+-- Test the dictionary encoding of the blocks of RLE_TYPE compressed
+-- columns of AOCS tables, see gp_enable_aocs_dictionary_encoding, and the
+-- scan filters evaluated once per dictionary entry.  The same rows are
+-- written with and without dictionaries, and every query must give the same
+-- results on both tables, with and without the scan filters.
+--
+CREATE SCHEMA aocs_dictionary_encoding;
+SET search_path = aocs_dictionary_encoding;
+
+SET gp_enable_aocs_dictionary_encoding = on;
+CREATE TABLE aocs_dict (a int, c text ENCODING (compresstype = rle_type, compresslevel = 1)) USING ao_column DISTRIBUTED BY (a);
+-- few distinct values, NULLs
+INSERT INTO aocs_dict SELECT i, CASE WHEN i % 13 = 0 THEN NULL ELSE 'value ' || (i % 10) END FROM generate_series(1, 20000) i;
+-- runs of repeated values
+INSERT INTO aocs_dict SELECT i, 'run ' || ((i / 100) % 5) FROM generate_series(20001, 22000) i;
+-- too many distinct values for a dictionary
+INSERT INTO aocs_dict SELECT i, 'distinct ' || i FROM generate_series(22001, 24000) i;
+
+SET gp_enable_aocs_dictionary_encoding = off;
+CREATE TABLE aocs_nodict (a int, c text ENCODING (compresstype = rle_type, compresslevel = 1)) USING ao_column DISTRIBUTED BY (a);
+INSERT INTO aocs_nodict SELECT i, CASE WHEN i % 13 = 0 THEN NULL ELSE 'value ' || (i % 10) END FROM generate_series(1, 20000) i;
+INSERT INTO aocs_nodict SELECT i, 'run ' || ((i / 100) % 5) FROM generate_series(20001, 22000) i;
+INSERT INTO aocs_nodict SELECT i, 'distinct ' || i FROM generate_series(22001, 24000) i;
+RESET gp_enable_aocs_dictionary_encoding;
+
+-- each value of the dictionary encoded blocks is stored once
+SELECT pg_relation_size('aocs_dict') < pg_relation_size('aocs_nodict') * 0.75 AS smaller;
+
+SET gp_enable_aocs_late_materialization = on;
+SELECT count(*), sum(a) FROM aocs_dict WHERE c = 'value 3';
+SELECT count(*), sum(a) FROM aocs_dict WHERE 'run 2' = c;
+SELECT count(*), sum(a) FROM aocs_dict WHERE c IN ('value 1', 'value 4', 'run 0', 'nothing');
+SELECT count(*), sum(a) FROM aocs_dict WHERE c = ANY ('{value 5, NULL}');
+SELECT count(*), sum(a) FROM aocs_dict WHERE c <> 'value 2';
+SELECT count(*), sum(a) FROM aocs_dict WHERE c IN ('value 7', 'distinct 23456');
+SELECT count(*), sum(a) FROM aocs_dict WHERE c IS NULL;
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c = 'value 3';
+SELECT count(*), sum(a) FROM aocs_nodict WHERE 'run 2' = c;
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c IN ('value 1', 'value 4', 'run 0', 'nothing');
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c = ANY ('{value 5, NULL}');
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c <> 'value 2';
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c IN ('value 7', 'distinct 23456');
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c IS NULL;
+SET gp_enable_aocs_late_materialization = off;
+SELECT count(*), sum(a) FROM aocs_dict WHERE c = 'value 3';
+SELECT count(*), sum(a) FROM aocs_dict WHERE 'run 2' = c;
+SELECT count(*), sum(a) FROM aocs_dict WHERE c IN ('value 1', 'value 4', 'run 0', 'nothing');
+SELECT count(*), sum(a) FROM aocs_dict WHERE c = ANY ('{value 5, NULL}');
+SELECT count(*), sum(a) FROM aocs_dict WHERE c <> 'value 2';
+SELECT count(*), sum(a) FROM aocs_dict WHERE c IN ('value 7', 'distinct 23456');
+SELECT count(*), sum(a) FROM aocs_dict WHERE c IS NULL;
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c = 'value 3';
+SELECT count(*), sum(a) FROM aocs_nodict WHERE 'run 2' = c;
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c IN ('value 1', 'value 4', 'run 0', 'nothing');
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c = ANY ('{value 5, NULL}');
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c <> 'value 2';
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c IN ('value 7', 'distinct 23456');
+SELECT count(*), sum(a) FROM aocs_nodict WHERE c IS NULL;
+RESET gp_enable_aocs_late_materialization;
+
+DROP TABLE aocs_dict, aocs_nodict;
+DROP SCHEMA aocs_dictionary_encoding;
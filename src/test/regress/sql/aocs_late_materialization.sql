@@ -0,0 +1,95 @@
+--
+-- Test the scan filters of AOCS sequential scans, see
+-- gp_enable_aocs_late_materialization.  Each query is run with the filters
+-- and without them, and must give the same results.
+--
+CREATE SCHEMA aocs_late_materialization;
+SET search_path = aocs_late_materialization;
+CREATE TABLE aocs_lm (a int, b int, c text, d int) USING ao_column WITH (blocksize = 8192) DISTRIBUTED BY (a);
+INSERT INTO aocs_lm SELECT i, i % 10, 'v' || (i % 7), CASE WHEN i % 5 = 0 THEN NULL ELSE i END FROM generate_series(1, 10000) i;
+
+SET gp_enable_aocs_late_materialization = on;
+-- column op constant
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b = 3;
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b < 2;
+SELECT count(*), sum(a), count(d) FROM aocs_lm WHERE c = 'v3';
+-- constant op column
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE 3 = b;
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE 9000 < d;
+-- column op ANY (array)
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b IN (1, 2, 12);
+SELECT count(*), sum(a), count(d) FROM aocs_lm WHERE c IN ('v1', 'v2');
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b = ANY ('{4, NULL}');
+-- NULLs of the filter column never pass
+SELECT count(*), sum(b) FROM aocs_lm WHERE d > 100 AND c = 'v3';
+SELECT count(*), count(d) FROM aocs_lm WHERE b = 5;
+SELECT count(*), sum(a) FROM aocs_lm WHERE d <> 7 OR d IS NULL;
+SET gp_enable_aocs_late_materialization = off;
+-- column op constant
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b = 3;
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b < 2;
+SELECT count(*), sum(a), count(d) FROM aocs_lm WHERE c = 'v3';
+-- constant op column
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE 3 = b;
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE 9000 < d;
+-- column op ANY (array)
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b IN (1, 2, 12);
+SELECT count(*), sum(a), count(d) FROM aocs_lm WHERE c IN ('v1', 'v2');
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b = ANY ('{4, NULL}');
+-- NULLs of the filter column never pass
+SELECT count(*), sum(b) FROM aocs_lm WHERE d > 100 AND c = 'v3';
+SELECT count(*), count(d) FROM aocs_lm WHERE b = 5;
+SELECT count(*), sum(a) FROM aocs_lm WHERE d <> 7 OR d IS NULL;
+
+ALTER TABLE aocs_lm ADD COLUMN e int DEFAULT 7;
+INSERT INTO aocs_lm SELECT i, i % 10, 'v' || (i % 7), i, i % 3 FROM generate_series(10001, 12000) i;
+
+SET gp_enable_aocs_late_materialization = on;
+-- missing values of a column added later
+SELECT count(*), sum(a) FROM aocs_lm WHERE e = 7;
+SELECT count(*), sum(a) FROM aocs_lm WHERE e < 2;
+SELECT count(*), sum(a), sum(e) FROM aocs_lm WHERE b = 3;
+SELECT count(*), sum(e) FROM aocs_lm WHERE e IN (1, 7) AND b = 2;
+SET gp_enable_aocs_late_materialization = off;
+-- missing values of a column added later
+SELECT count(*), sum(a) FROM aocs_lm WHERE e = 7;
+SELECT count(*), sum(a) FROM aocs_lm WHERE e < 2;
+SELECT count(*), sum(a), sum(e) FROM aocs_lm WHERE b = 3;
+SELECT count(*), sum(e) FROM aocs_lm WHERE e IN (1, 7) AND b = 2;
+
+DELETE FROM aocs_lm WHERE a % 3 = 0;
+
+SET gp_enable_aocs_late_materialization = on;
+-- deleted rows
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b = 3;
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b < 2;
+SELECT count(*), sum(a), count(d) FROM aocs_lm WHERE c = 'v3';
+SELECT count(*), sum(a) FROM aocs_lm WHERE e = 7;
+SELECT count(*), sum(a) FROM aocs_lm WHERE e < 2;
+SET gp_enable_aocs_late_materialization = off;
+-- deleted rows
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b = 3;
+SELECT count(*), sum(a), count(c) FROM aocs_lm WHERE b < 2;
+SELECT count(*), sum(a), count(d) FROM aocs_lm WHERE c = 'v3';
+SELECT count(*), sum(a) FROM aocs_lm WHERE e = 7;
+SELECT count(*), sum(a) FROM aocs_lm WHERE e < 2;
+
+CREATE TABLE aocs_lm_outer (x int) DISTRIBUTED BY (x);
+INSERT INTO aocs_lm_outer SELECT generate_series(1, 50);
+SET optimizer = off;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SET enable_material = off;
+SET gp_enable_aocs_late_materialization = on;
+-- the inner side of a nested loop is rescanned for every outer row
+SELECT count(*), sum(aocs_lm.a) FROM aocs_lm_outer JOIN aocs_lm ON aocs_lm.a = aocs_lm_outer.x WHERE aocs_lm.b IN (1, 3);
+SET gp_enable_aocs_late_materialization = off;
+-- the inner side of a nested loop is rescanned for every outer row
+SELECT count(*), sum(aocs_lm.a) FROM aocs_lm_outer JOIN aocs_lm ON aocs_lm.a = aocs_lm_outer.x WHERE aocs_lm.b IN (1, 3);
+
+RESET enable_material;
+RESET enable_mergejoin;
+RESET enable_hashjoin;
+RESET optimizer;
+RESET gp_enable_aocs_late_materialization;
+DROP SCHEMA aocs_late_materialization CASCADE;
@@ -0,0 +1,102 @@
+--
+-- Test the zone maps of AOCS tables, the minimum and maximum values of each
+-- block kept in the block directory, which let the sequential scans pass over
+-- the blocks their quals reject.  The blocks passed over are counted with
+-- the aocs_zone_map_skip_block fault.
+--
+CREATE SCHEMA aocs_zone_maps;
+SET search_path = aocs_zone_maps;
+SET optimizer = off;
+
+-- Blocks passed over on content 1 since the last call, which starts
+-- counting the ones of the given table
+CREATE FUNCTION zm_blocks_skipped(rel text) RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('aocs_zone_map_skip_block', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('aocs_zone_map_skip_block', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('aocs_zone_map_skip_block', 'skip', '', '', rel, 1, -1, 0, dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+-- All the rows go to content 1.  The zone maps are written to the block
+-- directory, which only the tables with an index have.
+CREATE TABLE aocs_zm (k int, a int, b int, c text) USING ao_column WITH (blocksize = 8192) DISTRIBUTED BY (k);
+CREATE INDEX aocs_zm_c ON aocs_zm (c);
+INSERT INTO aocs_zm SELECT 0, i, i % 100, 'row ' || i FROM generate_series(1, 100000) i;
+-- blocks of NULLs
+INSERT INTO aocs_zm SELECT 0, NULL, i % 100, 'row ' || i FROM generate_series(100001, 102000) i;
+DELETE FROM aocs_zm WHERE a BETWEEN 500 AND 600;
+-- the zone maps come with AORelationVersion_GP7_ZoneMaps
+SELECT version FROM pg_appendonly WHERE relid = 'aocs_zm'::regclass;
+
+SELECT gp_inject_fault('aocs_zone_map_skip_block', 'skip', '', '', 'aocs_zm', 1, -1, 0, dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+-- The zone maps are checked whether the rows are filtered early or not
+SET gp_enable_aocs_late_materialization = on;
+-- only the first blocks of a have the values
+SELECT count(*), sum(a) FROM aocs_zm WHERE a <= 1000;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+SELECT c FROM aocs_zm WHERE a = 54321;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+SELECT count(*), min(a), max(a) FROM aocs_zm WHERE a > 99000 AND b = 7;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+-- every block has the values of b
+SELECT count(*) FROM aocs_zm WHERE b = 7;
+SELECT zm_blocks_skipped('aocs_zm') AS skipped;
+-- no block has the values, nor the blocks of NULLs
+SELECT count(*) FROM aocs_zm WHERE a > 200000;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+-- IS NULL is not checked against the zone maps
+SELECT count(*) FROM aocs_zm WHERE a IS NULL;
+SELECT zm_blocks_skipped('aocs_zm') AS skipped;
+SET gp_enable_aocs_late_materialization = off;
+-- only the first blocks of a have the values
+SELECT count(*), sum(a) FROM aocs_zm WHERE a <= 1000;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+SELECT c FROM aocs_zm WHERE a = 54321;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+SELECT count(*), min(a), max(a) FROM aocs_zm WHERE a > 99000 AND b = 7;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+-- every block has the values of b
+SELECT count(*) FROM aocs_zm WHERE b = 7;
+SELECT zm_blocks_skipped('aocs_zm') AS skipped;
+-- no block has the values, nor the blocks of NULLs
+SELECT count(*) FROM aocs_zm WHERE a > 200000;
+SELECT zm_blocks_skipped('aocs_zm') > 40 AS skipped;
+-- IS NULL is not checked against the zone maps
+SELECT count(*) FROM aocs_zm WHERE a IS NULL;
+SELECT zm_blocks_skipped('aocs_zm') AS skipped;
+RESET gp_enable_aocs_late_materialization;
+
+-- Without an index, no block directory and no zone maps
+CREATE TABLE aocs_zm_noidx (k int, a int, b int, c text) USING ao_column WITH (blocksize = 8192) DISTRIBUTED BY (k);
+INSERT INTO aocs_zm_noidx SELECT 0, i, i % 100, 'row ' || i FROM generate_series(1, 100000) i;
+SELECT zm_blocks_skipped('aocs_zm_noidx') >= 0 AS skipped;
+SELECT count(*), sum(a) FROM aocs_zm_noidx WHERE a <= 1000;
+SELECT zm_blocks_skipped('aocs_zm_noidx') AS skipped;
+
+-- The block directory built with the index has no zone maps, only the
+-- blocks inserted after it do
+CREATE TABLE aocs_zm_late (k int, a int, b int, c text) USING ao_column WITH (blocksize = 8192) DISTRIBUTED BY (k);
+INSERT INTO aocs_zm_late SELECT 0, i, i % 100, 'row ' || i FROM generate_series(1, 100000) i;
+CREATE INDEX aocs_zm_late_c ON aocs_zm_late (c);
+INSERT INTO aocs_zm_late SELECT 0, i, i % 100, 'row ' || i FROM generate_series(100001, 200000) i;
+SELECT zm_blocks_skipped('aocs_zm_late') >= 0 AS skipped;
+SELECT count(*), min(a) FROM aocs_zm_late WHERE a > 150000;
+SELECT zm_blocks_skipped('aocs_zm_late') BETWEEN 20 AND 30 AS skipped;
+SELECT count(*), max(a) FROM aocs_zm_late WHERE a <= 1000;
+SELECT zm_blocks_skipped('aocs_zm_late') BETWEEN 40 AND 60 AS skipped;
+
+SELECT gp_inject_fault('aocs_zone_map_skip_block', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+RESET optimizer;
+DROP TABLE aocs_zm, aocs_zm_noidx, aocs_zm_late;
+DROP FUNCTION zm_blocks_skipped(text);
+DROP SCHEMA aocs_zone_maps;
@@ -0,0 +1,39 @@
+--
+-- Test constant folding of large IN lists by ORCA.  The duplicates of an IN
+-- list are found by comparing the sorted constants pairwise; the comparisons
+-- the optimizer cannot do itself are evaluated by the executor, all in one
+-- batch.  Every value of the lists below is there twice, some of them in a
+-- different but equal form, which only the executor can tell.
+--
+CREATE SCHEMA const_expr_eval_batch;
+SET search_path = const_expr_eval_batch;
+
+CREATE TABLE ceb (i int, k char(6), t text, n numeric) DISTRIBUTED BY (i);
+INSERT INTO ceb SELECT i, 'k' || i, 't' || i, i FROM generate_series(1, 1000) i;
+
+SET optimizer_enable_constant_expression_evaluation = on;
+SELECT count(*), sum(i) FROM ceb WHERE k IN ('k1', 'k38', 'k75', 'k12', 'k49', 'k86', 'k23', 'k60', 'k97', 'k34', 'k71', 'k8', 'k45', 'k82', 'k19', 'k56', 'k93', 'k30', 'k67', 'k4', 'k41', 'k78', 'k15', 'k52', 'k89', 'k26', 'k63', 'k100', 'k37', 'k74', 'k11', 'k48', 'k85', 'k22', 'k59', 'k96', 'k33', 'k70', 'k7', 'k44', 'k81', 'k18', 'k55', 'k92', 'k29', 'k66', 'k3', 'k40', 'k77', 'k14', 'k51', 'k88', 'k25', 'k62', 'k99', 'k36', 'k73', 'k10', 'k47', 'k84', 'k21', 'k58', 'k95', 'k32', 'k69', 'k6', 'k43', 'k80', 'k17', 'k54', 'k91', 'k28', 'k65', 'k2', 'k39', 'k76', 'k13', 'k50', 'k87', 'k24', 'k61', 'k98', 'k35', 'k72', 'k9', 'k46', 'k83', 'k20', 'k57', 'k94', 'k31', 'k68', 'k5', 'k42', 'k79', 'k16', 'k53', 'k90', 'k27', 'k64', 'k64  ', 'k27  ', 'k90  ', 'k53  ', 'k16  ', 'k79  ', 'k42  ', 'k5  ', 'k68  ', 'k31  ', 'k94  ', 'k57  ', 'k20  ', 'k83  ', 'k46  ', 'k9  ', 'k72  ', 'k35  ', 'k98  ', 'k61  ', 'k24  ', 'k87  ', 'k50  ', 'k13  ', 'k76  ', 'k39  ', 'k2  ', 'k65  ', 'k28  ', 'k91  ', 'k54  ', 'k17  ', 'k80  ', 'k43  ', 'k6  ', 'k69  ', 'k32  ', 'k95  ', 'k58  ', 'k21  ', 'k84  ', 'k47  ', 'k10  ', 'k73  ', 'k36  ', 'k99  ', 'k62  ', 'k25  ', 'k88  ', 'k51  ', 'k14  ', 'k77  ', 'k40  ', 'k3  ', 'k66  ', 'k29  ', 'k92  ', 'k55  ', 'k18  ', 'k81  ', 'k44  ', 'k7  ', 'k70  ', 'k33  ', 'k96  ', 'k59  ', 'k22  ', 'k85  ', 'k48  ', 'k11  ', 'k74  ', 'k37  ', 'k100  ', 'k63  ', 'k26  ', 'k89  ', 'k52  ', 'k15  ', 'k78  ', 'k41  ', 'k4  ', 'k67  ', 'k30  ', 'k93  ', 'k56  ', 'k19  ', 'k82  ', 'k45  ', 'k8  ', 'k71  ', 'k34  ', 'k97  ', 'k60  ', 'k23  ', 'k86  ', 'k49  ', 'k12  ', 'k75  ', 'k38  ', 'k1  ', NULL, 'none');
+SELECT count(*), sum(i) FROM ceb WHERE k = ANY (ARRAY['k1', 'k38', 'k75', 'k12', 'k49', 'k86', 'k23', 'k60', 'k97', 'k34', 'k71', 'k8', 'k45', 'k82', 'k19', 'k56', 'k93', 'k30', 'k67', 'k4', 'k41', 'k78', 'k15', 'k52', 'k89', 'k26', 'k63', 'k100', 'k37', 'k74', 'k11', 'k48', 'k85', 'k22', 'k59', 'k96', 'k33', 'k70', 'k7', 'k44', 'k81', 'k18', 'k55', 'k92', 'k29', 'k66', 'k3', 'k40', 'k77', 'k14', 'k51', 'k88', 'k25', 'k62', 'k99', 'k36', 'k73', 'k10', 'k47', 'k84', 'k21', 'k58', 'k95', 'k32', 'k69', 'k6', 'k43', 'k80', 'k17', 'k54', 'k91', 'k28', 'k65', 'k2', 'k39', 'k76', 'k13', 'k50', 'k87', 'k24', 'k61', 'k98', 'k35', 'k72', 'k9', 'k46', 'k83', 'k20', 'k57', 'k94', 'k31', 'k68', 'k5', 'k42', 'k79', 'k16', 'k53', 'k90', 'k27', 'k64', 'k64  ', 'k27  ', 'k90  ', 'k53  ', 'k16  ', 'k79  ', 'k42  ', 'k5  ', 'k68  ', 'k31  ', 'k94  ', 'k57  ', 'k20  ', 'k83  ', 'k46  ', 'k9  ', 'k72  ', 'k35  ', 'k98  ', 'k61  ', 'k24  ', 'k87  ', 'k50  ', 'k13  ', 'k76  ', 'k39  ', 'k2  ', 'k65  ', 'k28  ', 'k91  ', 'k54  ', 'k17  ', 'k80  ', 'k43  ', 'k6  ', 'k69  ', 'k32  ', 'k95  ', 'k58  ', 'k21  ', 'k84  ', 'k47  ', 'k10  ', 'k73  ', 'k36  ', 'k99  ', 'k62  ', 'k25  ', 'k88  ', 'k51  ', 'k14  ', 'k77  ', 'k40  ', 'k3  ', 'k66  ', 'k29  ', 'k92  ', 'k55  ', 'k18  ', 'k81  ', 'k44  ', 'k7  ', 'k70  ', 'k33  ', 'k96  ', 'k59  ', 'k22  ', 'k85  ', 'k48  ', 'k11  ', 'k74  ', 'k37  ', 'k100  ', 'k63  ', 'k26  ', 'k89  ', 'k52  ', 'k15  ', 'k78  ', 'k41  ', 'k4  ', 'k67  ', 'k30  ', 'k93  ', 'k56  ', 'k19  ', 'k82  ', 'k45  ', 'k8  ', 'k71  ', 'k34  ', 'k97  ', 'k60  ', 'k23  ', 'k86  ', 'k49  ', 'k12  ', 'k75  ', 'k38  ', 'k1  ', NULL, 'none']::char(6)[]);
+SELECT count(*), sum(i) FROM ceb WHERE t IN ('t1', 't38', 't75', 't12', 't49', 't86', 't23', 't60', 't97', 't34', 't71', 't8', 't45', 't82', 't19', 't56', 't93', 't30', 't67', 't4', 't41', 't78', 't15', 't52', 't89', 't26', 't63', 't100', 't37', 't74', 't11', 't48', 't85', 't22', 't59', 't96', 't33', 't70', 't7', 't44', 't81', 't18', 't55', 't92', 't29', 't66', 't3', 't40', 't77', 't14', 't51', 't88', 't25', 't62', 't99', 't36', 't73', 't10', 't47', 't84', 't21', 't58', 't95', 't32', 't69', 't6', 't43', 't80', 't17', 't54', 't91', 't28', 't65', 't2', 't39', 't76', 't13', 't50', 't87', 't24', 't61', 't98', 't35', 't72', 't9', 't46', 't83', 't20', 't57', 't94', 't31', 't68', 't5', 't42', 't79', 't16', 't53', 't90', 't27', 't64', 't1', 't2', 't3', 't4', 't5', 't6', 't7', 't8', 't9', 't10', 't11', 't12', 't13', 't14', 't15', 't16', 't17', 't18', 't19', 't20', 't21', 't22', 't23', 't24', 't25', 't26', 't27', 't28', 't29', 't30', 't31', 't32', 't33', 't34', 't35', 't36', 't37', 't38', 't39', 't40', 't41', 't42', 't43', 't44', 't45', 't46', 't47', 't48', 't49', 't50', 't51', 't52', 't53', 't54', 't55', 't56', 't57', 't58', 't59', 't60', 't61', 't62', 't63', 't64', 't65', 't66', 't67', 't68', 't69', 't70', 't71', 't72', 't73', 't74', 't75', 't76', 't77', 't78', 't79', 't80', 't81', 't82', 't83', 't84', 't85', 't86', 't87', 't88', 't89', 't90', 't91', 't92', 't93', 't94', 't95', 't96', 't97', 't98', 't99', 't100', NULL, 'none');
+SELECT count(*), sum(i) FROM ceb WHERE n IN (1.0, 38.0, 75.0, 12.0, 49.0, 86.0, 23.0, 60.0, 97.0, 34.0, 71.0, 8.0, 45.0, 82.0, 19.0, 56.0, 93.0, 30.0, 67.0, 4.0, 41.0, 78.0, 15.0, 52.0, 89.0, 26.0, 63.0, 100.0, 37.0, 74.0, 11.0, 48.0, 85.0, 22.0, 59.0, 96.0, 33.0, 70.0, 7.0, 44.0, 81.0, 18.0, 55.0, 92.0, 29.0, 66.0, 3.0, 40.0, 77.0, 14.0, 51.0, 88.0, 25.0, 62.0, 99.0, 36.0, 73.0, 10.0, 47.0, 84.0, 21.0, 58.0, 95.0, 32.0, 69.0, 6.0, 43.0, 80.0, 17.0, 54.0, 91.0, 28.0, 65.0, 2.0, 39.0, 76.0, 13.0, 50.0, 87.0, 24.0, 61.0, 98.0, 35.0, 72.0, 9.0, 46.0, 83.0, 20.0, 57.0, 94.0, 31.0, 68.0, 5.0, 42.0, 79.0, 16.0, 53.0, 90.0, 27.0, 64.0, 1.00, 2.00, 3.00, 4.00, 5.00, 6.00, 7.00, 8.00, 9.00, 10.00, 11.00, 12.00, 13.00, 14.00, 15.00, 16.00, 17.00, 18.00, 19.00, 20.00, 21.00, 22.00, 23.00, 24.00, 25.00, 26.00, 27.00, 28.00, 29.00, 30.00, 31.00, 32.00, 33.00, 34.00, 35.00, 36.00, 37.00, 38.00, 39.00, 40.00, 41.00, 42.00, 43.00, 44.00, 45.00, 46.00, 47.00, 48.00, 49.00, 50.00, 51.00, 52.00, 53.00, 54.00, 55.00, 56.00, 57.00, 58.00, 59.00, 60.00, 61.00, 62.00, 63.00, 64.00, 65.00, 66.00, 67.00, 68.00, 69.00, 70.00, 71.00, 72.00, 73.00, 74.00, 75.00, 76.00, 77.00, 78.00, 79.00, 80.00, 81.00, 82.00, 83.00, 84.00, 85.00, 86.00, 87.00, 88.00, 89.00, 90.00, 91.00, 92.00, 93.00, 94.00, 95.00, 96.00, 97.00, 98.00, 99.00, 100.00, NULL);
+-- the integers are compared by the optimizer itself, unless told otherwise
+SELECT count(*), sum(i) FROM ceb WHERE i IN (1, 38, 75, 12, 49, 86, 23, 60, 97, 34, 71, 8, 45, 82, 19, 56, 93, 30, 67, 4, 41, 78, 15, 52, 89, 26, 63, 100, 37, 74, 11, 48, 85, 22, 59, 96, 33, 70, 7, 44, 81, 18, 55, 92, 29, 66, 3, 40, 77, 14, 51, 88, 25, 62, 99, 36, 73, 10, 47, 84, 21, 58, 95, 32, 69, 6, 43, 80, 17, 54, 91, 28, 65, 2, 39, 76, 13, 50, 87, 24, 61, 98, 35, 72, 9, 46, 83, 20, 57, 94, 31, 68, 5, 42, 79, 16, 53, 90, 27, 64, 100, 99, 98, 97, 96, 95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84, 83, 82, 81, 80, 79, 78, 77, 76, 75, 74, 73, 72, 71, 70, 69, 68, 67, 66, 65, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 5000, NULL);
+SET optimizer_use_external_constant_expression_evaluation_for_ints = on;
+SELECT count(*), sum(i) FROM ceb WHERE i IN (1, 38, 75, 12, 49, 86, 23, 60, 97, 34, 71, 8, 45, 82, 19, 56, 93, 30, 67, 4, 41, 78, 15, 52, 89, 26, 63, 100, 37, 74, 11, 48, 85, 22, 59, 96, 33, 70, 7, 44, 81, 18, 55, 92, 29, 66, 3, 40, 77, 14, 51, 88, 25, 62, 99, 36, 73, 10, 47, 84, 21, 58, 95, 32, 69, 6, 43, 80, 17, 54, 91, 28, 65, 2, 39, 76, 13, 50, 87, 24, 61, 98, 35, 72, 9, 46, 83, 20, 57, 94, 31, 68, 5, 42, 79, 16, 53, 90, 27, 64, 100, 99, 98, 97, 96, 95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84, 83, 82, 81, 80, 79, 78, 77, 76, 75, 74, 73, 72, 71, 70, 69, 68, 67, 66, 65, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 5000, NULL);
+RESET optimizer_use_external_constant_expression_evaluation_for_ints;
+
+-- Without the executor, the lists are only folded where the optimizer can
+-- compare the values itself.
+SET optimizer_enable_constant_expression_evaluation = off;
+SELECT count(*), sum(i) FROM ceb WHERE k IN ('k1', 'k38', 'k75', 'k12', 'k49', 'k86', 'k23', 'k60', 'k97', 'k34', 'k71', 'k8', 'k45', 'k82', 'k19', 'k56', 'k93', 'k30', 'k67', 'k4', 'k41', 'k78', 'k15', 'k52', 'k89', 'k26', 'k63', 'k100', 'k37', 'k74', 'k11', 'k48', 'k85', 'k22', 'k59', 'k96', 'k33', 'k70', 'k7', 'k44', 'k81', 'k18', 'k55', 'k92', 'k29', 'k66', 'k3', 'k40', 'k77', 'k14', 'k51', 'k88', 'k25', 'k62', 'k99', 'k36', 'k73', 'k10', 'k47', 'k84', 'k21', 'k58', 'k95', 'k32', 'k69', 'k6', 'k43', 'k80', 'k17', 'k54', 'k91', 'k28', 'k65', 'k2', 'k39', 'k76', 'k13', 'k50', 'k87', 'k24', 'k61', 'k98', 'k35', 'k72', 'k9', 'k46', 'k83', 'k20', 'k57', 'k94', 'k31', 'k68', 'k5', 'k42', 'k79', 'k16', 'k53', 'k90', 'k27', 'k64', 'k64  ', 'k27  ', 'k90  ', 'k53  ', 'k16  ', 'k79  ', 'k42  ', 'k5  ', 'k68  ', 'k31  ', 'k94  ', 'k57  ', 'k20  ', 'k83  ', 'k46  ', 'k9  ', 'k72  ', 'k35  ', 'k98  ', 'k61  ', 'k24  ', 'k87  ', 'k50  ', 'k13  ', 'k76  ', 'k39  ', 'k2  ', 'k65  ', 'k28  ', 'k91  ', 'k54  ', 'k17  ', 'k80  ', 'k43  ', 'k6  ', 'k69  ', 'k32  ', 'k95  ', 'k58  ', 'k21  ', 'k84  ', 'k47  ', 'k10  ', 'k73  ', 'k36  ', 'k99  ', 'k62  ', 'k25  ', 'k88  ', 'k51  ', 'k14  ', 'k77  ', 'k40  ', 'k3  ', 'k66  ', 'k29  ', 'k92  ', 'k55  ', 'k18  ', 'k81  ', 'k44  ', 'k7  ', 'k70  ', 'k33  ', 'k96  ', 'k59  ', 'k22  ', 'k85  ', 'k48  ', 'k11  ', 'k74  ', 'k37  ', 'k100  ', 'k63  ', 'k26  ', 'k89  ', 'k52  ', 'k15  ', 'k78  ', 'k41  ', 'k4  ', 'k67  ', 'k30  ', 'k93  ', 'k56  ', 'k19  ', 'k82  ', 'k45  ', 'k8  ', 'k71  ', 'k34  ', 'k97  ', 'k60  ', 'k23  ', 'k86  ', 'k49  ', 'k12  ', 'k75  ', 'k38  ', 'k1  ', NULL, 'none');
+SELECT count(*), sum(i) FROM ceb WHERE k = ANY (ARRAY['k1', 'k38', 'k75', 'k12', 'k49', 'k86', 'k23', 'k60', 'k97', 'k34', 'k71', 'k8', 'k45', 'k82', 'k19', 'k56', 'k93', 'k30', 'k67', 'k4', 'k41', 'k78', 'k15', 'k52', 'k89', 'k26', 'k63', 'k100', 'k37', 'k74', 'k11', 'k48', 'k85', 'k22', 'k59', 'k96', 'k33', 'k70', 'k7', 'k44', 'k81', 'k18', 'k55', 'k92', 'k29', 'k66', 'k3', 'k40', 'k77', 'k14', 'k51', 'k88', 'k25', 'k62', 'k99', 'k36', 'k73', 'k10', 'k47', 'k84', 'k21', 'k58', 'k95', 'k32', 'k69', 'k6', 'k43', 'k80', 'k17', 'k54', 'k91', 'k28', 'k65', 'k2', 'k39', 'k76', 'k13', 'k50', 'k87', 'k24', 'k61', 'k98', 'k35', 'k72', 'k9', 'k46', 'k83', 'k20', 'k57', 'k94', 'k31', 'k68', 'k5', 'k42', 'k79', 'k16', 'k53', 'k90', 'k27', 'k64', 'k64  ', 'k27  ', 'k90  ', 'k53  ', 'k16  ', 'k79  ', 'k42  ', 'k5  ', 'k68  ', 'k31  ', 'k94  ', 'k57  ', 'k20  ', 'k83  ', 'k46  ', 'k9  ', 'k72  ', 'k35  ', 'k98  ', 'k61  ', 'k24  ', 'k87  ', 'k50  ', 'k13  ', 'k76  ', 'k39  ', 'k2  ', 'k65  ', 'k28  ', 'k91  ', 'k54  ', 'k17  ', 'k80  ', 'k43  ', 'k6  ', 'k69  ', 'k32  ', 'k95  ', 'k58  ', 'k21  ', 'k84  ', 'k47  ', 'k10  ', 'k73  ', 'k36  ', 'k99  ', 'k62  ', 'k25  ', 'k88  ', 'k51  ', 'k14  ', 'k77  ', 'k40  ', 'k3  ', 'k66  ', 'k29  ', 'k92  ', 'k55  ', 'k18  ', 'k81  ', 'k44  ', 'k7  ', 'k70  ', 'k33  ', 'k96  ', 'k59  ', 'k22  ', 'k85  ', 'k48  ', 'k11  ', 'k74  ', 'k37  ', 'k100  ', 'k63  ', 'k26  ', 'k89  ', 'k52  ', 'k15  ', 'k78  ', 'k41  ', 'k4  ', 'k67  ', 'k30  ', 'k93  ', 'k56  ', 'k19  ', 'k82  ', 'k45  ', 'k8  ', 'k71  ', 'k34  ', 'k97  ', 'k60  ', 'k23  ', 'k86  ', 'k49  ', 'k12  ', 'k75  ', 'k38  ', 'k1  ', NULL, 'none']::char(6)[]);
+SELECT count(*), sum(i) FROM ceb WHERE t IN ('t1', 't38', 't75', 't12', 't49', 't86', 't23', 't60', 't97', 't34', 't71', 't8', 't45', 't82', 't19', 't56', 't93', 't30', 't67', 't4', 't41', 't78', 't15', 't52', 't89', 't26', 't63', 't100', 't37', 't74', 't11', 't48', 't85', 't22', 't59', 't96', 't33', 't70', 't7', 't44', 't81', 't18', 't55', 't92', 't29', 't66', 't3', 't40', 't77', 't14', 't51', 't88', 't25', 't62', 't99', 't36', 't73', 't10', 't47', 't84', 't21', 't58', 't95', 't32', 't69', 't6', 't43', 't80', 't17', 't54', 't91', 't28', 't65', 't2', 't39', 't76', 't13', 't50', 't87', 't24', 't61', 't98', 't35', 't72', 't9', 't46', 't83', 't20', 't57', 't94', 't31', 't68', 't5', 't42', 't79', 't16', 't53', 't90', 't27', 't64', 't1', 't2', 't3', 't4', 't5', 't6', 't7', 't8', 't9', 't10', 't11', 't12', 't13', 't14', 't15', 't16', 't17', 't18', 't19', 't20', 't21', 't22', 't23', 't24', 't25', 't26', 't27', 't28', 't29', 't30', 't31', 't32', 't33', 't34', 't35', 't36', 't37', 't38', 't39', 't40', 't41', 't42', 't43', 't44', 't45', 't46', 't47', 't48', 't49', 't50', 't51', 't52', 't53', 't54', 't55', 't56', 't57', 't58', 't59', 't60', 't61', 't62', 't63', 't64', 't65', 't66', 't67', 't68', 't69', 't70', 't71', 't72', 't73', 't74', 't75', 't76', 't77', 't78', 't79', 't80', 't81', 't82', 't83', 't84', 't85', 't86', 't87', 't88', 't89', 't90', 't91', 't92', 't93', 't94', 't95', 't96', 't97', 't98', 't99', 't100', NULL, 'none');
+SELECT count(*), sum(i) FROM ceb WHERE n IN (1.0, 38.0, 75.0, 12.0, 49.0, 86.0, 23.0, 60.0, 97.0, 34.0, 71.0, 8.0, 45.0, 82.0, 19.0, 56.0, 93.0, 30.0, 67.0, 4.0, 41.0, 78.0, 15.0, 52.0, 89.0, 26.0, 63.0, 100.0, 37.0, 74.0, 11.0, 48.0, 85.0, 22.0, 59.0, 96.0, 33.0, 70.0, 7.0, 44.0, 81.0, 18.0, 55.0, 92.0, 29.0, 66.0, 3.0, 40.0, 77.0, 14.0, 51.0, 88.0, 25.0, 62.0, 99.0, 36.0, 73.0, 10.0, 47.0, 84.0, 21.0, 58.0, 95.0, 32.0, 69.0, 6.0, 43.0, 80.0, 17.0, 54.0, 91.0, 28.0, 65.0, 2.0, 39.0, 76.0, 13.0, 50.0, 87.0, 24.0, 61.0, 98.0, 35.0, 72.0, 9.0, 46.0, 83.0, 20.0, 57.0, 94.0, 31.0, 68.0, 5.0, 42.0, 79.0, 16.0, 53.0, 90.0, 27.0, 64.0, 1.00, 2.00, 3.00, 4.00, 5.00, 6.00, 7.00, 8.00, 9.00, 10.00, 11.00, 12.00, 13.00, 14.00, 15.00, 16.00, 17.00, 18.00, 19.00, 20.00, 21.00, 22.00, 23.00, 24.00, 25.00, 26.00, 27.00, 28.00, 29.00, 30.00, 31.00, 32.00, 33.00, 34.00, 35.00, 36.00, 37.00, 38.00, 39.00, 40.00, 41.00, 42.00, 43.00, 44.00, 45.00, 46.00, 47.00, 48.00, 49.00, 50.00, 51.00, 52.00, 53.00, 54.00, 55.00, 56.00, 57.00, 58.00, 59.00, 60.00, 61.00, 62.00, 63.00, 64.00, 65.00, 66.00, 67.00, 68.00, 69.00, 70.00, 71.00, 72.00, 73.00, 74.00, 75.00, 76.00, 77.00, 78.00, 79.00, 80.00, 81.00, 82.00, 83.00, 84.00, 85.00, 86.00, 87.00, 88.00, 89.00, 90.00, 91.00, 92.00, 93.00, 94.00, 95.00, 96.00, 97.00, 98.00, 99.00, 100.00, NULL);
+-- the integers are compared by the optimizer itself, unless told otherwise
+SELECT count(*), sum(i) FROM ceb WHERE i IN (1, 38, 75, 12, 49, 86, 23, 60, 97, 34, 71, 8, 45, 82, 19, 56, 93, 30, 67, 4, 41, 78, 15, 52, 89, 26, 63, 100, 37, 74, 11, 48, 85, 22, 59, 96, 33, 70, 7, 44, 81, 18, 55, 92, 29, 66, 3, 40, 77, 14, 51, 88, 25, 62, 99, 36, 73, 10, 47, 84, 21, 58, 95, 32, 69, 6, 43, 80, 17, 54, 91, 28, 65, 2, 39, 76, 13, 50, 87, 24, 61, 98, 35, 72, 9, 46, 83, 20, 57, 94, 31, 68, 5, 42, 79, 16, 53, 90, 27, 64, 100, 99, 98, 97, 96, 95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84, 83, 82, 81, 80, 79, 78, 77, 76, 75, 74, 73, 72, 71, 70, 69, 68, 67, 66, 65, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 5000, NULL);
+SET optimizer_use_external_constant_expression_evaluation_for_ints = on;
+SELECT count(*), sum(i) FROM ceb WHERE i IN (1, 38, 75, 12, 49, 86, 23, 60, 97, 34, 71, 8, 45, 82, 19, 56, 93, 30, 67, 4, 41, 78, 15, 52, 89, 26, 63, 100, 37, 74, 11, 48, 85, 22, 59, 96, 33, 70, 7, 44, 81, 18, 55, 92, 29, 66, 3, 40, 77, 14, 51, 88, 25, 62, 99, 36, 73, 10, 47, 84, 21, 58, 95, 32, 69, 6, 43, 80, 17, 54, 91, 28, 65, 2, 39, 76, 13, 50, 87, 24, 61, 98, 35, 72, 9, 46, 83, 20, 57, 94, 31, 68, 5, 42, 79, 16, 53, 90, 27, 64, 100, 99, 98, 97, 96, 95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84, 83, 82, 81, 80, 79, 78, 77, 76, 75, 74, 73, 72, 71, 70, 69, 68, 67, 66, 65, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 5000, NULL);
+RESET optimizer_use_external_constant_expression_evaluation_for_ints;
+RESET optimizer_enable_constant_expression_evaluation;
+
+DROP SCHEMA const_expr_eval_batch CASCADE;
@@ -0,0 +1,69 @@
+--
+-- Test hybrid redistribution of joins on skewed keys, see
+-- gp_enable_hybrid_redistribute.  The outer rows of the hot keys stay where
+-- they are, and the inner rows of the hot keys are broadcast.  The results
+-- must be the same as with a plain redistribution.  Only the Postgres planner
+-- plans hybrid redistribution.
+--
+CREATE SCHEMA hybrid_redistribute;
+SET search_path = hybrid_redistribute;
+SET optimizer = off;
+
+-- Half of the outer rows have k = 1, a few have a NULL k
+CREATE TABLE skew_o (id int, k int) DISTRIBUTED BY (id);
+INSERT INTO skew_o SELECT i, CASE WHEN i % 2 = 0 THEN 1 WHEN i % 50 = 1 THEN NULL ELSE i END FROM generate_series(1, 3000) i;
+CREATE TABLE skew_i (id int, k int) DISTRIBUTED BY (id);
+INSERT INTO skew_i SELECT i, i % 1500 + 1 FROM generate_series(1, 2000) i;
+-- the same rows, already distributed on the join key
+CREATE TABLE skew_ik (id int, k int) DISTRIBUTED BY (k);
+INSERT INTO skew_ik SELECT * FROM skew_i;
+ANALYZE skew_o;
+ANALYZE skew_i;
+ANALYZE skew_ik;
+
+SET gp_enable_hybrid_redistribute = on;
+EXPLAIN (COSTS OFF) SELECT o.id, i.id FROM skew_o o JOIN skew_i i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o JOIN skew_i i ON o.k = i.k;
+EXPLAIN (COSTS OFF) SELECT o.id, i.id FROM skew_o o LEFT JOIN skew_i i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o LEFT JOIN skew_i i ON o.k = i.k;
+EXPLAIN (COSTS OFF) SELECT o.id FROM skew_o o WHERE EXISTS (SELECT 1 FROM skew_i i WHERE i.k = o.k);
+SELECT count(*), sum(o.id) FROM skew_o o WHERE EXISTS (SELECT 1 FROM skew_i i WHERE i.k = o.k);
+EXPLAIN (COSTS OFF) SELECT o.id FROM skew_o o WHERE NOT EXISTS (SELECT 1 FROM skew_i i WHERE i.k = o.k);
+SELECT count(*), sum(o.id) FROM skew_o o WHERE NOT EXISTS (SELECT 1 FROM skew_i i WHERE i.k = o.k);
+-- the inner side gets a Motion only to broadcast its hot rows
+EXPLAIN (COSTS OFF) SELECT o.id, i.id FROM skew_o o JOIN skew_ik i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o JOIN skew_ik i ON o.k = i.k;
+EXPLAIN (COSTS OFF) SELECT o.id, i.id FROM skew_o o LEFT JOIN skew_ik i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o LEFT JOIN skew_ik i ON o.k = i.k;
+EXPLAIN (COSTS OFF) SELECT o.id FROM skew_o o WHERE EXISTS (SELECT 1 FROM skew_ik i WHERE i.k = o.k);
+SELECT count(*), sum(o.id) FROM skew_o o WHERE EXISTS (SELECT 1 FROM skew_ik i WHERE i.k = o.k);
+EXPLAIN (COSTS OFF) SELECT o.id FROM skew_o o WHERE NOT EXISTS (SELECT 1 FROM skew_ik i WHERE i.k = o.k);
+SELECT count(*), sum(o.id) FROM skew_o o WHERE NOT EXISTS (SELECT 1 FROM skew_ik i WHERE i.k = o.k);
+
+SET gp_enable_hybrid_redistribute = off;
+EXPLAIN (COSTS OFF) SELECT o.id, i.id FROM skew_o o JOIN skew_i i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o JOIN skew_i i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o LEFT JOIN skew_i i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o WHERE EXISTS (SELECT 1 FROM skew_i i WHERE i.k = o.k);
+SELECT count(*), sum(o.id) FROM skew_o o WHERE NOT EXISTS (SELECT 1 FROM skew_i i WHERE i.k = o.k);
+-- the inner side is not moved
+EXPLAIN (COSTS OFF) SELECT o.id, i.id FROM skew_o o JOIN skew_ik i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o JOIN skew_ik i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o LEFT JOIN skew_ik i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o WHERE EXISTS (SELECT 1 FROM skew_ik i WHERE i.k = o.k);
+SELECT count(*), sum(o.id) FROM skew_o o WHERE NOT EXISTS (SELECT 1 FROM skew_ik i WHERE i.k = o.k);
+
+-- no outer row meets the same inner row twice
+SET gp_enable_hybrid_redistribute = on;
+SELECT count(*) FROM (SELECT o.id, i.id FROM skew_o o LEFT JOIN skew_i i ON o.k = i.k
+  GROUP BY o.id, i.id HAVING count(*) > 1) dup;
+
+-- a key is not hot unless it is skewed enough
+SET gp_hybrid_redistribute_skew_ratio = 2;
+EXPLAIN (COSTS OFF) SELECT o.id, i.id FROM skew_o o JOIN skew_i i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o JOIN skew_i i ON o.k = i.k;
+
+RESET gp_hybrid_redistribute_skew_ratio;
+RESET gp_enable_hybrid_redistribute;
+RESET optimizer;
+DROP SCHEMA hybrid_redistribute CASCADE;
@@ -0,0 +1,73 @@
+--
+-- Test the UDP interconnect with packets sent and received one at a time
+-- (gp_interconnect_batch_size = 1), with the default batches, and with the
+-- largest ones.  The receive side takes the batch size when the backend
+-- sets up its interconnect, so it is set at connection start.  The results
+-- must be the same in all cases.  The batches of more than one packet are
+-- counted with the interconnect_send_batch fault.
+--
+CREATE SCHEMA ic_batch_size;
+SET search_path = ic_batch_size;
+
+-- Batches of more than one packet sent by content 1 since the last call
+CREATE FUNCTION ic_send_batches() RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('interconnect_send_batch', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('interconnect_send_batch', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault_infinite('interconnect_send_batch', 'skip', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TABLE ic_b (a int, b int, t text) DISTRIBUTED BY (a);
+INSERT INTO ic_b SELECT a, a % 1000 + 1, repeat(md5(a::text), 10) FROM generate_series(1, 20000) a;
+
+SELECT gp_inject_fault_infinite('interconnect_send_batch', 'skip', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+-- default
+SELECT DISTINCT current_setting('gp_interconnect_batch_size') FROM gp_dist_random('gp_id');
+-- gather
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_b;
+-- redistribute
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_b x JOIN ic_b y ON x.b = y.a;
+SELECT b, count(*), sum(a) FROM ic_b GROUP BY b ORDER BY b LIMIT 3;
+-- the receivers stop early
+SELECT count(*) FROM (SELECT x.a FROM ic_b x JOIN ic_b y ON x.b = y.b LIMIT 100) s;
+SELECT ic_send_batches() > 0 AS batches;
+
+\setenv PGOPTIONS '-c gp_interconnect_batch_size=1'
+\c -
+SET search_path = ic_batch_size;
+SELECT DISTINCT current_setting('gp_interconnect_batch_size') FROM gp_dist_random('gp_id');
+-- gather
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_b;
+-- redistribute
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_b x JOIN ic_b y ON x.b = y.a;
+SELECT b, count(*), sum(a) FROM ic_b GROUP BY b ORDER BY b LIMIT 3;
+-- the receivers stop early
+SELECT count(*) FROM (SELECT x.a FROM ic_b x JOIN ic_b y ON x.b = y.b LIMIT 100) s;
+SELECT ic_send_batches() AS batches;
+
+\setenv PGOPTIONS '-c gp_interconnect_batch_size=64'
+\c -
+SET search_path = ic_batch_size;
+SELECT DISTINCT current_setting('gp_interconnect_batch_size') FROM gp_dist_random('gp_id');
+-- gather
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_b;
+-- redistribute
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_b x JOIN ic_b y ON x.b = y.a;
+SELECT b, count(*), sum(a) FROM ic_b GROUP BY b ORDER BY b LIMIT 3;
+-- the receivers stop early
+SELECT count(*) FROM (SELECT x.a FROM ic_b x JOIN ic_b y ON x.b = y.b LIMIT 100) s;
+SELECT ic_send_batches() > 0 AS batches;
+
+SELECT gp_inject_fault('interconnect_send_batch', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+\setenv PGOPTIONS ''
+\c -
+DROP SCHEMA ic_batch_size CASCADE;
@@ -0,0 +1,103 @@
+--
+-- Test the compression of the interconnect, see gp_interconnect_compression.
+-- The packets are compressed by the sender and expanded by the receiver, so
+-- the results must be the same with every method.  Compressed packets are
+-- reported by EXPLAIN ANALYZE on the receiving Motion, with their size before
+-- and after compression.
+--
+CREATE SCHEMA ic_compression;
+SET search_path = ic_compression;
+
+-- How many times smaller the packets received by the Motion of the query were
+-- on the wire, or NULL if none was compressed
+CREATE FUNCTION ic_compression_ratio(query text) RETURNS numeric AS $$
+DECLARE
+  line text;
+  kb text[];
+BEGIN
+  FOR line IN EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF) ' || query LOOP
+    kb := regexp_match(line, 'Interconnect compression: \d+ packets, (\d+)kB received as (\d+)kB');
+    IF kb IS NOT NULL THEN
+      RETURN kb[1]::numeric / greatest(kb[2]::numeric, 1);
+    END IF;
+  END LOOP;
+  RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+-- t compresses well, r is random bytes
+CREATE TABLE ic_comp (a int, b int, t text, r bytea) DISTRIBUTED BY (a);
+INSERT INTO ic_comp SELECT i, i % 17, repeat('compressible ', 100) || i, decode(string_agg(md5(i || '.' || j), '' ORDER BY j), 'hex')
+  FROM generate_series(1, 2000) i, generate_series(1, 32) j GROUP BY i;
+
+-- UDP interconnect
+SET gp_interconnect_compression = none;
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_comp;
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_comp x JOIN ic_comp y ON x.b = y.a;
+SELECT count(*), md5(string_agg(r, ''::bytea ORDER BY a)) FROM ic_comp;
+-- nothing is compressed
+SELECT ic_compression_ratio('SELECT t FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT r FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT count(*) FROM ic_comp') IS NULL AS uncompressed;
+
+SET gp_interconnect_compression = zlib;
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_comp;
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_comp x JOIN ic_comp y ON x.b = y.a;
+SELECT count(*), md5(string_agg(r, ''::bytea ORDER BY a)) FROM ic_comp;
+-- compressible rows
+SELECT ic_compression_ratio('SELECT t FROM ic_comp') > 4 AS compressed;
+-- random bytes do not shrink, and small packets are sent as they are
+SELECT ic_compression_ratio('SELECT r FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT count(*) FROM ic_comp') IS NULL AS uncompressed;
+
+SET gp_interconnect_compression = zstd;
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_comp;
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_comp x JOIN ic_comp y ON x.b = y.a;
+SELECT count(*), md5(string_agg(r, ''::bytea ORDER BY a)) FROM ic_comp;
+-- compressible rows
+SELECT ic_compression_ratio('SELECT t FROM ic_comp') > 4 AS compressed;
+-- random bytes do not shrink, and small packets are sent as they are
+SELECT ic_compression_ratio('SELECT r FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT count(*) FROM ic_comp') IS NULL AS uncompressed;
+
+RESET gp_interconnect_compression;
+
+-- TCP interconnect; gp_interconnect_type can only be set at connection start
+\setenv PGOPTIONS '-c gp_interconnect_type=tcp'
+\c -
+SET search_path = ic_compression;
+SELECT current_setting('gp_interconnect_type');
+SET gp_interconnect_compression = none;
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_comp;
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_comp x JOIN ic_comp y ON x.b = y.a;
+SELECT count(*), md5(string_agg(r, ''::bytea ORDER BY a)) FROM ic_comp;
+-- nothing is compressed
+SELECT ic_compression_ratio('SELECT t FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT r FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT count(*) FROM ic_comp') IS NULL AS uncompressed;
+
+SET gp_interconnect_compression = zlib;
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_comp;
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_comp x JOIN ic_comp y ON x.b = y.a;
+SELECT count(*), md5(string_agg(r, ''::bytea ORDER BY a)) FROM ic_comp;
+-- compressible rows
+SELECT ic_compression_ratio('SELECT t FROM ic_comp') > 4 AS compressed;
+-- random bytes do not shrink, and small packets are sent as they are
+SELECT ic_compression_ratio('SELECT r FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT count(*) FROM ic_comp') IS NULL AS uncompressed;
+
+SET gp_interconnect_compression = zstd;
+SELECT count(*), sum(length(t)), md5(string_agg(t, ',' ORDER BY a)) FROM ic_comp;
+SELECT count(*), md5(string_agg(x.t || y.t, ',' ORDER BY x.a)) FROM ic_comp x JOIN ic_comp y ON x.b = y.a;
+SELECT count(*), md5(string_agg(r, ''::bytea ORDER BY a)) FROM ic_comp;
+-- compressible rows
+SELECT ic_compression_ratio('SELECT t FROM ic_comp') > 4 AS compressed;
+-- random bytes do not shrink, and small packets are sent as they are
+SELECT ic_compression_ratio('SELECT r FROM ic_comp') IS NULL AS uncompressed;
+SELECT ic_compression_ratio('SELECT count(*) FROM ic_comp') IS NULL AS uncompressed;
+
+RESET gp_interconnect_compression;
+
+\setenv PGOPTIONS ''
+\c -
+DROP SCHEMA ic_compression CASCADE;
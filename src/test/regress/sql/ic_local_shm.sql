@@ -0,0 +1,138 @@
+--
+-- Test the shared memory rings of the UDP interconnect, see
+-- gp_interconnect_local_shm.  Every query must give the same results whether
+-- the packets go through the network or through the rings.
+--
+CREATE SCHEMA ic_local_shm;
+SET search_path = ic_local_shm;
+
+CREATE TABLE shm_t1 (a int, b int, c text) DISTRIBUTED BY (a);
+INSERT INTO shm_t1 SELECT i, i % 97, repeat('x', i % 50) FROM generate_series(1, 100000) i;
+CREATE TABLE shm_t2 (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO shm_t2 SELECT i, i FROM generate_series(1, 1000) i;
+-- no compression nor toasting, so that the tuples keep their size in the motions
+CREATE TABLE shm_t3 (a int, b int, c text) DISTRIBUTED BY (a);
+ALTER TABLE shm_t3 ALTER COLUMN c SET STORAGE PLAIN;
+INSERT INTO shm_t3 SELECT i, i % 97, repeat('x', (i % 50) * 100) FROM generate_series(1, 10000) i;
+ANALYZE shm_t1;
+ANALYZE shm_t2;
+ANALYZE shm_t3;
+-- Through the network
+SET gp_interconnect_local_shm = off;
+-- redistribute
+SELECT count(*), sum(n) FROM (SELECT b, count(*) AS n FROM shm_t1 GROUP BY b) s;
+-- join on a column that is not the distribution key
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a;
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.b;
+-- gather merge
+SELECT count(*), sum(length(c)) FROM (SELECT c FROM shm_t1 ORDER BY a LIMIT 100000) s;
+-- tuples larger than a packet
+SELECT count(*), sum(length(c)) FROM (SELECT repeat(c, 1000) AS c FROM shm_t1 WHERE a <= 200 ORDER BY a LIMIT 200) s;
+-- tuples that fit into a packet but not into the rest of the current one
+SELECT count(*), sum(length(c)) FROM (SELECT c, row_number() OVER (PARTITION BY b) FROM shm_t3) s;
+-- the receiver stops before the end of the stream
+SELECT a FROM shm_t1 WHERE b = 1 ORDER BY a LIMIT 3;
+BEGIN;
+DECLARE shm_cur CURSOR FOR SELECT t1.a FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a ORDER BY t1.a;
+FETCH 3 FROM shm_cur;
+CLOSE shm_cur;
+COMMIT;
+-- a sender errors out in the middle of the stream
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a WHERE 1 / (t1.a - 50000) > -1;
+
+-- Through the rings between the processes of a segment
+SET gp_interconnect_local_shm = loopback;
+-- redistribute
+SELECT count(*), sum(n) FROM (SELECT b, count(*) AS n FROM shm_t1 GROUP BY b) s;
+-- join on a column that is not the distribution key
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a;
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.b;
+-- gather merge
+SELECT count(*), sum(length(c)) FROM (SELECT c FROM shm_t1 ORDER BY a LIMIT 100000) s;
+-- tuples larger than a packet
+SELECT count(*), sum(length(c)) FROM (SELECT repeat(c, 1000) AS c FROM shm_t1 WHERE a <= 200 ORDER BY a LIMIT 200) s;
+-- tuples that fit into a packet but not into the rest of the current one
+SELECT count(*), sum(length(c)) FROM (SELECT c, row_number() OVER (PARTITION BY b) FROM shm_t3) s;
+-- the receiver stops before the end of the stream
+SELECT a FROM shm_t1 WHERE b = 1 ORDER BY a LIMIT 3;
+BEGIN;
+DECLARE shm_cur CURSOR FOR SELECT t1.a FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a ORDER BY t1.a;
+FETCH 3 FROM shm_cur;
+CLOSE shm_cur;
+COMMIT;
+-- a sender errors out in the middle of the stream
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a WHERE 1 / (t1.a - 50000) > -1;
+
+-- Same with a single slot per ring, so that the senders keep finding it full
+SET gp_interconnect_queue_depth = 1;
+-- redistribute
+SELECT count(*), sum(n) FROM (SELECT b, count(*) AS n FROM shm_t1 GROUP BY b) s;
+-- join on a column that is not the distribution key
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a;
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.b;
+-- gather merge
+SELECT count(*), sum(length(c)) FROM (SELECT c FROM shm_t1 ORDER BY a LIMIT 100000) s;
+-- tuples larger than a packet
+SELECT count(*), sum(length(c)) FROM (SELECT repeat(c, 1000) AS c FROM shm_t1 WHERE a <= 200 ORDER BY a LIMIT 200) s;
+-- tuples that fit into a packet but not into the rest of the current one
+SELECT count(*), sum(length(c)) FROM (SELECT c, row_number() OVER (PARTITION BY b) FROM shm_t3) s;
+-- the receiver stops before the end of the stream
+SELECT a FROM shm_t1 WHERE b = 1 ORDER BY a LIMIT 3;
+BEGIN;
+DECLARE shm_cur CURSOR FOR SELECT t1.a FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a ORDER BY t1.a;
+FETCH 3 FROM shm_cur;
+CLOSE shm_cur;
+COMMIT;
+-- a sender errors out in the middle of the stream
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a WHERE 1 / (t1.a - 50000) > -1;
+
+-- Through the rings between all the processes of the host
+RESET gp_interconnect_queue_depth;
+SET gp_interconnect_local_shm = on;
+-- redistribute
+SELECT count(*), sum(n) FROM (SELECT b, count(*) AS n FROM shm_t1 GROUP BY b) s;
+-- join on a column that is not the distribution key
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a;
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.b;
+-- gather merge
+SELECT count(*), sum(length(c)) FROM (SELECT c FROM shm_t1 ORDER BY a LIMIT 100000) s;
+-- tuples larger than a packet
+SELECT count(*), sum(length(c)) FROM (SELECT repeat(c, 1000) AS c FROM shm_t1 WHERE a <= 200 ORDER BY a LIMIT 200) s;
+-- tuples that fit into a packet but not into the rest of the current one
+SELECT count(*), sum(length(c)) FROM (SELECT c, row_number() OVER (PARTITION BY b) FROM shm_t3) s;
+-- the receiver stops before the end of the stream
+SELECT a FROM shm_t1 WHERE b = 1 ORDER BY a LIMIT 3;
+BEGIN;
+DECLARE shm_cur CURSOR FOR SELECT t1.a FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a ORDER BY t1.a;
+FETCH 3 FROM shm_cur;
+CLOSE shm_cur;
+COMMIT;
+-- a sender errors out in the middle of the stream
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a WHERE 1 / (t1.a - 50000) > -1;
+
+-- Same with a single slot per ring
+SET gp_interconnect_queue_depth = 1;
+-- redistribute
+SELECT count(*), sum(n) FROM (SELECT b, count(*) AS n FROM shm_t1 GROUP BY b) s;
+-- join on a column that is not the distribution key
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a;
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.b;
+-- gather merge
+SELECT count(*), sum(length(c)) FROM (SELECT c FROM shm_t1 ORDER BY a LIMIT 100000) s;
+-- tuples larger than a packet
+SELECT count(*), sum(length(c)) FROM (SELECT repeat(c, 1000) AS c FROM shm_t1 WHERE a <= 200 ORDER BY a LIMIT 200) s;
+-- tuples that fit into a packet but not into the rest of the current one
+SELECT count(*), sum(length(c)) FROM (SELECT c, row_number() OVER (PARTITION BY b) FROM shm_t3) s;
+-- the receiver stops before the end of the stream
+SELECT a FROM shm_t1 WHERE b = 1 ORDER BY a LIMIT 3;
+BEGIN;
+DECLARE shm_cur CURSOR FOR SELECT t1.a FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a ORDER BY t1.a;
+FETCH 3 FROM shm_cur;
+CLOSE shm_cur;
+COMMIT;
+-- a sender errors out in the middle of the stream
+SELECT count(*) FROM shm_t1 t1 JOIN shm_t2 t2 ON t1.b = t2.a WHERE 1 / (t1.a - 50000) > -1;
+
+RESET gp_interconnect_queue_depth;
+RESET gp_interconnect_local_shm;
+DROP SCHEMA ic_local_shm CASCADE;
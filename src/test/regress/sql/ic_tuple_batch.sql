@@ -0,0 +1,90 @@
+--
+-- Test the batches of tuples that unordered motions send column by column,
+-- see gp_interconnect_tuple_batch_size.  Every batch size must give the same
+-- results as sending the tuples one by one.  The planner is used so that the
+-- columns themselves, not expressions of them, go through the motions.  The
+-- batches are counted with the motion_tuple_batch_sent fault.
+--
+CREATE SCHEMA ic_tuple_batch;
+SET search_path = ic_tuple_batch;
+SET optimizer = off;
+
+-- Tuple batches sent by content 1 since the last call
+CREATE FUNCTION tuple_batches() RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('motion_tuple_batch_sent', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('motion_tuple_batch_sent', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault_infinite('motion_tuple_batch_sent', 'skip', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+-- fixed-width columns, NULLs, short varlenas, 4-byte header varlenas, and
+-- compressed and toasted ones
+CREATE TABLE tb (a int, b int, i8 int8, f float8, bl bool, s text, l text, z text) DISTRIBUTED BY (a);
+INSERT INTO tb SELECT a, a % 10,
+  CASE WHEN a % 13 = 0 THEN NULL ELSE a::int8 * 1000000007 END,
+  a * 0.5,
+  CASE WHEN a % 11 = 0 THEN NULL ELSE a % 3 = 0 END,
+  CASE WHEN a % 17 = 0 THEN NULL ELSE repeat(chr(97 + a % 10), a % 10 + 1) END,
+  repeat(md5(a::text), 5),
+  CASE WHEN a % 100 = 0 THEN repeat('z', 5000) || a END
+  FROM generate_series(1, 3000) a;
+UPDATE tb SET z = (SELECT string_agg(md5(a::text || j), '' ORDER BY j) FROM generate_series(1, 250) j) WHERE a % 250 = 1;
+
+SELECT gp_inject_fault_infinite('motion_tuple_batch_sent', 'skip', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+SET gp_interconnect_tuple_batch_size = 0;
+SELECT count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb;
+SELECT b, count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb GROUP BY b ORDER BY b;
+SELECT tuple_batches() AS batches;
+SET gp_interconnect_tuple_batch_size = 1;
+SELECT count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb;
+SELECT b, count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb GROUP BY b ORDER BY b;
+SELECT tuple_batches() > 0 AS batches;
+SET gp_interconnect_tuple_batch_size = 7;
+SELECT count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb;
+SELECT b, count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb GROUP BY b ORDER BY b;
+SELECT tuple_batches() > 0 AS batches;
+SET gp_interconnect_tuple_batch_size = 1000;
+SELECT count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb;
+SELECT b, count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb GROUP BY b ORDER BY b;
+SELECT tuple_batches() > 0 AS batches;
+SET gp_interconnect_tuple_batch_size = 8192;
+SELECT count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb;
+SELECT b, count(*), md5(string_agg(concat_ws('|', a, b, coalesce(i8::text, '-'), f, coalesce(bl::text, '-'), coalesce(s, '-'), l, coalesce(md5(z), '-')), ',' ORDER BY a)) FROM tb GROUP BY b ORDER BY b;
+SELECT tuple_batches() > 0 AS batches;
+
+SET gp_interconnect_tuple_batch_size = 1000;
+
+-- these are sent one by one: record types, cstrings and merge receives
+SELECT count(*), md5(string_agg(r::text, ',' ORDER BY a)) FROM (SELECT a, ROW(a, s) AS r FROM tb OFFSET 0) x;
+SELECT tuple_batches() AS batches;
+SELECT count(*), md5(string_agg(c::text, ',' ORDER BY a)) FROM (SELECT a, textout(l) AS c FROM tb OFFSET 0) x;
+SELECT tuple_batches() AS batches;
+SELECT a, s FROM tb WHERE a % 299 = 0 ORDER BY a;
+SELECT tuple_batches() AS batches;
+SELECT gp_inject_fault('motion_tuple_batch_sent', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+-- the receiver stops before the senders are done
+SELECT count(*) FROM (SELECT * FROM tb LIMIT 100) x;
+SELECT count(*) FROM (SELECT * FROM tb LIMIT 2500) x;
+
+-- a cursor fetches only part of the rows
+BEGIN;
+DECLARE c CURSOR FOR SELECT b, s FROM tb WHERE b = 3 AND s IS NOT NULL;
+FETCH 3 FROM c;
+MOVE 100 IN c;
+FETCH 2 FROM c;
+CLOSE c;
+COMMIT;
+
+RESET gp_interconnect_tuple_batch_size;
+RESET optimizer;
+DROP SCHEMA ic_tuple_batch CASCADE;
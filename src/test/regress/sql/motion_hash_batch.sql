@@ -0,0 +1,102 @@
+--
+-- Test the redistribute motions that hash their tuples in batches, see
+-- gp_motion_hash_batch_size.  The rows must go to the same segments as when
+-- every tuple is hashed on its own.  The batches hashed on content 1 are
+-- counted with the motion_hash_batch fault.
+--
+CREATE SCHEMA motion_hash_batch;
+SET search_path = motion_hash_batch;
+SET optimizer = off;
+
+-- Batches hashed on content 1 since the last call
+CREATE FUNCTION hash_batches() RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('motion_hash_batch', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('motion_hash_batch', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('motion_hash_batch', 'skip', '', '', '', 1, -1, 0, dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+
+-- All the rows are on content 1, every 7th a is NULL
+CREATE TABLE hb_src (k int, a int, b int8, c text, d numeric) DISTRIBUTED BY (k);
+INSERT INTO hb_src SELECT 0, CASE WHEN i % 7 = 0 THEN NULL ELSE i END, i * 1000003::int8, 'row ' || i % 1000, i / 8.0
+  FROM generate_series(1, 10000) i;
+ANALYZE hb_src;
+-- the rows redistributed one at a time go to hb_*_1, in batches to hb_*_n
+CREATE TABLE hb_a_1 (LIKE hb_src) DISTRIBUTED BY (a);
+CREATE TABLE hb_a_n (LIKE hb_src) DISTRIBUTED BY (a);
+CREATE TABLE hb_bc_1 (LIKE hb_src) DISTRIBUTED BY (b, c);
+CREATE TABLE hb_bc_n (LIKE hb_src) DISTRIBUTED BY (b, c);
+CREATE TABLE hb_d_1 (LIKE hb_src) DISTRIBUTED BY (d);
+CREATE TABLE hb_d_n (LIKE hb_src) DISTRIBUTED BY (d);
+CREATE TABLE hb_legacy_1 (LIKE hb_src) DISTRIBUTED BY (a cdbhash_int4_ops);
+CREATE TABLE hb_legacy_n (LIKE hb_src) DISTRIBUTED BY (a cdbhash_int4_ops);
+
+SELECT gp_inject_fault('motion_hash_batch', 'skip', '', '', '', 1, -1, 0, dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+SET gp_motion_hash_batch_size = 0;
+INSERT INTO hb_a_1 SELECT * FROM hb_src;
+INSERT INTO hb_bc_1 SELECT * FROM hb_src;
+INSERT INTO hb_d_1 SELECT * FROM hb_src;
+INSERT INTO hb_legacy_1 SELECT * FROM hb_src;
+SELECT hash_batches();
+
+-- int4, with NULLs
+SET gp_motion_hash_batch_size = 100;
+INSERT INTO hb_a_n SELECT * FROM hb_src;
+SELECT hash_batches();
+-- int8 and text, with a batch left over at the end of the stream
+SET gp_motion_hash_batch_size = 64;
+INSERT INTO hb_bc_n SELECT * FROM hb_src;
+SELECT hash_batches();
+-- numeric, through the function manager
+SET gp_motion_hash_batch_size = 1000;
+INSERT INTO hb_d_n SELECT * FROM hb_src;
+SELECT hash_batches();
+-- a legacy hash opclass
+SET gp_motion_hash_batch_size = 8192;
+INSERT INTO hb_legacy_n SELECT * FROM hb_src;
+SELECT hash_batches();
+
+-- every row is on the same segment both ways
+SELECT count(*) FROM hb_a_n;
+SELECT gp_segment_id, * FROM hb_a_1 EXCEPT ALL SELECT gp_segment_id, * FROM hb_a_n;
+SELECT count(*) FROM hb_bc_n;
+SELECT gp_segment_id, * FROM hb_bc_1 EXCEPT ALL SELECT gp_segment_id, * FROM hb_bc_n;
+SELECT count(*) FROM hb_d_n;
+SELECT gp_segment_id, * FROM hb_d_1 EXCEPT ALL SELECT gp_segment_id, * FROM hb_d_n;
+SELECT count(*) FROM hb_legacy_n;
+SELECT gp_segment_id, * FROM hb_legacy_1 EXCEPT ALL SELECT gp_segment_id, * FROM hb_legacy_n;
+
+SELECT gp_inject_fault('motion_hash_batch', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+SET gp_motion_hash_batch_size = 100;
+-- joins
+SELECT count(*) FROM hb_src s JOIN hb_bc_n t ON s.b = t.b AND s.c = t.c;
+SELECT count(*), count(t.a) FROM hb_src s LEFT JOIN hb_a_n t ON s.a = t.a;
+-- the receiver stops before the end of the stream
+SELECT count(*) FROM (SELECT s.a FROM hb_src s JOIN hb_d_n t ON s.d = t.d LIMIT 10) l;
+
+-- the hot keys of a hybrid redistribution
+CREATE TABLE skew_o (id int, k int) DISTRIBUTED BY (id);
+INSERT INTO skew_o SELECT i, CASE WHEN i % 2 = 0 THEN 1 WHEN i % 50 = 1 THEN NULL ELSE i END FROM generate_series(1, 3000) i;
+CREATE TABLE skew_i (id int, k int) DISTRIBUTED BY (id);
+INSERT INTO skew_i SELECT i, i % 1500 + 1 FROM generate_series(1, 2000) i;
+ANALYZE skew_o;
+ANALYZE skew_i;
+SET gp_enable_hybrid_redistribute = on;
+SELECT count(*), sum(o.id) FROM skew_o o JOIN skew_i i ON o.k = i.k;
+SELECT count(*), sum(o.id) FROM skew_o o LEFT JOIN skew_i i ON o.k = i.k;
+
+RESET gp_enable_hybrid_redistribute;
+RESET gp_motion_hash_batch_size;
+RESET optimizer;
+DROP SCHEMA motion_hash_batch CASCADE;
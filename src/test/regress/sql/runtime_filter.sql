@@ -0,0 +1,158 @@
+--
+-- Test the runtime filters that hash joins pass down to the scans of their
+-- outer side, see gp_enable_runtime_filter.  The rows a filter removes are
+-- counted with the runtime_filter_row_removed fault, and the join results
+-- must not change.
+--
+CREATE SCHEMA runtime_filter;
+SET search_path = runtime_filter;
+SET optimizer = off;
+
+-- Rows removed by runtime filters on content 1 since the last call, which
+-- starts counting the ones of the given table
+CREATE FUNCTION rf_rows_removed(rel text) RETURNS int AS $$
+DECLARE
+	status text;
+BEGIN
+	SELECT gp_inject_fault('runtime_filter_row_removed', 'status', dbid) INTO status
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('runtime_filter_row_removed', 'reset', dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	PERFORM gp_inject_fault('runtime_filter_row_removed', 'skip', '', '', rel, 1, -1, 0, dbid)
+		FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+	RETURN substring(status FROM 'num times hit:''(\d+)''')::int;
+END;
+$$ LANGUAGE plpgsql;
+-- Does the plan of 'query' move rows between segments?
+CREATE FUNCTION rf_has_motion(query text) RETURNS bool AS $$
+DECLARE
+	line text;
+BEGIN
+	FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query LOOP
+		IF line ~ '(Redistribute|Broadcast) Motion' THEN
+			RETURN true;
+		END IF;
+	END LOOP;
+	RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TABLE rf_o (k int, v int) DISTRIBUTED BY (k);
+INSERT INTO rf_o SELECT i, i % 7 FROM generate_series(1, 30000) i;
+INSERT INTO rf_o SELECT NULL, 0 FROM generate_series(1, 10);
+-- 300 of the inner keys match, 100 don't, and one is NULL
+CREATE TABLE rf_i (k int) DISTRIBUTED BY (k);
+INSERT INTO rf_i SELECT i * 100 FROM generate_series(1, 400) i;
+INSERT INTO rf_i VALUES (NULL);
+CREATE TABLE rf_i8 (k int8) DISTRIBUTED BY (k);
+INSERT INTO rf_i8 SELECT k FROM rf_i;
+CREATE TABLE rf_x (k int) DISTRIBUTED BY (k);
+INSERT INTO rf_x SELECT i FROM generate_series(2, 30000, 2) i;
+-- the same rows, not distributed on the join key
+CREATE TABLE rf_iv (id int, k int) DISTRIBUTED BY (id);
+INSERT INTO rf_iv SELECT i, i * 100 FROM generate_series(1, 400) i;
+INSERT INTO rf_iv VALUES (401, NULL);
+CREATE TABLE rf_ov (k int, v int) DISTRIBUTED RANDOMLY;
+INSERT INTO rf_ov SELECT * FROM rf_o;
+ANALYZE rf_o;
+ANALYZE rf_i;
+ANALYZE rf_i8;
+ANALYZE rf_x;
+ANALYZE rf_iv;
+ANALYZE rf_ov;
+
+SELECT gp_inject_fault('runtime_filter_row_removed', 'skip', '', '', 'rf_o', 1, -1, 0, dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+
+-- inner join
+SET gp_enable_runtime_filter = off;
+SELECT count(*), sum(o.v) FROM rf_o o JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), sum(o.v) FROM rf_o o JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') > 5000 AS removed;
+
+-- right join, the unmatched inner rows are kept
+SET gp_enable_runtime_filter = off;
+SELECT count(*), count(o.k) FROM rf_o o RIGHT JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), count(o.k) FROM rf_o o RIGHT JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') > 5000 AS removed;
+
+-- semi join
+SET gp_enable_runtime_filter = off;
+SELECT count(*), sum(o.v) FROM rf_o o WHERE EXISTS (SELECT 1 FROM rf_i i WHERE i.k = o.k);
+SELECT rf_rows_removed('rf_o') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), sum(o.v) FROM rf_o o WHERE EXISTS (SELECT 1 FROM rf_i i WHERE i.k = o.k);
+SELECT rf_rows_removed('rf_o') > 5000 AS removed;
+
+-- the filter passes through the outer side of another join
+SET gp_enable_runtime_filter = off;
+SELECT count(*), count(x.k) FROM rf_o o LEFT JOIN rf_x x ON o.k = x.k JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), count(x.k) FROM rf_o o LEFT JOIN rf_x x ON o.k = x.k JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') > 5000 AS removed;
+
+-- int4 = int8 keys hash alike
+SET gp_enable_runtime_filter = off;
+SELECT count(*), sum(o.v) FROM rf_o o JOIN rf_i8 i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), sum(o.v) FROM rf_o o JOIN rf_i8 i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') > 5000 AS removed;
+
+-- a left join keeps the unmatched outer rows, so it gets no filter
+SET gp_enable_runtime_filter = off;
+SELECT count(*), count(i.k) FROM rf_o o LEFT JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), count(i.k) FROM rf_o o LEFT JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') AS removed;
+
+-- The filter is not sent across a Motion, so only the scans in the slice of
+-- the join are filtered.  The inner rows can still come through a Motion,
+-- when the inner rel is not distributed on the join key
+SELECT rf_has_motion($$SELECT count(*), sum(o.v) FROM rf_o o JOIN rf_iv i ON o.k = i.k$$) AS motion;
+SET gp_enable_runtime_filter = off;
+SELECT count(*), sum(o.v) FROM rf_o o JOIN rf_iv i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), sum(o.v) FROM rf_o o JOIN rf_iv i ON o.k = i.k;
+SELECT rf_rows_removed('rf_o') > 5000 AS removed;
+-- or when the outer rel is not
+SELECT rf_has_motion($$SELECT count(*), sum(o.v) FROM rf_ov o JOIN rf_i i ON o.k = i.k$$) AS motion;
+SET gp_enable_runtime_filter = off;
+SELECT count(*), sum(o.v) FROM rf_ov o JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_ov') AS removed;
+SET gp_enable_runtime_filter = on;
+SELECT count(*), sum(o.v) FROM rf_ov o JOIN rf_i i ON o.k = i.k;
+SELECT rf_rows_removed('rf_ov') > 5000 AS removed;
+
+-- NULL keys never match, and are not in the filter
+SELECT count(*) FROM rf_o o JOIN rf_i i ON o.k = i.k WHERE o.k IS NULL;
+SELECT count(*) FROM rf_o o RIGHT JOIN rf_i i ON o.k = i.k WHERE i.k IS NULL;
+
+-- The hash table of a correlated subquery is rebuilt for each outer row, and
+-- its filter with it.  Replicated tables keep the subquery in one slice.
+CREATE TABLE rf_ro (k int, v int) DISTRIBUTED REPLICATED;
+INSERT INTO rf_ro SELECT * FROM rf_o;
+CREATE TABLE rf_ri (k int) DISTRIBUTED REPLICATED;
+INSERT INTO rf_ri SELECT * FROM rf_i;
+CREATE TABLE rf_p (a int) DISTRIBUTED BY (a);
+INSERT INTO rf_p VALUES (0), (100), (250), (5000), (30000), (40000);
+ANALYZE rf_ro;
+ANALYZE rf_ri;
+ANALYZE rf_p;
+SET gp_enable_runtime_filter = off;
+SELECT p.a, (SELECT count(*) FROM rf_ro o JOIN rf_ri i ON o.k = i.k WHERE i.k <= p.a) FROM rf_p p ORDER BY p.a;
+SET gp_enable_runtime_filter = on;
+SELECT p.a, (SELECT count(*) FROM rf_ro o JOIN rf_ri i ON o.k = i.k WHERE i.k <= p.a) FROM rf_p p ORDER BY p.a;
+
+SELECT gp_inject_fault('runtime_filter_row_removed', 'reset', dbid)
+    FROM gp_segment_configuration WHERE content = 1 AND role = 'p';
+RESET gp_enable_runtime_filter;
+RESET optimizer;
+DROP SCHEMA runtime_filter CASCADE;